@@ -53,6 +53,7 @@
 //#include "KrellInstitute/Core/SymtabAPISymbols.hpp"
 #include "KrellInstitute/Core/Time.hpp"
 #include "KrellInstitute/Core/CBTFTopology.hpp"
+#include "KrellInstitute/Messages/NativeEncoding.h"
 
 using namespace boost;
 using namespace KrellInstitute::CBTF;
@@ -531,6 +532,10 @@ int main(int argc, char** argv)
 	    "Name of the mpi executable. This must match the name of the mpi exectuable used in the program argument and implies the collection is being done on an mpi job if it is set.")
         ("offline", boost::program_options::bool_switch()->default_value(false),
 	    "Use offline mode. Default is false.")
+        ("native-wire", boost::program_options::bool_switch()->default_value(false),
+	    "Send performance data to the leaf CPs in the native layout of this"
+	    " frontend rather than XDR. Only use when the CPs share the"
+	    " architecture of the frontend. Default is false.")
         ;
 
     boost::program_options::variables_map vm;
@@ -546,6 +551,7 @@ int main(int argc, char** argv)
     boost::program_options::notify(vm);
 
     bool use_offline_mode = vm["offline"].as<bool>();
+    bool use_native_wire = vm["native-wire"].as<bool>();
     bool exe_has_openmp = false;
     exe_class_types theExecutableType = Unknown_exe_type;
 
@@ -614,6 +620,15 @@ int main(int argc, char** argv)
 
     CBTFTopology cbtftopology;
     if (!use_offline_mode) {
+	// Ask the collectors to send their performance data natively when
+	// the CPs share the layout of this frontend. The collectors check this
+	// layout against their own and use XDR when they differ.
+	if (use_native_wire) {
+	    std::ostringstream layout;
+	    layout << CBTF_NativeLayout();
+	    setenv(CBTF_WIRE_LAYOUT_ENV, layout.str().c_str(), true);
+	}
+
 	// start with a fresh connections file.
 	// FIXME: this likely would remove any connections file passed
 	// on the command line. Should we allow that any more...
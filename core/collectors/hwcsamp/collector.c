@@ -308,7 +308,16 @@ static void hwcsampTimerHandler(const ucontext_t* context)
     if(tls->defer_sampling == true) {
         return;
     }
- 
+
+    /* Send the samples taken at the old rate if the timer adapted its rate */
+    uint64_t interval = CBTF_GetTimerInterval();
+    if (interval != tls->data.effective_interval) {
+	if (tls->buffer.length > 0) {
+	    send_samples(tls);
+	}
+	tls->data.effective_interval = interval;
+    }
+
     /* Obtain the program counter (PC) address from the thread context */
     uint64_t pc = CBTF_GetPCFromContext(context);
 
@@ -437,6 +446,7 @@ void cbtf_collector_start(const CBTF_DataHeader* header)
     args.collector = 1;
     args.experiment = 0;
     tls->data.interval = (uint64_t)(1000000000) / (uint64_t)(hwcsamp_rate);;
+    tls->data.effective_interval = tls->data.interval;
 #endif
 
 
@@ -99,6 +99,11 @@ typedef struct {
     /**< exist in buffer stacktraces. */
     CBTF_StackTraceData buffer;
 
+#if defined(USE_CCT)
+    /** Calling context tree of the sampled stacks. */
+    CBTF_CCTData tree;
+#endif
+
 #if defined (HAVE_OMPT)
     /* these are ompt specific. */
     bool thread_idle, thread_wait_barrier, thread_barrier;
@@ -265,6 +270,20 @@ static void initialize_data(TLS* tls)
     /* Re-initialize the sampling buffer */
     memset(tls->buffer.stacktraces, 0, sizeof(tls->buffer.stacktraces));
     memset(tls->buffer.count, 0, sizeof(tls->buffer.count));
+
+    /* Re-initialize the calling context tree */
+    tls->data.cct_pc.cct_pc_len = 0;
+    tls->data.cct_pc.cct_pc_val = NULL;
+    tls->data.cct_parent.cct_parent_len = 0;
+    tls->data.cct_parent.cct_parent_val = NULL;
+    tls->data.cct_count.cct_count_len = 0;
+    tls->data.cct_count.cct_count_val = NULL;
+#if defined(USE_CCT)
+    tls->data.cct_pc.cct_pc_val = tls->tree.pc;
+    tls->data.cct_parent.cct_parent_val = tls->tree.parent;
+    tls->data.cct_count.cct_count_val = tls->tree.count;
+    CBTF_InitializeCCTData(&tls->tree);
+#endif
 }
 
 
@@ -333,6 +352,14 @@ static void send_samples (TLS* tls)
     tls->header.rank = monitor_mpi_comm_rank();
 #endif
 
+#if defined(USE_CCT)
+    tls->header.addr_begin = tls->tree.addr_begin;
+    tls->header.addr_end = tls->tree.addr_end;
+    tls->data.cct_pc.cct_pc_len = tls->tree.length;
+    tls->data.cct_parent.cct_parent_len = tls->tree.length;
+    tls->data.cct_count.cct_count_len = tls->tree.length;
+#endif
+
 #ifndef NDEBUG
 	if (IsCollectorDebugEnabled) {
 	    fprintf(stderr, "[%ld,%d] hwctime send_samples: time_range(%lu,%lu) addr range[%lx, %lx] stacktraces_len(%d) count_len(%d)\n",
@@ -417,7 +444,11 @@ hwctimePAPIHandler(int EventSet, void *address, long_long overflow_vector, void*
      * overhead.
      */
 
-#if defined(USE_FASTTRACE)
+#if defined(USE_FPTRACE)
+    /* Frame pointer unwinder starting directly from the overflow context. */
+    CBTF_GetStackTraceFP((const ucontext_t*)context, 0,
+                        CBTF_USERTIME_MAXFRAMES /* maxframes*/, &framecount, framebuf) ;
+#elif defined(USE_FASTTRACE)
     CBTF_GetStackTrace(FALSE, 6,
                         CBTF_USERTIME_MAXFRAMES /* maxframes*/, &framecount, framebuf) ;
 #else
@@ -470,6 +501,13 @@ hwctimePAPIHandler(int EventSet, void *address, long_long overflow_vector, void*
     }
 #endif // if defined (HAVE_OMPT)
 
+#if defined(USE_CCT)
+    /* add the stack to the calling context tree. (sends the tree if full) */
+    if (!CBTF_UpdateCCTData(framecount, framebuf, &tls->tree)) {
+	send_samples(tls);
+	CBTF_UpdateCCTData(framecount, framebuf, &tls->tree);
+    }
+#else
     bool_t stack_already_exists = FALSE;
 
     int i, j;
@@ -533,12 +571,14 @@ hwctimePAPIHandler(int EventSet, void *address, long_long overflow_vector, void*
 	if (framebuf[i] < tls->header.addr_begin ) {
 	    tls->header.addr_begin = framebuf[i];
 	}
-	if (framebuf[i] > tls->header.addr_end ) {
+	if (!CBTF_IsFrameRepeat(framebuf[i]) &&
+	    framebuf[i] > tls->header.addr_end ) {
 	    tls->header.addr_end = framebuf[i];
 	}
 	tls->data.stacktraces.stacktraces_len++;
 	tls->data.count.count_len++;
     }
+#endif
 }
 
 void collector_record_addr(char* name, uint64_t addr)
@@ -661,6 +701,11 @@ void cbtf_collector_start(const CBTF_DataHeader* header)
     CBTF_Overflow(tls->EventSet, papi_event_code,
 		    hwctime_papithreshold, hwctimePAPIHandler);
 
+#if defined(__linux) && defined(__x86_64) && defined(USE_FPTRACE)
+    /* Set up the frame cache here since the handler can't allocate it. */
+    CBTF_InitializeStackTraceFP();
+#endif
+
     /* Begin sampling */
     tls->header.time_begin = CBTF_GetTime();
     tls->defer_sampling=false;
@@ -763,7 +808,11 @@ void cbtf_collector_stop()
     tls->header.time_end = CBTF_GetTime();
 
     /* Are there any unsent samples? */
+#if defined(USE_CCT)
+    if(tls->tree.length > 0) {
+#else
     if(tls->data.stacktraces.stacktraces_len > 0) {
+#endif
 	/* Send these samples */
 	send_samples(tls);
     }
@@ -780,6 +829,10 @@ void cbtf_collector_stop()
 #endif
 #endif
 
+#if defined(__linux) && defined(__x86_64) && defined(USE_FPTRACE)
+    CBTF_FinalizeStackTraceFP();
+#endif
+
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     destroy_explicit_tls();
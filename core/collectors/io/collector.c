@@ -48,6 +48,19 @@
 #include "IOTraceableFunctions.h"
 #include "monitor.h"
 
+#if defined(EXTENDEDTRACE)
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Newer kernels renamed these but they're the same. See wrappers.c */
+#if defined(SYS_pread64) && !defined(SYS_pread)
+#define SYS_pread SYS_pread64
+#endif
+#if defined(SYS_pwrite64) && !defined(SYS_pwrite)
+#define SYS_pwrite SYS_pwrite64
+#endif
+#endif
+
 // FIXME: What include are these defined in?
 extern bool cbtf_connected_to_mrnet();
 extern bool cbtf_mpi_init_done();
@@ -112,8 +125,65 @@ const unsigned OverheadFrameCount = 2;
 #if defined(EXTENDEDTRACE)
 #define EventBufferSize (CBTF_BlobSizeFactor * 140)
 #define PathBufferSize  (CBTF_BlobSizeFactor * 2048)
+
+/** Number of characters in the pathname intern table. */
+#define PathStoreSize (CBTF_BlobSizeFactor * 4096)
+
+/** Maximum number of pathnames in the intern table. */
+#define MaxPathIds 2048
+
+/** Number of entries in the pathname intern table's hash table. */
+#define PathHashSize (2 * MaxPathIds)
+
 /* FIXME: is this thread safe? */
 char currentpathname[PATH_MAX];
+
+/** Number of entries in the per file descriptor statistics table. */
+#define MaxStatsFds 256
+
+/** Number of characters kept from the pathname of each file descriptor. */
+#define MaxStatsPathLen 256
+
+/** Number of retired file descriptor statistics in the statistics blob. */
+#define StatsBufferSize (CBTF_BlobSizeFactor * 16)
+
+/** Number of characters of pathnames in the statistics blob. */
+#define StatsPathBufferSize (StatsBufferSize * 64)
+
+/** Flag indicating if only per file descriptor statistics are collected. */
+bool_t io_stats_only = FALSE;
+
+/** Type representing an entry in the per file descriptor statistics table. */
+typedef struct {
+    CBTF_io_fd_stats stats;          /**< Statistics of the file descriptor. */
+    uint64_t position;               /**< Estimated file position. */
+    uint64_t next_offset;            /**< Offset of a sequential access. */
+    bool_t active;                   /**< Is this entry in use? */
+    bool_t used;                     /**< Has this entry ever been in use? */
+    char pathname[MaxStatsPathLen];  /**< Pathname of the file. */
+} FdStatsEntry;
+
+/** Type representing the per file descriptor statistics of a thread. */
+typedef struct {
+
+    CBTF_io_stats_data data;  /**< Statistics data blob. */
+
+    /** Statistics buffer. */
+    struct {
+        CBTF_io_fd_stats files[StatsBufferSize];  /**< Retired statistics. */
+        char pathnames[StatsPathBufferSize];      /**< Their pathnames. */
+    } buffer;
+
+    /**
+     * Per file descriptor statistics table, hashed by file descriptor with
+     * linear probing. An entry is retired into the statistics blob when its
+     * file descriptor is closed or reopened, or when the table is full and
+     * another file descriptor needs its slot. Retired entries keep their
+     * used flag so that later probes continue past them.
+     */
+    FdStatsEntry fds[MaxStatsFds];
+
+} FdStats;
 #elif !defined(PROFILE)
 #define EventBufferSize (CBTF_BlobSizeFactor * 415)
 #endif
@@ -150,6 +220,25 @@ typedef struct {
 #endif
     } buffer;
 #endif
+
+#if defined(EXTENDEDTRACE)
+    /**
+     * Pathname intern table. Each distinct pathname is given a path ID the
+     * first time this thread sees it and only that ID is recorded in later
+     * events. The table outlives each data blob. The pathname itself is
+     * added to the blob's pathnames only when it is first interned.
+     */
+    struct {
+        char strings[PathStoreSize];        /**< Interned pathnames. */
+        uint32_t offsets[MaxPathIds + 1];   /**< Offset of each path ID. */
+        uint16_t hash_table[PathHashSize];  /**< Path IDs hashed by name. */
+        uint32_t strings_len;               /**< Characters used. */
+        uint16_t next_id;                   /**< Next path ID to assign. */
+    } paths;
+
+    /** Per file descriptor statistics (allocated only when collected). */
+    FdStats* stats;
+#endif
     
 #if defined (CBTF_SERVICE_USE_OFFLINE)
     char CBTF_io_traced[PATH_MAX];
@@ -184,6 +273,18 @@ static const uint32_t TLSKey = 0x00001EF7;
 
 int io_init_tls_done = 0;
 
+/** Slot assigned to our key by the TLS service. */
+static uint32_t TLSSlot = 0;
+
+/**
+ * Register our key with the TLS service upon loading so that every access
+ * to our thread-local storage is a direct slot lookup rather than a search.
+ */
+static void __attribute__ ((constructor)) register_tls_slot()
+{
+    TLSSlot = CBTF_RegisterTLS(TLSKey);
+}
+
 #else
 
 /** Thread-local storage. */
@@ -194,7 +295,7 @@ static __thread TLS the_tls;
 void defer_trace(bool defer_tracing) {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -242,10 +343,9 @@ static void initialize_data(TLS* tls)
 #else
     memset(tls->buffer.events, 0, sizeof(tls->buffer.events));
 #if defined(EXTENDEDTRACE)
-    tls->data.pathnames.pathnames_len = 1;
-    //tls->buffer.pathnames[0] = 0;
+    tls->data.first_pathid = tls->paths.next_id;
+    tls->data.pathnames.pathnames_len = 0;
     tls->data.pathnames.pathnames_val = tls->buffer.pathnames;
-    memset(tls->buffer.pathnames, 0, sizeof(tls->buffer.pathnames));
 #endif
 #endif
 }
@@ -341,6 +441,414 @@ static void send_samples(TLS *tls)
     initialize_data(tls);
 }
 
+#if defined(EXTENDEDTRACE)
+/**
+ * Reset the pathname intern table contained within the given thread-local
+ * storage. The next pathname interned is given path ID 1, which tells the
+ * decoder to forget the pathnames previously sent by this thread.
+ *
+ * @param tls    Thread-local storage to be reset.
+ */
+static void reset_pathnames(TLS* tls)
+{
+    Assert(tls != NULL);
+
+    tls->paths.strings_len = 0;
+    tls->paths.next_id = 1;
+    memset(tls->paths.hash_table, 0, sizeof(tls->paths.hash_table));
+    tls->data.first_pathid = 1;
+}
+
+
+
+/**
+ * Intern a pathname.
+ *
+ * Returns the path ID of the specified pathname, assigning a new path ID and
+ * adding the pathname to the data blob if this thread hasn't seen it before.
+ * The data blob is sent first if it doesn't have room for the pathname, and
+ * the intern table is reset once it fills up.
+ *
+ * @param tls         Thread-local storage containing the intern table.
+ * @param pathname    Pathname to be interned.
+ * @return            Path ID of the pathname.
+ */
+static uint16_t intern_pathname(TLS* tls, const char* pathname)
+{
+    uint32_t hash = 2166136261u;
+    unsigned len, index;
+    uint16_t id;
+    const char* c;
+
+    for(c = pathname; *c != 0; ++c)
+	hash = (hash ^ (unsigned char)*c) * 16777619u;
+    len = c - pathname;
+
+    /* Look for the pathname in the intern table */
+    index = hash % PathHashSize;
+    while((id = tls->paths.hash_table[index]) != 0) {
+	if(strcmp(&tls->paths.strings[tls->paths.offsets[id]], pathname) == 0)
+	    return id;
+	index = (index + 1) % PathHashSize;
+    }
+
+    /* Send events if the data blob has no room for this pathname */
+    if((tls->data.pathnames.pathnames_len + len + 1) > PathBufferSize)
+	send_samples(tls);
+
+    /* Start over if the intern table is full */
+    if((tls->paths.next_id > MaxPathIds) ||
+       ((tls->paths.strings_len + len + 1) > PathStoreSize)) {
+	if(tls->data.pathnames.pathnames_len > 0 ||
+	   tls->data.events.events_len > 0)
+	    send_samples(tls);
+	reset_pathnames(tls);
+	index = hash % PathHashSize;
+    }
+
+    /* Add the pathname to the intern table */
+    id = tls->paths.next_id++;
+    tls->paths.offsets[id] = tls->paths.strings_len;
+    memcpy(&tls->paths.strings[tls->paths.strings_len], pathname, len + 1);
+    tls->paths.strings_len += len + 1;
+    tls->paths.hash_table[index] = id;
+
+    /* And to the data blob */
+    memcpy(&tls->buffer.pathnames[tls->data.pathnames.pathnames_len],
+	   pathname, len + 1);
+    tls->data.pathnames.pathnames_len += len + 1;
+
+    return id;
+}
+
+
+/**
+ * Initialize the statistics blob contained within the given thread-local
+ * storage.
+ *
+ * @param tls    Thread-local storage to be initialized.
+ */
+static void initialize_stats(TLS* tls)
+{
+    Assert(tls != NULL);
+    Assert(tls->stats != NULL);
+
+    tls->stats->data.files.files_val = tls->stats->buffer.files;
+    tls->stats->data.files.files_len = 0;
+    tls->stats->data.pathnames.pathnames_val = tls->stats->buffer.pathnames;
+    tls->stats->data.pathnames.pathnames_len = 0;
+}
+
+
+
+/**
+ * Send the statistics blob.
+ *
+ * Sends the retired file descriptor statistics to the framework under their
+ * own data header identifier, leaving the event tracing data blob alone. Then
+ * resets the statistics blob to the empty state.
+ *
+ * @param tls    Thread-local storage containing the statistics blob.
+ */
+static void send_stats(TLS* tls)
+{
+    CBTF_DataHeader header;
+
+    Assert(tls != NULL);
+
+    memcpy(&header, &tls->header, sizeof(CBTF_DataHeader));
+    header.id = strdup("iostats");
+    header.time_end = CBTF_GetTime();
+    header.addr_begin = ~0;
+    header.addr_end = 0;
+    header.rank = monitor_mpi_comm_rank();
+
+#ifndef NDEBUG
+    if (IsCollectorDebugEnabled) {
+	fprintf(stderr, "[%ld,%d] io send_stats: files_len(%u)\n",
+		tls->header.pid, tls->header.omp_tid,
+		tls->stats->data.files.files_len);
+    }
+#endif
+
+    cbtf_collector_send(&header, (xdrproc_t)xdr_CBTF_io_stats_data,
+			&(tls->stats->data));
+    free(header.id);
+
+    initialize_stats(tls);
+}
+
+
+
+/**
+ * Retire a statistics table entry.
+ *
+ * Adds the statistics of the specified entry, along with its pathname, to the
+ * statistics blob and frees the entry. The blob is sent first if it doesn't
+ * have room for them.
+ *
+ * @param tls      Thread-local storage containing the statistics.
+ * @param entry    Entry to be retired.
+ */
+static void retire_fd_stats(TLS* tls, FdStatsEntry* entry)
+{
+    CBTF_io_stats_data* data = &tls->stats->data;
+    unsigned len = strlen(entry->pathname);
+
+    if((data->files.files_len == StatsBufferSize) ||
+       ((data->pathnames.pathnames_len + len + 1) > StatsPathBufferSize))
+	send_stats(tls);
+
+    entry->stats.pathname = data->pathnames.pathnames_len;
+    memcpy(&tls->stats->buffer.pathnames[data->pathnames.pathnames_len],
+	   entry->pathname, len + 1);
+    data->pathnames.pathnames_len += len + 1;
+
+    memcpy(&tls->stats->buffer.files[data->files.files_len],
+	   &entry->stats, sizeof(CBTF_io_fd_stats));
+    data->files.files_len++;
+
+    entry->active = FALSE;
+}
+
+
+
+/**
+ * Find the statistics table entry of a file descriptor.
+ *
+ * Probes the statistics table starting at the file descriptor's hashed slot
+ * until its entry, or a slot that has never been used, is found. Slots used
+ * by other file descriptors are skipped, so colliding file descriptors each
+ * keep their own entry.
+ *
+ * @param tls          Thread-local storage containing the statistics.
+ * @param fd           File descriptor to be found.
+ * @retval free_entry  First free entry on the probe sequence or null if the
+ *                     table is full.
+ * @return             Entry of the file descriptor or null if it has none.
+ */
+static FdStatsEntry* find_fd_stats(TLS* tls, int fd, FdStatsEntry** free_entry)
+{
+    unsigned i, index = (unsigned)fd % MaxStatsFds;
+    FdStatsEntry* entry;
+
+    *free_entry = NULL;
+    for(i = 0; i < MaxStatsFds; ++i, index = (index + 1) % MaxStatsFds) {
+	entry = &tls->stats->fds[index];
+	if(entry->active) {
+	    if(entry->stats.fd == fd)
+		return entry;
+	}
+	else {
+	    if(*free_entry == NULL)
+		*free_entry = entry;
+	    if(!entry->used)
+		break;
+	}
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * Start a statistics table entry.
+ *
+ * Starts a new entry for the specified file descriptor, retiring its previous
+ * entry if it already has one. When the table is full the entry in the file
+ * descriptor's hashed slot is retired to make room. When the pathname isn't
+ * known (the file descriptor was opened before collection started or by
+ * another thread) it is looked up in the /proc filesystem once.
+ *
+ * @param tls         Thread-local storage containing the statistics.
+ * @param fd          File descriptor of the new entry.
+ * @param pathname    Pathname of the file or null if not known.
+ * @return            New entry.
+ */
+static FdStatsEntry* new_fd_stats(TLS* tls, int fd, const char* pathname)
+{
+    FdStatsEntry* free_entry = NULL;
+    FdStatsEntry* entry = find_fd_stats(tls, fd, &free_entry);
+    char pf[64];
+    ssize_t len;
+
+    if(entry != NULL)
+	retire_fd_stats(tls, entry);
+    else if(free_entry != NULL)
+	entry = free_entry;
+    else {
+	entry = &tls->stats->fds[(unsigned)fd % MaxStatsFds];
+#ifndef NDEBUG
+	if (IsCollectorDebugEnabled) {
+	    fprintf(stderr, "[%ld,%d] io stats table full: fd %d retires fd %d\n",
+		    tls->header.pid, tls->header.omp_tid, fd, entry->stats.fd);
+	}
+#endif
+	retire_fd_stats(tls, entry);
+    }
+
+    memset(&entry->stats, 0, sizeof(CBTF_io_fd_stats));
+    entry->stats.fd = fd;
+    entry->position = 0;
+    entry->next_offset = 0;
+    entry->active = TRUE;
+    entry->used = TRUE;
+
+    if(pathname != NULL) {
+	strncpy(entry->pathname, pathname, MaxStatsPathLen - 1);
+	entry->pathname[MaxStatsPathLen - 1] = 0;
+    }
+    else {
+	sprintf(pf, "/proc/self/fd/%d", fd);
+	len = readlink(pf, entry->pathname, MaxStatsPathLen - 1);
+	entry->pathname[(len > 0) ? len : 0] = 0;
+    }
+
+    return entry;
+}
+
+
+
+/**
+ * Get the statistics table entry of a file descriptor, starting a new entry
+ * if the file descriptor doesn't have one yet.
+ *
+ * @param tls    Thread-local storage containing the statistics.
+ * @param fd     File descriptor to be found.
+ * @return       Entry of the file descriptor.
+ */
+static FdStatsEntry* get_fd_stats(TLS* tls, int fd)
+{
+    FdStatsEntry* free_entry = NULL;
+    FdStatsEntry* entry = find_fd_stats(tls, fd, &free_entry);
+
+    if(entry != NULL)
+	return entry;
+    return new_fd_stats(tls, fd, NULL);
+}
+
+
+
+/**
+ * Update the per file descriptor statistics.
+ *
+ * Adds the specified event to the statistics table entry of the file
+ * descriptor it used. Reads and writes are classified as sequential when
+ * they start where the previous read or write of that file descriptor ended
+ * and as random otherwise. Opens, creates and dups start a new entry for the
+ * resulting file descriptor, and closes retire its entry. Pipe calls aren't
+ * attributed to any file descriptor.
+ *
+ * @param tls      Thread-local storage containing the statistics.
+ * @param event    Event to be added.
+ */
+static void update_fd_stats(TLS* tls, const CBTF_iot_event* event)
+{
+    uint64_t time = event->stop_time - event->start_time;
+    uint64_t offset;
+    unsigned bucket = 0;
+    int fd = (int)event->sysargs[0];
+    FdStatsEntry* entry = NULL;
+    char pathname[MaxStatsPathLen];
+
+    switch(event->syscallno) {
+
+    case SYS_open:
+    case SYS_creat:
+	if(event->retval < 0)
+	    return;
+	entry = new_fd_stats(tls, event->retval, currentpathname);
+	entry->stats.other_calls++;
+	entry->stats.other_time += time;
+	break;
+
+    case SYS_dup:
+    case SYS_dup2:
+	if((fd < 0) || (event->retval < 0))
+	    return;
+	strcpy(pathname, get_fd_stats(tls, fd)->pathname);
+	entry = new_fd_stats(tls, event->retval, pathname);
+	entry->stats.other_calls++;
+	entry->stats.other_time += time;
+	break;
+
+    case SYS_lseek:
+	if(fd < 0)
+	    return;
+	entry = get_fd_stats(tls, fd);
+	if(event->sysargs[2] == SEEK_SET)
+	    entry->position = event->sysargs[1];
+	else if(event->sysargs[2] == SEEK_CUR)
+	    entry->position += event->sysargs[1];
+	else
+	    entry->position = (event->retval < 0) ? ~0 : event->retval;
+	entry->stats.other_calls++;
+	entry->stats.other_time += time;
+	break;
+
+    case SYS_close:
+	if(fd < 0)
+	    return;
+	entry = get_fd_stats(tls, fd);
+	entry->stats.other_calls++;
+	entry->stats.other_time += time;
+	break;
+
+    case SYS_read:
+    case SYS_readv:
+    case SYS_pread:
+    case SYS_write:
+    case SYS_writev:
+    case SYS_pwrite:
+	if(fd < 0)
+	    return;
+	entry = get_fd_stats(tls, fd);
+	if(event->retval >= 0) {
+	    if((event->syscallno == SYS_pread) ||
+	       (event->syscallno == SYS_pwrite))
+		offset = event->sysargs[3];
+	    else
+		offset = entry->position;
+	    if(offset == entry->next_offset)
+		entry->stats.sequential++;
+	    else
+		entry->stats.random++;
+	    entry->next_offset = offset + event->retval;
+	    if((event->syscallno != SYS_pread) &&
+	       (event->syscallno != SYS_pwrite))
+		entry->position = entry->next_offset;
+	}
+	if((event->syscallno == SYS_read) || (event->syscallno == SYS_readv) ||
+	   (event->syscallno == SYS_pread)) {
+	    entry->stats.read_calls++;
+	    entry->stats.read_bytes += (event->retval > 0) ? event->retval : 0;
+	    entry->stats.read_time += time;
+	}
+	else {
+	    entry->stats.write_calls++;
+	    entry->stats.write_bytes += (event->retval > 0) ? event->retval : 0;
+	    entry->stats.write_time += time;
+	}
+	break;
+
+    default:
+	return;
+    }
+
+    /* Bin the call by the log2 of its time in microseconds */
+    for(time /= 1000; (time > 0) && (bucket < CBTF_IO_STATS_HISTOGRAM_SIZE - 1);
+	time >>= 1)
+	++bucket;
+    entry->stats.histogram[bucket]++;
+
+    if(event->syscallno == SYS_close)
+	retire_fd_stats(tls, entry);
+}
+#endif
+
+
+
 /**
  * Start an event.
  *
@@ -364,7 +872,7 @@ void io_start_event(CBTF_io_event* event)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -415,7 +923,7 @@ void io_record_event(const CBTF_io_event* event, uint64_t function)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -441,71 +949,20 @@ fprintf(stderr,"ENTERED io_record_event, sizeof event=%d, sizeof stacktrace=%d,
 
 
 #if defined(EXTENDEDTRACE)
-    /* need to search pathnames to see if this pathname already exists. */
-    unsigned pathindex = 0;
-    int curpathlen = 0;
-    if (currentpathname[0] > 0) {
-	curpathlen = strlen(currentpathname);
-    }
-
-    for(start = 0, i = 0;
-	(i < curpathlen) &&
-	    ((start + i) < tls->data.pathnames.pathnames_len);
-	++i)
-    {
-	/* Do the i'th charactes differ? */
-	if(currentpathname[i] != tls->buffer.pathnames[start + i]) {
-	    
-	    /* Advance in the tracing buffer to the end of this stack trace */
-	    for(start += i;
-		(tls->buffer.pathnames[start] != 0) &&
-		    (start < tls->data.pathnames.pathnames_len);
-		++start);
-	    
-	    /* Advance in the pathnames buffer past the terminating zero */
-	    ++start;
-
-	    /* Begin comparing at the zero'th frame again */
-	    i = 0;
+    /* Only the per file descriptor statistics are needed in this mode */
+    if (io_stats_only) {
+	--tls->nesting_depth;
+	if (tls->nesting_depth == 0) {
+	    update_fd_stats(tls, event);
 	}
+	tls->do_trace = true;
+	return;
     }
 
-    /* Did we find a match in the pathnames buffer? */
-    if(i == curpathlen) {
-	entry = pathindex = start;
-#ifdef DEBUG
-	char *s = &(tls->buffer.pathnames[entry]);
-	printf("iot_record_event: tls->buffer.pathnames[%d]=%s, currentpathname=%s\n",entry, s, currentpathname );
-#endif
-
-    /* Otherwise add this pathname to the pathnames buffer */
-    } else {
-	
-	/* Send events if there is insufficient room for this pathname */
-	if((tls->data.pathnames.pathnames_len + curpathlen + 1) >=
-	   PathBufferSize) {
-#ifdef DEBUG
-fprintf(stderr,"PathBufferSize is full, call send_samples\n");
-#endif
-	    send_samples(tls);
-	}
-	
-	/* Add each char in the pathname to the pathnames buffer. */	
-	entry = tls->data.pathnames.pathnames_len;
-	for(i = 0; i < curpathlen; ++i) {
-	    
-	    /* Add the i'th frame to the tracing buffer */
-	    tls->buffer.pathnames[entry + i] = currentpathname[i];
-	}
-
-	pathindex = entry;
-	
-	/* Add a terminating zero  to the pathnames buffer */
-	tls->buffer.pathnames[entry + curpathlen] = 0;
-	
-	/* Set the new size of the pathnames buffer */
-	tls->data.pathnames.pathnames_len += (curpathlen + 1);
-	
+    /* Find the path ID of the pathname (if any) used by this call */
+    unsigned pathindex = 0;
+    if (currentpathname[0] != 0) {
+	pathindex = intern_pathname(tls, currentpathname);
     }
 #endif
 
@@ -613,7 +1070,8 @@ fprintf(stderr,"PathBufferSize is full, call send_samples\n");
 	if (stacktrace[i] < tls->header.addr_begin ) {
 	    tls->header.addr_begin = stacktrace[i];
 	}
-	if (stacktrace[i] > tls->header.addr_end ) {
+	if (!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	    stacktrace[i] > tls->header.addr_end ) {
 	    tls->header.addr_end = stacktrace[i];
 	}
 	tls->data.stacktraces.stacktraces_len++;
@@ -684,7 +1142,8 @@ fprintf(stderr,"StackTraceBufferSize is full, call send_samples\n");
 	    /* Update the address interval in the data blob's header */
 	    if(stacktrace[i] < tls->header.addr_begin)
 		tls->header.addr_begin = stacktrace[i];
-	    if(stacktrace[i] > tls->header.addr_end)
+	    if(!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	       stacktrace[i] > tls->header.addr_end)
 		tls->header.addr_end = stacktrace[i];
 	    
 	}
@@ -740,7 +1199,7 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 #ifdef USE_EXPLICIT_TLS
     TLS* tls = malloc(sizeof(TLS));
     Assert(tls != NULL);
-    CBTF_SetTLS(TLSKey, tls);
+    CBTF_SetTLSSlot(TLSSlot, tls);
     io_init_tls_done = true;
 #else
     TLS* tls = &the_tls;
@@ -775,6 +1234,25 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 
     memcpy(&tls->header, header, sizeof(CBTF_DataHeader));
 
+#if defined(EXTENDEDTRACE)
+    /* Initialize the pathname intern table */
+    reset_pathnames(tls);
+
+    /*
+     * If CBTF_IO_STATS is set, replace event tracing with a table of per file
+     * descriptor statistics: bytes, call counts, time histogram and access
+     * pattern. No stack traces or events are collected.
+     */
+    io_stats_only = (getenv("CBTF_IO_STATS") != NULL);
+    tls->stats = NULL;
+    if (io_stats_only) {
+	tls->stats = malloc(sizeof(FdStats));
+	Assert(tls->stats != NULL);
+	memset(tls->stats->fds, 0, sizeof(tls->stats->fds));
+	initialize_stats(tls);
+    }
+#endif
+
     /* Initialize the actual data blob */
     initialize_data(tls);
 
@@ -840,7 +1318,7 @@ void cbtf_collector_pause()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -860,7 +1338,7 @@ void cbtf_collector_resume()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -874,12 +1352,15 @@ void cbtf_collector_resume()
 
 #ifdef USE_EXPLICIT_TLS
 void destroy_explicit_tls() {
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
     /* Destroy our thread-local storage */
     if (tls) {
+#if defined(EXTENDEDTRACE)
+        free(tls->stats);
+#endif
         free(tls);
     }
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 }
 #endif
 
@@ -896,7 +1377,7 @@ void cbtf_collector_stop()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -919,10 +1400,27 @@ void cbtf_collector_stop()
     }
 #endif
 
+#if defined(EXTENDEDTRACE)
+    /* Retire the entries still in the statistics table and send them */
+    if (tls->stats != NULL) {
+	unsigned i;
+	for(i = 0; i < MaxStatsFds; ++i) {
+	    if(tls->stats->fds[i].active) {
+		retire_fd_stats(tls, &tls->stats->fds[i]);
+	    }
+	}
+	if(tls->stats->data.files.files_len > 0) {
+	    send_stats(tls);
+	}
+	free(tls->stats);
+	tls->stats = NULL;
+    }
+#endif
+
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     free(tls);
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 #endif
 }
 
@@ -932,7 +1430,7 @@ bool_t io_do_trace(const char* traced_func)
 #ifdef USE_EXPLICIT_TLS
     TLS* tls;
     if (io_init_tls_done) {
-        tls = CBTF_GetTLS(TLSKey);
+        tls = CBTF_GetTLSSlot(TLSSlot);
     } else {
 	return FALSE;
     }
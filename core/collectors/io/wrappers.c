@@ -123,6 +123,36 @@ SYS_lseek64;
 /* file descriptor to a pathname. */
 
 extern char currentpathname[PATH_MAX];
+
+/* In the per file descriptor statistics mode the collector maps each file */
+/* descriptor to its pathname when it is opened, so the /proc lookups are */
+/* skipped. */
+extern bool_t io_stats_only;
+
+/**
+ * Set the current pathname from a file descriptor.
+ *
+ * Reads the link the file descriptor points to in the /proc filesystem into
+ * the current pathname, leaving it empty if the link can't be read. Skipped
+ * in the per file descriptor statistics mode.
+ *
+ * @param fd    File descriptor whose pathname is to be found.
+ */
+static void set_currentpathname(int fd)
+{
+    char pf[64];
+    ssize_t status;
+
+    if (io_stats_only)
+	return;
+
+    /* use that to get the path into /proc. */
+    sprintf(pf,"/proc/self/fd/%d",fd);
+
+    /* Read the link the file descriptor points to in the /proc filesystem */
+    status = readlink(pf, currentpathname, PATH_MAX - 1);
+    currentpathname[(status > 0) ? status : 0] = 0;
+}
 #endif
 
 #if defined (CBTF_SERVICE_USE_OFFLINE) && !defined(CBTF_SERVICE_BUILD_STATIC)
@@ -143,11 +173,6 @@ ssize_t ioread(int fd, void *buf, size_t count)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -188,24 +213,12 @@ ssize_t ioread(int fd, void *buf, size_t count)
     event.retval = retval;
 
 #ifdef DEBUG_IOT
-    printf("iotread, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotread, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
-/*
-    event.sysargs[3] = namebuf;
-*/
+    set_currentpathname(fd);
 
 #ifdef DEBUG_IOT
-    printf("iotread, status=%d, namebuf=%s\n", status, namebuf);
+    printf("iotread, currentpathname=%s\n", currentpathname);
 #endif
 
 #endif
@@ -245,11 +258,6 @@ ssize_t iowrite(int fd, void *buf, size_t count)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -293,18 +301,9 @@ ssize_t iowrite(int fd, void *buf, size_t count)
     event.retval = retval;
 
 #ifdef DEBUG_IOT
-    printf("iotwrite, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotwrite, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #endif
 #endif
 
@@ -344,11 +343,6 @@ off_t iolseek(int fd, off_t offset, int whence)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -390,18 +384,9 @@ off_t iolseek(int fd, off_t offset, int whence)
     event.sysargs[2] = whence;
     event.retval = retval;
 
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #ifdef DEBUG_IOT
-    printf("iotlseek, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotlseek, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
 
 #endif
@@ -440,11 +425,6 @@ off_t iolseek64(int fd, off_t offset, int whence)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -485,18 +465,9 @@ off_t iolseek64(int fd, off_t offset, int whence)
     event.sysargs[2] = whence;
     event.retval = retval;
 
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #ifdef DEBUG_IOT
-    printf("iotlseek64, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotlseek64, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
 
 #endif
@@ -691,11 +662,6 @@ int ioclose(int fd)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -711,20 +677,10 @@ int ioclose(int fd)
 	event.start_time = CBTF_GetTime();
 
 #if defined(EXTENDEDTRACE)
-	/* use that to get the path into /proc. */
-	sprintf(pf,"/proc/self/fd/%d",fd);
-
-	/* Read the link the file descriptor points to in the /proc filesystem */
-	status = readlink(pf,namebuf,1024);
-	if (status > 1024) {
-	    printf("ERROR, name too large\n");
-	}
-	namebuf[status] = 0;
+	set_currentpathname(fd);
 #ifdef DEBUG_IOT
-	printf("iotclose, fd=%d, namebuf=%s\n", fd, namebuf);
+	    printf("iotclose, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-
-	strncpy(currentpathname,namebuf,strlen(namebuf));
 #endif
 #endif
     }
@@ -787,11 +743,6 @@ int iodup(int oldfd)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -830,18 +781,9 @@ int iodup(int oldfd)
     event.sysargs[0] = oldfd;
     event.retval = retval;
 
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",oldfd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(oldfd);
 #ifdef DEBUG_IOT
-    printf("iotdup, oldfd=%d, namebuf=%s\n", oldfd, namebuf);
+    printf("iotdup, oldfd=%d, currentpathname=%s\n", oldfd, currentpathname);
 #endif
 
 #endif
@@ -881,11 +823,6 @@ int iodup2(int oldfd, int newfd)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -925,18 +862,9 @@ int iodup2(int oldfd, int newfd)
     event.sysargs[1] = newfd;
     event.retval = retval;
 
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",oldfd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(oldfd);
 #ifdef DEBUG_IOT
-    printf("iotdup2, oldfd=%d, namebuf=%s\n", oldfd, namebuf);
+    printf("iotdup2, oldfd=%d, currentpathname=%s\n", oldfd, currentpathname);
 #endif
 #endif
 #endif
@@ -1284,11 +1212,6 @@ ssize_t iopread64(int fd, void *buf, size_t count, off_t offset)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -1339,18 +1262,9 @@ ssize_t iopread64(int fd, void *buf, size_t count, off_t offset)
     event.retval = retval;
 
 #ifdef DEBUG_IOT
-    printf("iotpread64, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotpread64, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #endif
 #endif
 
@@ -1388,11 +1302,6 @@ ssize_t iopwrite(int fd, void *buf, size_t count, off_t offset)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -1442,18 +1351,9 @@ ssize_t iopwrite(int fd, void *buf, size_t count, off_t offset)
     event.sysargs[3] = offset;
     event.retval = retval;
 #ifdef DEBUG_IOT
-    printf("iotpwrite, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotpwrite, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #endif
 #endif
 
@@ -1492,11 +1392,6 @@ ssize_t iopwrite64(int fd, void *buf, size_t count, off_t offset)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -1547,18 +1442,9 @@ ssize_t iopwrite64(int fd, void *buf, size_t count, off_t offset)
     event.retval = retval;
 
 #ifdef DEBUG_IOT
-    printf("iotwrite64, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotwrite64, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #endif
 #endif
 
@@ -1597,11 +1483,6 @@ ssize_t ioreadv(int fd, const struct iovec *vector, int count)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -1642,18 +1523,9 @@ ssize_t ioreadv(int fd, const struct iovec *vector, int count)
     event.sysargs[2] = count;
     event.retval = retval;
 #ifdef DEBUG_IOT
-    printf("iotreadv, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotreadv, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #endif
 #endif
 
@@ -1692,11 +1564,6 @@ ssize_t iowritev(int fd, const struct iovec *vector, int count)
 #else
 #if defined(EXTENDEDTRACE)
     CBTF_iot_event event;
-    int status = -1;
-    char namebuf[1024];
-    char pf[256];
-    memset(namebuf, 0, sizeof(namebuf));
-    memset(pf, 0, sizeof(pf));
 #else
     CBTF_io_event event;
 #endif
@@ -1738,18 +1605,9 @@ ssize_t iowritev(int fd, const struct iovec *vector, int count)
     event.retval = retval;
 
 #ifdef DEBUG_IOT
-    printf("iotwritev, fd=%d, namebuf=%s\n", fd, namebuf);
+    printf("iotwritev, fd=%d, currentpathname=%s\n", fd, currentpathname);
 #endif
-    /* use that to get the path into /proc. */
-    sprintf(pf,"/proc/self/fd/%d",fd);
-
-    /* Read the link the file descriptor points to in the /proc filesystem */
-    status = readlink(pf,namebuf,1024);
-    if (status > 1024) {
-      printf("ERROR, name too large\n");
-    }
-    namebuf[status] = 0;
-    strncpy(currentpathname,namebuf,strlen(namebuf));
+    set_currentpathname(fd);
 #endif
 #endif
 
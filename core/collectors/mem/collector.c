@@ -99,6 +99,15 @@ const unsigned OverheadFrameCount = 2;
 //#define EventBufferSize (CBTF_BlobSizeFactor * 200)
 #define EventBufferSize (CBTF_BlobSizeFactor * 100)
 
+/** Number of call sites in the allocation size histograms. */
+#define HistogramSiteSize (CBTF_BlobSizeFactor * 16)
+
+/** Number of entries in the allocation size histograms' hash table. */
+#define HistogramHashSize (2 * HistogramSiteSize)
+
+/** Flag indicating if only allocation size histograms are collected. */
+static bool_t histogram_only = FALSE;
+
 /** Type defining the items stored in thread-local storage. */
 typedef struct {
 
@@ -111,6 +120,19 @@ typedef struct {
 	CBTF_memt_event events[EventBufferSize];     /**< Mem call events. */
     } buffer;
 
+    CBTF_mem_histogram_data hist;  /**< Allocation size histograms blob. */
+
+    /**
+     * Allocation size histograms of each call site. The stack traces of the
+     * call sites are kept in the tracing buffer above, which is otherwise
+     * unused in this mode.
+     */
+    struct {
+	CBTF_mem_size_histogram sites[HistogramSiteSize]; /**< Call sites. */
+	uint32_t hashes[HistogramSiteSize];    /**< Hash of each site's stack. */
+	uint16_t hash_table[HistogramHashSize]; /**< Site index plus one. */
+    } histbuf;
+
 #if defined (CBTF_SERVICE_USE_OFFLINE)
     char CBTF_mem_traced[PATH_MAX];
 #endif
@@ -135,6 +157,18 @@ static bool IsCollectorDebugEnabled = false;
 static const uint32_t TLSKey = 0x00001EFA;
 int mem_init_tls_done = 0;
 
+/** Slot assigned to our key by the TLS service. */
+static uint32_t TLSSlot = 0;
+
+/**
+ * Register our key with the TLS service upon loading so that every access
+ * to our thread-local storage is a direct slot lookup rather than a search.
+ */
+static void __attribute__ ((constructor)) register_tls_slot()
+{
+    TLSSlot = CBTF_RegisterTLS(TLSKey);
+}
+
 #else
 
 /** Thread-local storage. */
@@ -145,7 +179,7 @@ static __thread TLS the_tls;
 void defer_trace(int defer_tracing) {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -267,6 +301,156 @@ static void send_samples(TLS *tls)
     tls->do_trace = saved_do_trace;
 }
 
+
+/**
+ * Initialize the allocation size histograms contained within the given
+ * thread-local storage, along with the stack traces of their call sites.
+ *
+ * @param tls    Thread-local storage to be initialized.
+ */
+static void initialize_histograms(TLS* tls)
+{
+    Assert(tls != NULL);
+
+    initialize_data(tls);
+
+    tls->hist.stacktraces.stacktraces_val = tls->buffer.stacktraces;
+    tls->hist.stacktraces.stacktraces_len = 0;
+    tls->hist.sites.sites_val = tls->histbuf.sites;
+    tls->hist.sites.sites_len = 0;
+    memset(tls->histbuf.hash_table, 0, sizeof(tls->histbuf.hash_table));
+}
+
+
+
+/**
+ * Send the allocation size histograms.
+ *
+ * Sends the allocation size histograms to the framework under their own data
+ * header identifier. Then resets the histograms to the empty state.
+ *
+ * @param tls    Thread-local storage containing the histograms.
+ */
+static void send_histograms(TLS* tls)
+{
+    int saved_do_trace = tls->do_trace;
+    tls->do_trace = 0;
+
+    tls->header.id = strdup("memhist");
+    tls->header.time_end = CBTF_GetTime();
+    tls->header.rank = monitor_mpi_comm_rank();
+
+#ifndef NDEBUG
+    if (IsCollectorDebugEnabled) {
+	fprintf(stderr, "[%ld:%d] mem send_histograms: stacktraces_len(%d) sites_len(%d)\n",
+		tls->header.pid, tls->header.omp_tid,
+		tls->hist.stacktraces.stacktraces_len,
+		tls->hist.sites.sites_len);
+    }
+#endif
+
+    cbtf_collector_send(&(tls->header), (xdrproc_t)xdr_CBTF_mem_histogram_data, &(tls->hist));
+    free(tls->header.id);
+    tls->header.id = NULL;
+
+    initialize_histograms(tls);
+    tls->do_trace = saved_do_trace;
+}
+
+
+
+/**
+ * Update the allocation size histograms.
+ *
+ * Adds the specified event to the histogram of its call site, adding the call
+ * site (and its stack trace) if this is its first event. The histograms are
+ * sent first when there is no room for a new call site.
+ *
+ * @param tls                Thread-local storage containing the histograms.
+ * @param event              Event to be added.
+ * @param stacktrace         Stack trace of the event's call site.
+ * @param stacktrace_size    Number of frames in the stack trace.
+ */
+static void update_histograms(TLS* tls, const CBTF_memt_event* event,
+			      const uint64_t* stacktrace,
+			      unsigned stacktrace_size)
+{
+    CBTF_mem_size_histogram* site = NULL;
+    uint32_t hash = 2166136261u;
+    uint64_t size = 0, bytes;
+    unsigned bin = 0, index, i;
+
+    /* Find (or add) the histogram for this call site */
+    for(i = 0; i < stacktrace_size; ++i)
+	hash = (hash ^ (uint32_t)(stacktrace[i] ^ (stacktrace[i] >> 32))) *
+	    16777619u;
+    index = hash % HistogramHashSize;
+    while(tls->histbuf.hash_table[index] != 0) {
+	unsigned s = tls->histbuf.hash_table[index] - 1;
+	if(tls->histbuf.hashes[s] == hash) {
+	    site = &tls->histbuf.sites[s];
+	    for(i = 0; i < stacktrace_size; ++i)
+		if(tls->buffer.stacktraces[site->stacktrace + i] != stacktrace[i])
+		    break;
+	    if((i == stacktrace_size) &&
+	       (tls->buffer.stacktraces[site->stacktrace + i] == 0))
+		break;
+	}
+	site = NULL;
+	index = (index + 1) % HistogramHashSize;
+    }
+    if(site == NULL) {
+	if((tls->hist.sites.sites_len == HistogramSiteSize) ||
+	   ((tls->hist.stacktraces.stacktraces_len + stacktrace_size + 1) >=
+	    StackTraceBufferSize)) {
+	    send_histograms(tls);
+	    index = hash % HistogramHashSize;
+	}
+	site = &tls->histbuf.sites[tls->hist.sites.sites_len];
+	memset(site, 0, sizeof(CBTF_mem_size_histogram));
+	site->stacktrace = tls->hist.stacktraces.stacktraces_len;
+	for(i = 0; i < stacktrace_size; ++i) {
+	    tls->buffer.stacktraces[site->stacktrace + i] = stacktrace[i];
+	    if(stacktrace[i] < tls->header.addr_begin)
+		tls->header.addr_begin = stacktrace[i];
+	    if(!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	       stacktrace[i] > tls->header.addr_end)
+		tls->header.addr_end = stacktrace[i];
+	}
+	tls->buffer.stacktraces[site->stacktrace + stacktrace_size] = 0;
+	tls->hist.stacktraces.stacktraces_len += (stacktrace_size + 1);
+	tls->histbuf.hashes[tls->hist.sites.sites_len] = hash;
+	tls->histbuf.hash_table[index] = ++tls->hist.sites.sites_len;
+    }
+
+    site->calls++;
+    site->time += event->stop_time - event->start_time;
+
+    switch(event->mem_type) {
+    case CBTF_MEM_MALLOC:
+    case CBTF_MEM_REALLOC:
+	size = event->size1;
+	break;
+    case CBTF_MEM_CALLOC:
+	size = event->size1 * event->size2;
+	break;
+    case CBTF_MEM_MEMALIGN:
+    case CBTF_MEM_POSIX_MEMALIGN:
+	size = event->size2;
+	break;
+    default:
+	/* Frees only count as calls */
+	return;
+    }
+
+    /* Bin the allocation by the log2 of its size */
+    for(bytes = size; (bytes > 0) && (bin < CBTF_MEM_HISTOGRAM_SIZE - 1);
+	bytes >>= 1)
+	++bin;
+    site->count[bin]++;
+    site->bytes[bin] += size;
+}
+
 /**
  * Start an event.
  *
@@ -282,7 +466,7 @@ void mem_start_event(CBTF_memt_event* event)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -322,7 +506,7 @@ void mem_record_event(const CBTF_memt_event* event, uint64_t function)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -373,6 +557,13 @@ void mem_record_event(const CBTF_memt_event* event, uint64_t function)
      */
     if(stacktrace_size > 0)
 	stacktrace[0] = function;
+
+    /* Only the allocation size histograms are needed in this mode */
+    if(histogram_only) {
+	update_histograms(tls, event, stacktrace, stacktrace_size);
+	tls->do_trace = saved_do_trace;
+	return;
+    }
     
     /*
      * Search the tracing buffer for an existing stack trace matching the stack
@@ -425,7 +616,8 @@ void mem_record_event(const CBTF_memt_event* event, uint64_t function)
 	    /* Update the address interval in the data blob's header */
 	    if(stacktrace[i] < tls->header.addr_begin)
 		tls->header.addr_begin = stacktrace[i];
-	    if(stacktrace[i] > tls->header.addr_end)
+	    if(!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	       stacktrace[i] > tls->header.addr_end)
 		tls->header.addr_end = stacktrace[i];
 	    
 	}
@@ -471,7 +663,7 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 #ifdef USE_EXPLICIT_TLS
     TLS* tls = malloc(sizeof(TLS));
     Assert(tls != NULL);
-    CBTF_SetTLS(TLSKey, tls);
+    CBTF_SetTLSSlot(TLSSlot, tls);
     mem_init_tls_done = 1;
 #else
     TLS* tls = &the_tls;
@@ -514,8 +706,14 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 
     memcpy(&tls->header, header, sizeof(CBTF_DataHeader));
 
+    /*
+     * If CBTF_MEM_HISTOGRAM is set, replace event tracing with per call site
+     * histograms of the log2 allocation sizes. No events are collected.
+     */
+    histogram_only = (getenv("CBTF_MEM_HISTOGRAM") != NULL);
+
     /* Initialize the actual data blob */
-    initialize_data(tls);
+    initialize_histograms(tls);
 
     /* Initialize the mem function wrapper nesting depth */
     tls->nesting_depth = 0;
@@ -579,7 +777,7 @@ void cbtf_collector_pause()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -599,7 +797,7 @@ void cbtf_collector_resume()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -613,12 +811,12 @@ void cbtf_collector_resume()
 
 #ifdef USE_EXPLICIT_TLS
 void destroy_explicit_tls() {
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
     /* Destroy our thread-local storage */
     if (tls) {
         free(tls);
     }
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 }
 #endif
 
@@ -635,7 +833,7 @@ void cbtf_collector_stop()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -654,6 +852,9 @@ void cbtf_collector_stop()
     if(tls->data.events.events_len > 0 && tls->data.stacktraces.stacktraces_len > 0) {
 	send_samples(tls);
     }
+    if(tls->hist.sites.sites_len > 0) {
+	send_histograms(tls);
+    }
 
 #ifndef NDEBUG
     if (IsCollectorDebugEnabled) {
@@ -666,7 +867,7 @@ void cbtf_collector_stop()
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     free(tls);
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 #endif
 }
 
@@ -676,7 +877,7 @@ bool_t mem_do_trace(const char* traced_func)
 #ifdef USE_EXPLICIT_TLS
     TLS* tls;
     if (mem_init_tls_done) {
-        tls = CBTF_GetTLS(TLSKey);
+        tls = CBTF_GetTLSSlot(TLSSlot);
     } else {
 	return FALSE;
     }
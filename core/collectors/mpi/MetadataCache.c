@@ -0,0 +1,415 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Per-process cache of the communicator and datatype metadata needed by the
+ * MPI wrappers. The world rank of this process, the size of each datatype,
+ * and the translation of each communicator's ranks into MPI_COMM_WORLD ranks
+ * are looked up with PMPI calls the first time they are needed and served
+ * from the cache afterwards. Entries are invalidated by the MPI_Comm_free and
+ * MPI_Type_free wrappers since MPI implementations reuse freed handles.
+ *
+ * Lookups don't take a lock. Insertions and invalidations are serialized by
+ * a mutex and publish an entry by setting its state only after the rest of
+ * the entry has been filled in.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <mpi.h>
+
+
+
+/** Number of entries in each cache (must be a power of 2). */
+#define CacheSize 1024
+
+/** States of a cache entry. */
+typedef enum {
+    EntryEmpty = 0,  /**< Entry has never been used. */
+    EntryLive,       /**< Entry holds valid metadata. */
+    EntryFreed       /**< Entry was invalidated and may be reused. */
+} EntryState;
+
+/** Type representing the cached metadata of a communicator. */
+typedef struct {
+    volatile int state;  /**< State of this entry. */
+    int64_t handle;      /**< Communicator handle. */
+    int size;            /**< Number of ranks in the (remote) group. */
+    int* world_ranks;    /**< World rank of each rank or null for identity. */
+} CommEntry;
+
+/** Type representing the cached metadata of a datatype. */
+typedef struct {
+    volatile int state;  /**< State of this entry. */
+    int64_t handle;      /**< Datatype handle. */
+    int size;            /**< Size of the datatype in bytes. */
+} TypeEntry;
+
+/** Cached communicator metadata. */
+static CommEntry comm_cache[CacheSize];
+
+/** Cached datatype metadata. */
+static TypeEntry type_cache[CacheSize];
+
+/** Mutual exclusion lock serializing updates of the caches. */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** World rank of this process or -1 if not yet known. */
+static volatile int world_rank = -1;
+
+
+
+/** Hash a handle into a cache index. */
+static inline unsigned hashHandle(int64_t handle)
+{
+    uint64_t value = (uint64_t)handle;
+    value ^= value >> 33;
+    value *= UINT64_C(0xFF51AFD7ED558CCD);
+    value ^= value >> 33;
+    return (unsigned)value & (CacheSize - 1);
+}
+
+
+
+/** Find the live communicator entry for a handle. */
+static CommEntry* findComm(int64_t handle)
+{
+    unsigned i, index = hashHandle(handle);
+
+    for(i = 0; i < CacheSize; ++i, index = (index + 1) & (CacheSize - 1)) {
+	CommEntry* entry = &comm_cache[index];
+	int state = entry->state;
+	if(state == EntryEmpty)
+	    return NULL;
+	__sync_synchronize();
+	if((state == EntryLive) && (entry->handle == handle))
+	    return entry;
+    }
+    return NULL;
+}
+
+
+
+/** Find the live datatype entry for a handle. */
+static TypeEntry* findType(int64_t handle)
+{
+    unsigned i, index = hashHandle(handle);
+
+    for(i = 0; i < CacheSize; ++i, index = (index + 1) & (CacheSize - 1)) {
+	TypeEntry* entry = &type_cache[index];
+	int state = entry->state;
+	if(state == EntryEmpty)
+	    return NULL;
+	__sync_synchronize();
+	if((state == EntryLive) && (entry->handle == handle))
+	    return entry;
+    }
+    return NULL;
+}
+
+
+
+/**
+ * Compute the world rank translation of a communicator.
+ *
+ * Returns an array giving the MPI_COMM_WORLD rank of each rank in the group
+ * addressed by point-to-point operations on the communicator: the local
+ * group of an intracommunicator or the remote group of an intercommunicator.
+ *
+ * @param comm    Communicator to be translated.
+ * @retval size   Number of ranks in the group.
+ * @return        Array of world ranks or null if the group is MPI_COMM_WORLD
+ *                itself or couldn't be translated.
+ *
+ * @ingroup Implementation
+ */
+static int* translateComm(MPI_Comm comm, int* size)
+{
+    MPI_Group group, world_group;
+    int* ranks = NULL;
+    int* world_ranks = NULL;
+    int i, is_inter = 0;
+
+    *size = 0;
+    if(comm == MPI_COMM_WORLD) {
+	PMPI_Comm_size(comm, size);
+	return NULL;
+    }
+
+    PMPI_Comm_test_inter(comm, &is_inter);
+    if(is_inter) {
+	if(PMPI_Comm_remote_group(comm, &group) != MPI_SUCCESS)
+	    return NULL;
+    }
+    else if(PMPI_Comm_group(comm, &group) != MPI_SUCCESS)
+	return NULL;
+    PMPI_Comm_group(MPI_COMM_WORLD, &world_group);
+
+    PMPI_Group_size(group, size);
+    ranks = malloc(*size * sizeof(int));
+    world_ranks = malloc(*size * sizeof(int));
+    if((ranks != NULL) && (world_ranks != NULL)) {
+	for(i = 0; i < *size; ++i)
+	    ranks[i] = i;
+	PMPI_Group_translate_ranks(group, *size, ranks,
+				   world_group, world_ranks);
+    }
+    else {
+	free(world_ranks);
+	world_ranks = NULL;
+	*size = 0;
+    }
+    free(ranks);
+
+    PMPI_Group_free(&group);
+    PMPI_Group_free(&world_group);
+    return world_ranks;
+}
+
+
+
+/**
+ * Get the cached communicator entry.
+ *
+ * Returns the entry for the specified communicator, adding it to the cache
+ * if it isn't present yet.
+ *
+ * @param comm    Communicator to be found.
+ * @return        Cache entry for this communicator or null if the cache is
+ *                full.
+ *
+ * @ingroup Implementation
+ */
+static CommEntry* getComm(MPI_Comm comm)
+{
+    int64_t handle = (int64_t)comm;
+    CommEntry* entry = findComm(handle);
+    unsigned i, index;
+    int size = 0;
+    int* world_ranks = NULL;
+
+    if(entry != NULL)
+	return entry;
+
+    /* Do the PMPI calls outside the lock */
+    world_ranks = translateComm(comm, &size);
+
+    pthread_mutex_lock(&cache_lock);
+    entry = findComm(handle);
+    if(entry == NULL) {
+	index = hashHandle(handle);
+	for(i = 0; i < CacheSize; ++i, index = (index + 1) & (CacheSize - 1))
+	    if(comm_cache[index].state != EntryLive) {
+		entry = &comm_cache[index];
+		entry->handle = handle;
+		entry->size = size;
+		entry->world_ranks = world_ranks;
+		world_ranks = NULL;
+		__sync_synchronize();
+		entry->state = EntryLive;
+		break;
+	    }
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    free(world_ranks);
+    return entry;
+}
+
+
+
+/**
+ * Get the world rank of this process.
+ *
+ * @return    Rank of this process within MPI_COMM_WORLD.
+ *
+ * @ingroup Implementation
+ */
+int mpi_cached_world_rank()
+{
+    int rank = world_rank;
+
+    if(rank < 0) {
+	if(PMPI_Comm_rank(MPI_COMM_WORLD, &rank) == MPI_SUCCESS)
+	    world_rank = rank;
+    }
+    return rank;
+}
+
+
+
+/**
+ * Get the world rank of a communicator rank.
+ *
+ * Translates a rank within the specified communicator into the equivalent
+ * MPI_COMM_WORLD rank. Wildcards such as MPI_ANY_SOURCE and MPI_PROC_NULL,
+ * as well as ranks that can't be translated, are returned unchanged.
+ *
+ * @param comm    Communicator containing the rank.
+ * @param rank    Rank to be translated.
+ * @return        Rank within MPI_COMM_WORLD.
+ *
+ * @ingroup Implementation
+ */
+int mpi_cached_global_rank(MPI_Comm comm, int rank)
+{
+    CommEntry* entry = NULL;
+    int* world_ranks = NULL;
+    int size = 0;
+
+    if((rank < 0) || (comm == MPI_COMM_WORLD))
+	return rank;
+
+    entry = getComm(comm);
+    if(entry != NULL) {
+	if((entry->world_ranks != NULL) && (rank < entry->size) &&
+	   (entry->world_ranks[rank] != MPI_UNDEFINED))
+	    return entry->world_ranks[rank];
+	return rank;
+    }
+
+    /* Translate directly when the cache is full */
+    world_ranks = translateComm(comm, &size);
+    if((world_ranks != NULL) && (rank < size) &&
+       (world_ranks[rank] != MPI_UNDEFINED))
+	rank = world_ranks[rank];
+    free(world_ranks);
+    return rank;
+}
+
+
+
+/**
+ * Get the size of a communicator.
+ *
+ * @param comm    Communicator to be queried.
+ * @return        Number of ranks in the communicator's (remote) group.
+ *
+ * @ingroup Implementation
+ */
+int mpi_cached_comm_size(MPI_Comm comm)
+{
+    CommEntry* entry = getComm(comm);
+    int size = 0;
+
+    if(entry != NULL)
+	return entry->size;
+    PMPI_Comm_size(comm, &size);
+    return size;
+}
+
+
+
+/**
+ * Get the size of a datatype.
+ *
+ * @param datatype    Datatype to be queried.
+ * @return            Size of the datatype in bytes.
+ *
+ * @ingroup Implementation
+ */
+int mpi_cached_type_size(MPI_Datatype datatype)
+{
+    int64_t handle = (int64_t)datatype;
+    TypeEntry* entry = findType(handle);
+    unsigned i, index;
+    int size = 0;
+
+    if(entry != NULL)
+	return entry->size;
+
+    if(PMPI_Type_size(datatype, &size) != MPI_SUCCESS)
+	return 0;
+
+    pthread_mutex_lock(&cache_lock);
+    if(findType(handle) == NULL) {
+	index = hashHandle(handle);
+	for(i = 0; i < CacheSize; ++i, index = (index + 1) & (CacheSize - 1))
+	    if(type_cache[index].state != EntryLive) {
+		type_cache[index].handle = handle;
+		type_cache[index].size = size;
+		__sync_synchronize();
+		type_cache[index].state = EntryLive;
+		break;
+	    }
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    return size;
+}
+
+
+
+/**
+ * Invalidate a communicator.
+ *
+ * Removes the specified communicator from the cache. Must be called before
+ * the communicator is actually freed.
+ *
+ * @param comm    Communicator being freed.
+ *
+ * @ingroup Implementation
+ */
+void mpi_cache_free_comm(MPI_Comm comm)
+{
+    CommEntry* entry = NULL;
+    int* world_ranks = NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    entry = findComm((int64_t)comm);
+    if(entry != NULL) {
+	entry->state = EntryFreed;
+	__sync_synchronize();
+	world_ranks = entry->world_ranks;
+	entry->world_ranks = NULL;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    free(world_ranks);
+}
+
+
+
+/**
+ * Invalidate a datatype.
+ *
+ * Removes the specified datatype from the cache. Must be called before the
+ * datatype is actually freed.
+ *
+ * @param datatype    Datatype being freed.
+ *
+ * @ingroup Implementation
+ */
+void mpi_cache_free_type(MPI_Datatype datatype)
+{
+    TypeEntry* entry = NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    entry = findType((int64_t)datatype);
+    if(entry != NULL)
+	entry->state = EntryFreed;
+    pthread_mutex_unlock(&cache_lock);
+}
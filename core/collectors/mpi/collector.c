@@ -115,6 +115,17 @@ const unsigned OverheadFrameCount = 2;
 #define EventBufferSize (CBTF_BlobSizeFactor * 415)
 #endif
 
+#if defined(EXTENDEDTRACE)
+/** Number of peers in the communication matrix row. */
+#define CommRowSize 512
+
+/** Number of entries in the communication matrix row's hash table. */
+#define CommRowHashSize (2 * CommRowSize)
+
+/** Flag indicating if only the communication matrix is collected. */
+static bool_t comm_matrix_only = FALSE;
+#endif
+
 /** Type defining the items stored in thread-local storage. */
 typedef struct {
 
@@ -146,6 +157,17 @@ typedef struct {
 #endif
     } buffer;
 #endif
+
+#if defined(EXTENDEDTRACE)
+    /** Row of the communication matrix for this thread. */
+    CBTF_mpi_comm_row_data row;
+
+    /** Communication matrix row buffer. */
+    struct {
+        CBTF_mpi_comm_peer peers[CommRowSize];   /**< Peers sent to. */
+        uint16_t hash_table[CommRowHashSize];    /**< Peer index plus one. */
+    } rowbuf;
+#endif
     
 #if defined (CBTF_SERVICE_USE_OFFLINE)
     char CBTF_mpi_traced[PATH_MAX];
@@ -181,6 +203,18 @@ static const uint32_t TLSKey = 0x00001EFB;
 
 int mpi_init_tls_done = 0;
 
+/** Slot assigned to our key by the TLS service. */
+static uint32_t TLSSlot = 0;
+
+/**
+ * Register our key with the TLS service upon loading so that every access
+ * to our thread-local storage is a direct slot lookup rather than a search.
+ */
+static void __attribute__ ((constructor)) register_tls_slot()
+{
+    TLSSlot = CBTF_RegisterTLS(TLSKey);
+}
+
 #else
 
 /** Thread-local storage. */
@@ -191,7 +225,7 @@ static __thread TLS the_tls;
 void defer_trace(int defer_tracing) {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -335,6 +369,120 @@ static void send_samples(TLS *tls)
     initialize_data(tls);
 }
 
+
+
+#if defined(EXTENDEDTRACE)
+/**
+ * Initialize the communication matrix row contained within the given
+ * thread-local storage.
+ *
+ * @param tls    Thread-local storage to be initialized.
+ */
+static void initialize_comm_row(TLS* tls)
+{
+    Assert(tls != NULL);
+
+    tls->row.peers.peers_val = tls->rowbuf.peers;
+    tls->row.peers.peers_len = 0;
+    memset(tls->rowbuf.hash_table, 0, sizeof(tls->rowbuf.hash_table));
+}
+
+
+
+/**
+ * Send the communication matrix row.
+ *
+ * Sends the communication matrix row to the framework under its own data
+ * header identifier, leaving the event tracing data blob alone. Then resets
+ * the row to the empty state.
+ *
+ * @param tls    Thread-local storage containing the row.
+ */
+static void send_comm_row(TLS* tls)
+{
+    CBTF_DataHeader header;
+
+    Assert(tls != NULL);
+
+    memcpy(&header, &tls->header, sizeof(CBTF_DataHeader));
+    header.id = strdup("mpicomm");
+    header.time_end = CBTF_GetTime();
+    header.addr_begin = ~0;
+    header.addr_end = 0;
+    header.rank = monitor_mpi_comm_rank();
+
+#ifndef NDEBUG
+    if (IsCollectorDebugEnabled) {
+	fprintf(stderr, "[%ld,%d] mpi send_comm_row: peers_len(%u)\n",
+		tls->header.pid, tls->header.omp_tid,
+		tls->row.peers.peers_len);
+    }
+#endif
+
+    cbtf_collector_send(&header, (xdrproc_t)xdr_CBTF_mpi_comm_row_data,
+			&(tls->row));
+    free(header.id);
+
+    initialize_comm_row(tls);
+}
+
+
+
+/**
+ * Update the communication matrix row.
+ *
+ * Adds a point-to-point send to the row entry for its destination. Events
+ * that aren't sends by this rank (receives, collectives, and sends to self
+ * or MPI_PROC_NULL) leave the row unchanged. The row is sent when it has no
+ * room for a new peer, so its size is bounded regardless of run length.
+ *
+ * @param tls      Thread-local storage containing the row.
+ * @param event    Event to be added.
+ */
+static void update_comm_row(TLS* tls, const CBTF_mpit_event* event)
+{
+    int rank = monitor_mpi_comm_rank();
+    uint64_t time = event->stop_time - event->start_time;
+    unsigned bucket = 0, index;
+    CBTF_mpi_comm_peer* peer = NULL;
+
+    if((event->source != rank) || (event->destination < 0) ||
+       (event->destination == rank))
+	return;
+
+    /* Find (or add) the row entry for this destination */
+    index = ((unsigned)event->destination * 2654435761u) % CommRowHashSize;
+    while(tls->rowbuf.hash_table[index] != 0) {
+	peer = &tls->rowbuf.peers[tls->rowbuf.hash_table[index] - 1];
+	if(peer->peer == event->destination)
+	    break;
+	peer = NULL;
+	index = (index + 1) % CommRowHashSize;
+    }
+    if(peer == NULL) {
+	if(tls->row.peers.peers_len == CommRowSize) {
+	    send_comm_row(tls);
+	    index = ((unsigned)event->destination * 2654435761u) %
+		CommRowHashSize;
+	}
+	peer = &tls->rowbuf.peers[tls->row.peers.peers_len];
+	memset(peer, 0, sizeof(CBTF_mpi_comm_peer));
+	peer->peer = event->destination;
+	tls->rowbuf.hash_table[index] = ++tls->row.peers.peers_len;
+    }
+
+    /* Bin the send by the log2 of its time in microseconds */
+    for(time /= 1000; (time > 0) && (bucket < CBTF_MPI_COMM_HISTOGRAM_SIZE - 1);
+	time >>= 1)
+	++bucket;
+
+    peer->count++;
+    peer->bytes += event->size;
+    peer->time += event->stop_time - event->start_time;
+    peer->histogram[bucket]++;
+}
+#endif
+
 /**
  * Start an event.
  *
@@ -355,7 +503,7 @@ void mpi_start_event(CBTF_mpi_event* event)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -404,7 +552,7 @@ void mpi_record_event(const CBTF_mpi_event* event, uint64_t function)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -447,6 +595,15 @@ fprintf(stderr,"[%ld,%d] ENTERED mpi_record_event, sizeof event=%ld, sizeof stac
 #endif
 	return;
     }
+
+#if defined(EXTENDEDTRACE)
+    /* Only the communication matrix row is needed in this mode */
+    if(comm_matrix_only) {
+	update_comm_row(tls, event);
+	tls->do_trace = TRUE;
+	return;
+    }
+#endif
     
     /* Newer versions of libunwind now make io calls (open a file in /proc/<self>/maps)
      * that cause a thread lock in the libunwind dwarf parser. We are not interested in
@@ -544,7 +701,8 @@ fprintf(stderr,"[%ld,%d] ENTERED mpi_record_event, sizeof event=%ld, sizeof stac
 	if (stacktrace[i] < tls->header.addr_begin ) {
 	    tls->header.addr_begin = stacktrace[i];
 	}
-	if (stacktrace[i] > tls->header.addr_end ) {
+	if (!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	    stacktrace[i] > tls->header.addr_end ) {
 	    tls->header.addr_end = stacktrace[i];
 	}
 	tls->data.stacktraces.stacktraces_len++;
@@ -617,7 +775,8 @@ fprintf(stderr,"[%ld,%d] ENTERED mpi_record_event, sizeof event=%ld, sizeof stac
 	    /* Update the address interval in the data blob's header */
 	    if(stacktrace[i] < tls->header.addr_begin)
 		tls->header.addr_begin = stacktrace[i];
-	    if(stacktrace[i] > tls->header.addr_end)
+	    if(!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	       stacktrace[i] > tls->header.addr_end)
 		tls->header.addr_end = stacktrace[i];
 	    
 	}
@@ -674,7 +833,7 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 #ifdef USE_EXPLICIT_TLS
     TLS* tls = malloc(sizeof(TLS));
     Assert(tls != NULL);
-    CBTF_SetTLS(TLSKey, tls);
+    CBTF_SetTLSSlot(TLSSlot, tls);
     mpi_init_tls_done = true;
 #else
     TLS* tls = &the_tls;
@@ -717,6 +876,16 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
     /* Initialize the actual data blob */
     initialize_data(tls);
 
+#if defined(EXTENDEDTRACE)
+    /*
+     * If CBTF_MPI_COMM_MATRIX is set, replace event tracing with a sparse row
+     * of the rank-to-rank communication matrix: per destination message count,
+     * bytes and time histogram. No stack traces or events are collected.
+     */
+    comm_matrix_only = (getenv("CBTF_MPI_COMM_MATRIX") != NULL);
+    initialize_comm_row(tls);
+#endif
+
     /* We can not assign mpi rank in the header at this point as it may not
      * be set yet. assign an integer tid value.  omp_tid is used regardless of
      * whether the application is using openmp threads.
@@ -749,7 +918,7 @@ void cbtf_collector_pause()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -774,7 +943,7 @@ void cbtf_collector_resume()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -793,12 +962,12 @@ void cbtf_collector_resume()
 
 #ifdef USE_EXPLICIT_TLS
 void destroy_explicit_tls() {
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
     /* Destroy our thread-local storage */
     if (tls) {
         free(tls);
     }
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 }
 #endif
 
@@ -815,7 +984,7 @@ void cbtf_collector_stop()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -852,12 +1021,17 @@ void cbtf_collector_stop()
     if(tls->data.events.events_len > 0 || tls->data.stacktraces.stacktraces_len > 0) {
 	send_samples(tls);
     }
+#if defined(EXTENDEDTRACE)
+    if(tls->row.peers.peers_len > 0) {
+	send_comm_row(tls);
+    }
+#endif
 #endif
 
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     free(tls);
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 #endif
 }
 
@@ -867,7 +1041,7 @@ bool_t mpi_do_trace(const char* traced_func)
 #ifdef USE_EXPLICIT_TLS
     TLS* tls;
     if (mpi_init_tls_done) {
-        tls = CBTF_GetTLS(TLSKey);
+        tls = CBTF_GetTLSSlot(TLSSlot);
     } else {
 	return FALSE;
     }
@@ -2204,6 +2204,26 @@ OSS_WRAP_FORTRAN(MPI_PACK,mpi_pack,__wrap_mpi_pack,
    (inbuf, incount, datatype, outbuf, outsize, position, comm, ierr))
 
 
+/*
+ * MPI_Type_free
+ */
+
+#if defined (CBTF_SERVICE_USE_OFFLINE) && !defined(CBTF_STATIC)
+void mpi_type_free
+#elif defined (CBTF_STATIC) && defined (CBTF_SERVICE_USE_OFFLINE)
+void __wrap_mpi_type_free
+#endif
+    (MPI_Fint* datatype, MPI_Fint* ierr)
+{
+  MPI_Datatype l_datatype = MPI_Type_f2c(*datatype);
+  *ierr = MPI_Type_free(&l_datatype);
+  if (*ierr == MPI_SUCCESS) *datatype = MPI_Type_c2f(l_datatype);
+}
+OSS_WRAP_FORTRAN(MPI_TYPE_FREE,mpi_type_free,__wrap_mpi_type_free,
+    (MPI_Fint* datatype, MPI_Fint* ierr),
+    (datatype, ierr))
+
+
 /* MPI_Init */
 
 #if defined (CBTF_SERVICE_USE_OFFLINE) && !defined(CBTF_STATIC)
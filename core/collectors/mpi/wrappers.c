@@ -56,6 +56,12 @@ extern void mpi_start_event(CBTF_mpi_event*);
 
 extern bool_t mpi_do_trace(const char*);
 
+extern int mpi_cached_world_rank();
+extern int mpi_cached_global_rank(MPI_Comm, int);
+extern int mpi_cached_type_size(MPI_Datatype);
+extern void mpi_cache_free_comm(MPI_Comm);
+extern void mpi_cache_free_type(MPI_Datatype);
+
 
 static int debug_trace = 0;
 
@@ -118,8 +124,8 @@ int mpi_PMPI_Iallgather
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size = recvcount * datatype_size;
     event.communicator = (int64_t) comm;
@@ -202,8 +208,8 @@ int mpi_PMPI_Iallgatherv
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
@@ -281,8 +287,8 @@ int mpi_PMPI_Iallreduce
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
@@ -363,8 +369,8 @@ int mpi_PMPI_Ialltoall
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size = recvcount * datatype_size;
     event.communicator = (int64_t) comm;
@@ -442,8 +448,8 @@ int mpi_PMPI_Ialltoallv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
@@ -523,8 +529,8 @@ int mpi_PMPI_Ialltoallw
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(*recvtypes, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(*recvtypes);
 
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
@@ -598,7 +604,7 @@ int mpi_PMPI_Ibarrier
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
 
     event.size = 0;
     event.communicator = (int64_t) comm;
@@ -677,8 +683,8 @@ int mpi_PMPI_Ibcast
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
@@ -757,8 +763,8 @@ int mpi_PMPI_Iexscan
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
@@ -837,8 +843,8 @@ int mpi_PMPI_Igather
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size = recvcount * datatype_size;
     event.communicator = (int64_t) comm;
@@ -917,8 +923,8 @@ int mpi_PMPI_Igatherv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size = * recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
@@ -1008,9 +1014,9 @@ int mpi_PMPI_Improbe
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.source = source;
+    event.source = mpi_cached_global_rank(comm, source);
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     //PMPI_Type_size(datatype, &datatype_size);
 
     event.size =  0;
@@ -1088,8 +1094,8 @@ int mpi_PMPI_Imrecv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size =  count * datatype_size;
     event.datatype = (int64_t) datatype;
@@ -1170,8 +1176,8 @@ int mpi_PMPI_Ineighbor_allgather
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size =  recvcount * datatype_size;
     event.datatype = (int64_t) recvtype;
@@ -1252,8 +1258,8 @@ int mpi_PMPI_Ineighbor_allgatherv
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size =  *recvcounts * datatype_size;
     event.datatype = (int64_t) recvtype;
@@ -1334,8 +1340,8 @@ int mpi_PMPI_Ineighbor_alltoall
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size =  recvcount * datatype_size;
     event.datatype = (int64_t) recvtype;
@@ -1416,8 +1422,8 @@ int mpi_PMPI_Ineighbor_alltoallv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size =  *recvcounts * datatype_size;
     event.datatype = (int64_t) recvtype;
@@ -1498,8 +1504,8 @@ int mpi_PMPI_Ineighbor_alltoallw
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(*recvtypes, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(*recvtypes);
 
     event.size =  *recvcounts * datatype_size;
     event.datatype = (int64_t) (*recvtypes);
@@ -1579,8 +1585,8 @@ int mpi_PMPI_Ireduce
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size =  count * datatype_size;
     event.datatype = (int64_t) datatype;
@@ -1664,8 +1670,8 @@ int mpi_PMPI_Ireduce_scatter
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size =  (*recvcounts) * datatype_size;
     event.datatype = (int64_t) datatype;
@@ -1747,8 +1753,8 @@ int mpi_PMPI_Ireduce_scatter_block
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size =  recvcount * datatype_size;
     event.datatype = (int64_t) datatype;
@@ -1828,7 +1834,7 @@ int mpi_PMPI_Comm_idup
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     //PMPI_Type_size(datatype, &datatype_size);
 
     event.size =  0;
@@ -1909,8 +1915,8 @@ int mpi_PMPI_Iscan
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size =  count * datatype_size;
     event.datatype = (int64_t) datatype;
@@ -1994,8 +2000,8 @@ int mpi_PMPI_Iscatter
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size =  recvcount * datatype_size;
     event.datatype = (int64_t) recvtype;
@@ -2077,8 +2083,8 @@ int mpi_PMPI_Iscatterv
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
 
     event.size =  recvcount * datatype_size;
     event.datatype = (int64_t) recvtype;
@@ -2155,10 +2161,10 @@ int mpi_PMPI_Irecv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.source = source;
+    event.source = mpi_cached_global_rank(comm, source);
 
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
 
     event.size = count * datatype_size;
     event.tag = tag;
@@ -2234,9 +2240,9 @@ int mpi_PMPI_Recv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.source = source;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.source = mpi_cached_global_rank(comm, source);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2312,9 +2318,9 @@ int mpi_PMPI_Recv_init
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.source = source;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.source = mpi_cached_global_rank(comm, source);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2386,8 +2392,8 @@ int mpi_PMPI_Iprobe
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.source = source;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.source = mpi_cached_global_rank(comm, source);
+    event.destination = mpi_cached_world_rank();
     event.tag = tag;
     event.communicator = (int64_t) comm;
     event.retval = retval;
@@ -2458,8 +2464,8 @@ int mpi_PMPI_Probe
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.source = source;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.source = mpi_cached_global_rank(comm, source);
+    event.destination = mpi_cached_world_rank();
     event.tag = tag;
     event.communicator = (int64_t) comm;
     event.retval = retval;
@@ -2545,9 +2551,9 @@ int mpi_PMPI_Isend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    event.destination = dest;
-    PMPI_Type_size(datatype, &datatype_size);
+    event.source = mpi_cached_world_rank();
+    event.destination = mpi_cached_global_rank(comm, dest);
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2625,9 +2631,9 @@ int mpi_PMPI_Bsend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2707,9 +2713,9 @@ int mpi_PMPI_Bsend_init
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2788,9 +2794,9 @@ int mpi_PMPI_Ibsend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2869,9 +2875,9 @@ int mpi_PMPI_Irsend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -2950,9 +2956,9 @@ int mpi_PMPI_Issend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3030,9 +3036,9 @@ int mpi_PMPI_Rsend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3112,9 +3118,9 @@ int mpi_PMPI_Rsend_init
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3192,9 +3198,9 @@ int mpi_PMPI_Send
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3274,9 +3280,9 @@ int mpi_PMPI_Send_init
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3354,9 +3360,9 @@ int mpi_PMPI_Ssend
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3436,9 +3442,9 @@ int mpi_PMPI_Ssend_init
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_global_rank(comm, dest);
+    event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.tag = tag;
     event.communicator = (int64_t) comm;
@@ -3505,7 +3511,7 @@ int mpi_PMPI_Waitall
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -3557,7 +3563,7 @@ int mpi_PMPI_Finalize()
 #else
 
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
 #endif
 
     event.start_time = CBTF_GetTime();
@@ -3655,7 +3661,7 @@ int mpi_PMPI_Waitsome
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -3733,7 +3739,7 @@ int mpi_PMPI_Testsome
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -3805,7 +3811,7 @@ int mpi_PMPI_Waitany
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -3892,8 +3898,8 @@ int mpi_PMPI_Unpack
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = outcount * datatype_size;
     event.datatype = (int64_t) datatype;
     event.retval = retval;
@@ -3963,7 +3969,7 @@ int mpi_PMPI_Wait
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -4036,7 +4042,7 @@ int mpi_PMPI_Testany
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -4108,7 +4114,7 @@ int mpi_PMPI_Testall
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -4179,7 +4185,7 @@ int mpi_PMPI_Test
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -4261,8 +4267,8 @@ int mpi_PMPI_Scan
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) datatype;
@@ -4331,7 +4337,7 @@ int mpi_PMPI_Request_free
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -4420,8 +4426,8 @@ int mpi_PMPI_Reduce_scatter
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) datatype;
@@ -4504,8 +4510,8 @@ int mpi_PMPI_Reduce
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) datatype;
@@ -4589,8 +4595,8 @@ int mpi_PMPI_Pack
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = incount * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) datatype;
@@ -4608,6 +4614,28 @@ int mpi_PMPI_Pack
     return retval;
 }
 
+
+/*
+ * MPI_Type_free
+ *
+ * Not traced. Wrapped only so the cached size of the datatype is dropped
+ * before the MPI implementation can reuse its handle.
+ */
+
+#if defined (CBTF_SERVICE_USE_OFFLINE) && !defined(CBTF_STATIC)
+int MPI_Type_free
+#elif defined (CBTF_STATIC) && defined (CBTF_SERVICE_USE_OFFLINE)
+int __wrap_MPI_Type_free
+#else
+int mpi_PMPI_Type_free
+#endif
+			(MPI_Datatype* datatype)
+{
+    mpi_cache_free_type(*datatype);
+    return PMPI_Type_free(datatype);
+}
+
+
 /*
  * MPI_Init
  */
@@ -4650,9 +4678,7 @@ int mpi_PMPI_Init
     retval = PMPI_Init(argc, argv);
 
 #if defined (CBTF_SERVICE_USE_OFFLINE)
-    int oss_rank = -1;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &oss_rank);
-    CBTF_mpi_rank = oss_rank;
+    CBTF_mpi_rank = mpi_cached_world_rank();
 #endif
 
     if (dotrace) {
@@ -4666,7 +4692,7 @@ int mpi_PMPI_Init
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -4743,8 +4769,8 @@ int mpi_PMPI_Get_count
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = *count * datatype_size;
     event.datatype = (int64_t) datatype;
     event.retval = retval;
@@ -4840,8 +4866,8 @@ int mpi_PMPI_Gatherv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) recvtype;
@@ -4928,8 +4954,8 @@ int mpi_PMPI_Gather
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     event.size = recvcount * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) recvtype;
@@ -4998,7 +5024,7 @@ int mpi_PMPI_Cancel
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.retval = retval;
 
     /* Initialize unused arguments */
@@ -5072,8 +5098,8 @@ int mpi_PMPI_Bcast
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) datatype;
@@ -5142,7 +5168,7 @@ int mpi_PMPI_Barrier
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
+    event.destination = mpi_cached_world_rank();
     event.communicator = (int64_t) comm;
     event.retval = retval;
 
@@ -5241,8 +5267,8 @@ int mpi_PMPI_Alltoallv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) recvtype;
@@ -5322,8 +5348,8 @@ int mpi_PMPI_Alltoall
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     event.size = recvcount * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) recvtype;
@@ -5405,8 +5431,8 @@ int mpi_PMPI_Allreduce
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     event.size = count * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) datatype;
@@ -5502,8 +5528,8 @@ int mpi_PMPI_Allgatherv
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     event.size = *recvcounts * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) recvtype;
@@ -5587,8 +5613,8 @@ int mpi_PMPI_Allgather
 
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     event.size = recvcount * datatype_size;
     event.communicator = (int64_t) comm;
     event.datatype = (int64_t) recvtype;
@@ -5659,8 +5685,8 @@ int mpi_PMPI_Scatter
     mpi_start_event(&send_event);
     mpi_start_event(&recv_event);
     send_event.source = root;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(send_event.source));
-    PMPI_Type_size(sendtype, &datatype_size);
+    send_event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(sendtype);
     send_event.size = sendcount * datatype_size;
     send_event.datatype = (int64_t) sendtype;
     
@@ -5696,7 +5722,7 @@ int mpi_PMPI_Scatter
     mpi_record_event(&send_event, CBTF_GetAddressOfFunction(PMPI_Scatter));
 
     /* Set up the recv record */
-    PMPI_Type_size(recvtype, &datatype_size);
+    datatype_size = mpi_cached_type_size(recvtype);
     recv_event.size = recvcount * datatype_size;
     recv_event.datatype = (int64_t) recvtype;
 
@@ -5779,8 +5805,8 @@ int mpi_PMPI_Scatterv
     mpi_start_event(&send_event);
     mpi_start_event(&recv_event);
     send_event.source = root;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(send_event.source));
-    PMPI_Type_size(sendtype, &datatype_size);
+    send_event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(sendtype);
     /* This is surly wrong */
     send_event.size = sendcounts[0] * datatype_size;
     send_event.datatype = (int64_t) sendtype;
@@ -5829,7 +5855,7 @@ int mpi_PMPI_Scatterv
     /*TRACE DETAILS*/
 #if defined(EXTENDEDTRACE)
     /* Set up the recv record */
-    PMPI_Type_size(recvtype, &datatype_size);
+    datatype_size = mpi_cached_type_size(recvtype);
     recv_event.size = recvcount * datatype_size;
     recv_event.datatype = (int64_t) recvtype;
 
@@ -5904,9 +5930,9 @@ int mpi_PMPI_Sendrecv
     /* Set up the send record */
     mpi_start_event(&send_event);
     mpi_start_event(&recv_event);
-    send_event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(send_event.source));
-    PMPI_Type_size(sendtype, &datatype_size);
+    send_event.destination = mpi_cached_global_rank(comm, dest);
+    send_event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(sendtype);
     send_event.size = sendcount * datatype_size;
     send_event.tag = sendtag;
     send_event.datatype = (int64_t) sendtype;
@@ -5939,9 +5965,9 @@ int mpi_PMPI_Sendrecv
     mpi_record_event(&send_event, CBTF_GetAddressOfFunction(PMPI_Sendrecv));
 
     /* Set up the recv record */
-    recv_event.source = source;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(recv_event.destination));
-    PMPI_Type_size(recvtype, &datatype_size);
+    recv_event.source = mpi_cached_global_rank(comm, source);
+    recv_event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(recvtype);
     recv_event.size = recvcount * datatype_size;
     recv_event.tag = recvtag;
     recv_event.datatype = (int64_t) recvtype;
@@ -6011,9 +6037,9 @@ int mpi_PMPI_Sendrecv_replace
     /* Set up the send record */
     mpi_start_event(&send_event);
     mpi_start_event(&recv_event);
-    send_event.destination = dest;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(send_event.source));
-    PMPI_Type_size(datatype, &datatype_size);
+    send_event.destination = mpi_cached_global_rank(comm, dest);
+    send_event.source = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     send_event.size = count * datatype_size;
     send_event.tag = sendtag;
     send_event.datatype = (int64_t) datatype;
@@ -6047,9 +6073,9 @@ int mpi_PMPI_Sendrecv_replace
     mpi_record_event(&send_event, CBTF_GetAddressOfFunction(PMPI_Sendrecv_replace));
 
     /* Set up the recv record */
-    recv_event.source = source;
-    PMPI_Comm_rank(MPI_COMM_WORLD, &(recv_event.destination));
-    PMPI_Type_size(datatype, &datatype_size);
+    recv_event.source = mpi_cached_global_rank(comm, source);
+    recv_event.destination = mpi_cached_world_rank();
+    datatype_size = mpi_cached_type_size(datatype);
     recv_event.size = count * datatype_size;
     recv_event.tag = recvtag;
     recv_event.datatype = (int64_t) datatype;
@@ -6515,6 +6541,9 @@ int mpi_PMPI_Comm_free
 
     }
 
+    /* The handle is reset by PMPI_Comm_free so invalidate it first */
+    mpi_cache_free_comm(*comm);
+
     retval = PMPI_Comm_free(comm);
 
     if (dotrace) {
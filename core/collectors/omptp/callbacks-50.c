@@ -121,8 +121,6 @@ typedef struct {
     uint64_t barrier_ttime;
     uint64_t wbarrier_btime;
     uint64_t wbarrier_ttime;
-    uint64_t lock_btime;
-    uint64_t lock_time;
     uint64_t itask_btime;
     uint64_t itask_ttime;
     uint64_t serial_btime;
@@ -339,8 +337,6 @@ void CBTF_ompt_callback_thread_begin()
     tls->serial_ttime = 0;
     tls->serial_btime = CBTF_GetTime();
     tls->thread_btime = tls->serial_btime;
-    tls->lock_btime = 0;
-    tls->lock_time = 0;
 #ifndef NDEBUG
     if (cbtf_ompt_debug) {
 	fprintf(stderr, "[%d,%d] CBTF_ompt_callback_thread_begin:%ld\n",getpid(),monitor_get_thread_num(),ompt_get_thread_data()->value);
@@ -408,45 +404,83 @@ void CBTF_ompt_callback_runtime_shutdown()
 #endif
 }
 
-// ompt_event_UNIMPLEMENTED
-// if acquired, end time on wait name.
-// clear wait, set acquired, start time on region name
-void CBTF_ompt_callback_acquired_lock (ompt_wait_id_t *waitID) {
-#if 1
-    /* Access our thread-local storage */
-#ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
-#else
-    TLS* tls = &the_tls;
-#endif
-    Assert(tls != NULL);
-    tls->lock_btime = CBTF_GetTime();
+/**
+ * Map an OMPT mutex kind to the kind recorded in the mutex statistics.
+ *
+ * @param kind    OMPT mutex kind.
+ * @return        Kind recorded in the mutex statistics.
+ */
+static int mutex_kind(ompt_mutex_t kind)
+{
+    switch (kind) {
+    case ompt_mutex_nest_lock:
+    case ompt_mutex_test_nest_lock:
+	return CBTF_OMPT_MUTEX_NEST_LOCK;
+    case ompt_mutex_critical:
+	return CBTF_OMPT_MUTEX_CRITICAL;
+    case ompt_mutex_atomic:
+	return CBTF_OMPT_MUTEX_ATOMIC;
+    case ompt_mutex_ordered:
+	return CBTF_OMPT_MUTEX_ORDERED;
+    default:
+	return CBTF_OMPT_MUTEX_LOCK;
+    }
+}
+
+// ompt_event_MAY_ALWAYS_TRACE
+// begin waiting on a lock, critical, atomic or ordered region.
+// nested locks only report their first acquisition.
+void CBTF_ompt_callback_mutex_acquire(
+  ompt_mutex_t kind,
+  unsigned int hint,
+  unsigned int impl,
+  ompt_wait_id_t wait_id,
+  const void *codeptr_ra)
+{
 #ifndef NDEBUG
-    if (cbtf_ompt_debug_trace) {
+    if (cbtf_ompt_debug_lock) {
+	fprintf(stderr, "[%ld] CBTF_ompt_callback_mutex_acquire: kind:%d waitID:%lu codeptr_ra:%p\n",
+		ompt_get_thread_data()->value,kind,wait_id,codeptr_ra);
     }
 #endif
-	fprintf(stderr, "[%ld] CBTF_ompt_callback_acquired_lock: waitID:%p\n",ompt_get_thread_data()->value,waitID);
-#endif
+
+    omptp_mutex_acquire(mutex_kind(kind), wait_id, (uint64_t)codeptr_ra,
+			(kind == ompt_mutex_test_lock) ||
+			(kind == ompt_mutex_test_nest_lock));
 }
 
-// ompt_event_MAY_ALWAYS_BLAME
-// if acquired, end time region name, clear acquired
-void CBTF_ompt_callback_release_lock (ompt_wait_id_t *waitID) {
-    /* Access our thread-local storage */
-#ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
-#else
-    TLS* tls = &the_tls;
+// ompt_event_MAY_ALWAYS_TRACE
+// end the wait and begin the hold of the mutex.
+void CBTF_ompt_callback_mutex_acquired(
+  ompt_mutex_t kind,
+  ompt_wait_id_t wait_id,
+  const void *codeptr_ra)
+{
+#ifndef NDEBUG
+    if (cbtf_ompt_debug_lock) {
+	fprintf(stderr, "[%ld] CBTF_ompt_callback_mutex_acquired: kind:%d waitID:%lu\n",
+		ompt_get_thread_data()->value,kind,wait_id);
+    }
 #endif
-    Assert(tls != NULL);
 
+    omptp_mutex_acquired(mutex_kind(kind), wait_id);
+}
+
+// ompt_event_MAY_ALWAYS_BLAME
+// end the hold of the mutex.
+void CBTF_ompt_callback_mutex_released(
+  ompt_mutex_t kind,
+  ompt_wait_id_t wait_id,
+  const void *codeptr_ra)
+{
 #ifndef NDEBUG
-    if (cbtf_ompt_debug_trace) {
-	fprintf(stderr, "[%ld] CBTF_ompt_callback_release_lock: waitID:%p\n",ompt_get_thread_data()->value,waitID);
+    if (cbtf_ompt_debug_lock) {
+	fprintf(stderr, "[%ld] CBTF_ompt_callback_mutex_released: kind:%d waitID:%lu\n",
+		ompt_get_thread_data()->value,kind,wait_id);
     }
 #endif
 
-    tls->lock_time += CBTF_GetTime() - tls->lock_btime;
+    omptp_mutex_released(mutex_kind(kind), wait_id);
 }
 
 // ompt_event_MAY_ALWAYS_TRACE but also seems used as BLAME??
@@ -936,6 +970,9 @@ int ompt_initialize(
   register_callback(ompt_callback_parallel_end);
   register_callback(ompt_callback_thread_begin);
   register_callback(ompt_callback_thread_end);
+  register_callback(ompt_callback_mutex_acquire);
+  register_callback_t(ompt_callback_mutex_acquired, ompt_callback_mutex_t);
+  register_callback_t(ompt_callback_mutex_released, ompt_callback_mutex_t);
 
 #ifndef NDEBUG
   if (cbtf_ompt_debug) {
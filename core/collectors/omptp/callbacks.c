@@ -100,8 +100,6 @@ typedef struct {
     uint64_t barrier_ttime;
     uint64_t wbarrier_btime;
     uint64_t wbarrier_ttime;
-    uint64_t lock_btime;
-    uint64_t lock_time;
     uint64_t itask_btime;
     uint64_t itask_ttime;
     uint64_t serial_btime;
@@ -380,8 +378,6 @@ void CBTF_ompt_cb_thread_begin()
     tls->serial_ttime = 0;
     tls->serial_btime = CBTF_GetTime();
     tls->thread_btime = tls->serial_btime;
-    tls->lock_btime = 0;
-    tls->lock_time = 0;
 #ifndef NDEBUG
     if (cbtf_ompt_debug) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_thread_begin:\n",ompt_get_thread_id());
@@ -450,6 +446,8 @@ void CBTF_ompt_cb_wait_atomic (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_wait_atomic: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_acquire(CBTF_OMPT_MUTEX_ATOMIC, (uint64_t)waitID, 0, false);
 }
 
 // ompt_event_MAY_ALWAYS_TRACE
@@ -462,6 +460,8 @@ void CBTF_ompt_cb_wait_ordered (ompt_wait_id_t *waitID) {
 		ompt_get_thread_id(),waitID,task_state);
     }
 #endif
+
+    omptp_mutex_acquire(CBTF_OMPT_MUTEX_ORDERED, (uint64_t)waitID, 0, false);
 }
 
 // ompt_event_UNIMPLEMENTED
@@ -472,6 +472,8 @@ void CBTF_ompt_cb_wait_critical (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_wait_critical: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_acquire(CBTF_OMPT_MUTEX_CRITICAL, (uint64_t)waitID, 0, false);
 }
 
 // ompt_event_UNIMPLEMENTED
@@ -482,6 +484,8 @@ void CBTF_ompt_cb_wait_lock (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_wait_lock: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_acquire(CBTF_OMPT_MUTEX_LOCK, (uint64_t)waitID, 0, false);
 }
 
 // ompt_event_MAY_ALWAYS_TRACE
@@ -493,6 +497,8 @@ void CBTF_ompt_cb_acquired_atomic (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_acquired_atomic: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_acquired(CBTF_OMPT_MUTEX_ATOMIC, (uint64_t)waitID);
 }
 
 // ompt_event_MAY_ALWAYS_TRACE
@@ -506,38 +512,32 @@ void CBTF_ompt_cb_acquired_ordered (ompt_wait_id_t *waitID) {
 		ompt_get_thread_id(),waitID,task_state);
     }
 #endif
+
+    omptp_mutex_acquired(CBTF_OMPT_MUTEX_ORDERED, (uint64_t)waitID);
 }
 
 // ompt_event_UNIMPLEMENTED
 void CBTF_ompt_cb_acquired_critical (ompt_wait_id_t *waitID) {
-#if 1
 #ifndef NDEBUG
     if (cbtf_ompt_debug_wait) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_acquired_critical: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
-#endif
+
+    omptp_mutex_acquired(CBTF_OMPT_MUTEX_CRITICAL, (uint64_t)waitID);
 }
 
 // ompt_event_UNIMPLEMENTED
 // if acquired, end time on wait name.
 // clear wait, set acquired, start time on region name
 void CBTF_ompt_cb_acquired_lock (ompt_wait_id_t *waitID) {
-#if 1
-    /* Access our thread-local storage */
-#ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
-#else
-    TLS* tls = &the_tls;
-#endif
-    Assert(tls != NULL);
-    tls->lock_btime = CBTF_GetTime();
 #ifndef NDEBUG
-    if (cbtf_ompt_debug_trace) {
-    }
-#endif
+    if (cbtf_ompt_debug_lock) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_acquired_lock: waitID = %lu\n",ompt_get_thread_id(),waitID);
+    }
 #endif
+
+    omptp_mutex_acquired(CBTF_OMPT_MUTEX_LOCK, (uint64_t)waitID);
 }
 
 // ompt_event_MAY_ALWAYS_BLAME
@@ -547,6 +547,8 @@ void CBTF_ompt_cb_release_atomic (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_release_atomic: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_released(CBTF_OMPT_MUTEX_ATOMIC, (uint64_t)waitID);
 }
 
 // ompt_event_MAY_ALWAYS_BLAME
@@ -558,6 +560,8 @@ void CBTF_ompt_cb_release_ordered (ompt_wait_id_t *waitID) {
 		ompt_get_thread_id(),waitID,task_state);
     }
 #endif
+
+    omptp_mutex_released(CBTF_OMPT_MUTEX_ORDERED, (uint64_t)waitID);
 }
 
 // ompt_event_MAY_ALWAYS_BLAME
@@ -567,26 +571,20 @@ void CBTF_ompt_cb_release_critical (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_release_critical: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_released(CBTF_OMPT_MUTEX_CRITICAL, (uint64_t)waitID);
 }
 
 // ompt_event_MAY_ALWAYS_BLAME
 // if acquired, end time region name, clear acquired
 void CBTF_ompt_cb_release_lock (ompt_wait_id_t *waitID) {
-    /* Access our thread-local storage */
-#ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
-#else
-    TLS* tls = &the_tls;
-#endif
-    Assert(tls != NULL);
-
 #ifndef NDEBUG
     if (cbtf_ompt_debug_blame) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_release_lock: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
 
-    tls->lock_time += CBTF_GetTime() - tls->lock_btime;
+    omptp_mutex_released(CBTF_OMPT_MUTEX_LOCK, (uint64_t)waitID);
 }
 
 // TODO: LOCKS
@@ -616,6 +614,8 @@ void CBTF_ompt_cb_wait_nest_lock (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_wait_nest_lock: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_acquire(CBTF_OMPT_MUTEX_NEST_LOCK, (uint64_t)waitID, 0, false);
 }
 
 // ompt_event_release_nest_lock_last ompt_event_MAY_ALWAYS_BLAME
@@ -625,6 +625,8 @@ void CBTF_ompt_cb_release_nest_lock_last (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_release_nest_lock_last: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_released(CBTF_OMPT_MUTEX_NEST_LOCK, (uint64_t)waitID);
 }
 
 // ompt_event_release_nest_lock_prev ompt_event_MAY_ALWAYS_TRACE
@@ -643,6 +645,8 @@ void CBTF_ompt_cb_acquired_nest_lock_first (ompt_wait_id_t *waitID) {
 	fprintf(stderr, "[%d] CBTF_ompt_cb_acquired_nest_lock_first: waitID = %lu\n",ompt_get_thread_id(),waitID);
     }
 #endif
+
+    omptp_mutex_acquired(CBTF_OMPT_MUTEX_NEST_LOCK, (uint64_t)waitID);
 }
 
 //
@@ -69,6 +69,15 @@ const unsigned OverheadFrameCount = 2;
 // and the size of a ompt event.  Should find the best fit going forward.
 #define EventBufferSize (CBTF_BlobSizeFactor * 200)
 
+/** Number of (mutex, call site) pairs in the mutex statistics table. */
+#define MutexStatsSize (CBTF_BlobSizeFactor * 32)
+
+/** Number of entries in the mutex statistics table's hash table. */
+#define MutexStatsHashSize (2 * MutexStatsSize)
+
+/** Maximum number of mutexes tracked as waited on or held at one time. */
+#define MaxHeldMutexes 16
+
 extern void CBTF_ompt_set_collector_active(bool);
 
 /** Type defining the items stored in thread-local storage. */
@@ -87,6 +96,30 @@ typedef struct {
 	uint8_t count[StackTraceBufferSize];  /**< Stack traces. */
     } buffer;
 
+    CBTF_ompt_mutex_data mutex_data;  /**< OpenMP mutex statistics blob. */
+    uint64_t mutex_time_begin;        /**< Time the statistics were reset. */
+
+    /** OpenMP mutex statistics table. */
+    struct {
+	CBTF_ompt_mutex_stats mutexes[MutexStatsSize]; /**< Mutex statistics. */
+	uint32_t hashes[MutexStatsSize];         /**< Hash of each mutex's key. */
+	uint16_t hash_table[MutexStatsHashSize]; /**< Mutex index plus one. */
+    } mutexbuf;
+
+    /**
+     * Mutexes this thread is waiting on or holding, most recent last. The
+     * acquisition time is zero while the thread is still waiting.
+     */
+    struct {
+	uint64_t wait_id;     /**< OMPT wait identifier of the mutex. */
+	int kind;             /**< Kind of construct. */
+	uint64_t codeptr;     /**< Return address of the acquiring call. */
+	bool is_test;         /**< Is this a lock test? */
+	uint64_t wait_time;   /**< Time the thread began waiting. */
+	uint64_t time;        /**< Time the mutex was acquired. */
+    } held[MaxHeldMutexes];
+    unsigned held_count;  /**< Number of mutexes waited on or held. */
+
     int defer_sampling;
     bool do_trace;
     bool in_parallel_region;
@@ -238,6 +271,301 @@ static void send_samples(TLS *tls)
     initialize_data(tls);
 }
 
+
+/**
+ * Initialize the OpenMP mutex statistics contained within the given
+ * thread-local storage. Mutexes currently waited on or held are kept.
+ *
+ * @param tls    Thread-local storage to be initialized.
+ */
+static void initialize_mutex_data(TLS* tls)
+{
+    Assert(tls != NULL);
+
+    tls->mutex_time_begin = CBTF_GetTime();
+    tls->mutex_data.mutexes.mutexes_val = tls->mutexbuf.mutexes;
+    tls->mutex_data.mutexes.mutexes_len = 0;
+    memset(tls->mutexbuf.hash_table, 0, sizeof(tls->mutexbuf.hash_table));
+}
+
+
+
+/**
+ * Send the OpenMP mutex statistics.
+ *
+ * Sends the mutex statistics to the framework under their own data header
+ * identifier. Then resets the statistics to the empty state.
+ *
+ * @param tls    Thread-local storage containing the statistics.
+ */
+static void send_mutex_data(TLS* tls)
+{
+    CBTF_DataHeader header;
+    unsigned i;
+
+    memcpy(&header, &tls->header, sizeof(CBTF_DataHeader));
+    header.id = strdup("omptplocks");
+    header.omp_tid = monitor_get_thread_num();
+    header.time_begin = tls->mutex_time_begin;
+    header.time_end = CBTF_GetTime();
+    header.addr_begin = ~0;
+    header.addr_end = 0;
+    header.rank = monitor_mpi_comm_rank();
+    for (i = 0; i < tls->mutex_data.mutexes.mutexes_len; ++i) {
+	uint64_t codeptr = tls->mutexbuf.mutexes[i].codeptr;
+	if (codeptr == 0) {
+	    continue;
+	}
+	if (codeptr < header.addr_begin) {
+	    header.addr_begin = codeptr;
+	}
+	if (codeptr >= header.addr_end) {
+	    header.addr_end = codeptr + 1;
+	}
+    }
+
+#ifndef NDEBUG
+    if (IsCollectorDebugEnabled) {
+	fprintf(stderr, "[%ld,%d] omptp send_mutex_data: mutexes_len(%u)\n",
+		header.pid, header.omp_tid,
+		tls->mutex_data.mutexes.mutexes_len);
+    }
+#endif
+
+    cbtf_collector_send(&header, (xdrproc_t)xdr_CBTF_ompt_mutex_data, &(tls->mutex_data));
+    free(header.id);
+
+    initialize_mutex_data(tls);
+}
+
+
+
+/**
+ * Get the statistics of an OpenMP mutex.
+ *
+ * Returns the statistics of the specified mutex as acquired from the specified
+ * call site, adding them if this is the first time the pair is seen. The
+ * statistics are sent first when there is no room for a new pair.
+ *
+ * @param tls        Thread-local storage containing the statistics.
+ * @param wait_id    OMPT wait identifier of the mutex.
+ * @param kind       Kind of construct.
+ * @param codeptr    Return address of the acquiring call.
+ * @return           Statistics of this mutex and call site.
+ */
+static CBTF_ompt_mutex_stats* get_mutex_stats(TLS* tls, uint64_t wait_id,
+					      int kind, uint64_t codeptr)
+{
+    CBTF_ompt_mutex_stats* mutex = NULL;
+    uint32_t hash = 2166136261u;
+    unsigned index;
+
+    /* Find (or add) the statistics for this mutex and call site */
+    hash = (hash ^ (uint32_t)(wait_id ^ (wait_id >> 32))) * 16777619u;
+    hash = (hash ^ (uint32_t)kind) * 16777619u;
+    hash = (hash ^ (uint32_t)(codeptr ^ (codeptr >> 32))) * 16777619u;
+    index = hash % MutexStatsHashSize;
+    while (tls->mutexbuf.hash_table[index] != 0) {
+	unsigned m = tls->mutexbuf.hash_table[index] - 1;
+	mutex = &tls->mutexbuf.mutexes[m];
+	if ((tls->mutexbuf.hashes[m] == hash) && (mutex->wait_id == wait_id) &&
+	    (mutex->kind == kind) && (mutex->codeptr == codeptr)) {
+	    return mutex;
+	}
+	index = (index + 1) % MutexStatsHashSize;
+    }
+
+    if (tls->mutex_data.mutexes.mutexes_len == MutexStatsSize) {
+	send_mutex_data(tls);
+	index = hash % MutexStatsHashSize;
+    }
+    mutex = &tls->mutexbuf.mutexes[tls->mutex_data.mutexes.mutexes_len];
+    memset(mutex, 0, sizeof(CBTF_ompt_mutex_stats));
+    mutex->wait_id = wait_id;
+    mutex->kind = kind;
+    mutex->codeptr = codeptr;
+    tls->mutexbuf.hashes[tls->mutex_data.mutexes.mutexes_len] = hash;
+    tls->mutexbuf.hash_table[index] = ++tls->mutex_data.mutexes.mutexes_len;
+    return mutex;
+}
+
+
+
+/**
+ * Find a mutex this thread is waiting on or holding.
+ *
+ * @param tls         Thread-local storage of this thread.
+ * @param wait_id     OMPT wait identifier of the mutex.
+ * @param kind        Kind of construct.
+ * @param acquired    Find a held mutex rather than one waited on.
+ * @return            Index of the most recent such mutex in the held mutexes
+ *                    or MaxHeldMutexes if there is none.
+ */
+static unsigned find_held_mutex(TLS* tls, uint64_t wait_id, int kind,
+				bool acquired)
+{
+    unsigned h = tls->held_count;
+
+    while (h > 0) {
+	--h;
+	if ((tls->held[h].wait_id == wait_id) && (tls->held[h].kind == kind) &&
+	    ((tls->held[h].time != 0) == acquired)) {
+	    return h;
+	}
+    }
+    return MaxHeldMutexes;
+}
+
+
+
+/**
+ * Remove a mutex from the mutexes this thread is waiting on or holding. A lock
+ * test still waiting on its mutex is counted as a failed test.
+ *
+ * @param tls    Thread-local storage of this thread.
+ * @param h      Index of the mutex in the held mutexes.
+ */
+static void remove_held_mutex(TLS* tls, unsigned h)
+{
+    if (tls->held[h].is_test && (tls->held[h].time == 0)) {
+	get_mutex_stats(tls, tls->held[h].wait_id, tls->held[h].kind,
+			tls->held[h].codeptr)->failed_tests++;
+    }
+    memmove(&tls->held[h], &tls->held[h + 1],
+	    (tls->held_count - h - 1) * sizeof(tls->held[0]));
+    tls->held_count--;
+}
+
+
+
+/**
+ * Begin waiting on an OpenMP mutex.
+ *
+ * Called by the omptp callbacks when this thread begins acquiring a lock,
+ * critical section, atomic or ordered region. A lock test that never reported
+ * acquiring the same mutex is counted as failed. Mutexes beyond the first
+ * MaxHeldMutexes waited on or held at one time aren't tracked.
+ *
+ * @param kind       Kind of construct.
+ * @param wait_id    OMPT wait identifier of the mutex.
+ * @param codeptr    Return address of the acquiring call (or zero).
+ * @param is_test    Is this a lock test?
+ */
+void omptp_mutex_acquire(int kind, uint64_t wait_id, uint64_t codeptr,
+			 bool is_test)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if (tls == NULL || !tls->do_trace)
+	return;
+
+    unsigned h = find_held_mutex(tls, wait_id, kind, false);
+    if (h < MaxHeldMutexes) {
+	remove_held_mutex(tls, h);
+    }
+    if (tls->held_count == MaxHeldMutexes) {
+	/* Drop the oldest mutex still waited on (likely a failed test) */
+	for (h = 0; (h < tls->held_count) && (tls->held[h].time != 0); ++h);
+	if (h == tls->held_count)
+	    return;
+	remove_held_mutex(tls, h);
+    }
+
+    h = tls->held_count++;
+    tls->held[h].wait_id = wait_id;
+    tls->held[h].kind = kind;
+    tls->held[h].codeptr = codeptr;
+    tls->held[h].is_test = is_test;
+    tls->held[h].wait_time = CBTF_GetTime();
+    tls->held[h].time = 0;
+}
+
+
+
+/**
+ * Acquire an OpenMP mutex.
+ *
+ * Called by the omptp callbacks when this thread has acquired a mutex. Credits
+ * the time spent waiting for it to the call site that began waiting.
+ *
+ * @param kind       Kind of construct.
+ * @param wait_id    OMPT wait identifier of the mutex.
+ */
+void omptp_mutex_acquired(int kind, uint64_t wait_id)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if (tls == NULL || !tls->do_trace)
+	return;
+
+    uint64_t now = CBTF_GetTime();
+    unsigned h = find_held_mutex(tls, wait_id, kind, false);
+    if (h == MaxHeldMutexes)
+	return;
+
+    uint64_t wait = now - tls->held[h].wait_time, time;
+    unsigned bucket = 0;
+    CBTF_ompt_mutex_stats* mutex =
+	get_mutex_stats(tls, wait_id, kind, tls->held[h].codeptr);
+    mutex->acquisitions++;
+    mutex->wait_time += wait;
+    if (wait > mutex->max_wait_time)
+	mutex->max_wait_time = wait;
+    for (time = wait / 1000;
+	 (time > 0) && (bucket < CBTF_OMPT_MUTEX_HISTOGRAM_SIZE - 1);
+	 time >>= 1)
+	++bucket;
+    mutex->histogram[bucket]++;
+
+    tls->held[h].time = (now != 0) ? now : 1;
+}
+
+
+
+/**
+ * Release an OpenMP mutex.
+ *
+ * Called by the omptp callbacks when this thread releases a mutex. Credits the
+ * time it was held to the call site that acquired it. Mutexes that aren't
+ * tracked as held are ignored.
+ *
+ * @param kind       Kind of construct.
+ * @param wait_id    OMPT wait identifier of the mutex.
+ */
+void omptp_mutex_released(int kind, uint64_t wait_id)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if (tls == NULL || !tls->do_trace)
+	return;
+
+    uint64_t now = CBTF_GetTime();
+    unsigned h = find_held_mutex(tls, wait_id, kind, true);
+    if (h == MaxHeldMutexes)
+	return;
+
+    uint64_t hold = (now > tls->held[h].time) ? (now - tls->held[h].time) : 0;
+    CBTF_ompt_mutex_stats* mutex =
+	get_mutex_stats(tls, wait_id, kind, tls->held[h].codeptr);
+    mutex->hold_time += hold;
+    if (hold > mutex->max_hold_time)
+	mutex->max_hold_time = hold;
+
+    remove_held_mutex(tls, h);
+}
+
 /**
  * Start an event.
  *
@@ -398,7 +726,8 @@ void omptp_record_event(const CBTF_omptp_event* event, uint64_t* stacktrace, uns
 	if (stacktrace[i] < tls->header.addr_begin ) {
 	    tls->header.addr_begin = stacktrace[i];
 	}
-	if (stacktrace[i] > tls->header.addr_end ) {
+	if (!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	    stacktrace[i] > tls->header.addr_end ) {
 	    tls->header.addr_end = stacktrace[i];
 	}
 	tls->data.stacktraces.stacktraces_len++;
@@ -448,6 +777,8 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 
     /* Initialize the actual data blob */
     initialize_data(tls);
+    initialize_mutex_data(tls);
+    tls->held_count = 0;
 
     /* Initialize the callstack nesting depth */
     tls->nesting_depth = 0;
@@ -553,6 +884,11 @@ void cbtf_collector_stop()
 	send_samples(tls);
     }
 
+    /* Send the mutex statistics of this thread */
+    if(tls->mutex_data.mutexes.mutexes_len > 0) {
+	send_mutex_data(tls);
+    }
+
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     free(tls);
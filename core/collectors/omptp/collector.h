@@ -60,5 +60,12 @@ extern void IDLE(bool);
 extern void BARRIER(bool);
 extern void WAIT_BARRIER(bool);
 
+// notification to collector of OpenMP lock, critical, atomic and ordered
+// waits, acquisitions and releases. The collector accumulates the wait and
+// hold time of each mutex per thread.
+extern void omptp_mutex_acquire(int, uint64_t, uint64_t, bool);
+extern void omptp_mutex_acquired(int, uint64_t);
+extern void omptp_mutex_released(int, uint64_t);
+
 extern void omptp_record_event(const CBTF_omptp_event*, uint64_t*, unsigned);
 extern void omptp_start_event(CBTF_omptp_event*, uint64_t, uint64_t*, unsigned*);
@@ -0,0 +1,216 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This program is free software; you can redistribute it and/or modify it under
+** the terms of the GNU General Public License as published by the Free Software
+** Foundation; either version 2 of the License, or (at your option) any later
+** version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+** details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+** Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file Definition of the overview collector's binary output records. */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "OverviewRecord.h"
+
+/*
+ * Helper function to create a path.
+ */
+int CBTF_overview_mkpath(const char* dir, mode_t mode)
+{
+    struct stat sb;
+
+    if (!dir) {
+        errno = EINVAL;
+        return 1;
+    }
+
+    if (!stat(dir, &sb))
+        return 0;
+
+    CBTF_overview_mkpath(dirname(strdupa(dir)), mode);
+
+    if (mkdir(dir, mode) != 0)
+	return (errno == EEXIST) ? 0 : -1;
+    return 0;
+}
+
+int CBTF_overview_record_csv_dir(const CBTF_overview_record* record,
+				 const char* base, char* path, size_t size)
+{
+    int length;
+
+    if (record->rank < 0) {
+	length = snprintf(path, size, "%s/%s-%" PRId64,
+			  base, record->host, record->pid);
+    } else {
+	length = snprintf(path, size, "%s/%s-%d",
+			  base, record->host, record->rank);
+    }
+    return ((length < 0) || ((size_t)length >= size)) ? -1 : 0;
+}
+
+int CBTF_overview_record_csv_path(const CBTF_overview_record* record,
+				  const char* base, char* path, size_t size)
+{
+    char dir[PATH_MAX];
+    int length;
+
+    if (CBTF_overview_record_csv_dir(record, base, dir, sizeof(dir)) != 0)
+	return -1;
+
+    if (record->posix_tid == 0) {
+        if (record->rank < 0) {
+	    length = snprintf(path, size, "%s/%s-%" PRId64 ".csv",
+			      dir, record->executable, record->pid);
+	} else {
+	    length = snprintf(path, size, "%s/%s-%d.csv",
+			      dir, record->executable, record->rank);
+	}
+    } else {
+        if (record->rank < 0) {
+	    length = snprintf(path, size, "%s/%s-%" PRId64 "-%d.csv",
+			      dir, record->executable, record->pid,
+			      record->omp_tid);
+	} else {
+	    length = snprintf(path, size, "%s/%s-%d-%d.csv",
+			      dir, record->executable, record->rank,
+			      record->omp_tid);
+	}
+    }
+    return ((length < 0) || ((size_t)length >= size)) ? -1 : 0;
+}
+
+/* Print one CSV line with the optional prefix. */
+static void print_line(FILE* file, const char* prefix, const char* line)
+{
+    fprintf(file, "%s%s\n", (prefix != NULL) ? prefix : "", line);
+}
+
+void CBTF_overview_record_print_csv(FILE* file, const char* prefix,
+				    const CBTF_overview_record* record)
+{
+    char values[1024];
+    uint32_t i;
+
+    // Provenance.
+    print_line(file, prefix,
+	"host,pid,rank,tid,posix_tid,executable,total_time_seconds");
+    snprintf(values, sizeof(values),
+	"%s,%" PRId64 ",%d,%d,%" PRId64 ",%s,%f",
+	record->host, record->pid, record->rank, record->omp_tid,
+	record->posix_tid, record->executable,
+	(float)record->thread_time/1000000000);
+    print_line(file, prefix, values);
+
+    // Rusage.
+    print_line(file, prefix, "maxrss_kB,utime_seconds,stime_seconds");
+    snprintf(values, sizeof(values),
+	"%" PRId64 ",%" PRId64 ".%06u,%" PRId64 ".%06u",
+	record->maxrss,
+	record->utime_sec, (unsigned int) record->utime_usec,
+	record->stime_sec, (unsigned int) record->stime_usec);
+    print_line(file, prefix, values);
+
+    // PAPI_dmem.
+    print_line(file, prefix,
+	"dmem_size_kB,dmem_resident_kB,dmem_high_water_mark_kB,dmem_shared_kB,dmem_heap_kB");
+    snprintf(values, sizeof(values),
+	"%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64,
+	record->dmem_size, record->dmem_resident,
+	record->dmem_high_water_mark, record->dmem_shared, record->dmem_heap);
+    print_line(file, prefix, values);
+
+    // POSIX IO
+    if (record->posixio_time > 0) {
+	print_line(file, prefix,
+	    "io_total_time_seconds,read_time_seconds,write_time_seconds,read_bytes,write_bytes");
+	snprintf(values, sizeof(values),
+	    "%f,%f,%f,%" PRIu64 ",%" PRIu64,
+	    (float)record->posixio_time/1000000000,
+	    (float)record->posixio_read_time/1000000000,
+	    (float)record->posixio_write_time/1000000000,
+	    record->posixio_bytes_read,
+	    record->posixio_bytes_written);
+	print_line(file, prefix, values);
+    }
+
+    // MEM
+    if (record->allocation_calls > 0) {
+	print_line(file, prefix,
+	    "allocation_time_seconds,allocation_calls,allocation_bytes");
+	snprintf(values, sizeof(values),
+	    "%f,%" PRIu64 ",%" PRIu64,
+	    (float)record->allocation_time/1000000000,
+	    record->allocation_calls,
+	    record->allocation_bytes);
+	print_line(file, prefix, values);
+    }
+
+    if (record->free_calls > 0) {
+	print_line(file, prefix, "free_time_seconds,free_calls");
+	snprintf(values, sizeof(values),
+	    "%f,%" PRIu64,
+	    (float)record->free_time/1000000000,
+	    record->free_calls);
+	print_line(file, prefix, values);
+    }
+
+    // MPI: TODO: handle all calls seen.
+    if (record->mpi_time > 0) {
+	print_line(file, prefix, "total_mpi_time_seconds");
+	snprintf(values, sizeof(values),
+	    "%f", (float)record->mpi_time/1000000000);
+	print_line(file, prefix, values);
+    }
+
+    // PAPI
+    {
+	char names[CBTF_OVERVIEW_RECORD_MAX_EVENTS *
+		   (CBTF_OVERVIEW_RECORD_MAX_EVENT_NAME + 1)] = {0};
+	char counts[CBTF_OVERVIEW_RECORD_MAX_EVENTS * 24] = {0};
+	size_t nlength = 0, clength = 0;
+
+	for (i = 0; (i < record->num_events) &&
+		    (i < CBTF_OVERVIEW_RECORD_MAX_EVENTS); ++i) {
+	    nlength += snprintf(names + nlength, sizeof(names) - nlength,
+				"%s%.*s", (i > 0) ? "," : "",
+				CBTF_OVERVIEW_RECORD_MAX_EVENT_NAME,
+				record->event_names[i]);
+	    clength += snprintf(counts + clength, sizeof(counts) - clength,
+				"%s%" PRId64, (i > 0) ? "," : "",
+				record->event_values[i]);
+	}
+	print_line(file, prefix, names);
+	print_line(file, prefix, counts);
+    }
+
+    // OMPT
+    if (record->itask_time > 0) {
+	print_line(file, prefix,
+	    "implicit_task_time_seconds,serial_time_seconds,barrier_time_seconds,wait_barrier_time_seconds,idle_time_seconds");
+	snprintf(values, sizeof(values), "%f,%f,%f,%f,%f",
+	    (float)record->itask_time/1000000000,
+	    (float)record->serial_time/1000000000,
+	    (float)record->barrier_time/1000000000,
+	    (float)record->wait_barrier_time/1000000000,
+	    (float)record->idle_time/1000000000);
+	print_line(file, prefix, values);
+    }
+}
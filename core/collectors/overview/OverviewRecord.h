@@ -0,0 +1,140 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This program is free software; you can redistribute it and/or modify it under
+** the terms of the GNU General Public License as published by the Free Software
+** Foundation; either version 2 of the License, or (at your option) any later
+** version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+** details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+** Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file Declaration of the overview collector's binary output records. */
+
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+/** Magic number identifying a record (also detects a foreign byte order). */
+#define CBTF_OVERVIEW_RECORD_MAGIC 0x4F565231  /* "OVR1" */
+
+/** Version of the record layout. */
+#define CBTF_OVERVIEW_RECORD_VERSION 1
+
+/** Maximum number of PAPI events in each record. */
+#define CBTF_OVERVIEW_RECORD_MAX_EVENTS 12
+
+/** Maximum length of each PAPI event name (matches PAPI_MAX_STR_LEN). */
+#define CBTF_OVERVIEW_RECORD_MAX_EVENT_NAME 128
+
+/**
+ * Fixed layout record holding the overview totals of one thread. Records
+ * are written in the native byte order, one after another, into a single
+ * file per node and are converted into the usual CSV files offline by the
+ * cbtf-overview-csv tool. All times are in nanoseconds.
+ */
+typedef struct {
+    uint32_t magic;       /**< CBTF_OVERVIEW_RECORD_MAGIC. */
+    uint32_t version;     /**< CBTF_OVERVIEW_RECORD_VERSION. */
+    uint32_t size;        /**< Size of this record in bytes. */
+    uint32_t num_events;  /**< Number of valid PAPI events. */
+
+    char host[256];        /**< Name of the host. */
+    char executable[256];  /**< Base name of the executable. */
+    int64_t pid;           /**< Process identifier. */
+    int64_t posix_tid;     /**< POSIX thread identifier. */
+    int32_t rank;          /**< MPI rank or -1. */
+    int32_t omp_tid;       /**< OpenMP thread identifier. */
+    uint64_t thread_time;  /**< Total time of the thread. */
+
+    int64_t maxrss;      /**< Maximum resident set size in kB. */
+    int64_t utime_sec;   /**< User time (seconds part). */
+    int64_t utime_usec;  /**< User time (microseconds part). */
+    int64_t stime_sec;   /**< System time (seconds part). */
+    int64_t stime_usec;  /**< System time (microseconds part). */
+
+    int64_t dmem_size;             /**< PAPI_dmem size in kB. */
+    int64_t dmem_resident;         /**< PAPI_dmem resident size in kB. */
+    int64_t dmem_high_water_mark;  /**< PAPI_dmem high water mark in kB. */
+    int64_t dmem_shared;           /**< PAPI_dmem shared size in kB. */
+    int64_t dmem_heap;             /**< PAPI_dmem heap size in kB. */
+
+    uint64_t posixio_time;           /**< Total POSIX I/O time. */
+    uint64_t posixio_read_time;      /**< Total read time. */
+    uint64_t posixio_write_time;     /**< Total write time. */
+    uint64_t posixio_bytes_read;     /**< Total bytes read. */
+    uint64_t posixio_bytes_written;  /**< Total bytes written. */
+
+    uint64_t allocation_time;   /**< Total allocation time. */
+    uint64_t allocation_calls;  /**< Number of allocation calls. */
+    uint64_t allocation_bytes;  /**< Total bytes allocated. */
+    uint64_t free_time;         /**< Total free time. */
+    uint64_t free_calls;        /**< Number of free calls. */
+
+    uint64_t mpi_time;  /**< Total MPI time. */
+
+    uint64_t itask_time;         /**< Total OpenMP implicit task time. */
+    uint64_t serial_time;        /**< Total OpenMP serial time. */
+    uint64_t barrier_time;       /**< Total OpenMP barrier time. */
+    uint64_t wait_barrier_time;  /**< Total OpenMP wait barrier time. */
+    uint64_t idle_time;          /**< Total OpenMP idle time. */
+
+    /** Name of each PAPI event. */
+    char event_names[CBTF_OVERVIEW_RECORD_MAX_EVENTS][CBTF_OVERVIEW_RECORD_MAX_EVENT_NAME];
+    int64_t event_values[CBTF_OVERVIEW_RECORD_MAX_EVENTS];  /**< Counts. */
+} CBTF_overview_record;
+
+/*
+ * Create a directory and any missing parent directories.
+ *
+ * @param dir     Directory to be created.
+ * @param mode    Permissions of the created directories.
+ * @return        Zero if the directory exists afterwards, non-zero otherwise.
+ */
+int CBTF_overview_mkpath(const char* dir, mode_t mode);
+
+/*
+ * Get the directory of the CSV file of the given record. This is the per
+ * host and rank (or pid) subdirectory of the given directory.
+ *
+ * @param record    Record whose directory is to be found.
+ * @param base      Directory containing the CSV files of every record.
+ * @param path      Buffer receiving the directory.
+ * @param size      Size of that buffer.
+ * @return          Zero on success or -1 if the directory was truncated.
+ */
+int CBTF_overview_record_csv_dir(const CBTF_overview_record* record,
+				 const char* base, char* path, size_t size);
+
+/*
+ * Get the path of the CSV file of the given record.
+ *
+ * @param record    Record whose path is to be found.
+ * @param base      Directory containing the CSV files of every record.
+ * @param path      Buffer receiving the path.
+ * @param size      Size of that buffer.
+ * @return          Zero on success or -1 if the path was truncated.
+ */
+int CBTF_overview_record_csv_path(const CBTF_overview_record* record,
+				  const char* base, char* path, size_t size);
+
+/*
+ * Print the given record as CSV. Each section is a line of column names
+ * followed by a line of values. Sections without data are omitted.
+ *
+ * @param file      File to be printed to.
+ * @param prefix    Prefix of each printed line or null for none.
+ * @param record    Record to be printed.
+ */
+void CBTF_overview_record_print_csv(FILE* file, const char* prefix,
+				    const CBTF_overview_record* record);
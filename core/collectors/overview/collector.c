@@ -282,6 +282,44 @@ void send_samples (TLS* tls)
     TLS_initialize_data(tls);
 }
 
+/**
+ * Send aggregated Kokkos timings.
+ *
+ * Called by the overview Kokkos connector (looked up with dlsym) when Kokkos
+ * is finalized. Sends the timings of this process under their own data header
+ * identifier using the header of the calling thread.
+ *
+ * @param data    Aggregated Kokkos timings to be sent.
+ */
+void overview_send_kokkos_data(const CBTF_kokkos_data* data)
+{
+    TLS* tls = TLS_get();
+    CBTF_DataHeader header;
+
+    if (tls == NULL || !tls->started) {
+	return;
+    }
+
+    memcpy(&header, &tls->data_header, sizeof(CBTF_DataHeader));
+    header.id = strdup("kokkos");
+    header.time_begin = tls->collector_start_time;
+    header.time_end = CBTF_GetTime();
+    header.addr_begin = 0;
+    header.addr_end = 0;
+    header.rank = monitor_mpi_comm_rank();
+
+#ifndef NDEBUG
+    if (IsDebugEnabled) {
+	fprintf(stderr, "[%ld,%d] overview_send_kokkos_data: kernels_len(%d) names_len(%d)\n",
+		header.pid, header.omp_tid,
+		data->kernels.kernels_len, data->names.names_len);
+    }
+#endif
+
+    cbtf_collector_send(&header, (xdrproc_t)xdr_CBTF_kokkos_data, data);
+    free(header.id);
+}
+
 #if defined(BUILD_TIMER_HANDLER)
 /**
  * Timer event handler.
@@ -24,7 +24,9 @@
 
 #include <KrellInstitute/Messages/Overview_data.h>
 #include "KrellInstitute/Messages/IO_data.h"
+#include "KrellInstitute/Messages/Kokkos_data.h"
 
 /* Flag indicating if debugging is enabled. */
 extern bool IsDebugEnabled;
 bool collector_do_trace();
+void overview_send_kokkos_data(const CBTF_kokkos_data*);
@@ -2,18 +2,289 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <unistd.h>
+#include <dlfcn.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
-#include <unordered_map>
+#include <mutex>
+#include <vector>
 #include <string>
 #include <cxxabi.h>
 
+#include "KrellInstitute/Messages/Kokkos_data.h"
 #include "monitor.h"
 #include "overview_connector.h"
 
-static KernelOverviewConnectorInfo* currentKernel;
-static std::unordered_map<std::string, KernelOverviewConnectorInfo*> domain_map;
-static uint64_t nextKernelID;
+/** Maximum nesting of kernels (or regions) tracked on each thread. */
+#define MaxNestingDepth 64
+
+/** Maximum number of kernels in each blob sent to the overview collector. */
+#define MaxKernelsPerBlob 512
+
+/** Maximum number of name characters in each blob. */
+#define MaxNamesPerBlob (32 * 1024)
+
+/** Type of the overview collector function sending the kernel timings. */
+typedef void (*SendKokkosData)(const CBTF_kokkos_data*);
+
+/** A kernel launch or region entry in progress on this thread. */
+struct ActiveKernel {
+    uint64_t kID;
+    KernelOverviewConnectorInfo* kernel;
+    uint64_t start;
+};
+
+/** Kernels launched on this thread that haven't yet ended. */
+static thread_local ActiveKernel activeKernels[MaxNestingDepth];
+static thread_local unsigned activeKernelCount;
+
+/** Profile regions entered on this thread that haven't yet been popped. */
+static thread_local ActiveKernel activeRegions[MaxNestingDepth];
+static thread_local unsigned activeRegionCount;
+
+/** Most recently launched kernel on this thread (interning fast path). */
+static thread_local const char* lastName;
+static thread_local KernelOverviewConnectorInfo* lastKernel;
+
+/**
+ * Open addressing hash table of the interned kernels. Slots only ever go
+ * from NULL to a kernel, so a probe needs no lock. The table is replaced
+ * rather than resized in place when it grows.
+ */
+struct KernelTable {
+    explicit KernelTable(size_t size) :
+	mask(size - 1), slots(new std::atomic<KernelOverviewConnectorInfo*>[size]) {
+	for (size_t i = 0; i < size; ++i) {
+	    slots[i].store(NULL, std::memory_order_relaxed);
+	}
+    }
+
+    const size_t mask;
+    std::atomic<KernelOverviewConnectorInfo*>* const slots;
+};
+
+/**
+ * Interned kernels of this process and the currently published hash table.
+ * The table is kept at most half full. Kernels and tables are published
+ * with release stores and probed with acquire loads, so looking up a name
+ * that is already interned never takes the lock. Only interning a new name
+ * does. Replaced tables are retired rather than freed since a concurrent
+ * probe may still be reading them; their total size is less than the size
+ * of the current table.
+ */
+static std::mutex domain_lock;
+static std::vector<KernelOverviewConnectorInfo*> domain_kernels;
+static std::atomic<KernelTable*> domain_table(new KernelTable(1024));
+static std::vector<KernelTable*> domain_retired_tables;
+
+static std::atomic<uint64_t> nextKernelID;
+static bool debug = false;
+
+static uint64_t getTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+static uint32_t hashName(const char* name, KernelExecutionType type)
+{
+    uint32_t hash = 2166136261u ^ static_cast<uint32_t>(type);
+    for (const char* c = name; *c != 0; ++c) {
+	hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Find the kernel with the given name and type in a table without locking.
+ * On a miss, the index of the empty slot ending the probe is returned in
+ * slot (if not NULL).
+ */
+static KernelOverviewConnectorInfo* findKernel(const KernelTable* table,
+					       const char* name, KernelExecutionType type,
+					       uint32_t hash, size_t* slot)
+{
+    size_t index = hash & table->mask;
+    KernelOverviewConnectorInfo* kernel;
+    while ((kernel = table->slots[index].load(std::memory_order_acquire)) != NULL) {
+	if (kernel->hash == hash && kernel->type == type && kernel->name == name) {
+	    return kernel;
+	}
+	index = (index + 1) & table->mask;
+    }
+    if (slot != NULL) {
+	*slot = index;
+    }
+    return NULL;
+}
+
+/** Find (or add) the interned kernel with the given name and type. */
+static KernelOverviewConnectorInfo* internKernel(const char* name, KernelExecutionType type)
+{
+    if (name == NULL) {
+	name = "";
+    }
+
+    /* Kernels are usually launched repeatedly from the same call site */
+    if (name == lastName && lastKernel != NULL && lastKernel->type == type &&
+	lastKernel->name == name) {
+	return lastKernel;
+    }
+
+    uint32_t hash = hashName(name, type);
+    KernelOverviewConnectorInfo* kernel =
+	findKernel(domain_table.load(std::memory_order_acquire), name, type, hash, NULL);
+
+    if (kernel == NULL) {
+	std::lock_guard<std::mutex> guard(domain_lock);
+
+	/* Probe again since another thread may have interned it meanwhile */
+	KernelTable* table = domain_table.load(std::memory_order_relaxed);
+	size_t index;
+	kernel = findKernel(table, name, type, hash, &index);
+
+	if (kernel == NULL) {
+	    kernel = new KernelOverviewConnectorInfo(name, type, hash);
+	    domain_kernels.push_back(kernel);
+
+	    if (2 * domain_kernels.size() > table->mask + 1) {
+		/* Publish a rehashed table once the current one is half full */
+		KernelTable* grown = new KernelTable(2 * (table->mask + 1));
+		for (size_t i = 0; i < domain_kernels.size(); ++i) {
+		    for (index = domain_kernels[i]->hash & grown->mask;
+			 grown->slots[index].load(std::memory_order_relaxed) != NULL;
+			 index = (index + 1) & grown->mask);
+		    grown->slots[index].store(domain_kernels[i], std::memory_order_relaxed);
+		}
+		domain_table.store(grown, std::memory_order_release);
+		domain_retired_tables.push_back(table);
+	    } else {
+		table->slots[index].store(kernel, std::memory_order_release);
+	    }
+	}
+    }
+
+    lastName = name;
+    lastKernel = kernel;
+    return kernel;
+}
+
+static void beginKernel(const char* name, KernelExecutionType type, uint64_t* kID)
+{
+    *kID = nextKernelID++;
+    if (activeKernelCount < MaxNestingDepth) {
+	ActiveKernel& active = activeKernels[activeKernelCount];
+	active.kID = *kID;
+	active.kernel = internKernel(name, type);
+	active.start = getTime();
+    }
+    ++activeKernelCount;
+}
+
+static void endKernel(const uint64_t kID)
+{
+    uint64_t stop = getTime();
+    if (activeKernelCount == 0) {
+	return;
+    }
+
+    /* Kernels normally end in the reverse order they were launched */
+    unsigned i = std::min(activeKernelCount, static_cast<unsigned>(MaxNestingDepth));
+    while (i > 0 && activeKernels[i - 1].kID != kID) {
+	--i;
+    }
+    if (i > 0) {
+	ActiveKernel& active = activeKernels[i - 1];
+	active.kernel->update(stop - active.start);
+	for (; i < std::min(activeKernelCount, static_cast<unsigned>(MaxNestingDepth)); ++i) {
+	    activeKernels[i - 1] = activeKernels[i];
+	}
+    }
+    --activeKernelCount;
+}
+
+/**
+ * Send the aggregated timings to the overview collector in blobs small
+ * enough for its encoding buffer, or print them to the standard error
+ * stream if the overview collector isn't loaded.
+ */
+static void sendKernels()
+{
+    SendKokkosData send =
+	reinterpret_cast<SendKokkosData>(dlsym(RTLD_DEFAULT, "overview_send_kokkos_data"));
+
+    std::lock_guard<std::mutex> guard(domain_lock);
+
+    if (send == NULL || debug) {
+	std::vector<KernelOverviewConnectorInfo*> sorted(domain_kernels);
+	std::sort(sorted.begin(), sorted.end(),
+		  [](const KernelOverviewConnectorInfo* lhs, const KernelOverviewConnectorInfo* rhs) {
+		      return lhs->total_time > rhs->total_time;
+		  });
+	static const char* const types[] = { "ParallelFor", "ParallelReduce", "ParallelScan", "Region" };
+	for (std::vector<KernelOverviewConnectorInfo*>::const_iterator
+		 i = sorted.begin(); i != sorted.end(); ++i) {
+	    if ((*i)->calls == 0) {
+		continue;
+	    }
+	    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
+	    << "KokkosP: " << types[(*i)->type] << "." << (*i)->name
+	    << " calls:" << (*i)->calls
+	    << " total:" << static_cast<double>((*i)->total_time) / 1000000000
+	    << " min:" << static_cast<double>((*i)->min_time) / 1000000000
+	    << " max:" << static_cast<double>((*i)->max_time) / 1000000000
+	    << std::endl;
+	}
+    }
+
+    if (send == NULL) {
+	return;
+    }
+
+    std::vector<CBTF_kokkos_kernel> kernels;
+    std::vector<char> names;
+    for (size_t i = 0; i <= domain_kernels.size(); ++i) {
+	if ((i == domain_kernels.size() && !kernels.empty()) ||
+	    (i < domain_kernels.size() &&
+	     (kernels.size() == MaxKernelsPerBlob ||
+	      names.size() + domain_kernels[i]->name.size() + 1 > MaxNamesPerBlob) &&
+	     !kernels.empty())) {
+	    CBTF_kokkos_data data;
+	    data.kernels.kernels_len = kernels.size();
+	    data.kernels.kernels_val = kernels.data();
+	    data.names.names_len = names.size();
+	    data.names.names_val = names.data();
+	    (*send)(&data);
+	    kernels.clear();
+	    names.clear();
+	}
+	if (i == domain_kernels.size()) {
+	    break;
+	}
+
+	const KernelOverviewConnectorInfo* kernel = domain_kernels[i];
+	if (kernel->calls == 0) {
+	    continue;
+	}
+
+	/* Truncate any name too long to fit in a blob by itself */
+	size_t length = std::min(kernel->name.size(), static_cast<size_t>(MaxNamesPerBlob - 1));
+
+	CBTF_kokkos_kernel entry;
+	entry.name = names.size();
+	entry.type = static_cast<CBTF_kokkos_type>(kernel->type);
+	entry.calls = kernel->calls;
+	entry.total_time = kernel->total_time;
+	entry.min_time = kernel->min_time;
+	entry.max_time = kernel->max_time;
+	kernels.push_back(entry);
+	names.insert(names.end(), kernel->name.begin(), kernel->name.begin() + length);
+	names.push_back(0);
+    }
+}
 
 extern "C" void kokkosp_init_library(const int loadSeq,
 	const uint64_t interfaceVer,
@@ -21,66 +292,69 @@ extern "C" void kokkosp_init_library(const int loadSeq,
 	void* deviceInfo) {
 
     nextKernelID = 0;
+    debug = (getenv("CBTF_DEBUG_COLLECTOR") != NULL);
+    if (debug) {
     std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
     << "KokkosP: Overview Connector sequence:" << loadSeq << " version:" << interfaceVer  << std::endl;
+    }
 
 }
 
 extern "C" void kokkosp_finalize_library() {
 
+    sendKernels();
+
+    if (debug) {
     std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
     << "KokkosP: Finalization of Overview Connector. Complete."  << std::endl;
+    }
 
 }
 
 extern "C" void kokkosp_begin_parallel_for(const char* name, const uint32_t devID, uint64_t* kID) {
-    *kID = nextKernelID++;
-    std::string nameStr(name);
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_begin_parallel_for: name:" << nameStr << " kID:" << *kID << " devID:" << devID << std::endl;
+    beginKernel(name, PARALLEL_FOR, kID);
 }
 
 extern "C" void kokkosp_end_parallel_for(const uint64_t kID) {
-    currentKernel = NULL;
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_end_parallel_for:  kID:" << kID << std::endl;
+    endKernel(kID);
 }
 
 extern "C" void kokkosp_begin_parallel_scan(const char* name, const uint32_t devID, uint64_t* kID) {
-    *kID = nextKernelID++;
-    std::string nameStr(name);
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_begin_parallel_scan: name:" << nameStr << " kID:" << *kID << " devID:" << devID << std::endl;
-
+    beginKernel(name, PARALLEL_SCAN, kID);
 }
 
 extern "C" void kokkosp_end_parallel_scan(const uint64_t kID) {
-    currentKernel = NULL;
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_end_parallel_scan:  kID:" << kID << std::endl;
+    endKernel(kID);
 }
 
 extern "C" void kokkosp_begin_parallel_reduce(const char* name, const uint32_t devID, uint64_t* kID) {
-    *kID = nextKernelID++;
-    std::string nameStr(name);
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_begin_parallel_reduce: name:" << nameStr << " kID:" << *kID << " devID:" << devID << std::endl;
+    beginKernel(name, PARALLEL_REDUCE, kID);
 }
 
 extern "C" void kokkosp_end_parallel_reduce(const uint64_t kID) {
-    currentKernel = NULL;
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_end_parallel_reduce:  kID:" << kID << std::endl;
+    endKernel(kID);
 }
 
 
 // REGIONS
 extern "C" void kokkosp_push_profile_region(char* regionName) {
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_push_profile_region: " << regionName << std::endl;
+    if (activeRegionCount < MaxNestingDepth) {
+	ActiveKernel& active = activeRegions[activeRegionCount];
+	active.kID = 0;
+	active.kernel = internKernel(regionName, PROFILE_REGION);
+	active.start = getTime();
+    }
+    ++activeRegionCount;
 }
 
 extern "C" void kokkosp_pop_profile_region() {
-    std::cerr << "[" << getpid() << "," << monitor_get_thread_num() << "] "
-    << "kokkosp_pop_profile_region" << std::endl;
+    uint64_t stop = getTime();
+    if (activeRegionCount == 0) {
+	return;
+    }
+    --activeRegionCount;
+    if (activeRegionCount < MaxNestingDepth) {
+	ActiveKernel& active = activeRegions[activeRegionCount];
+	active.kernel->update(stop - active.start);
+    }
 }
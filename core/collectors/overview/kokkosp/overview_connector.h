@@ -3,38 +3,56 @@
 #define _H_OVERVIEW_KOKKOS_CONNECTOR_INFO
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/time.h>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <string>
 
+/** Kinds of kernels and regions. Matches CBTF_kokkos_type. */
 enum KernelExecutionType {
 	PARALLEL_FOR = 0,
 	PARALLEL_REDUCE = 1,
-	PARALLEL_SCAN = 2
+	PARALLEL_SCAN = 2,
+	PROFILE_REGION = 3
 };
 
+/**
+ * Aggregated timings of one kernel (or profile region) name. The name is
+ * interned once per process and the timings of every launch are added to
+ * the same entry, so no per launch events are kept. Entries are never
+ * freed or moved once created, and are updated without taking a lock.
+ */
 class KernelOverviewConnectorInfo {
 	public:
-		KernelOverviewConnectorInfo(std::string kName, KernelExecutionType kernelType) {
-
-			char* domainName = (char*) malloc( sizeof(char*) * (32 + kName.size()) );
-
-			if(kernelType == PARALLEL_FOR) {
-				sprintf(domainName, "ParallelFor.%s", kName.c_str());
-			} else if(kernelType == PARALLEL_REDUCE) {
-				sprintf(domainName, "ParallelReduce.%s", kName.c_str());
-			} else if(kernelType == PARALLEL_SCAN) {
-				sprintf(domainName, "ParallelScan.%s", kName.c_str());
-			} else {
-				sprintf(domainName, "Kernel.%s", kName.c_str());
-			}
-
+		KernelOverviewConnectorInfo(const char* kName, KernelExecutionType kernelType, uint32_t kHash) :
+			name(kName), type(kernelType), hash(kHash),
+			calls(0), total_time(0), min_time(UINT64_MAX), max_time(0) {
 		}
 
 		~KernelOverviewConnectorInfo() {
 		}
 
-	private:
+		/** Add the time of one launch. */
+		void update(uint64_t time) {
+			calls.fetch_add(1, std::memory_order_relaxed);
+			total_time.fetch_add(time, std::memory_order_relaxed);
+			uint64_t current = min_time.load(std::memory_order_relaxed);
+			while (time < current &&
+			       !min_time.compare_exchange_weak(current, time, std::memory_order_relaxed));
+			current = max_time.load(std::memory_order_relaxed);
+			while (time > current &&
+			       !max_time.compare_exchange_weak(current, time, std::memory_order_relaxed));
+		}
+
+		const std::string name;
+		const KernelExecutionType type;
+		const uint32_t hash;
+		std::atomic<uint64_t> calls;
+		std::atomic<uint64_t> total_time;
+		std::atomic<uint64_t> min_time;
+		std::atomic<uint64_t> max_time;
 };
 
 #endif
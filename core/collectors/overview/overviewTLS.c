@@ -45,6 +45,7 @@
 #include "collector.h"
 #include "monitor.h"
 #include "overviewTLS.h"
+#include "OverviewRecord.h"
 
 /* FIXME: find include files for these externs. */
 extern bool cbtf_connected_to_mrnet();
@@ -670,85 +671,79 @@ void TLS_record_ompt_event(const CBTF_overview_omptp_event* event, uint64_t addr
     /** record event like omptp */
 }
 
-/*
- * Helper function to create a path.
- * TODO: Move this to services?
- */
-static int mkpath(char *dir, mode_t mode)
-{
-    struct stat sb;
-
-    if (!dir) {
-        errno = EINVAL;
-        return 1;
-    }
-
-    if (!stat(dir, &sb))
-        return 0;
-
-    mkpath(dirname(strdupa(dir)), mode);
-
-    return mkdir(dir, mode);
-}
+/* Maximum number of attempts to create the output directory. */
+#define MaxMkdirTries 16
 
 /*
- * Create a folder for csv files and setup csv for each thread.
+ * Get the directory containing the overview output of this process.
  */
-static void SetCSVFile(TLS* tls, const char* unique_id,
-			const char* suffix)
+static void GetDataDir(char* dir_path, size_t size, const char* exename)
 {
-    int fd;
-    char* cbtf_csvdata_dir = NULL;
-    char* user_name = NULL;
-    char dir_path[PATH_MAX] = {0};
+    char* cbtf_csvdata_dir = getenv("CBTF_CSVDATA_DIR");
+    char* user_name = getenv("USER");
     char cwd[PATH_MAX];
 
     if (getcwd(cwd, sizeof(cwd)) == NULL) {
-	sprintf(cwd, "%s", "/tmp");
+	snprintf(cwd, sizeof(cwd), "%s", "/tmp");
     }
-    
-
-    cbtf_csvdata_dir = getenv("CBTF_CSVDATA_DIR");
-    user_name = getenv("USER");
-    char *exename = basename(executable_path);
 
     // TODO: add jobid from any resource manager found.
     if (cbtf_csvdata_dir != NULL) {
-	sprintf(dir_path, "%s", cbtf_csvdata_dir);
+	snprintf(dir_path, size, "%s", cbtf_csvdata_dir);
     } else if (strcmp(cwd,"/tmp") == 0) {
-	sprintf(dir_path, "%s/%s/%s-csvdata",
+	snprintf(dir_path, size, "%s/%s/%s-csvdata",
 	    cwd, (user_name != NULL) ? user_name : "/unknownuser",exename);
     } else {
-	sprintf(dir_path, "%s/%s-csvdata",
+	snprintf(dir_path, size, "%s/%s-csvdata",
 	    cwd,exename);
     }
+}
 
-    if (tls->data_header.rank < 0) {
-	sprintf(dir_path, "%s/%s-%lu",
-	    dir_path, tls->data_header.host,tls->data_header.pid);
-    } else {
-	sprintf(dir_path, "%s/%s-%u",
-	    dir_path, tls->data_header.host,tls->data_header.rank);
+/*
+ * Insure the given directory exists.
+ */
+static void MakeDataDir(const char* dir_path)
+{
+    struct stat st;
+    if (stat(dir_path, &st) == 0 && S_ISDIR (st.st_mode)) {
+	if ( (getenv("CBTF_DEBUG_FILEIO_SERVICE") != NULL)) {
+	    fprintf(stderr,"MakeDataDir pathname %s exists and is a directory\n", dir_path);
+	}
+	return;
     }
 
-    {
-	sprintf(tls->csv_path,"");
-	if(tls->data_header.posix_tid == 0) {
-            if (tls->data_header.rank < 0) {
-		sprintf(tls->csv_path, "%s/%s-%lu", dir_path, exename, tls->data_header.pid);
-	    } else {
-		sprintf(tls->csv_path, "%s/%s-%u", dir_path, exename, tls->data_header.rank);
-	    }
-	} else {
-            if (tls->data_header.rank < 0) {
-		sprintf(tls->csv_path, "%s/%s-%lu-%u", dir_path, exename, tls->data_header.pid, tls->data_header.omp_tid);
-	    } else {
-		sprintf(tls->csv_path, "%s/%s-%u-%u", dir_path, exename, tls->data_header.rank, tls->data_header.omp_tid);
-	    }
-	}
+    /* The directory does not exist.
+     * Retry the mkdir a bounded number of times in case it fails
+     * for some reason. On a cluster running nvidia-nmi under the
+     * watch command (run command by default every 2 secs) the mkdir
+     * on an NFS directory was interupted.
+     */
+    int status = -1;
+    int save_errno = 0;
+    int try_count = 0;
+    while (status != 0 && try_count < MaxMkdirTries) {
+	status = CBTF_overview_mkpath(dir_path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	save_errno = errno;
+	try_count = try_count + 1;
+    }
+    if (status != 0 || (getenv("CBTF_DEBUG_FILEIO_SERVICE") != NULL)) {
+	fprintf(stderr,"MakeDataDir mkdir dir_path:%s status=%d errno:%d try_count:%d\n",
+	    dir_path, status, save_errno, try_count);
+    }
+}
+
+/*
+ * Create a folder for csv files and setup csv for each thread.
+ */
+static void SetCSVFile(TLS* tls, const CBTF_overview_record* record)
+{
+    char base[PATH_MAX];
+    char dir_path[PATH_MAX];
 
-	sprintf(tls->csv_path, "%s.%s", tls->csv_path, suffix);
-   }
+    GetDataDir(base, sizeof(base), record->executable);
+    CBTF_overview_record_csv_dir(record, base, dir_path, sizeof(dir_path));
+    CBTF_overview_record_csv_path(record, base,
+				  tls->csv_path, sizeof(tls->csv_path));
 
 #if !defined(NDEBUG)
     if (IsDebugEnabled) {
@@ -759,265 +754,183 @@ static void SetCSVFile(TLS* tls, const char* unique_id,
 #endif
 
     /* Insure the directory path to contain the file exists */
-    struct stat st;
-    if (stat(dir_path, &st) == 0 && S_ISDIR (st.st_mode)) {
-	if ( (getenv("CBTF_DEBUG_FILEIO_SERVICE") != NULL)) {
-	    fprintf(stderr,"SetCSVFile pathname %s exists and is a directory\n", dir_path);
-	}
-    } else {
-
-        /* The directory does not exist.
-	 * Try to make the directory in this section of code.
-	 * Use a while loop to test the status of mkdir in case
-	 * it fails for some reason. On a cluster running nvidia-nmi
-	 * under the watch command (run command by default every 2 secs)
-	 * the mkdir on an NFS directory was interupted.
-	 * TODO: if some threshold of trys is exceeded, abort.
-	 */
-        int status = -1;
-        int save_errno = 0;
-        int try_count = 0;
-        while (status != 0 ) {
-   	   status = mkpath(dir_path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-           save_errno = errno;
-           try_count = try_count + 1;
-        }
-	if ( (getenv("CBTF_DEBUG_FILEIO_SERVICE") != NULL)) {
-	    if (try_count > 0) {
-            fprintf(stderr,"SetCSVFile mkdir dir_path:%s status=%d errno:%d try_count:%d\n",
-		dir_path, status, save_errno, try_count);
-	    }
-        }
-    } 
-        
-    /* Insure the file itself exists */
-    fd = open(tls->csv_path, O_CREAT | O_APPEND,
-	      S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
-    if(fd >= 0)
-	close(fd);
+    MakeDataDir(dir_path);
 }
 
 /*
- * This function currectly prints debug to stderr and creates
- * a csv file per thread of execution.
+ * Append a record to the binary overview file shared by every process
+ * of the executable running on this node. Concurrent writers are
+ * serialized by a lock on the file so records are never interleaved.
  */
-void TLS_print_data(TLS* tls)
+static void WriteRecord(const CBTF_overview_record* record)
 {
-    bool print_to_stdout = getenv("CBTF_SHOW_CSVDATA") ? true : false;
-    /* Get our executable path */
-    if (executable_path == NULL) {
-        executable_path = strdup(CBTF_GetExecutablePath());
-    }
-    char *exename = basename(executable_path);
+    char base[PATH_MAX];
+    char path[PATH_MAX];
+    const char* buffer = (const char*)record;
+    size_t remaining = sizeof(CBTF_overview_record);
+    struct flock lock;
+    int fd;
 
-    /* header is created before mpi rank is known so fill it
-     * in here to make sure it is accurate
-     */
-    tls->data_header.rank = monitor_mpi_comm_rank();
+    GetDataDir(base, sizeof(base), record->executable);
+    snprintf(path, sizeof(path), "%s/%s-%s.overview",
+	     base, record->executable, record->host);
+    MakeDataDir(base);
 
-    SetCSVFile(tls, cbtf_collector_unique_id, "csv");
+    fd = open(path, O_WRONLY | O_CREAT | O_APPEND,
+	      S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+    if (fd < 0) {
+	fprintf(stderr,"[OVERVIEW %ld,%d] cannot open %s errno:%d\n",
+	    record->pid, record->omp_tid, path, errno);
+	return;
+    }
 
-    /* Open the file for writing */
-    FILE *csvfileptr = fopen(tls->csv_path, "a");
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &lock) == -1 && errno == EINTR);
 
-    // Provenance.
-    char provenance_csv_header[64] = {0};
-    char provenance_csv_values[1024] = {0};
-    strcat(provenance_csv_header,"host,pid,rank,tid,posix_tid,executable,total_time_seconds");
-    sprintf(provenance_csv_values, "%s,%ld,%d,%d,%ld,%s,%f",
-	tls->data_header.host, tls->data_header.pid,
-	tls->data_header.rank, tls->data_header.omp_tid,
-	tls->data_header.posix_tid, exename,
-	(float)tls->thread_ttime/1000000000
-	);
-    fprintf(csvfileptr,"%s\n",provenance_csv_header);
-    fprintf(csvfileptr,"%s\n",provenance_csv_values);
+    while (remaining > 0) {
+	ssize_t written = write(fd, buffer, remaining);
+	if (written < 0) {
+	    if (errno == EINTR)
+		continue;
+	    fprintf(stderr,"[OVERVIEW %ld,%d] cannot write %s errno:%d\n",
+		record->pid, record->omp_tid, path, errno);
+	    break;
+	}
+	buffer += written;
+	remaining -= written;
+    }
 
-    if (print_to_stdout) {
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, provenance_csv_header);
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, provenance_csv_values);
+    lock.l_type = F_UNLCK;
+    fcntl(fd, F_SETLK, &lock);
+    close(fd);
+
+#if !defined(NDEBUG)
+    if (IsDebugEnabled) {
+    fprintf(stderr,"[OVERVIEW %ld,%d] RECORD PATH %s\n",
+	record->pid, record->omp_tid, path);
     }
+#endif
+}
 
+/*
+ * Fill in the overview record of a thread from its thread-local storage.
+ */
+static void FillRecord(TLS* tls, CBTF_overview_record* record)
+{
+    memset(record, 0, sizeof(CBTF_overview_record));
+    record->magic = CBTF_OVERVIEW_RECORD_MAGIC;
+    record->version = CBTF_OVERVIEW_RECORD_VERSION;
+    record->size = sizeof(CBTF_overview_record);
+
+    // Provenance.
+    strncpy(record->host, tls->data_header.host, sizeof(record->host) - 1);
+    strncpy(record->executable, basename(executable_path),
+	    sizeof(record->executable) - 1);
+    record->pid = tls->data_header.pid;
+    record->posix_tid = tls->data_header.posix_tid;
+    record->rank = tls->data_header.rank;
+    record->omp_tid = tls->data_header.omp_tid;
+    record->thread_time = tls->thread_ttime;
 
     // Rusage.
-    char rusage_csv_header[48] = {0};
-    char rusage_csv_values[128] = {0};
-    strcat(rusage_csv_header,"maxrss_kB,utime_seconds,stime_seconds");
     overview_rusage_t ov_rusage = get_usage();
-    sprintf(rusage_csv_values, "%ld,%lu.%06u,%lu.%06u",
-	ov_rusage.ru_maxrss,
-        ov_rusage.ru_utime.tv_sec,
-	(unsigned int) ov_rusage.ru_utime.tv_usec,
-	ov_rusage.ru_stime.tv_sec,
-	(unsigned int) ov_rusage.ru_stime.tv_usec);
-    fprintf(csvfileptr,"%s\n",rusage_csv_header);
-    fprintf(csvfileptr,"%s\n",rusage_csv_values);
-
-    if (print_to_stdout) {
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, rusage_csv_header);
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, rusage_csv_values);
-    }
+    record->maxrss = ov_rusage.ru_maxrss;
+    record->utime_sec = ov_rusage.ru_utime.tv_sec;
+    record->utime_usec = ov_rusage.ru_utime.tv_usec;
+    record->stime_sec = ov_rusage.ru_stime.tv_sec;
+    record->stime_usec = ov_rusage.ru_stime.tv_usec;
 
     // PAPI_dmem.
-    char papi_dmem_csv_header[80] = {0};
-    char papi_dmem_csv_values[128] = {0};
-    strcat(papi_dmem_csv_header,"dmem_size_kB,dmem_resident_kB,dmem_high_water_mark_kB,dmem_shared_kB,dmem_heap_kB");
     overview_papi_dmem_t ov_dmem = get_papi_dmem_info();
-    sprintf(papi_dmem_csv_values, "%lld,%lld,%lld,%lld,%lld",
-	ov_dmem.size, ov_dmem.resident, ov_dmem.high_water_mark, ov_dmem.shared, ov_dmem.heap);
-    fprintf(csvfileptr,"%s\n",papi_dmem_csv_header);
-    fprintf(csvfileptr,"%s\n",papi_dmem_csv_values);
-
-    if (print_to_stdout) {
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, papi_dmem_csv_header);
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, papi_dmem_csv_values);
-    }
+    record->dmem_size = ov_dmem.size;
+    record->dmem_resident = ov_dmem.resident;
+    record->dmem_high_water_mark = ov_dmem.high_water_mark;
+    record->dmem_shared = ov_dmem.shared;
+    record->dmem_heap = ov_dmem.heap;
 
     // POSIX IO
-    if (tls->total_posixio_time > 0) {
-	char posixio_csv_header[64] = {0};
-	char posixio_csv_values[64] = {0};
-	strcat(posixio_csv_header,"io_total_time_seconds,read_time_seconds,write_time_seconds,read_bytes,write_bytes");
-	sprintf(posixio_csv_values, "%f,%f,%f,%ld,%ld",
-	    (tls->total_posixio_time > 0)?(float)tls->total_posixio_time/1000000000:0,
-	    (tls->total_posixio_read_time > 0)?(float)tls->total_posixio_read_time/1000000000:0,
-	    (tls->total_posixio_write_time > 0)?(float)tls->total_posixio_write_time/1000000000:0,
-	    tls->total_posixio_bytes_read,
-	    tls->total_posixio_bytes_written
-	);
-	fprintf(csvfileptr,"%s\n",posixio_csv_header);
-	fprintf(csvfileptr,"%s\n",posixio_csv_values);
-
-	if (print_to_stdout) {
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, posixio_csv_header);
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, posixio_csv_values);
-	}
-    }
+    record->posixio_time = tls->total_posixio_time;
+    record->posixio_read_time = tls->total_posixio_read_time;
+    record->posixio_write_time = tls->total_posixio_write_time;
+    record->posixio_bytes_read = tls->total_posixio_bytes_read;
+    record->posixio_bytes_written = tls->total_posixio_bytes_written;
 
     // MEM
-    if (tls->mem_data.total_allocation_calls > 0) {
-	char mem_alloc_csv_header[64] = {0};
-	char mem_alloc_csv_values[64] = {0};
-	strcat(mem_alloc_csv_header,"allocation_time_seconds,allocation_calls,allocation_bytes");
-	sprintf(mem_alloc_csv_values, "%f,%ld,%ld",
-		(tls->mem_data.total_allocation_time > 0)?(float)tls->mem_data.total_allocation_time/1000000000:0,
-		(tls->mem_data.total_allocation_calls > 0)?tls->mem_data.total_allocation_calls:0,
-		(tls->mem_data.total_bytes_allocated > 0)?tls->mem_data.total_bytes_allocated:0);
-	fprintf(csvfileptr,"%s\n",mem_alloc_csv_header);
-	fprintf(csvfileptr,"%s\n",mem_alloc_csv_values);
-
-	if (print_to_stdout) {
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid,
-	mem_alloc_csv_header);
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid,
-	mem_alloc_csv_values);
-	}
-    }
-
-    if (tls->mem_data.total_free_calls > 0) {
-	char mem_free_csv_header[64] = {0};
-	char mem_free_csv_values[64] = {0};
-	strcat(mem_free_csv_header,"free_time_seconds,free_calls");
-	sprintf(mem_free_csv_values, "%f,%ld",
-		(tls->mem_data.total_free_time > 0)?(float)tls->mem_data.total_free_time/1000000000:0,
-		(tls->mem_data.total_free_calls > 0)?tls->mem_data.total_free_calls:0);
-	fprintf(csvfileptr,"%s\n",mem_free_csv_header);
-	fprintf(csvfileptr,"%s\n",mem_free_csv_values);
-
-	if (print_to_stdout) {
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, mem_free_csv_header);
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, mem_free_csv_values);
-	}
-
-    }
+    record->allocation_time = tls->mem_data.total_allocation_time;
+    record->allocation_calls = tls->mem_data.total_allocation_calls;
+    record->allocation_bytes = tls->mem_data.total_bytes_allocated;
+    record->free_time = tls->mem_data.total_free_time;
+    record->free_calls = tls->mem_data.total_free_calls;
 
     // MPI: TODO: handle all calls seen.
-    if (tls->total_mpi_time > 0) {
-	char mpi_csv_header[64] = {0};
-	char mpi_csv_values[64] = {0};
-	strcat(mpi_csv_header,"total_mpi_time_seconds");
-	sprintf(mpi_csv_values, "%f",
-	    (tls->total_mpi_time > 0)?(float)tls->total_mpi_time/1000000000:0);
-
-	fprintf(csvfileptr,"%s\n",mpi_csv_header);
-	fprintf(csvfileptr,"%s\n",mpi_csv_values);
-
-	if (print_to_stdout) {
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, mpi_csv_header);
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, mpi_csv_values);
-	}
-    }
+    record->mpi_time = tls->total_mpi_time;
+
+    // OMPT
+    record->itask_time = tls->itask_ttime;
+    record->serial_time = tls->serial_ttime;
+    record->barrier_time = tls->barrier_ttime;
+    record->wait_barrier_time = tls->wbarrier_ttime;
+    record->idle_time = tls->idle_ttime;
 
     // PAPI
-    char evName[256];
-    char papi_csv_header[8192] = {0};
-    char papi_csv_values[4096] = {0};
-    int pNumEvents = PAPI_num_events(tls->EventSet);
+    int pNumEvents = MAX_PAPI_EVENTS;
     int PAPI_events[MAX_PAPI_EVENTS];
-    int rval = PAPI_list_events(tls->EventSet, PAPI_events, &pNumEvents);
     int i;
-    for (i = 0; i < pNumEvents; i++) {
+    if (PAPI_list_events(tls->EventSet, PAPI_events, &pNumEvents) != PAPI_OK) {
+	pNumEvents = 0;
+    }
+    for (i = 0; i < pNumEvents && i < CBTF_OVERVIEW_RECORD_MAX_EVENTS; i++) {
+	char* evName = record->event_names[record->num_events];
 	if (!PAPI_event_code_to_name(PAPI_events[i], evName)) {
-
-	    strcat(papi_csv_header,evName);
-	    char str[20];
-	    sprintf(str, "%lld", tls->evalues[i]);
-	    strcat(papi_csv_values,str);
-
-	    if (i < pNumEvents-1) {
-		strcat(papi_csv_header,",");
-		strcat(papi_csv_values,",");
-	    }
+	    record->event_values[record->num_events++] = tls->evalues[i];
 	}
     }
+}
 
-    fprintf(csvfileptr,"%s\n",papi_csv_header);
-    fprintf(csvfileptr,"%s\n",papi_csv_values);
+/*
+ * This function currectly prints debug to stderr and creates
+ * a csv file per thread of execution. If CBTF_OVERVIEW_BINARY is
+ * set, a binary record is appended to a file per node instead.
+ * Those records are converted to the same csv files offline by
+ * the cbtf-overview-csv tool.
+ */
+void TLS_print_data(TLS* tls)
+{
+    CBTF_overview_record record;
+    bool print_to_stdout = getenv("CBTF_SHOW_CSVDATA") ? true : false;
+    bool print_binary = getenv("CBTF_OVERVIEW_BINARY") ? true : false;
 
-    if (print_to_stdout) {
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, papi_csv_header);
-    fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, papi_csv_values);
+    /* Get our executable path */
+    if (executable_path == NULL) {
+        executable_path = strdup(CBTF_GetExecutablePath());
     }
 
-    // OMPT
-    if (tls->itask_ttime > 0) {
-	char ompt_csv_header[128] = {0};
-	char ompt_csv_values[128] = {0};
-	strcat(ompt_csv_header,"implicit_task_time_seconds,serial_time_seconds,barrier_time_seconds,wait_barrier_time_seconds,idle_time_seconds");
-	sprintf(ompt_csv_values, "%f,%f,%f,%f,%f",
-            (float)tls->itask_ttime/1000000000,
-            (float)tls->serial_ttime/1000000000,
-            (float)tls->barrier_ttime/1000000000,
-            (float)tls->wbarrier_ttime/1000000000,
-            (float)tls->idle_ttime/1000000000);
-
-	fprintf(csvfileptr,"%s\n",ompt_csv_header);
-	fprintf(csvfileptr,"%s\n",ompt_csv_values);
-
-        if (print_to_stdout) {
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, ompt_csv_header);
-	fprintf(stdout,"[%ld,%d] %s\n",
-	tls->data_header.pid, tls->data_header.omp_tid, ompt_csv_values);
+    /* header is created before mpi rank is known so fill it
+     * in here to make sure it is accurate
+     */
+    tls->data_header.rank = monitor_mpi_comm_rank();
+
+    FillRecord(tls, &record);
+
+    if (print_binary) {
+	WriteRecord(&record);
+    } else {
+	SetCSVFile(tls, &record);
+
+	/* Open the file for writing */
+	FILE *csvfileptr = fopen(tls->csv_path, "a");
+	if (csvfileptr != NULL) {
+	    CBTF_overview_record_print_csv(csvfileptr, NULL, &record);
+	    fclose(csvfileptr);
 	}
     }
 
-    /* Close the file */
-    fclose(csvfileptr);
+    if (print_to_stdout) {
+	char prefix[64];
+	snprintf(prefix, sizeof(prefix), "[%ld,%d] ",
+	    tls->data_header.pid, tls->data_header.omp_tid);
+	CBTF_overview_record_print_csv(stdout, prefix, &record);
+    }
 }
@@ -76,6 +76,7 @@ typedef struct {
 
 
     bool defer_sampling;
+    bool use_perf_events;  /**< Sampling with perf events instead of a timer. */
 } TLS;
 
 /* debug flags */
@@ -258,35 +259,17 @@ static void send_samples (TLS* tls)
 
 
 /**
- * Timer event handler.
+ * Record a sample.
  *
- * Called by the timer handler each time a sample is to be taken. Extracts the
- * program counter (PC) address from the signal context and places it into the
- * sample buffer. When the sample buffer is full, it is sent to the framework
- * for storage in the experiment's database.
+ * Places the sampled program counter (PC) address into the sample buffer.
+ * When the sample buffer is full, it is sent to the framework for storage
+ * in the experiment's database.
  *
- * @note    
- * 
- * @param context    Thread context at timer interrupt.
+ * @param tls    Thread-local storage of the sampled thread.
+ * @param pc     Sampled PC address.
  */
-static void serviceTimerHandler(const ucontext_t* context)
+static void record_sample(TLS* tls, uint64_t pc)
 {
-    /* Access our thread-local storage */
-#ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
-#else
-    TLS* tls = &the_tls;
-#endif
-    Assert(tls != NULL);
-
-    if(tls->defer_sampling == true) {
-        return;
-    }
- 
-    /* Obtain the program counter (PC) address from the thread context */
-    uint64_t pc = CBTF_GetPCFromContext(context);
-
-
 #if defined (HAVE_OMPT)
     /* these are ompt specific.*/
     if (tls->thread_idle) {
@@ -325,6 +308,71 @@ static void serviceTimerHandler(const ucontext_t* context)
     }
 }
 
+
+/**
+ * Timer event handler.
+ *
+ * Called by the timer handler each time a sample is to be taken. Extracts the
+ * program counter (PC) address from the signal context and records it.
+ *
+ * @note    
+ * 
+ * @param context    Thread context at timer interrupt.
+ */
+static void serviceTimerHandler(const ucontext_t* context)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    Assert(tls != NULL);
+
+    if(tls->defer_sampling == true) {
+        return;
+    }
+
+    /* Send the samples taken at the old rate if the timer adapted its rate */
+    uint64_t interval = CBTF_GetTimerInterval();
+    if (interval != tls->data.effective_interval) {
+	if (tls->buffer.length > 0) {
+	    send_samples(tls);
+	}
+	tls->data.effective_interval = interval;
+    }
+
+    /* Obtain the program counter (PC) address from the thread context */
+    record_sample(tls, CBTF_GetPCFromContext(context));
+}
+
+
+/**
+ * Perf event handler.
+ *
+ * Called for each sample drained from this thread's perf event ring buffer.
+ * The kernel captured the PC address, which is the first frame.
+ *
+ * @param framecount    Number of frames in the sample.
+ * @param frames        Frames of the sample.
+ */
+static void servicePerfEventHandler(unsigned framecount, const uint64_t* frames)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    Assert(tls != NULL);
+
+    if(tls->defer_sampling == true) {
+        return;
+    }
+
+    record_sample(tls, frames[0]);
+}
+
 void collector_record_addr(char* name, uint64_t addr)
 {
     /* Access our thread-local storage */
@@ -385,6 +433,7 @@ void cbtf_collector_start(const CBTF_DataHeader* header)
 
     tls->data.interval = 
 	(uint64_t)(1000000000) / (uint64_t)(args.sampling_rate);
+    tls->data.effective_interval = tls->data.interval;
     tls->data.pc.pc_val = tls->buffer.pc;
     tls->data.count.count_val = tls->buffer.count;
 
@@ -415,8 +464,12 @@ void cbtf_collector_start(const CBTF_DataHeader* header)
     }
 #endif
 
-    /* Begin sampling */
-    CBTF_Timer(tls->data.interval, serviceTimerHandler);
+    /* Begin sampling. Use perf events if requested and available. */
+    tls->use_perf_events =
+	CBTF_PerfEventTimer(tls->data.interval, false, servicePerfEventHandler);
+    if (!tls->use_perf_events) {
+	CBTF_Timer(tls->data.interval, serviceTimerHandler);
+    }
 }
 
 
@@ -443,7 +496,13 @@ void cbtf_collector_pause()
     // real time signals (SIGRTMIN or SIGRTMIN+N) as well and
     // likely default to the posix based timer.
     // fixes issues seen with omnipath based mpi connects.
-    CBTF_BlockTimerSignal();
+    if (tls->use_perf_events) {
+	// keep the samples taken before the pause.
+	CBTF_PerfEventEnable(false);
+	CBTF_PerfEventDrain();
+    } else {
+	CBTF_BlockTimerSignal();
+    }
     tls->defer_sampling=true;
 }
 
@@ -471,8 +530,12 @@ void cbtf_collector_resume()
     // real time signals (SIGRTMIN or SIGRTMIN+N) as well and
     // likely default to the posix based timer.
     // fixes issues seen with omnipath based mpi connects.
-    CBTF_UnBlockTimerSignal();
     tls->defer_sampling=false;
+    if (tls->use_perf_events) {
+	CBTF_PerfEventEnable(true);
+    } else {
+	CBTF_UnBlockTimerSignal();
+    }
 }
 
 
@@ -513,8 +576,12 @@ void cbtf_collector_stop()
     }
 #endif
 
-    /* Stop sampling */
-    CBTF_Timer(0, NULL);
+    /* Stop sampling. (perf events drain any remaining samples) */
+    if (tls->use_perf_events) {
+	CBTF_PerfEventTimer(0, false, NULL);
+    } else {
+	CBTF_Timer(0, NULL);
+    }
 
     tls->header.time_end = CBTF_GetTime();
 
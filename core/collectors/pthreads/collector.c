@@ -85,6 +85,18 @@ const unsigned OverheadFrameCount = 2;
 /** FIXME: VERIFY: CBTF_pthreadt_event is 32 bytes */
 #define EventBufferSize (CBTF_BlobSizeFactor * 415)
 
+/** Number of (mutex, call site) pairs in the lock contention table. */
+#define LockStatsSize (CBTF_BlobSizeFactor * 32)
+
+/** Number of entries in the lock contention table's hash table. */
+#define LockStatsHashSize (2 * LockStatsSize)
+
+/** Maximum number of mutexes tracked as held by a thread at one time. */
+#define MaxHeldLocks 16
+
+/** Flag indicating if only lock contention statistics are collected. */
+static bool_t contention_only = FALSE;
+
 /** Type defining the items stored in thread-local storage. */
 typedef struct {
 
@@ -100,6 +112,32 @@ typedef struct {
         CBTF_pthreadt_event events[EventBufferSize]; /**< Pthread call events. */
     } buffer;
 
+    CBTF_pthreads_contention_data contention;  /**< Lock contention blob. */
+
+    /**
+     * Contention statistics of each (mutex, call site) pair. The stack traces
+     * of the call sites are kept in the tracing buffer above, which is
+     * otherwise unused in this mode.
+     */
+    struct {
+	CBTF_pthreads_lock_stats locks[LockStatsSize]; /**< Lock statistics. */
+	uint32_t hashes[LockStatsSize];        /**< Hash of each lock's key. */
+	uint16_t hash_table[LockStatsHashSize]; /**< Lock index plus one. */
+    } lockbuf;
+
+    /**
+     * Mutexes currently held by this thread, most recently acquired last.
+     * Each keeps a copy of its acquiring call site so that its hold time
+     * can be credited even if the statistics were sent while it was held.
+     */
+    struct {
+	uint64_t mutex;            /**< Address of the mutex. */
+	uint64_t time;             /**< Time the mutex was acquired. */
+	unsigned stacktrace_size;  /**< Number of frames in the call site. */
+	uint64_t stacktrace[MaxFramesPerStackTrace]; /**< Call site. */
+    } held[MaxHeldLocks];
+    unsigned held_count;  /**< Number of mutexes currently held. */
+
 #if defined (CBTF_SERVICE_USE_OFFLINE)
     char CBTF_pthreads_traced[PATH_MAX];
 #endif
@@ -117,6 +155,18 @@ typedef struct {
 static const uint32_t TLSKey = 0x00001EFE ;
 int pthreads_init_tls_done = 0;
 
+/** Slot assigned to our key by the TLS service. */
+static uint32_t TLSSlot = 0;
+
+/**
+ * Register our key with the TLS service upon loading so that every access
+ * to our thread-local storage is a direct slot lookup rather than a search.
+ */
+static void __attribute__ ((constructor)) register_tls_slot()
+{
+    TLSSlot = CBTF_RegisterTLS(TLSKey);
+}
+
 #else
 
 /** Thread-local storage. */
@@ -127,7 +177,7 @@ static __thread TLS the_tls;
 void defer_trace(int defer_tracing) {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -247,6 +297,278 @@ static void send_samples(TLS *tls)
     initialize_data(tls);
 }
 
+/**
+ * Initialize the lock contention statistics contained within the given
+ * thread-local storage, along with the stack traces of their call sites.
+ *
+ * @param tls    Thread-local storage to be initialized.
+ */
+static void initialize_contention(TLS* tls)
+{
+    Assert(tls != NULL);
+
+    initialize_data(tls);
+
+    tls->contention.stacktraces.stacktraces_val = tls->buffer.stacktraces;
+    tls->contention.stacktraces.stacktraces_len = 0;
+    tls->contention.locks.locks_val = tls->lockbuf.locks;
+    tls->contention.locks.locks_len = 0;
+    memset(tls->lockbuf.hash_table, 0, sizeof(tls->lockbuf.hash_table));
+}
+
+
+
+/**
+ * Send the lock contention statistics.
+ *
+ * Sends the lock contention statistics to the framework under their own data
+ * header identifier. Then resets the statistics to the empty state. Mutexes
+ * that are currently held remain held.
+ *
+ * @param tls    Thread-local storage containing the statistics.
+ */
+static void send_contention(TLS* tls)
+{
+    int saved_do_trace = tls->do_trace;
+    tls->do_trace = 0;
+
+    tls->header.id = strdup("pthreadlocks");
+    tls->header.time_end = CBTF_GetTime();
+    tls->header.rank = monitor_mpi_comm_rank();
+
+#ifndef NDEBUG
+    if (getenv("CBTF_DEBUG_COLLECTOR") != NULL) {
+	fprintf(stderr, "pthread send_contention: stacktraces_len(%d) locks_len(%d)\n",
+		tls->contention.stacktraces.stacktraces_len,
+		tls->contention.locks.locks_len);
+    }
+#endif
+
+    cbtf_collector_send(&(tls->header), (xdrproc_t)xdr_CBTF_pthreads_contention_data, &(tls->contention));
+    free(tls->header.id);
+    tls->header.id = NULL;
+
+    initialize_contention(tls);
+    tls->do_trace = saved_do_trace;
+}
+
+
+
+/**
+ * Get the lock contention statistics of a mutex.
+ *
+ * Returns the statistics of the specified mutex as acquired from the specified
+ * call site, adding them (and the call site's stack trace) if this is the first
+ * time the pair is seen. The statistics are sent first when there is no room
+ * for a new pair.
+ *
+ * @param tls                Thread-local storage containing the statistics.
+ * @param mutex              Address of the mutex.
+ * @param stacktrace         Stack trace of the call site.
+ * @param stacktrace_size    Number of frames in the stack trace.
+ * @return                   Statistics of this mutex and call site.
+ */
+static CBTF_pthreads_lock_stats* get_lock_stats(TLS* tls, uint64_t mutex,
+						const uint64_t* stacktrace,
+						unsigned stacktrace_size)
+{
+    CBTF_pthreads_lock_stats* lock = NULL;
+    uint32_t hash = 2166136261u;
+    unsigned index, i;
+
+    /* Find (or add) the statistics for this mutex and call site */
+    hash = (hash ^ (uint32_t)(mutex ^ (mutex >> 32))) * 16777619u;
+    for(i = 0; i < stacktrace_size; ++i)
+	hash = (hash ^ (uint32_t)(stacktrace[i] ^ (stacktrace[i] >> 32))) *
+	    16777619u;
+    index = hash % LockStatsHashSize;
+    while(tls->lockbuf.hash_table[index] != 0) {
+	unsigned l = tls->lockbuf.hash_table[index] - 1;
+	if((tls->lockbuf.hashes[l] == hash) &&
+	   (tls->lockbuf.locks[l].mutex == mutex)) {
+	    lock = &tls->lockbuf.locks[l];
+	    for(i = 0; i < stacktrace_size; ++i)
+		if(tls->buffer.stacktraces[lock->stacktrace + i] != stacktrace[i])
+		    break;
+	    if((i == stacktrace_size) &&
+	       (tls->buffer.stacktraces[lock->stacktrace + i] == 0))
+		return lock;
+	}
+	index = (index + 1) % LockStatsHashSize;
+    }
+
+    if((tls->contention.locks.locks_len == LockStatsSize) ||
+       ((tls->contention.stacktraces.stacktraces_len + stacktrace_size + 1) >=
+	StackTraceBufferSize)) {
+	send_contention(tls);
+	index = hash % LockStatsHashSize;
+    }
+    lock = &tls->lockbuf.locks[tls->contention.locks.locks_len];
+    memset(lock, 0, sizeof(CBTF_pthreads_lock_stats));
+    lock->mutex = mutex;
+    lock->stacktrace = tls->contention.stacktraces.stacktraces_len;
+    for(i = 0; i < stacktrace_size; ++i) {
+	tls->buffer.stacktraces[lock->stacktrace + i] = stacktrace[i];
+	if(stacktrace[i] < tls->header.addr_begin)
+	    tls->header.addr_begin = stacktrace[i];
+	if(!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	   stacktrace[i] > tls->header.addr_end)
+	    tls->header.addr_end = stacktrace[i];
+    }
+    tls->buffer.stacktraces[lock->stacktrace + stacktrace_size] = 0;
+    tls->contention.stacktraces.stacktraces_len += (stacktrace_size + 1);
+    tls->lockbuf.hashes[tls->contention.locks.locks_len] = hash;
+    tls->lockbuf.hash_table[index] = ++tls->contention.locks.locks_len;
+    return lock;
+}
+
+
+
+/**
+ * Acquire a mutex.
+ *
+ * Adds the specified mutex to the mutexes held by this thread. Mutexes beyond
+ * the first MaxHeldLocks held at one time aren't tracked.
+ *
+ * @param tls                Thread-local storage of this thread.
+ * @param mutex              Address of the mutex.
+ * @param time               Time the mutex was acquired.
+ * @param stacktrace         Stack trace of the acquiring call site.
+ * @param stacktrace_size    Number of frames in the stack trace.
+ */
+static void acquire_lock(TLS* tls, uint64_t mutex, uint64_t time,
+			 const uint64_t* stacktrace, unsigned stacktrace_size)
+{
+    if(tls->held_count == MaxHeldLocks)
+	return;
+    tls->held[tls->held_count].mutex = mutex;
+    tls->held[tls->held_count].time = time;
+    tls->held[tls->held_count].stacktrace_size = stacktrace_size;
+    memcpy(tls->held[tls->held_count].stacktrace, stacktrace,
+	   stacktrace_size * sizeof(uint64_t));
+    tls->held_count++;
+}
+
+
+
+/**
+ * Release a mutex.
+ *
+ * Removes the most recently acquired instance of the specified mutex from the
+ * mutexes held by this thread, and credits the time it was held to the call
+ * site that acquired it. Mutexes that aren't tracked as held are ignored.
+ *
+ * @param tls      Thread-local storage of this thread.
+ * @param mutex    Address of the mutex.
+ * @param time     Time the mutex was released.
+ * @return         Index of the released mutex in the held mutexes or
+ *                 MaxHeldLocks if it wasn't held.
+ */
+static unsigned release_lock(TLS* tls, uint64_t mutex, uint64_t time)
+{
+    CBTF_pthreads_lock_stats* lock = NULL;
+    uint64_t hold = 0;
+    unsigned h = tls->held_count;
+
+    while((h > 0) && (tls->held[h - 1].mutex != mutex))
+	--h;
+    if(h == 0)
+	return MaxHeldLocks;
+    --h;
+
+    hold = (time > tls->held[h].time) ? (time - tls->held[h].time) : 0;
+    lock = get_lock_stats(tls, mutex, tls->held[h].stacktrace,
+			  tls->held[h].stacktrace_size);
+    lock->hold_time += hold;
+    if(hold > lock->max_hold_time)
+	lock->max_hold_time = hold;
+    return h;
+}
+
+
+
+/**
+ * Update the lock contention statistics.
+ *
+ * Adds the specified event to the statistics of the mutex it operates on.
+ * Lock and trylock calls credit their wait time to the acquiring call site
+ * and begin a hold. Unlock calls end the hold and credit its time to the call
+ * site that acquired the mutex. Condition waits end the hold of their mutex
+ * on entry and begin a new one on return, since the mutex is released while
+ * waiting; the time spent waiting on the condition isn't lock contention.
+ * Only lock and trylock calls need a stack trace.
+ *
+ * @param tls         Thread-local storage containing the statistics.
+ * @param event       Event to be added.
+ * @param function    Address of the Pthread function for which the event is
+ *                    being recorded.
+ */
+static void update_contention(TLS* tls, const CBTF_pthreadt_event* event,
+			      uint64_t function)
+{
+    CBTF_pthreads_lock_stats* lock = NULL;
+    uint64_t stacktrace[MaxFramesPerStackTrace];
+    unsigned stacktrace_size = 0;
+    uint64_t wait = event->stop_time - event->start_time, time;
+    unsigned bucket = 0, h;
+
+    switch(event->pthread_type) {
+
+    case CBTF_PTHREAD_MUTEX_LOCK:
+    case CBTF_PTHREAD_MUTEX_TRYLOCK:
+	++tls->nesting_depth;
+	CBTF_GetStackTraceFromContext(NULL, FALSE, OverheadFrameCount,
+				      MaxFramesPerStackTrace,
+				      &stacktrace_size, stacktrace);
+	--tls->nesting_depth;
+	if(stacktrace_size > 0)
+	    stacktrace[0] = function;
+
+	lock = get_lock_stats(tls, event->ptr1, stacktrace, stacktrace_size);
+	if(event->retval != 0) {
+	    if(event->pthread_type == CBTF_PTHREAD_MUTEX_TRYLOCK)
+		lock->failed_trylocks++;
+	    break;
+	}
+
+	lock->acquisitions++;
+	lock->wait_time += wait;
+	if(wait > lock->max_wait_time)
+	    lock->max_wait_time = wait;
+	for(time = wait / 1000;
+	    (time > 0) && (bucket < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE - 1);
+	    time >>= 1)
+	    ++bucket;
+	lock->histogram[bucket]++;
+
+	acquire_lock(tls, event->ptr1, event->stop_time,
+		     stacktrace, stacktrace_size);
+	break;
+
+    case CBTF_PTHREAD_MUTEX_UNLOCK:
+	h = release_lock(tls, event->ptr1, event->start_time);
+	if(h < MaxHeldLocks) {
+	    memmove(&tls->held[h], &tls->held[h + 1],
+		    (tls->held_count - h - 1) * sizeof(tls->held[0]));
+	    tls->held_count--;
+	}
+	break;
+
+    case CBTF_PTHREAD_COND_WAIT:
+    case CBTF_PTHREAD_COND_TIMEDWAIT:
+	h = release_lock(tls, event->ptr2, event->start_time);
+	if(h < MaxHeldLocks)
+	    tls->held[h].time = event->stop_time;
+	break;
+
+    default:
+	break;
+
+    }
+}
+
+
+
 /**
  * Start an event.
  *
@@ -262,7 +584,7 @@ int pthreads_start_event(CBTF_pthreadt_event* event)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -304,7 +626,7 @@ void pthreads_record_event(const CBTF_pthreadt_event* event, uint64_t function)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -338,6 +660,13 @@ fprintf(stderr,"ENTERED pthreads_record_event, sizeof event=%d, sizeof stacktrac
 #endif
 	return;
     }
+
+    /* Only the lock contention statistics are needed in this mode */
+    if(contention_only) {
+	update_contention(tls, event, function);
+	tls->do_trace = saved_do_trace;
+	return;
+    }
     
     ++tls->nesting_depth;
     /* Obtain the stack trace from the current thread context */
@@ -408,7 +737,8 @@ fprintf(stderr,"StackTraceBufferSize is full, call send_samples\n");
 	    /* Update the address interval in the data blob's header */
 	    if(stacktrace[i] < tls->header.addr_begin)
 		tls->header.addr_begin = stacktrace[i];
-	    if(stacktrace[i] > tls->header.addr_end)
+	    if(!CBTF_IsFrameRepeat(stacktrace[i]) &&
+	       stacktrace[i] > tls->header.addr_end)
 		tls->header.addr_end = stacktrace[i];
 	    
 	}
@@ -462,7 +792,7 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
     // we are not yet ready to start our collector.
     TLS* tls = malloc(sizeof(TLS));
     Assert(tls != NULL);
-    CBTF_SetTLS(TLSKey, tls);
+    CBTF_SetTLSSlot(TLSSlot, tls);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -501,8 +831,15 @@ void cbtf_collector_start(const CBTF_DataHeader* const header)
 
     memcpy(&tls->header, header, sizeof(CBTF_DataHeader));
 
+    /*
+     * If CBTF_PTHREAD_CONTENTION is set, replace event tracing with per mutex
+     * and call site wait and hold times. No events are collected.
+     */
+    contention_only = (getenv("CBTF_PTHREAD_CONTENTION") != NULL);
+
     /* Initialize the actual data blob */
-    initialize_data(tls);
+    initialize_contention(tls);
+    tls->held_count = 0;
 
     /* Initialize the IO function wrapper nesting depth */
     tls->nesting_depth = 0;
@@ -520,7 +857,7 @@ void cbtf_collector_pause()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -540,7 +877,7 @@ void cbtf_collector_resume()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -554,12 +891,12 @@ void cbtf_collector_resume()
 
 #ifdef USE_EXPLICIT_TLS
 void destroy_explicit_tls() {
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
     /* Destroy our thread-local storage */
     if (tls) {
         free(tls);
     }
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 }
 #endif
 
@@ -576,7 +913,7 @@ void cbtf_collector_stop()
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
@@ -595,11 +932,14 @@ void cbtf_collector_stop()
     if(tls->data.events.events_len > 0 || tls->data.stacktraces.stacktraces_len > 0) {
 	send_samples(tls);
     }
+    if(tls->contention.locks.locks_len > 0) {
+	send_contention(tls);
+    }
 
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     free(tls);
-    CBTF_SetTLS(TLSKey, NULL);
+    CBTF_SetTLSSlot(TLSSlot, NULL);
 #endif
 }
 
@@ -607,7 +947,7 @@ bool_t pthreads_do_trace(const char* traced_func)
 {
     /* Access our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = CBTF_GetTLS(TLSKey);
+    TLS* tls = CBTF_GetTLSSlot(TLSSlot);
 #else
     TLS* tls = &the_tls;
 #endif
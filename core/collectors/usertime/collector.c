@@ -95,6 +95,11 @@ typedef struct {
     /**< exist in buffer stacktraces. */
     CBTF_StackTraceData buffer;
 
+#if defined(USE_CCT)
+    /** Calling context tree of the sampled stacks. */
+    CBTF_CCTData tree;
+#endif
+
 #if defined (HAVE_OMPT)
     /* these are ompt specific. */
     bool thread_idle, thread_wait_barrier, thread_barrier;
@@ -102,6 +107,7 @@ typedef struct {
 
     /* debug flags */
     bool defer_sampling;
+    bool use_perf_events;  /**< Sampling with perf events instead of a timer. */
 
 #if defined(CBTF_HANDLE_UNWIND_SEGV)
     sigjmp_buf unwind_jmp;
@@ -259,6 +265,20 @@ static void initialize_data(TLS* tls)
     /* Re-initialize the sampling buffer */
     memset(tls->buffer.stacktraces, 0, sizeof(tls->buffer.stacktraces));
     memset(tls->buffer.count, 0, sizeof(tls->buffer.count));
+
+    /* Re-initialize the calling context tree */
+    tls->data.cct_pc.cct_pc_len = 0;
+    tls->data.cct_pc.cct_pc_val = NULL;
+    tls->data.cct_parent.cct_parent_len = 0;
+    tls->data.cct_parent.cct_parent_val = NULL;
+    tls->data.cct_count.cct_count_len = 0;
+    tls->data.cct_count.cct_count_val = NULL;
+#if defined(USE_CCT)
+    tls->data.cct_pc.cct_pc_val = tls->tree.pc;
+    tls->data.cct_parent.cct_parent_val = tls->tree.parent;
+    tls->data.cct_count.cct_count_val = tls->tree.count;
+    CBTF_InitializeCCTData(&tls->tree);
+#endif
 }
 
 
@@ -309,6 +329,22 @@ inline void update_header_with_address(TLS* tls, uint64_t addr)
 }
 
 
+/**
+ * Test if there are unsent samples.
+ *
+ * @param tls    Thread-local storage to be tested.
+ * @return       Boolean "true" if there are unsent samples.
+ */
+static bool have_samples(TLS *tls)
+{
+#if defined(USE_CCT)
+    return (tls->tree.length > 0);
+#else
+    return (tls->data.stacktraces.stacktraces_len > 0);
+#endif
+}
+
+
 /**
  * Send samples.
  *
@@ -327,6 +363,14 @@ static void send_samples(TLS *tls)
     tls->header.rank = monitor_mpi_comm_rank();
 #endif
 
+#if defined(USE_CCT)
+    tls->header.addr_begin = tls->tree.addr_begin;
+    tls->header.addr_end = tls->tree.addr_end;
+    tls->data.cct_pc.cct_pc_len = tls->tree.length;
+    tls->data.cct_parent.cct_parent_len = tls->tree.length;
+    tls->data.cct_count.cct_count_len = tls->tree.length;
+#endif
+
 #ifndef NDEBUG
 	if (IsCollectorDebugEnabled) {
 	    fprintf(stderr, "[%ld:%d] usertime send_samples:\n",tls->header.pid, tls->header.omp_tid);
@@ -346,17 +390,14 @@ static void send_samples(TLS *tls)
 }
 
 
+static void record_stack(TLS*, unsigned int, uint64_t*);
+
 /**
  * Timer event handler.
  *
  * Called by the timer handler each time a sample is to be taken. 
- * Extract the PC address for each frame in the current stack trace and store
- * them into the sample buffer. For each address that represents the
- * top of a unique stack update it's count in the count buffer.
- * If a stack count reaches 255 in the count buffer, start a new stack
- * entry in the sample buffer.
- * When the sample buffer is full, it is sent to the framework
- * for storage in the experiment's database.
+ * Extract the PC address for each frame in the current stack trace and
+ * record them.
  *
  * @note    
  * 
@@ -375,9 +416,17 @@ static void serviceTimerHandler(const ucontext_t* context)
     if(tls->defer_sampling == true) {
         return;
     }
- 
+
+    /* Send the samples taken at the old rate if the timer adapted its rate */
+    uint64_t interval = CBTF_GetTimerInterval();
+    if (interval != tls->data.effective_interval) {
+	if (have_samples(tls)) {
+	    send_samples(tls);
+	}
+	tls->data.effective_interval = interval;
+    }
+
     unsigned int framecount = 0;
-    int stackindex = 0;
     uint64_t framebuf[CBTF_USERTIME_MAXFRAMES];
 
     memset(framebuf,0, sizeof(framebuf));
@@ -403,7 +452,11 @@ static void serviceTimerHandler(const ucontext_t* context)
 	/* get stack address for current context and store them into framebuf. */
 #if defined(__linux) && defined(__x86_64)
 
-#if defined(USE_FASTTRACE)
+#if defined(USE_FPTRACE)
+	/* Frame pointer unwinder with a per-thread cache of frame rules. */
+	CBTF_GetStackTraceFP(context, 0,
+                        CBTF_USERTIME_MAXFRAMES /* maxframes*/, &framecount, framebuf) ;
+#elif defined(USE_FASTTRACE)
 	/* The x86_64 unwinder uses fast cache based storage of addresses. */
 	CBTF_GetStackTrace(TRUE, 0,
                         CBTF_USERTIME_MAXFRAMES /* maxframes*/, &framecount, framebuf) ;
@@ -426,6 +479,27 @@ static void serviceTimerHandler(const ucontext_t* context)
     tls->is_unwinding = false;
 #endif
 
+    record_stack(tls, framecount, framebuf);
+}
+
+
+/**
+ * Record a sampled stack.
+ *
+ * Store the PC address of each frame of the stack trace into the sample
+ * buffer. For each address that represents the top of a unique stack update
+ * it's count in the count buffer. If a stack count reaches 255 in the count
+ * buffer, start a new stack entry in the sample buffer. When the sample
+ * buffer is full, it is sent to the framework for storage in the
+ * experiment's database.
+ *
+ * @param tls           Thread-local storage of the sampled thread.
+ * @param framecount    Number of frames in the stack trace.
+ * @param framebuf      Stack trace with the top of stack first.
+ */
+static void record_stack(TLS* tls, unsigned int framecount, uint64_t* framebuf)
+{
+    int stackindex = 0;
 
 #if defined (HAVE_OMPT)
     /* these are ompt specific.*/
@@ -457,6 +531,13 @@ static void serviceTimerHandler(const ucontext_t* context)
     }
 #endif // if defined (HAVE_OMPT)
 
+#if defined(USE_CCT)
+    /* add the stack to the calling context tree. (sends the tree if full) */
+    if (!CBTF_UpdateCCTData(framecount, framebuf, &tls->tree)) {
+	send_samples(tls);
+	CBTF_UpdateCCTData(framecount, framebuf, &tls->tree);
+    }
+#else
     bool_t stack_already_exists = FALSE;
 
     int i, j;
@@ -520,12 +601,47 @@ static void serviceTimerHandler(const ucontext_t* context)
 	if (framebuf[i] < tls->header.addr_begin ) {
 	    tls->header.addr_begin = framebuf[i];
 	}
-	if (framebuf[i] > tls->header.addr_end ) {
+	if (!CBTF_IsFrameRepeat(framebuf[i]) &&
+	    framebuf[i] > tls->header.addr_end ) {
 	    tls->header.addr_end = framebuf[i];
 	}
 	tls->data.stacktraces.stacktraces_len++;
 	tls->data.count.count_len++;
     }
+#endif
+}
+
+/**
+ * Perf event handler.
+ *
+ * Called for each sample drained from this thread's perf event ring buffer.
+ * The kernel captured the stack trace by walking the frame pointers of the
+ * thread, so code built without frame pointers yields shorter stacks.
+ *
+ * @param framecount    Number of frames in the sample.
+ * @param frames        Frames of the sample with the top of stack first.
+ */
+static void servicePerfEventHandler(unsigned framecount, const uint64_t* frames)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    Assert(tls != NULL);
+
+    if(tls->defer_sampling == true) {
+        return;
+    }
+
+    uint64_t framebuf[CBTF_USERTIME_MAXFRAMES];
+    if (framecount > CBTF_USERTIME_MAXFRAMES) {
+	framecount = CBTF_USERTIME_MAXFRAMES;
+    }
+    memcpy(framebuf, frames, framecount * sizeof(uint64_t));
+
+    record_stack(tls, framecount, framebuf);
 }
 
 void collector_record_addr(char* name, uint64_t addr)
@@ -595,6 +711,7 @@ void cbtf_collector_start(const CBTF_DataHeader* header)
 
     tls->data.interval = 
 	(uint64_t)(1000000000) / (uint64_t)(args.sampling_rate);
+    tls->data.effective_interval = tls->data.interval;
 
 
 
@@ -624,8 +741,17 @@ void cbtf_collector_start(const CBTF_DataHeader* header)
     tls->sample_count = 0;
 #endif
 
-    /* Begin sampling */
-    CBTF_Timer(tls->data.interval, serviceTimerHandler);
+#if defined(__linux) && defined(__x86_64) && defined(USE_FPTRACE)
+    /* Set up the frame cache here since the handler can't allocate it. */
+    CBTF_InitializeStackTraceFP();
+#endif
+
+    /* Begin sampling. Use perf events if requested and available. */
+    tls->use_perf_events =
+	CBTF_PerfEventTimer(tls->data.interval, true, servicePerfEventHandler);
+    if (!tls->use_perf_events) {
+	CBTF_Timer(tls->data.interval, serviceTimerHandler);
+    }
 }
 
 
@@ -652,7 +778,13 @@ void cbtf_collector_pause()
     // real time signals (SIGRTMIN or SIGRTMIN+N) as well and
     // likely default to the posix based timer.
     // fixes issues seen with omnipath based mpi connects.
-    CBTF_BlockTimerSignal();
+    if (tls->use_perf_events) {
+	// keep the samples taken before the pause.
+	CBTF_PerfEventEnable(false);
+	CBTF_PerfEventDrain();
+    } else {
+	CBTF_BlockTimerSignal();
+    }
     tls->defer_sampling=true;
 }
 
@@ -680,8 +812,12 @@ void cbtf_collector_resume()
     // real time signals (SIGRTMIN or SIGRTMIN+N) as well and
     // likely default to the posix based timer.
     // fixes issues seen with omnipath based mpi connects.
-    CBTF_UnBlockTimerSignal();
     tls->defer_sampling=false;
+    if (tls->use_perf_events) {
+	CBTF_PerfEventEnable(true);
+    } else {
+	CBTF_UnBlockTimerSignal();
+    }
 }
 
 
@@ -710,13 +846,17 @@ void cbtf_collector_stop()
 #endif
     Assert(tls != NULL);
 
-    /* Stop sampling */
-    CBTF_Timer(0, NULL);
+    /* Stop sampling. (perf events drain any remaining samples) */
+    if (tls->use_perf_events) {
+	CBTF_PerfEventTimer(0, false, NULL);
+    } else {
+	CBTF_Timer(0, NULL);
+    }
 
     tls->header.time_end = CBTF_GetTime();
 
     /* Are there any unsent samples? */
-    if(tls->data.stacktraces.stacktraces_len > 0) {
+    if(have_samples(tls)) {
 	/* Send these samples */
 	send_samples(tls);
     }
@@ -733,6 +873,10 @@ void cbtf_collector_stop()
 #endif
 #endif
 
+#if defined(__linux) && defined(__x86_64) && defined(USE_FPTRACE)
+    CBTF_FinalizeStackTraceFP();
+#endif
+
     /* Destroy our thread-local storage */
 #ifdef CBTF_SERVICE_USE_EXPLICIT_TLS
     destroy_explicit_tls();
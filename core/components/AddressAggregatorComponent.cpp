@@ -37,6 +37,7 @@
 #include "KrellInstitute/Core/Address.hpp"
 #include "KrellInstitute/Core/AddressBuffer.hpp"
 #include "KrellInstitute/Core/AddressRange.hpp"
+#include "KrellInstitute/Core/AddressSpill.hpp"
 #include "KrellInstitute/Core/Blob.hpp"
 #if 0
 #include "KrellInstitute/Core/Graph.hpp"
@@ -63,6 +64,7 @@
 #include "KrellInstitute/Messages/Pthreads_data.h"
 #endif
 #include "KrellInstitute/Messages/ThreadEvents.h"
+#include "KrellInstitute/Messages/PerformanceData.hpp"
 
 using namespace KrellInstitute::CBTF;
 using namespace KrellInstitute::Core;
@@ -102,6 +104,40 @@ bool is_time_aggregator_events_enabled =
 
     bool is_defer_emit = (getenv("CBTF_DEFER_AGGR_EMIT") != NULL);
 
+    // Length in seconds of the windows used by the incremental (epoch)
+    // aggregation mode. Zero disables the mode and all addresses are
+    // accumulated until the end of the run.
+    uint64_t epoch_interval = (getenv("CBTF_AGGR_EPOCH") != NULL) ?
+	strtoull(getenv("CBTF_AGGR_EPOCH"), NULL, 10) * 1000000000 : 0;
+
+    // Start of the current window.
+    Time epoch_start = Time::Now();
+
+    // The final buffer of this node has been emitted.
+    bool emitted_buffer = false;
+
+    // Number of addresses retained by the top-K sketch mode. Zero disables
+    // the mode and all unique addresses are retained.
+    unsigned topk_size = (getenv("CBTF_AGGR_TOPK") != NULL) ?
+	strtoul(getenv("CBTF_AGGR_TOPK"), NULL, 10) : 0;
+
+    // Memory budget in megabytes for the merged address counts. Zero
+    // disables spilling. Sketches and windows are already bounded so
+    // only the exact cumulative buffer is ever spilled.
+    uint64_t memory_budget =
+	(getenv("CBTF_AGGR_MEMORY_BUDGET") != NULL && topk_size == 0) ?
+	strtoull(getenv("CBTF_AGGR_MEMORY_BUDGET"), NULL, 10) * 1024 * 1024 : 0;
+
+    // Send the stacks of the usertime, hwctime, io, iot and mem blobs up the
+    // tree folded into the calling context tree rather than as the per-thread
+    // stack lists of the original blobs.
+    bool is_cct_enabled = (getenv("CBTF_AGGR_CCT") != NULL);
+
+    // Node local directory holding the spilled runs.
+    std::string spill_directory =
+	(getenv("CBTF_AGGR_SPILL_DIR") != NULL) ? getenv("CBTF_AGGR_SPILL_DIR") :
+	(getenv("TMPDIR") != NULL) ? getenv("TMPDIR") : "/tmp";
+
     bool is_finished = false;
     int data_blobs = 0;
     int handled_buffers = 0;
@@ -128,6 +164,13 @@ bool is_time_aggregator_events_enabled =
 	}
 #endif
 	threadaddrbufmap.insert(std::make_pair(tname,buf));
+
+	// The per address map grows with every unique address, which is what
+	// the memory budget bounds, and is only kept for debugging.
+	if (memory_budget > 0) {
+	    return true;
+	}
+
 	AddressCounts::const_iterator aci;
 
 	for (aci = buf.addresscounts.begin(); aci != buf.addresscounts.end(); ++aci) {
@@ -154,6 +197,34 @@ bool is_time_aggregator_events_enabled =
 #endif
     }
 
+    // bound a buffer to the top-K addresses before it is emitted.
+    AddressBuffer& sketchAddressBuffer(AddressBuffer& buf)
+    {
+	if (topk_size > 0) {
+	    buf.truncate(topk_size);
+	}
+	return buf;
+    }
+
+    // merge the counts of one addressbuffer into another. In top-K
+    // sketch mode the buffer is allowed to grow to twice its final
+    // size between truncations to amortize their cost.
+    void mergeAddressBuffer(AddressBuffer& to, const AddressBuffer& from)
+    {
+	if (topk_size > 0) {
+	    to.mergeSketch(from);
+	    if (to.addresscounts.size() > 2 * topk_size) {
+		to.truncate(topk_size);
+	    }
+	    return;
+	}
+
+	AddressCounts::const_iterator aci;
+	for (aci = from.addresscounts.begin(); aci != from.addresscounts.end(); ++aci) {
+	    to.updateAddressCounts(aci->first.getValue(), aci->second);
+	}
+    }
+
     void printAddrThreadCountMap(AddrThreadCountMap& addrTM)
     {
 #ifndef NDEBUG
@@ -224,6 +295,33 @@ bool is_time_aggregator_events_enabled =
 
 /**
  * Component that aggregates address values and their counts.
+ *
+ * When CBTF_AGGR_EPOCH is set to a number of seconds, the leaf and
+ * intermediate CPs also keep the counts of the current window and emit
+ * them upstream as deltas on the "AggregatorDelta" output once the window
+ * has elapsed. The frontend merges the deltas into a rolling cumulative
+ * buffer that is emitted on the "AggregatorPartial" output each time it
+ * changes. The last window is sent as a delta when the node finishes. The
+ * final buffers emitted on "Aggregatorout" are still the complete buffers,
+ * since the linked objects and symbols are found from the buffer of the
+ * leaf CP. The collector networks carry "AggregatorDelta"
+ * to the "addressBufferDelta" input of the parent node on the BufferDeltas
+ * stream and hand "AggregatorPartial" to the client as the
+ * addressbuffer_partial_output. Windows are closed as data arrives since
+ * components aren't driven by timers.
+ *
+ * When CBTF_AGGR_TOPK is set to a number of addresses, the buffers are
+ * used as mergeable top-K sketches. Each node retains only the addresses
+ * with the largest counts along with bounds on the error of those counts
+ * and the exact total count, so that the memory and transfer size at
+ * every level of the tree is fixed regardless of the job size.
+ *
+ * When CBTF_AGGR_MEMORY_BUDGET is set to a number of megabytes, the merged
+ * buffer is written as sorted runs to CBTF_AGGR_SPILL_DIR (or TMPDIR) each
+ * time it exceeds the budget. The CPs stream the merge of the runs out on
+ * "Aggregatorout" in chunks no larger than the budget, which the parent
+ * merges into its own spilled buffer. Only the frontend merges the runs
+ * back into a single buffer for the client.
  */
 class __attribute__ ((visibility ("hidden"))) AddressAggregator :
     public Component
@@ -243,7 +341,8 @@ private:
 
     /** Default constructor. */
     AddressAggregator() :
-        Component(Type(typeid(AddressAggregator)), Version(0, 0, 1))
+        Component(Type(typeid(AddressAggregator)), Version(0, 0, 1)),
+	spill(spill_directory, memory_budget)
     {
         declareInput<int>(
             "numBE", boost::bind(&AddressAggregator::numBEHandler, this, _1)
@@ -251,6 +350,9 @@ private:
         declareInput<AddressBuffer>(
             "addressBuffer", boost::bind(&AddressAggregator::addressBufferHandler, this, _1)
             );
+        declareInput<AddressBuffer>(
+            "addressBufferDelta", boost::bind(&AddressAggregator::addressBufferDeltaHandler, this, _1)
+            );
         declareInput<Blob>(
             "blob", boost::bind(&AddressAggregator::blobHandler, this, _1)
             );
@@ -277,8 +379,11 @@ private:
             );
  
         declareOutput<AddressBuffer>("Aggregatorout");
+        declareOutput<AddressBuffer>("AggregatorDelta");
+        declareOutput<AddressBuffer>("AggregatorPartial");
         declareOutput<ThreadAddrBufMap>("ThreadAddrBufMap");
 	declareOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("datablob_xdr_out");
+	declareOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("stackblob_out");
 
 	init_TopologyInfo();
     }
@@ -387,7 +492,12 @@ private:
 	        flushOutput(output);
 	    }
 #endif
-	    emitOutput<AddressBuffer>("Aggregatorout",  abuffer);
+	    // In epoch mode the last window goes out as a delta.
+	    emitted_buffer = true;
+	    if (epoch_interval > 0) {
+		flushWindow();
+	    }
+	    emitFinalBuffer(abuffer);
 #ifndef NDEBUG
 	    if (is_trace_aggregator_events_enabled) {
 	        output << debug_prefix.str() <<
@@ -472,7 +582,7 @@ private:
     // TODO: queue the incoming datablobs rather than just resending them as
     // they arrive.  Once all known threads are terminated and no more blobs
     // are arriving, flush the queue.
-    void cbtf_protocol_blob_Handler(const boost::shared_ptr<CBTF_Protocol_Blob>& in)
+    void cbtf_protocol_blob_Handler(const boost::shared_ptr<CBTF_Protocol_Blob>& raw)
     {
 	init_TopologyInfo();
 	++data_blobs;
@@ -500,38 +610,28 @@ private:
 #endif
 
 	// FIXME: Should we abort or just return here?
-	if (in->data.data_len == 0 ) {
+	if (raw->data.data_len == 0 ) {
 	    std::cerr << "EXIT AddressAggregator::cbtf_protocol_blob_Handler data length 0" << std::endl;
 	    abort();
 	}
 
 	// Allow all levels to re-emit the data blob from this handler.
-	if (isLeafCP()) {
-#ifndef NDEBUG
-	    if (is_trace_aggregator_events_enabled) {
-		output << debug_prefix.str() << "AddressAggregator::cbtf_protocol_blob_Handler"
-		    << "  EMITS CBTF_Protocol_Blob" << std::endl;
-	        flushOutput(output);
-	    }
-#endif
-	    emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("datablob_xdr_out",in);
-	} else if (!isLeafCP()) {
+	if (!isLeafCP()) {
 #ifndef NDEBUG
 	    if (is_trace_aggregator_events_enabled) {
 	        output << debug_prefix.str()
 	        << "AddressAggregator::cbtf_protocol_blob_Handler PASS ON DATABLOB" << std::endl;
 	        flushOutput(output);
 	    }
-	    emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("datablob_xdr_out",in);
+	    emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("datablob_xdr_out",raw);
 #endif
 	    return;
-	} else {
 	}
 
 	// From this point on only leafCP nodes decode and handle
 	// the passed in performance data blobs.
 
-	Blob perfdatablob(in.get()->data.data_len, in.get()->data.data_val);
+	Blob perfdatablob(raw.get()->data.data_len, raw.get()->data.data_val);
 
 	// decode this blobs data header and create a threadname object
 	// and collector id object.
@@ -549,9 +649,34 @@ private:
 	unsigned data_size = perfdatablob.getSize() - header_size;
 	total_data_size += data_size;
 
+	// update aggregate addresses and counts. Natively encoded performance
+	// data is aggregated as it is. Only the blob passed on is converted
+	// back to XDR, with its folded stacks unfolded, so that every blob
+	// passed on from here is what the client expects.
 	AddressBuffer buf;
-	// update aggregate addresses and counts.
-	total_data_size += perfdata.aggregate(perfdatablob,buf);
+	boost::shared_ptr<CBTF_Protocol_Blob> in;
+	try {
+	    total_data_size += perfdata.aggregate(raw, buf, in);
+	} catch (const std::runtime_error& error) {
+	    std::cerr << "AddressAggregator::cbtf_protocol_blob_Handler"
+		<< " dropped a performance data blob: " << error.what()
+		<< std::endl;
+	    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), reinterpret_cast<char*>(&header));
+	    return;
+	}
+
+#ifndef NDEBUG
+	if (is_trace_aggregator_events_enabled) {
+	    output << debug_prefix.str() << "AddressAggregator::cbtf_protocol_blob_Handler"
+		<< "  EMITS CBTF_Protocol_Blob" << std::endl;
+	    flushOutput(output);
+	}
+#endif
+	// In CCT mode the stack carrying blobs go to the CCTAggregator in
+	// place of the client.
+	emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >(
+	    (is_cct_enabled && PerfData::hasCallingContext(header.id)) ?
+	    "stackblob_out" : "datablob_xdr_out", in);
 
 #ifndef NDEBUG
         if (is_debug_aggregator_events_enabled) {
@@ -563,7 +688,12 @@ private:
 	    flushOutput(output);
 	}
 #endif
-	abuffer.updateAddressCounts(buf);
+	mergeAddressBuffer(abuffer, buf);
+	spill.update(abuffer);
+	if (epoch_interval > 0) {
+	    mergeAddressBuffer(window, buf);
+	    flushWindow();
+	}
 
 	// load balance on address counts or raw time.
 	updateAddrThreadCountMap(buf, addrThreadCount, threadname);
@@ -624,6 +754,15 @@ private:
     void addressBufferHandler(const AddressBuffer& in)
     {
 	init_TopologyInfo();
+
+	// The chunks of a spilled buffer from a child only count as its
+	// buffer once the last one arrives.
+	if (in.partial) {
+	    mergeAddressBuffer(abuffer, in);
+	    spill.update(abuffer);
+	    return;
+	}
+
         ++handled_buffers;
 
 #ifndef NDEBUG
@@ -651,13 +790,8 @@ private:
 	    flushOutput(output);
 	}
 #endif
-	AddressCounts::const_iterator aci;
-	for (aci = in.addresscounts.begin(); aci != in.addresscounts.end(); ++aci) {
-
-	    AddressCounts::iterator lb = abuffer.addresscounts.lower_bound(aci->first);
-	    abuffer.updateAddressCounts(aci->first.getValue(), aci->second);
-	}
-
+	mergeAddressBuffer(abuffer, in);
+	spill.update(abuffer);
 
 #ifndef NDEBUG
         if (is_debug_aggregator_events_enabled) {
@@ -704,7 +838,12 @@ private:
 	        flushOutput(output);
 	    }
 #endif
-	    emitOutput<AddressBuffer>("Aggregatorout",  abuffer);
+	    // In epoch mode the last window goes out as a delta.
+	    emitted_buffer = true;
+	    if (epoch_interval > 0 && !isFrontend()) {
+		flushWindow();
+	    }
+	    emitFinalBuffer(abuffer);
 	}
 
 #ifndef NDEBUG
@@ -714,6 +853,87 @@ private:
     }
 
 
+    /** Emit the final buffer of this node on the "Aggregatorout" output.
+      * A CP streams a spilled buffer out in chunks no larger than the
+      * memory budget, all but the last marked as partial, so the merged
+      * buffer is never held in memory. The frontend hands the client a
+      * single buffer.
+      */
+    void emitFinalBuffer(AddressBuffer& buf)
+    {
+	if (isFrontend() || spill.getRunCount() == 0) {
+	    spill.merge(buf);
+	    emitOutput<AddressBuffer>("Aggregatorout",  sketchAddressBuffer(buf));
+	    return;
+	}
+
+	AddressBuffer chunk;
+	while (spill.next(buf, chunk)) {
+	    chunk.partial = true;
+	    emitOutput<AddressBuffer>("Aggregatorout",  chunk);
+	}
+	emitOutput<AddressBuffer>("Aggregatorout",  chunk);
+    }
+
+
+    /** Handler for the "addressBufferDelta" input.
+      * Only used in epoch mode. The frontend merges the deltas of its
+      * children into its rolling buffer and emits it as a partial
+      * result. The intermediate CPs merge them into their own window.
+      * The complete buffer arrives separately on "addressBuffer".
+      */
+    void addressBufferDeltaHandler(const AddressBuffer& in)
+    {
+	init_TopologyInfo();
+#ifndef NDEBUG
+	std::stringstream output;
+	DEBUGPREFIX(Impl::TheTopologyInfo.IsFrontend,Impl::TheTopologyInfo.MaxLeafDistance);
+        if (is_trace_aggregator_events_enabled) {
+	    output << debug_prefix.str()
+	    	<< "ENTERED AddressAggregator::addressBufferDeltaHandler"
+		<< " addresscounts size:" << in.addresscounts.size()
+		<< std::endl;
+	    flushOutput(output);
+	}
+#endif
+
+	if (isFrontend()) {
+	    mergeAddressBuffer(window, in);
+	    emitOutput<AddressBuffer>("AggregatorPartial",  sketchAddressBuffer(window));
+	} else {
+	    mergeAddressBuffer(window, in);
+	    flushWindow();
+	}
+    }
+
+
+    /** Emit the counts of the current window as a delta once the window
+      * has elapsed. Counts arriving after the final buffer was emitted
+      * are forwarded right away.
+      */
+    void flushWindow()
+    {
+	Time now = Time::Now();
+
+	if (window.addresscounts.empty() ||
+	    (!emitted_buffer &&
+	     static_cast<uint64_t>(now - epoch_start) < epoch_interval)) {
+	    return;
+	}
+
+#ifndef NDEBUG
+        if (is_debug_aggregator_events_enabled) {
+	    std::cerr << debug_prefix.str()
+		<< "AddressAggregator::flushWindow EMITS AddressBuffer delta size:"
+		<< window.addresscounts.size() << std::endl;
+	}
+#endif
+	emitOutput<AddressBuffer>("AggregatorDelta",  sketchAddressBuffer(window));
+	window = AddressBuffer();
+	epoch_start = now;
+    }
+
+
     /** Handler for the "blob" input.*/
     void blobHandler(const Blob& in)
     {
@@ -770,6 +990,10 @@ private:
     uint64_t interval;
 
     AddressBuffer abuffer;
+    // Counts of the current window in epoch mode, or the rolling
+    // cumulative buffer of the deltas at the frontend.
+    AddressBuffer window;
+    AddressSpill spill;
     AddrThreadCountMap addrThreadCount;
     PerfData perfdata;
 
@@ -23,6 +23,7 @@
 #include <mrnet/MRNet.h>
 #include <typeinfo>
 #include <algorithm>
+#include <cstring>
 
 #include <KrellInstitute/CBTF/Component.hpp>
 #include <KrellInstitute/CBTF/Type.hpp>
@@ -38,6 +39,15 @@ namespace {
 
     uint64_t interval = 0;
 
+    /** Packet format of a plain address buffer. */
+    const char* const AddressBufferFormat = "%auld %auld";
+
+    /** Packet format of an address buffer used as a top-K sketch. */
+    const char* const AddressSketchFormat = "%auld %auld %auld %uld %uld";
+
+    /** Packet format of a chunk of an address buffer that more follow. */
+    const char* const AddressChunkFormat = "%auld %auld %d";
+
 }
 
 /**
@@ -75,8 +85,14 @@ private:
 
 	AddressCounts ac = in.addresscounts;
 	int bufsize = ac.size();
+	// Only buffers used as top-K sketches carry the error bounds, so
+	// plain buffers keep the original packet format.
+	bool is_sketch = !in.addresserrors.empty() ||
+			 in.missing > 0 || in.dropped > 0;
+	int errsize = in.addresserrors.empty() ? 0 : bufsize;
 	uint64_t * addr = NULL;
 	uint64_t * counts = NULL;
+	uint64_t * errors = NULL;
 
 	addr = reinterpret_cast<uint64_t*>(
             malloc(bufsize * sizeof(uint64_t*))
@@ -84,20 +100,41 @@ private:
 	counts = reinterpret_cast<uint64_t*>(
             malloc(bufsize * sizeof(uint64_t*))
             );
+	errors = reinterpret_cast<uint64_t*>(
+            malloc(errsize * sizeof(uint64_t*))
+            );
 	
 	AddressCounts::iterator i;
 	int j = 0;
 	for (i = ac.begin(); i != ac.end(); ++i) {
 	    addr[j] = i->first.getValue();
 	    counts[j] = i->second;
+	    if (errsize > 0) {
+		errors[j] = in.getError(i->first);
+	    }
 	    j++;
 	}
 
-        emitOutput<MRN::PacketPtr>(
-            "out", MRN::PacketPtr(new MRN::Packet(0, 0, "%auld %auld", addr,bufsize,counts,bufsize))
-            );
+	if (in.partial) {
+            emitOutput<MRN::PacketPtr>(
+		"out", MRN::PacketPtr(new MRN::Packet(0, 0, AddressChunkFormat,
+		    addr,bufsize,counts,bufsize,1))
+		);
+	} else if (is_sketch) {
+            emitOutput<MRN::PacketPtr>(
+		"out", MRN::PacketPtr(new MRN::Packet(0, 0, AddressSketchFormat,
+		    addr,bufsize,counts,bufsize,errors,errsize,
+		    in.missing,in.dropped))
+		);
+	} else {
+            emitOutput<MRN::PacketPtr>(
+		"out", MRN::PacketPtr(new MRN::Packet(0, 0, AddressBufferFormat,
+		    addr,bufsize,counts,bufsize))
+		);
+	}
 	if (addr) free(addr);
 	if (counts) free(counts);
+	if (errors) free(errors);
     }
     
 }; // class ConvertAddressBufferToPacket
@@ -141,16 +178,33 @@ private:
         AddressBuffer out;
 	uint64_t *addr = NULL;
 	uint64_t *counts = NULL;
+	uint64_t *errors = NULL;
 	int addrsize = 0;
 	int countssize = 0;
-
-
-        in->unpack("%auld %auld", &addr, &addrsize, &counts, &countssize);
+	int errorssize = 0;
+	int partial = 0;
+
+
+	if (strcmp(in->get_FormatString(), AddressChunkFormat) == 0) {
+            in->unpack(AddressChunkFormat, &addr, &addrsize,
+		       &counts, &countssize, &partial);
+	    out.partial = (partial != 0);
+	} else if (strcmp(in->get_FormatString(), AddressSketchFormat) == 0) {
+            in->unpack(AddressSketchFormat, &addr, &addrsize,
+		       &counts, &countssize, &errors, &errorssize,
+		       &out.missing, &out.dropped);
+	} else {
+            in->unpack(AddressBufferFormat, &addr, &addrsize,
+		       &counts, &countssize);
+	}
 
 	// TODO: error handling
 
 	for (int i= 0; i < addrsize; ++i) {
 	    out.updateAddressCounts(addr[i],counts[i]);
+	    if (errorssize == addrsize && errors[i] > 0) {
+		out.addresserrors[Address(addr[i])] = errors[i];
+	    }
 	}
 
         emitOutput<AddressBuffer>("out", out);
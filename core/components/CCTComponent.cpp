@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file CCTAggregator component. */
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <mrnet/MRNet.h>
+#include <typeinfo>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <KrellInstitute/CBTF/Component.hpp>
+#include <KrellInstitute/CBTF/Type.hpp>
+#include <KrellInstitute/CBTF/Version.hpp>
+#include <KrellInstitute/CBTF/Impl/MRNet.hpp>
+
+#include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/CallingContextTree.hpp"
+#include "KrellInstitute/Core/PerfData.hpp"
+
+#include "ReductionAggregator.hpp"
+
+using namespace KrellInstitute::CBTF;
+using namespace KrellInstitute::Core;
+
+/**
+ * Component that reduces the stacks sent by the usertime, hwctime, io, iot
+ * and mem collectors into a single calling context tree.
+ *
+ * In CBTF_AGGR_CCT mode the aggregators send the stack carrying blobs here
+ * in place of the client. The size of the tree at each node, and of the
+ * packets sent up from it, is then bounded by the number of unique call
+ * paths below it rather than by the number of samples or events, and the
+ * frontend receives the complete tree.
+ */
+class __attribute__ ((visibility ("hidden"))) CCTAggregator :
+    public ReductionAggregator<CallingContextTree>
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new CCTAggregator())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    CCTAggregator() :
+        ReductionAggregator<CallingContextTree>(
+            Type(typeid(CCTAggregator)), "cct", "CCTout",
+            "CBTF_PRINT_CCT", "CBTF_DEBUG_CCT"
+            )
+    {
+    }
+
+    void decode(PerfData& perfdata, const Blob& blob, CallingContextTree& data)
+    {
+	perfdata.callingContextTree(blob, data);
+    }
+
+    void merge(CallingContextTree& data, const CallingContextTree& in)
+    {
+	data.merge(in);
+    }
+
+    std::size_t size(const CallingContextTree& data) const
+    {
+	return data.nodes.size();
+    }
+
+}; // class CCTAggregator
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(CCTAggregator)
+
+
+
+/**
+ * Component that converts a CallingContextTree into a MRNet packet.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertCCTToPacket :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertCCTToPacket())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertCCTToPacket() :
+        Component(Type(typeid(ConvertCCTToPacket)), Version(0, 0, 1))
+    {
+        declareInput<CallingContextTree>(
+            "in", boost::bind(&ConvertCCTToPacket::inHandler, this, _1)
+            );
+        declareOutput<MRN::PacketPtr>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const CallingContextTree& in)
+    {
+	int size = in.nodes.size();
+	uint64_t* pcs = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint32_t* parents = reinterpret_cast<uint32_t*>(malloc(size * sizeof(uint32_t)));
+	uint64_t* counts = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+
+	for (int i = 0; i < size; ++i) {
+	    pcs[i] = in.nodes[i].pc;
+	    parents[i] = in.nodes[i].parent;
+	    counts[i] = in.nodes[i].count;
+	}
+
+        emitOutput<MRN::PacketPtr>(
+            "out", MRN::PacketPtr(new MRN::Packet(0, 0, "%auld %aud %auld",
+		pcs, size, parents, size, counts, size))
+            );
+
+	free(pcs);
+	free(parents);
+	free(counts);
+    }
+
+}; // class ConvertCCTToPacket
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertCCTToPacket)
+
+
+
+/**
+ * Component that converts a MRNet packet into a CallingContextTree.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertPacketToCCT :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertPacketToCCT())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertPacketToCCT() :
+        Component(Type(typeid(ConvertPacketToCCT)), Version(0, 0, 1))
+    {
+        declareInput<MRN::PacketPtr>(
+            "in", boost::bind(&ConvertPacketToCCT::inHandler, this, _1)
+            );
+        declareOutput<CallingContextTree>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const MRN::PacketPtr& in)
+    {
+        CallingContextTree out;
+	uint64_t* pcs = NULL;
+	uint32_t* parents = NULL;
+	uint64_t* counts = NULL;
+	int size = 0, psize = 0, csize = 0;
+
+        in->unpack("%auld %aud %auld",
+		   &pcs, &size, &parents, &psize, &counts, &csize);
+
+	if (psize == size && csize == size) {
+	    out.addTree(size, pcs, parents, counts);
+	}
+
+        emitOutput<CallingContextTree>("out", out);
+    }
+
+}; // class ConvertPacketToCCT
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertPacketToCCT)
@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file CommMatrixAggregator component. */
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <mrnet/MRNet.h>
+#include <typeinfo>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <KrellInstitute/CBTF/Component.hpp>
+#include <KrellInstitute/CBTF/Type.hpp>
+#include <KrellInstitute/CBTF/Version.hpp>
+#include <KrellInstitute/CBTF/Impl/MRNet.hpp>
+
+#include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/CommMatrix.hpp"
+#include "KrellInstitute/Core/PerfData.hpp"
+
+#include "ReductionAggregator.hpp"
+
+using namespace KrellInstitute::CBTF;
+using namespace KrellInstitute::Core;
+
+/**
+ * Component that reduces the communication matrix rows sent by the mpit
+ * collector (in CBTF_MPI_COMM_MATRIX mode) into a full rank-to-rank matrix.
+ *
+ * Memory at each node is bounded by the number of distinct communicating
+ * rank pairs below it rather than by the number of messages.
+ */
+class __attribute__ ((visibility ("hidden"))) CommMatrixAggregator :
+    public ReductionAggregator<CommMatrix>
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new CommMatrixAggregator())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    CommMatrixAggregator() :
+        ReductionAggregator<CommMatrix>(
+            Type(typeid(CommMatrixAggregator)), "commMatrix", "CommMatrixout",
+            "CBTF_PRINT_COMM_MATRIX", "CBTF_DEBUG_COMM_MATRIX"
+            )
+    {
+    }
+
+    void decode(PerfData& perfdata, const Blob& blob, CommMatrix& data)
+    {
+	perfdata.commMatrix(blob, data);
+    }
+
+    void merge(CommMatrix& data, const CommMatrix& in)
+    {
+	data.updateCommMatrix(in);
+    }
+
+    std::size_t size(const CommMatrix& data) const
+    {
+	return data.cells.size();
+    }
+
+}; // class CommMatrixAggregator
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(CommMatrixAggregator)
+
+
+
+/**
+ * Component that converts a CommMatrix into a MRNet packet.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertCommMatrixToPacket :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertCommMatrixToPacket())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertCommMatrixToPacket() :
+        Component(Type(typeid(ConvertCommMatrixToPacket)), Version(0, 0, 1))
+    {
+        declareInput<CommMatrix>(
+            "in", boost::bind(&ConvertCommMatrixToPacket::inHandler, this, _1)
+            );
+        declareOutput<MRN::PacketPtr>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const CommMatrix& in)
+    {
+	int size = in.cells.size();
+	int hsize = size * CBTF_MPI_COMM_HISTOGRAM_SIZE;
+	int* sources = reinterpret_cast<int*>(malloc(size * sizeof(int)));
+	int* destinations = reinterpret_cast<int*>(malloc(size * sizeof(int)));
+	uint64_t* counts = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* bytes = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* times = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* histograms = reinterpret_cast<uint64_t*>(malloc(hsize * sizeof(uint64_t)));
+
+	CommMatrixCells::const_iterator ci;
+	int j = 0;
+	for (ci = in.cells.begin(); ci != in.cells.end(); ++ci, ++j) {
+	    sources[j] = ci->first.first;
+	    destinations[j] = ci->first.second;
+	    counts[j] = ci->second.count;
+	    bytes[j] = ci->second.bytes;
+	    times[j] = ci->second.time;
+	    for (int k = 0; k < CBTF_MPI_COMM_HISTOGRAM_SIZE; ++k) {
+		histograms[j * CBTF_MPI_COMM_HISTOGRAM_SIZE + k] =
+		    ci->second.histogram[k];
+	    }
+	}
+
+        emitOutput<MRN::PacketPtr>(
+            "out", MRN::PacketPtr(new MRN::Packet(0, 0,
+		"%ad %ad %auld %auld %auld %auld",
+		sources, size, destinations, size, counts, size,
+		bytes, size, times, size, histograms, hsize))
+            );
+
+	free(sources);
+	free(destinations);
+	free(counts);
+	free(bytes);
+	free(times);
+	free(histograms);
+    }
+
+}; // class ConvertCommMatrixToPacket
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertCommMatrixToPacket)
+
+
+
+/**
+ * Component that converts a MRNet packet into a CommMatrix.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertPacketToCommMatrix :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertPacketToCommMatrix())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertPacketToCommMatrix() :
+        Component(Type(typeid(ConvertPacketToCommMatrix)), Version(0, 0, 1))
+    {
+        declareInput<MRN::PacketPtr>(
+            "in", boost::bind(&ConvertPacketToCommMatrix::inHandler, this, _1)
+            );
+        declareOutput<CommMatrix>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const MRN::PacketPtr& in)
+    {
+        CommMatrix out;
+	int* sources = NULL;
+	int* destinations = NULL;
+	uint64_t* counts = NULL;
+	uint64_t* bytes = NULL;
+	uint64_t* times = NULL;
+	uint64_t* histograms = NULL;
+	int size = 0, dsize = 0, csize = 0, bsize = 0, tsize = 0, hsize = 0;
+
+        in->unpack("%ad %ad %auld %auld %auld %auld",
+		   &sources, &size, &destinations, &dsize, &counts, &csize,
+		   &bytes, &bsize, &times, &tsize, &histograms, &hsize);
+
+	if (hsize == size * CBTF_MPI_COMM_HISTOGRAM_SIZE) {
+	    for (int i = 0; i < size; ++i) {
+		CommMatrixCell cell;
+		cell.count = counts[i];
+		cell.bytes = bytes[i];
+		cell.time = times[i];
+		for (int k = 0; k < CBTF_MPI_COMM_HISTOGRAM_SIZE; ++k) {
+		    cell.histogram[k] =
+			histograms[i * CBTF_MPI_COMM_HISTOGRAM_SIZE + k];
+		}
+		out.updateCommMatrix(sources[i], destinations[i], cell);
+	    }
+	}
+
+        emitOutput<CommMatrix>("out", out);
+    }
+
+}; // class ConvertPacketToCommMatrix
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertPacketToCommMatrix)
@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file IOStatsAggregator component. */
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <mrnet/MRNet.h>
+#include <typeinfo>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <KrellInstitute/CBTF/Component.hpp>
+#include <KrellInstitute/CBTF/Type.hpp>
+#include <KrellInstitute/CBTF/Version.hpp>
+#include <KrellInstitute/CBTF/Impl/MRNet.hpp>
+
+#include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/IOStats.hpp"
+#include "KrellInstitute/Core/PerfData.hpp"
+
+#include "ReductionAggregator.hpp"
+
+using namespace KrellInstitute::CBTF;
+using namespace KrellInstitute::Core;
+
+/** Number of totals packed for each file besides its histogram. */
+#define IOStatsTotals 10
+
+/**
+ * Component that reduces the per file descriptor statistics sent by the iot
+ * collector (in CBTF_IO_STATS mode) into per file totals.
+ *
+ * Memory at each node is bounded by the number of distinct files accessed
+ * below it rather than by the number of I/O calls.
+ */
+class __attribute__ ((visibility ("hidden"))) IOStatsAggregator :
+    public ReductionAggregator<IOStats>
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new IOStatsAggregator())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    IOStatsAggregator() :
+        ReductionAggregator<IOStats>(
+            Type(typeid(IOStatsAggregator)), "ioStats", "IOStatsout",
+            "CBTF_PRINT_IO_STATS", "CBTF_DEBUG_IO_STATS"
+            )
+    {
+    }
+
+    void decode(PerfData& perfdata, const Blob& blob, IOStats& data)
+    {
+	perfdata.ioStats(blob, data);
+    }
+
+    void merge(IOStats& data, const IOStats& in)
+    {
+	data.update(in);
+    }
+
+    std::size_t size(const IOStats& data) const
+    {
+	return data.files.size();
+    }
+
+}; // class IOStatsAggregator
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(IOStatsAggregator)
+
+
+
+/**
+ * Component that converts an IOStats into a MRNet packet.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertIOStatsToPacket :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertIOStatsToPacket())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertIOStatsToPacket() :
+        Component(Type(typeid(ConvertIOStatsToPacket)), Version(0, 0, 1))
+    {
+        declareInput<IOStats>(
+            "in", boost::bind(&ConvertIOStatsToPacket::inHandler, this, _1)
+            );
+        declareOutput<MRN::PacketPtr>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const IOStats& in)
+    {
+	int size = in.files.size();
+	int tsize = size * IOStatsTotals;
+	int hsize = size * CBTF_IO_STATS_HISTOGRAM_SIZE;
+	char** pathnames = reinterpret_cast<char**>(malloc(size * sizeof(char*)));
+	uint64_t* totals = reinterpret_cast<uint64_t*>(malloc(tsize * sizeof(uint64_t)));
+	uint64_t* histograms = reinterpret_cast<uint64_t*>(malloc(hsize * sizeof(uint64_t)));
+
+	IOStatsFiles::const_iterator fi;
+	int j = 0;
+	for (fi = in.files.begin(); fi != in.files.end(); ++fi, ++j) {
+	    uint64_t* t = &totals[j * IOStatsTotals];
+	    pathnames[j] = strdup(fi->first.c_str());
+	    t[0] = fi->second.read_calls;
+	    t[1] = fi->second.read_bytes;
+	    t[2] = fi->second.read_time;
+	    t[3] = fi->second.write_calls;
+	    t[4] = fi->second.write_bytes;
+	    t[5] = fi->second.write_time;
+	    t[6] = fi->second.other_calls;
+	    t[7] = fi->second.other_time;
+	    t[8] = fi->second.sequential;
+	    t[9] = fi->second.random;
+	    for (int k = 0; k < CBTF_IO_STATS_HISTOGRAM_SIZE; ++k) {
+		histograms[j * CBTF_IO_STATS_HISTOGRAM_SIZE + k] =
+		    fi->second.histogram[k];
+	    }
+	}
+
+        emitOutput<MRN::PacketPtr>(
+            "out", MRN::PacketPtr(new MRN::Packet(0, 0, "%as %auld %auld",
+		pathnames, size, totals, tsize, histograms, hsize))
+            );
+
+	for (j = 0; j < size; ++j) {
+	    free(pathnames[j]);
+	}
+	free(pathnames);
+	free(totals);
+	free(histograms);
+    }
+
+}; // class ConvertIOStatsToPacket
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertIOStatsToPacket)
+
+
+
+/**
+ * Component that converts a MRNet packet into an IOStats.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertPacketToIOStats :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertPacketToIOStats())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertPacketToIOStats() :
+        Component(Type(typeid(ConvertPacketToIOStats)), Version(0, 0, 1))
+    {
+        declareInput<MRN::PacketPtr>(
+            "in", boost::bind(&ConvertPacketToIOStats::inHandler, this, _1)
+            );
+        declareOutput<IOStats>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const MRN::PacketPtr& in)
+    {
+        IOStats out;
+	char** pathnames = NULL;
+	uint64_t* totals = NULL;
+	uint64_t* histograms = NULL;
+	int size = 0, tsize = 0, hsize = 0;
+
+        in->unpack("%as %auld %auld",
+		   &pathnames, &size, &totals, &tsize, &histograms, &hsize);
+
+	if ((tsize == size * IOStatsTotals) &&
+	    (hsize == size * CBTF_IO_STATS_HISTOGRAM_SIZE)) {
+	    for (int i = 0; i < size; ++i) {
+		const uint64_t* t = &totals[i * IOStatsTotals];
+		IOStatsFile file;
+		file.read_calls = t[0];
+		file.read_bytes = t[1];
+		file.read_time = t[2];
+		file.write_calls = t[3];
+		file.write_bytes = t[4];
+		file.write_time = t[5];
+		file.other_calls = t[6];
+		file.other_time = t[7];
+		file.sequential = t[8];
+		file.random = t[9];
+		for (int k = 0; k < CBTF_IO_STATS_HISTOGRAM_SIZE; ++k) {
+		    file.histogram[k] =
+			histograms[i * CBTF_IO_STATS_HISTOGRAM_SIZE + k];
+		}
+		out.update(pathnames[i], file);
+	    }
+	}
+
+        emitOutput<IOStats>("out", out);
+    }
+
+}; // class ConvertPacketToIOStats
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertPacketToIOStats)
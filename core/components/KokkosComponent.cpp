@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file KokkosAggregator component. */
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <mrnet/MRNet.h>
+#include <typeinfo>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <KrellInstitute/CBTF/Component.hpp>
+#include <KrellInstitute/CBTF/Type.hpp>
+#include <KrellInstitute/CBTF/Version.hpp>
+#include <KrellInstitute/CBTF/Impl/MRNet.hpp>
+
+#include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/KokkosKernels.hpp"
+#include "KrellInstitute/Core/PerfData.hpp"
+
+#include "ReductionAggregator.hpp"
+
+using namespace KrellInstitute::CBTF;
+using namespace KrellInstitute::Core;
+
+/**
+ * Component that reduces the Kokkos kernel timings sent through the overview
+ * collector into per kernel totals.
+ *
+ * Memory at each node is bounded by the number of distinct kernel names
+ * below it rather than by the number of kernel launches.
+ */
+class __attribute__ ((visibility ("hidden"))) KokkosAggregator :
+    public ReductionAggregator<KokkosKernels>
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new KokkosAggregator())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    KokkosAggregator() :
+        ReductionAggregator<KokkosKernels>(
+            Type(typeid(KokkosAggregator)), "kokkosKernels", "KokkosKernelsout",
+            "CBTF_PRINT_KOKKOS", "CBTF_DEBUG_KOKKOS"
+            )
+    {
+    }
+
+    void decode(PerfData& perfdata, const Blob& blob, KokkosKernels& data)
+    {
+	perfdata.kokkosKernels(blob, data);
+    }
+
+    void merge(KokkosKernels& data, const KokkosKernels& in)
+    {
+	data.update(in);
+    }
+
+    std::size_t size(const KokkosKernels& data) const
+    {
+	return data.kernels.size();
+    }
+
+}; // class KokkosAggregator
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(KokkosAggregator)
+
+
+
+/**
+ * Component that converts a KokkosKernels into a MRNet packet.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertKokkosKernelsToPacket :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertKokkosKernelsToPacket())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertKokkosKernelsToPacket() :
+        Component(Type(typeid(ConvertKokkosKernelsToPacket)), Version(0, 0, 1))
+    {
+        declareInput<KokkosKernels>(
+            "in", boost::bind(&ConvertKokkosKernelsToPacket::inHandler, this, _1)
+            );
+        declareOutput<MRN::PacketPtr>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const KokkosKernels& in)
+    {
+	int size = in.kernels.size();
+	int* types = reinterpret_cast<int*>(malloc(size * sizeof(int)));
+	char** names = reinterpret_cast<char**>(malloc(size * sizeof(char*)));
+	uint64_t* calls = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* totals = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* mins = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* maxs = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+
+	KokkosKernelTimings::const_iterator ki;
+	int j = 0;
+	for (ki = in.kernels.begin(); ki != in.kernels.end(); ++ki, ++j) {
+	    types[j] = ki->first.first;
+	    names[j] = const_cast<char*>(ki->first.second.c_str());
+	    calls[j] = ki->second.calls;
+	    totals[j] = ki->second.total_time;
+	    mins[j] = ki->second.min_time;
+	    maxs[j] = ki->second.max_time;
+	}
+
+        emitOutput<MRN::PacketPtr>(
+            "out", MRN::PacketPtr(new MRN::Packet(0, 0,
+		"%ad %as %auld %auld %auld %auld",
+		types, size, names, size, calls, size,
+		totals, size, mins, size, maxs, size))
+            );
+
+	free(types);
+	free(names);
+	free(calls);
+	free(totals);
+	free(mins);
+	free(maxs);
+    }
+
+}; // class ConvertKokkosKernelsToPacket
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertKokkosKernelsToPacket)
+
+
+
+/**
+ * Component that converts a MRNet packet into a KokkosKernels.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertPacketToKokkosKernels :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertPacketToKokkosKernels())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertPacketToKokkosKernels() :
+        Component(Type(typeid(ConvertPacketToKokkosKernels)), Version(0, 0, 1))
+    {
+        declareInput<MRN::PacketPtr>(
+            "in", boost::bind(&ConvertPacketToKokkosKernels::inHandler, this, _1)
+            );
+        declareOutput<KokkosKernels>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const MRN::PacketPtr& in)
+    {
+        KokkosKernels out;
+	int* types = NULL;
+	char** names = NULL;
+	uint64_t* calls = NULL;
+	uint64_t* totals = NULL;
+	uint64_t* mins = NULL;
+	uint64_t* maxs = NULL;
+	int size = 0, nsize = 0, csize = 0, tsize = 0, minsize = 0, maxsize = 0;
+
+        in->unpack("%ad %as %auld %auld %auld %auld",
+		   &types, &size, &names, &nsize, &calls, &csize,
+		   &totals, &tsize, &mins, &minsize, &maxs, &maxsize);
+
+	if (nsize == size && csize == size && tsize == size &&
+	    minsize == size && maxsize == size) {
+	    for (int i = 0; i < size; ++i) {
+		KokkosKernelStats stats;
+		stats.calls = calls[i];
+		stats.total_time = totals[i];
+		stats.min_time = mins[i];
+		stats.max_time = maxs[i];
+		out.update(types[i], names[i], stats);
+	    }
+	}
+
+        emitOutput<KokkosKernels>("out", out);
+    }
+
+}; // class ConvertPacketToKokkosKernels
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertPacketToKokkosKernels)
@@ -24,6 +24,8 @@
 #include <mrnet/MRNet.h>
 #include <typeinfo>
 #include <algorithm>
+#include <map>
+#include <set>
 #include <sstream>
 
 #include <KrellInstitute/CBTF/Component.hpp>
@@ -197,7 +199,9 @@ private:
 
     /** Default constructor. */
     LinkedObjectComponent() :
-        Component(Type(typeid(LinkedObjectComponent)), Version(0, 0, 1))
+        Component(Type(typeid(LinkedObjectComponent)), Version(0, 0, 1)),
+        havecounts(false),
+        streaming(false)
     {
         declareInput<int>(
             "numBE", boost::bind(&LinkedObjectComponent::numBEHandler, this, _1)
@@ -286,9 +290,7 @@ private:
         if (numTerminated == numThreads && addressspace.size() == numThreads) {
 
 
-	    AddressCounts ac = abuffer.addresscounts;
 	    // ICP and FE levels do not have counts. Possibly due to no buffer yet?
-	    bool havecounts = (ac.size() > 0) ? true : false ;
 	    AddressSpace found;
 
 	    AddressSpace::iterator i;
@@ -298,14 +300,10 @@ private:
 		for (LinkedObjectVec::iterator k = (*i).second.begin();
 			     k != (*i).second.end(); ++k) {
 
-		    bool has_sample = false;
 		    AddressRange addr_range((*k).getAddressRange());
-		    AddressCounts::const_iterator aci;
-		    for (aci=ac.equal_range(addr_range.getBegin()).first;
-			 aci!=ac.equal_range(addr_range.getEnd()).second;aci++) {
-			has_sample = true;
-			break;
-		    }
+		    bool has_sample = (sampled.find(addr_range) != sampled.end()) ||
+			(unmatched.lower_bound(addr_range.getBegin()) !=
+			 unmatched.upper_bound(addr_range.getEnd()));
 
 		    if(has_sample || !havecounts) {
 #ifndef NDEBUG
@@ -403,13 +401,68 @@ private:
 	    flushOutput(output);
 	}
 #endif
-	abuffer = in;
+	// A spilled buffer arrives as chunks of disjoint addresses, all
+	// but the last of which are partial. Each chunk is reduced to the
+	// linked objects it samples as it arrives rather than merged back
+	// into the complete buffer.
+	if (!streaming) {
+	    havecounts = false;
+	    sampled.clear();
+	    unmatched.clear();
+	}
+	streaming = in.partial;
+	addSampledObjects(in);
 
 #ifndef NDEBUG
 	//flushOutput(output);
 #endif
     }
 
+    // Add the address ranges of the linked objects holding an address of
+    // the buffer to sampled. Addresses that lie in no linked object seen
+    // so far are kept in unmatched and checked against the complete
+    // address space by numTerminatedHandler.
+    void addSampledObjects(const AddressBuffer& buf)
+    {
+	if (buf.addresscounts.empty()) {
+	    return;
+	}
+	havecounts = true;
+
+	std::set<AddressRange> ranges;
+	for (AddressSpace::iterator i = addressspace.begin(); i != addressspace.end(); ++i) {
+	    for (LinkedObjectVec::iterator k = (*i).second.begin();
+			 k != (*i).second.end(); ++k) {
+		ranges.insert((*k).getAddressRange());
+	    }
+	}
+
+	// The known ranges merged into disjoint spans keyed by their begin.
+	std::map<Address, Address> spans;
+	for (std::set<AddressRange>::iterator r = ranges.begin(); r != ranges.end(); ++r) {
+	    const AddressCounts& ac = buf.addresscounts;
+	    if (ac.lower_bound(r->getBegin()) != ac.upper_bound(r->getEnd())) {
+		sampled.insert(*r);
+	    }
+
+	    if (!spans.empty() && !(spans.rbegin()->second < r->getBegin())) {
+		if (spans.rbegin()->second < r->getEnd()) {
+		    spans.rbegin()->second = r->getEnd();
+		}
+	    } else {
+		spans.insert(spans.end(), std::make_pair(r->getBegin(), r->getEnd()));
+	    }
+	}
+
+	for (AddressCounts::const_iterator aci = buf.addresscounts.begin();
+	     aci != buf.addresscounts.end(); ++aci) {
+	    std::map<Address, Address>::iterator span = spans.upper_bound(aci->first);
+	    if (span == spans.begin() || (--span)->second < aci->first) {
+		unmatched.insert(unmatched.end(), *aci);
+	    }
+	}
+    }
+
     // This message can only arrive on a local component network
     // as it currently has no mrnet converter to pass it on to other nodes.
     // Arrives on the "threadnames" input and exists here to inform
@@ -630,9 +683,15 @@ private:
 #endif
     }
 
-    // address buffer used to reduce incoming linkedobject groups
-    // from the ltwt BEs.
-    AddressBuffer abuffer;
+    // address ranges of the linked objects sampled by the address buffer,
+    // used to reduce incoming linkedobject groups from the ltwt BEs.
+    std::set<AddressRange> sampled;
+    // sampled addresses not yet found in any linked object.
+    AddressCounts unmatched;
+    // whether an address buffer with counts has arrived.
+    bool havecounts;
+    // whether more chunks of a spilled address buffer are expected.
+    bool streaming;
 
     // vector of linkedobjectentry with thread info.
     LinkedObjectEntryVec linkedobjectentryvec;
@@ -0,0 +1,275 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file LockContentionAggregator component. */
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <mrnet/MRNet.h>
+#include <typeinfo>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+#include <KrellInstitute/CBTF/Component.hpp>
+#include <KrellInstitute/CBTF/Type.hpp>
+#include <KrellInstitute/CBTF/Version.hpp>
+#include <KrellInstitute/CBTF/Impl/MRNet.hpp>
+
+#include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/LockContention.hpp"
+#include "KrellInstitute/Core/PerfData.hpp"
+
+#include "ReductionAggregator.hpp"
+
+using namespace KrellInstitute::CBTF;
+using namespace KrellInstitute::Core;
+
+/**
+ * Component that reduces the lock contention statistics sent by the pthreads
+ * collector (in CBTF_PTHREAD_CONTENTION mode) and the OpenMP mutex statistics
+ * sent by the omptp collector into per lock totals.
+ *
+ * Memory at each node is bounded by the number of distinct (mutex, call site)
+ * pairs below it rather than by the number of lock calls.
+ */
+class __attribute__ ((visibility ("hidden"))) LockContentionAggregator :
+    public ReductionAggregator<LockContention>
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new LockContentionAggregator())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    LockContentionAggregator() :
+        ReductionAggregator<LockContention>(
+            Type(typeid(LockContentionAggregator)), "lockContention", "LockContentionout",
+            "CBTF_PRINT_LOCK_CONTENTION", "CBTF_DEBUG_LOCK_CONTENTION"
+            )
+    {
+    }
+
+    void decode(PerfData& perfdata, const Blob& blob, LockContention& data)
+    {
+	perfdata.lockContention(blob, data);
+    }
+
+    void merge(LockContention& data, const LockContention& in)
+    {
+	data.update(in);
+    }
+
+    std::size_t size(const LockContention& data) const
+    {
+	return data.locks.size();
+    }
+
+}; // class LockContentionAggregator
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(LockContentionAggregator)
+
+
+
+/**
+ * Component that converts a LockContention into a MRNet packet.
+ * The call site of each lock is flattened into a single array of
+ * addresses with a zero address terminating each call site.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertLockContentionToPacket :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertLockContentionToPacket())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertLockContentionToPacket() :
+        Component(Type(typeid(ConvertLockContentionToPacket)), Version(0, 0, 1))
+    {
+        declareInput<LockContention>(
+            "in", boost::bind(&ConvertLockContentionToPacket::inHandler, this, _1)
+            );
+        declareOutput<MRN::PacketPtr>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const LockContention& in)
+    {
+	int size = in.locks.size();
+	int hsize = size * CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE;
+	uint64_t* mutexes = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* acquisitions = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* failed = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* waits = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* max_waits = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* holds = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* max_holds = reinterpret_cast<uint64_t*>(malloc(size * sizeof(uint64_t)));
+	uint64_t* histograms = reinterpret_cast<uint64_t*>(malloc(hsize * sizeof(uint64_t)));
+	std::vector<uint64_t> stacks;
+
+	LockContentionLocks::const_iterator li;
+	int j = 0;
+	for (li = in.locks.begin(); li != in.locks.end(); ++li, ++j) {
+	    mutexes[j] = li->first.first;
+	    acquisitions[j] = li->second.acquisitions;
+	    failed[j] = li->second.failed_trylocks;
+	    waits[j] = li->second.wait_time;
+	    max_waits[j] = li->second.max_wait_time;
+	    holds[j] = li->second.hold_time;
+	    max_holds[j] = li->second.max_hold_time;
+	    for (int k = 0; k < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE; ++k) {
+		histograms[j * CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE + k] =
+		    li->second.histogram[k];
+	    }
+	    const StackTrace& stack = li->first.second;
+	    for (unsigned k = 0; k < stack.size(); ++k) {
+		stacks.push_back(stack[k].getValue());
+	    }
+	    stacks.push_back(0);
+	}
+	int ssize = stacks.size();
+	uint64_t* addresses = reinterpret_cast<uint64_t*>(malloc(ssize * sizeof(uint64_t)));
+	for (int k = 0; k < ssize; ++k) {
+	    addresses[k] = stacks[k];
+	}
+
+        emitOutput<MRN::PacketPtr>(
+            "out", MRN::PacketPtr(new MRN::Packet(0, 0,
+		"%auld %auld %auld %auld %auld %auld %auld %auld %auld",
+		mutexes, size, acquisitions, size, failed, size,
+		waits, size, max_waits, size, holds, size, max_holds, size,
+		histograms, hsize, addresses, ssize))
+            );
+
+	free(mutexes);
+	free(acquisitions);
+	free(failed);
+	free(waits);
+	free(max_waits);
+	free(holds);
+	free(max_holds);
+	free(histograms);
+	free(addresses);
+    }
+
+}; // class ConvertLockContentionToPacket
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertLockContentionToPacket)
+
+
+
+/**
+ * Component that converts a MRNet packet into a LockContention.
+ */
+class __attribute__ ((visibility ("hidden"))) ConvertPacketToLockContention :
+    public Component
+{
+
+public:
+
+    /** Factory function for this component type. */
+    static Component::Instance factoryFunction()
+    {
+        return Component::Instance(
+            reinterpret_cast<Component*>(new ConvertPacketToLockContention())
+            );
+    }
+
+private:
+
+    /** Default constructor. */
+    ConvertPacketToLockContention() :
+        Component(Type(typeid(ConvertPacketToLockContention)), Version(0, 0, 1))
+    {
+        declareInput<MRN::PacketPtr>(
+            "in", boost::bind(&ConvertPacketToLockContention::inHandler, this, _1)
+            );
+        declareOutput<LockContention>("out");
+    }
+
+    /** Handler for the "in" input.*/
+    void inHandler(const MRN::PacketPtr& in)
+    {
+        LockContention out;
+	uint64_t* mutexes = NULL;
+	uint64_t* acquisitions = NULL;
+	uint64_t* failed = NULL;
+	uint64_t* waits = NULL;
+	uint64_t* max_waits = NULL;
+	uint64_t* holds = NULL;
+	uint64_t* max_holds = NULL;
+	uint64_t* histograms = NULL;
+	uint64_t* addresses = NULL;
+	int size = 0, asize = 0, fsize = 0, wsize = 0, mwsize = 0;
+	int hdsize = 0, mhsize = 0, hsize = 0, ssize = 0;
+
+        in->unpack("%auld %auld %auld %auld %auld %auld %auld %auld %auld",
+		   &mutexes, &size, &acquisitions, &asize, &failed, &fsize,
+		   &waits, &wsize, &max_waits, &mwsize, &holds, &hdsize,
+		   &max_holds, &mhsize, &histograms, &hsize,
+		   &addresses, &ssize);
+
+	if (hsize == size * CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE) {
+	    int s = 0;
+	    for (int i = 0; i < size && s < ssize; ++i) {
+		StackTrace stack;
+		for (; s < ssize && addresses[s] != 0; ++s) {
+		    stack.push_back(Address(addresses[s]));
+		}
+		++s; // skip the terminating zero
+
+		LockContentionStats stats;
+		stats.acquisitions = acquisitions[i];
+		stats.failed_trylocks = failed[i];
+		stats.wait_time = waits[i];
+		stats.max_wait_time = max_waits[i];
+		stats.hold_time = holds[i];
+		stats.max_hold_time = max_holds[i];
+		for (int k = 0; k < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE; ++k) {
+		    stats.histogram[k] =
+			histograms[i * CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE + k];
+		}
+		out.update(mutexes[i], stack, stats);
+	    }
+	}
+
+        emitOutput<LockContention>("out", out);
+    }
+
+}; // class ConvertPacketToLockContention
+
+KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(ConvertPacketToLockContention)
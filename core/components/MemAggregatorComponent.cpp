@@ -28,6 +28,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <deque>
+#include <pthread.h>
 #include <rpc/rpc.h>
 
 #include <KrellInstitute/CBTF/Component.hpp>
@@ -106,9 +108,6 @@ bool is_time_aggregator_events_enabled =
     ThreadAddrBufMap threadaddrbufmap;
     // map thread to mem metrics 
     ThreadMemMetricsMap threadmemmetricsmap;
-    // class that handles computing address buffer and any additional
-    // metrics for a specific experiment.
-    PerfData perfdata;
     // The mem metrics specific to this experiment.
     MemMetrics memMetrics;
 
@@ -120,7 +119,8 @@ bool is_time_aggregator_events_enabled =
     // helper to map address counts to threads.
     bool updateAddrThreadCountMap(AddressBuffer& buf,
 				   AddrThreadCountMap& addrThreadCount,
-				   ThreadName& tname)
+				   ThreadAddrBufMap& threadaddrbufmap,
+				   const ThreadName& tname)
     {
 #ifndef NDEBUG
 	std::stringstream output;
@@ -166,6 +166,246 @@ bool is_time_aggregator_events_enabled =
     // total size of performance data seen.
     int total_data_size = 0;
 
+    // Number of worker threads decoding the blobs on the leaf CP. Zero
+    // keeps all of the work on the handler thread.
+    unsigned num_workers = (getenv("CBTF_MEM_AGGR_WORKERS") != NULL) ?
+	strtoul(getenv("CBTF_MEM_AGGR_WORKERS"), NULL, 10) : 0;
+
+    // Number of blobs that may wait in the queue of a worker. The handler
+    // thread waits for room beyond that so that the pending blobs don't
+    // grow with the data volume when the workers fall behind.
+    const size_t MaxPendingBlobs = 16;
+
+    // Width in milliseconds of the buckets of the memory usage time series
+    // of each thread. Zero disables the series.
+    uint64_t usage_interval = (getenv("CBTF_MEM_USAGE_INTERVAL") != NULL) ?
+	strtoull(getenv("CBTF_MEM_USAGE_INTERVAL"), NULL, 10) * 1000000 : 0;
+
+    // Output of the reduced mem event blobs. In CCT mode their stacks go to
+    // the CCTAggregator in place of the per-thread stack lists sent to the
+    // client.
+    const char* stack_blob_output = (getenv("CBTF_AGGR_CCT") != NULL) ?
+	"stackblob_out" : "datablob_xdr_out";
+
+    /** A decoded header and its blob waiting for aggregation. */
+    struct MemWork {
+	boost::shared_ptr<Blob> blob;
+	std::string collectorID;
+	ThreadName threadname;
+
+	MemWork(const boost::shared_ptr<Blob>& b, const std::string& id,
+		const ThreadName& tname) :
+	    blob(b), collectorID(id), threadname(tname) {
+	}
+    };
+
+    /**
+     * Results for the blobs of a set of threads. Each worker owns one
+     * for the threads assigned to it, and the handler thread uses its
+     * own when there are no workers. They are merged into the results
+     * above once all threads have terminated.
+     */
+    struct MemPartial {
+	// computes the address buffer and metrics of the blobs.
+	PerfData perfdata;
+	AddressBuffer abuffer;
+	AddrThreadCountMap addrThreadCount;
+	ThreadAddrBufMap threadaddrbufmap;
+	ThreadMemMetricsMap threadmemmetricsmap;
+	int total_data_size;
+	int data_blobs_size;
+
+	MemPartial() : total_data_size(0), data_blobs_size(0) {
+	}
+    };
+
+    /** A worker thread and the blobs queued for it. */
+    struct MemWorker {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t ready;
+	pthread_cond_t drained;
+	std::deque<MemWork> queue;
+	bool done;
+	MemPartial partial;
+    };
+
+    MemPartial handler_partial;
+    std::vector<MemWorker*> workers;
+    // Every blob of a thread goes to the same worker so its events are
+    // aggregated in order. Threads are assigned round robin.
+    std::map<ThreadName, unsigned> thread_worker;
+
+    // aggregate the addresses and mem metrics of one blob.
+    void aggregateMemBlob(MemPartial& p, const MemWork& work)
+    {
+	// Any folded stacks are unfolded by the same decoding so that the
+	// stacks of the reduced blobs emitted from here are plain stacks.
+	AddressBuffer buf;
+	Blob unfolded;
+	p.total_data_size += p.perfdata.aggregate(*work.blob,buf,&unfolded);
+	const Blob& blob = unfolded.isEmpty() ? *work.blob : unfolded;
+
+	ThreadMemMetricsMap::iterator it =
+	    p.threadmemmetricsmap.find(work.threadname);
+	if (it == p.threadmemmetricsmap.end()) {
+	    MemMetrics M;
+	    M.highwater = 0;
+	    M.currentAllocation = 0;
+	    M.usage.interval = usage_interval;
+	    std::pair<ThreadMemMetricsMap::iterator, bool> tmp =
+		p.threadmemmetricsmap.insert(std::make_pair(work.threadname,M));
+	    it = tmp.first;
+	}
+
+#ifndef NDEBUG
+	if (is_debug_aggregator_events_enabled) {
+	    std::stringstream output;
+	    output << debug_prefix.str()
+	    << "MemAggregator::aggregateMemBlob Aggregating"
+	    << " addresses and determining reduced events for thread:" << work.threadname
+	    << " total data bytes: " << p.total_data_size
+	    << std::endl;
+	    flushOutput(output);
+	}
+#endif
+	if (work.collectorID == "memhist") {
+	    // Histograms of call sites from the same thread are merged.
+	    p.data_blobs_size += p.perfdata.memHistograms(blob,it->second);
+	} else {
+	    p.data_blobs_size += p.perfdata.memMetrics(blob,it->second);
+	}
+
+	p.abuffer.updateAddressCounts(buf);
+	updateAddrThreadCountMap(buf, p.addrThreadCount, p.threadaddrbufmap,
+				 work.threadname);
+    }
+
+    void* runMemWorker(void* arg)
+    {
+	MemWorker* w = reinterpret_cast<MemWorker*>(arg);
+
+	pthread_mutex_lock(&w->lock);
+	while (true) {
+	    while (w->queue.empty() && !w->done) {
+		pthread_cond_wait(&w->ready, &w->lock);
+	    }
+	    if (w->queue.empty()) {
+		break;
+	    }
+	    MemWork work = w->queue.front();
+	    w->queue.pop_front();
+	    pthread_cond_signal(&w->drained);
+	    pthread_mutex_unlock(&w->lock);
+
+	    aggregateMemBlob(w->partial, work);
+
+	    pthread_mutex_lock(&w->lock);
+	}
+	pthread_mutex_unlock(&w->lock);
+	return NULL;
+    }
+
+    // hand a blob to the worker of its thread, or aggregate it here.
+    void queueMemWork(const MemWork& work)
+    {
+	if (num_workers == 0) {
+	    aggregateMemBlob(handler_partial, work);
+	    return;
+	}
+
+	if (workers.empty()) {
+	    for (unsigned i = 0; i < num_workers; ++i) {
+		MemWorker* w = new MemWorker();
+		w->done = false;
+		pthread_mutex_init(&w->lock, NULL);
+		pthread_cond_init(&w->ready, NULL);
+		pthread_cond_init(&w->drained, NULL);
+		if (pthread_create(&w->thread, NULL, runMemWorker, w) != 0) {
+		    pthread_cond_destroy(&w->drained);
+		    pthread_cond_destroy(&w->ready);
+		    pthread_mutex_destroy(&w->lock);
+		    delete w;
+		    break;
+		}
+		workers.push_back(w);
+	    }
+	    if (workers.empty()) {
+		std::cerr << "MemAggregator: unable to start worker threads" << std::endl;
+		num_workers = 0;
+		aggregateMemBlob(handler_partial, work);
+		return;
+	    }
+	}
+
+	std::map<ThreadName, unsigned>::iterator ti =
+	    thread_worker.find(work.threadname);
+	if (ti == thread_worker.end()) {
+	    ti = thread_worker.insert(std::make_pair(work.threadname,
+		thread_worker.size() % workers.size())).first;
+	}
+
+	MemWorker* w = workers[ti->second];
+	pthread_mutex_lock(&w->lock);
+	while (w->queue.size() >= MaxPendingBlobs) {
+	    pthread_cond_wait(&w->drained, &w->lock);
+	}
+	w->queue.push_back(work);
+	pthread_cond_signal(&w->ready);
+	pthread_mutex_unlock(&w->lock);
+    }
+
+    // merge the results of a partial. The threads of the partials are
+    // disjoint, so only the address counts need to be combined.
+    void mergeMemPartial(MemPartial& p)
+    {
+	abuffer.updateAddressCounts(p.abuffer);
+
+	AddrThreadCountMap::const_iterator aci;
+	for (aci = p.addrThreadCount.begin(); aci != p.addrThreadCount.end(); ++aci) {
+	    AddrThreadCountMap::iterator lb = addrThreadCount.lower_bound(aci->first);
+	    if(lb != addrThreadCount.end() && !(addrThreadCount.key_comp()(aci->first, lb->first))) {
+		if (aci->second.second > lb->second.second) {
+		    lb->second = aci->second;
+		}
+	    } else {
+		addrThreadCount.insert(lb, *aci);
+	    }
+	}
+
+	threadaddrbufmap.insert(p.threadaddrbufmap.begin(), p.threadaddrbufmap.end());
+	threadmemmetricsmap.insert(p.threadmemmetricsmap.begin(),
+				   p.threadmemmetricsmap.end());
+	total_data_size += p.total_data_size;
+	data_blobs_size += p.data_blobs_size;
+
+	p = MemPartial();
+    }
+
+    // wait for the workers to drain their queues and merge all partials.
+    // Blobs arriving afterwards are aggregated on the handler thread.
+    void mergeMemWorkers()
+    {
+	for (unsigned i = 0; i < workers.size(); ++i) {
+	    pthread_mutex_lock(&workers[i]->lock);
+	    workers[i]->done = true;
+	    pthread_cond_signal(&workers[i]->ready);
+	    pthread_mutex_unlock(&workers[i]->lock);
+	}
+
+	mergeMemPartial(handler_partial);
+	for (unsigned i = 0; i < workers.size(); ++i) {
+	    pthread_join(workers[i]->thread, NULL);
+	    mergeMemPartial(workers[i]->partial);
+	    pthread_cond_destroy(&workers[i]->drained);
+	    pthread_cond_destroy(&workers[i]->ready);
+	    pthread_mutex_destroy(&workers[i]->lock);
+	    delete workers[i];
+	}
+	workers.clear();
+	num_workers = 0;
+    }
+
     int _MaxLeafDistance = 0;
     int _NumChildren = 0;
 
@@ -208,6 +448,16 @@ bool is_time_aggregator_events_enabled =
 /**
  * Component aggregates address values and their counts.
  * Performs additional metrics used for the mem experiment.
+ *
+ * When CBTF_MEM_AGGR_WORKERS is set to a number of threads, the leaf CP
+ * only decodes the header of each blob on the handler thread and queues
+ * the blob to a worker chosen by the thread it came from. Each worker
+ * builds its own results, which are merged once all threads have
+ * terminated, so the emitted data is the same as with a single thread.
+ *
+ * When CBTF_MEM_USAGE_INTERVAL is set to a number of milliseconds, the
+ * bytes allocated by each thread are also tracked over time in buckets
+ * of that width and emitted as a CBTF_mem_usage_data blob per thread.
  */
 class __attribute__ ((visibility ("hidden"))) MemAggregator :
     public Component
@@ -231,6 +481,9 @@ private:
  
     bool update_data(const MemEvent& event,CBTF_DataHeader& data_header, CBTF_mem_exttrace_data& data);
     void initialize_data(const ThreadName& tname, CBTF_DataHeader& data_header, CBTF_mem_exttrace_data& data);
+    void initialize_header(const ThreadName& tname, CBTF_DataHeader& data_header, const char* id);
+    void emit_histograms(const ThreadName& tname, const StackMemSizeHistogramMap& histograms);
+    void emit_usage(const ThreadName& tname, const MemUsage& usage);
 
     /** Default constructor. */
     MemAggregator() :
@@ -261,6 +514,7 @@ private:
         declareOutput<AddressBuffer>("Aggregatorout");
         declareOutput<ThreadAddrBufMap>("ThreadAddrBufMap");
 	declareOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("datablob_xdr_out");
+	declareOutput<boost::shared_ptr<CBTF_Protocol_Blob> >("stackblob_out");
 
 	init_TopologyInfo();
     }
@@ -354,6 +608,8 @@ private:
 #endif
 
 	if (isLeafCP() && numTerminated == threadnames.size()) {
+	    mergeMemWorkers();
+
 	    // Handle mem specific metrics here.
 	    for (ThreadMemMetricsMap::iterator it = threadmemmetricsmap.begin();
 		 it != threadmemmetricsmap.end(); ++it) {
@@ -427,7 +683,7 @@ private:
 			    << std::endl;
 			}
 #endif
-			emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( "datablob_xdr_out",
+			emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( stack_blob_output,
 				KrellInstitute::Messages::pack<CBTF_mem_exttrace_data>(
 				pack_message, reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data)
 				)
@@ -504,7 +760,7 @@ private:
 			    << std::endl;
 			}
 #endif
-			emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( "datablob_xdr_out",
+			emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( stack_blob_output,
 				KrellInstitute::Messages::pack<CBTF_mem_exttrace_data>(
 				pack_message, reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data)
 				)
@@ -551,7 +807,7 @@ private:
 			    << std::endl;
 			}
 #endif
-			emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( "datablob_xdr_out",
+			emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( stack_blob_output,
 				KrellInstitute::Messages::pack<CBTF_mem_exttrace_data>(
 				pack_message, reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data)
 				)
@@ -615,11 +871,17 @@ private:
 			<< std::endl;
 		    }
 #endif
-		    emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( "datablob_xdr_out",
+		    emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( stack_blob_output,
 			KrellInstitute::Messages::pack<CBTF_mem_exttrace_data>(
 			pack_message, reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data))
 			);
 		}
+
+		// Emit the merged allocation size histograms (if any).
+		emit_histograms((*it).first, it->second.sizeHistograms);
+
+		// Emit the memory usage time series (if enabled).
+		emit_usage((*it).first, it->second.usage);
 	    }
 
 	    //std::cerr << "\ttotal size of all datablobs:" << data_blobs_size << std::endl;
@@ -757,13 +1019,14 @@ private:
 	// From this point on only leafCP nodes should decode and handle
 	// the passed in performance data blobs from lightweight backends.
 
-	Blob perfdatablob(in.get()->data.data_len, in.get()->data.data_val);
+	boost::shared_ptr<Blob> perfdatablob(
+	    new Blob(in->data.data_len, in->data.data_val));
 
 	// decode this blobs data header and create a threadname object
 	// and collector id object.
         CBTF_DataHeader header;
         memset(&header, 0, sizeof(header));
-        unsigned header_size = perfdatablob.getXDRDecoding(
+        unsigned header_size = perfdatablob->getXDRDecoding(
             reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
             );
 	std::string collectorID(header.id);
@@ -774,34 +1037,8 @@ private:
 	// This is the ideal place to do additional metrics for collectors
 	// that record detailed events.
 
-	AddressBuffer buf;
-	if (collectorID == "mem" ) {
-	    total_data_size += perfdata.aggregate(perfdatablob,buf);
-
-	    ThreadMemMetricsMap::iterator it = threadmemmetricsmap.find(threadname);
-	    if (it == threadmemmetricsmap.end()) {
-		MemMetrics M;
-		M.highwater = 0;
-		M.currentAllocation = 0;
-		std::pair<ThreadMemMetricsMap::iterator, bool> tmp =
-			threadmemmetricsmap.insert(std::make_pair(threadname,M));
-		it = tmp.first;
-	    }
-
-#ifndef NDEBUG
-	    if (is_debug_aggregator_events_enabled) {
-		output << debug_prefix.str()
-		<< "MemAggregator::cbtf_protocol_blob_Handler Aggregating"
-		<< " addresses and determining reduced events for thread:" << threadname
-		<< " total data bytes: " << total_data_size
-		<< std::endl;
-		flushOutput(output);
-	    }
-#endif
-	    data_blobs_size += perfdata.memMetrics(perfdatablob,it->second);
-
-	    abuffer.updateAddressCounts(buf);
-	    updateAddrThreadCountMap(buf, addrThreadCount, threadname);
+	if (collectorID == "mem" || collectorID == "memhist") {
+	    queueMemWork(MemWork(perfdatablob, collectorID, threadname));
 	}
 
 
@@ -918,15 +1155,14 @@ private:
     }
 }; // class MemAggregator
 
-// initialize a CBTF_mem_exttrace_data blob.
-void MemAggregator::initialize_data(const ThreadName& tname,
-				    CBTF_DataHeader& data_header,
-				    CBTF_mem_exttrace_data& data)
+// initialize a data header for the passed thread and collector id.
+void MemAggregator::initialize_header(const ThreadName& tname,
+				      CBTF_DataHeader& data_header,
+				      const char* id)
 {
-	
     data_header.experiment = 0;  /* offline always 0 */
     data_header.collector = 1;  /* offline always 1 */
-    data_header.id = strdup("mem");
+    data_header.id = strdup(id);
     strcpy(data_header.host,tname.getHost().c_str());
     data_header.pid = tname.getPid();
     data_header.posix_tid = tname.getPosixThreadId().second;
@@ -937,6 +1173,15 @@ void MemAggregator::initialize_data(const ThreadName& tname,
     data_header.time_end = Time::TheBeginning().getValue();
     data_header.addr_begin = ~0;
     data_header.addr_end = 0;
+}
+
+// initialize a CBTF_mem_exttrace_data blob.
+void MemAggregator::initialize_data(const ThreadName& tname,
+				    CBTF_DataHeader& data_header,
+				    CBTF_mem_exttrace_data& data)
+{
+	
+    initialize_header(tname,data_header,"mem");
 
     // Re-initialize the actual data blob
     data.stacktraces.stacktraces_len = 0;
@@ -1025,4 +1270,200 @@ bool MemAggregator::update_data(const MemEvent& event,
     return retval;
 }
 
+// Emit the merged allocation size histograms of the passed thread as
+// CBTF_mem_histogram_data blobs. Each blob holds as many call sites as
+// fit in a stack trace buffer of the collector's size so that the stack
+// trace indices fit in the blob's 16 bit fields.
+void MemAggregator::emit_histograms(const ThreadName& tname,
+				    const StackMemSizeHistogramMap& histograms)
+{
+    StackMemSizeHistogramMap::const_iterator hi = histograms.begin();
+    while (hi != histograms.end()) {
+	std::pair<boost::shared_ptr<CBTF_DataHeader>,
+		  boost::shared_ptr<CBTF_mem_histogram_data> >
+		   pack_message(
+			boost::shared_ptr<CBTF_DataHeader>(new CBTF_DataHeader()),
+			boost::shared_ptr<CBTF_mem_histogram_data>(new CBTF_mem_histogram_data())
+			);
+	CBTF_DataHeader& data_header = *pack_message.first;
+	CBTF_mem_histogram_data& data = *pack_message.second;
+	initialize_header(tname,data_header,"memhist");
+	data_header.time_begin = Time::TheBeginning().getValue();
+	data_header.time_end = Time::TheEnd().getValue();
+
+	std::vector<uint64_t> frames;
+	std::vector<CBTF_mem_size_histogram> sites;
+	for (; hi != histograms.end(); ++hi) {
+	    if (!frames.empty() &&
+		(frames.size() + hi->first.size() + 1) >= StackTraceBufferSize) {
+		break;
+	    }
+
+	    CBTF_mem_size_histogram site;
+	    memset(&site, 0, sizeof(site));
+	    site.stacktrace = frames.size();
+	    site.calls = hi->second.calls;
+	    site.time = hi->second.time;
+	    for (int k = 0; k < CBTF_MEM_HISTOGRAM_SIZE; ++k) {
+		site.count[k] = std::min(hi->second.count[k],
+					 static_cast<uint64_t>(UINT32_MAX));
+		site.bytes[k] = hi->second.bytes[k];
+	    }
+	    sites.push_back(site);
+
+	    for (StackTrace::const_iterator si = hi->first.begin();
+		 si != hi->first.end(); ++si) {
+		frames.push_back(si->getValue());
+		if (si->getValue() < data_header.addr_begin)
+		    data_header.addr_begin = si->getValue();
+		if (si->getValue() > data_header.addr_end)
+		    data_header.addr_end = si->getValue();
+	    }
+	    frames.push_back(0);
+	}
+
+	data.stacktraces.stacktraces_len = frames.size();
+	data.stacktraces.stacktraces_val =
+	    reinterpret_cast<uint64_t*>(
+		malloc(std::max(static_cast<size_t>(1), frames.size())
+		       * sizeof(uint64_t))
+		);
+	memcpy(data.stacktraces.stacktraces_val, &frames[0],
+	       frames.size() * sizeof(uint64_t));
+	data.sites.sites_len = sites.size();
+	data.sites.sites_val =
+	    reinterpret_cast<CBTF_mem_size_histogram*>(
+		malloc(std::max(static_cast<size_t>(1), sites.size())
+		       * sizeof(CBTF_mem_size_histogram))
+		);
+	memcpy(data.sites.sites_val, &sites[0],
+	       sites.size() * sizeof(CBTF_mem_size_histogram));
+
+#ifndef NDEBUG
+	if (is_trace_aggregator_events_enabled) {
+	    std::cerr << "EMITTING histogram data blob on datablob_xdr_out"
+	    << " data.stacktraces.stacktraces_len:" << data.stacktraces.stacktraces_len
+	    << " data.sites.sites_len:" << data.sites.sites_len
+	    << std::endl;
+	}
+#endif
+	emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( "datablob_xdr_out",
+		KrellInstitute::Messages::pack<CBTF_mem_histogram_data>(
+		pack_message, reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_histogram_data))
+		);
+    }
+}
+
+// Emit the memory usage time series of the passed thread as a
+// CBTF_mem_usage_data blob along with the series of its top call sites.
+void MemAggregator::emit_usage(const ThreadName& tname, const MemUsage& usage)
+{
+    if (usage.buckets.empty()) {
+	return;
+    }
+
+    std::pair<boost::shared_ptr<CBTF_DataHeader>,
+	      boost::shared_ptr<CBTF_mem_usage_data> >
+	       pack_message(
+		    boost::shared_ptr<CBTF_DataHeader>(new CBTF_DataHeader()),
+		    boost::shared_ptr<CBTF_mem_usage_data>(new CBTF_mem_usage_data())
+		    );
+    CBTF_DataHeader& data_header = *pack_message.first;
+    CBTF_mem_usage_data& data = *pack_message.second;
+    initialize_header(tname,data_header,"memusage");
+    data_header.time_begin = usage.begin;
+    data_header.time_end = usage.begin + usage.buckets.size() * usage.interval;
+
+    std::vector<CBTF_mem_usage_bucket> buckets;
+    for (unsigned i = 0; i < usage.buckets.size(); ++i) {
+	const MemUsageBucket& b = usage.buckets[i];
+	CBTF_mem_usage_bucket bucket;
+	bucket.live = b.live;
+	bucket.peak = b.peak;
+	bucket.allocated = b.allocated;
+	bucket.freed = b.freed;
+	bucket.allocations = std::min(b.allocations,
+				      static_cast<uint64_t>(UINT32_MAX));
+	bucket.frees = std::min(b.frees, static_cast<uint64_t>(UINT32_MAX));
+	buckets.push_back(bucket);
+    }
+
+    std::vector<StackMemUsageMap::const_iterator> top =
+	usage.getTopSites(CBTF_MEM_USAGE_SITES);
+    std::vector<uint64_t> frames;
+    std::vector<uint32_t> sites;
+    std::vector<uint64_t> allocated;
+    for (unsigned i = 0; i < top.size(); ++i) {
+	sites.push_back(frames.size());
+	for (StackTrace::const_iterator si = top[i]->first.begin();
+	     si != top[i]->first.end(); ++si) {
+	    if (si->getValue() == 0) {
+		continue;
+	    }
+	    frames.push_back(si->getValue());
+	    if (si->getValue() < data_header.addr_begin)
+		data_header.addr_begin = si->getValue();
+	    if (si->getValue() > data_header.addr_end)
+		data_header.addr_end = si->getValue();
+	}
+	frames.push_back(0);
+
+	const std::vector<uint64_t>& series = top[i]->second;
+	for (unsigned k = 0; k < buckets.size(); ++k) {
+	    allocated.push_back(k < series.size() ? series[k] : 0);
+	}
+    }
+
+    data.interval = usage.interval;
+    data.buckets.buckets_len = buckets.size();
+    data.buckets.buckets_val =
+	reinterpret_cast<CBTF_mem_usage_bucket*>(
+	    malloc(buckets.size() * sizeof(CBTF_mem_usage_bucket))
+	    );
+    memcpy(data.buckets.buckets_val, &buckets[0],
+	   buckets.size() * sizeof(CBTF_mem_usage_bucket));
+    data.stacktraces.stacktraces_len = frames.size();
+    data.stacktraces.stacktraces_val =
+	reinterpret_cast<uint64_t*>(
+	    malloc(std::max(static_cast<size_t>(1), frames.size())
+		   * sizeof(uint64_t))
+	    );
+    if (!frames.empty()) {
+	memcpy(data.stacktraces.stacktraces_val, &frames[0],
+	       frames.size() * sizeof(uint64_t));
+    }
+    data.sites.sites_len = sites.size();
+    data.sites.sites_val =
+	reinterpret_cast<uint32_t*>(
+	    malloc(std::max(static_cast<size_t>(1), sites.size())
+		   * sizeof(uint32_t))
+	    );
+    if (!sites.empty()) {
+	memcpy(data.sites.sites_val, &sites[0], sites.size() * sizeof(uint32_t));
+    }
+    data.site_allocated.site_allocated_len = allocated.size();
+    data.site_allocated.site_allocated_val =
+	reinterpret_cast<uint64_t*>(
+	    malloc(std::max(static_cast<size_t>(1), allocated.size())
+		   * sizeof(uint64_t))
+	    );
+    if (!allocated.empty()) {
+	memcpy(data.site_allocated.site_allocated_val, &allocated[0],
+	       allocated.size() * sizeof(uint64_t));
+    }
+
+#ifndef NDEBUG
+    if (is_trace_aggregator_events_enabled) {
+	std::cerr << "EMITTING memory usage data blob on datablob_xdr_out"
+	<< " data.buckets.buckets_len:" << data.buckets.buckets_len
+	<< " data.sites.sites_len:" << data.sites.sites_len
+	<< std::endl;
+    }
+#endif
+    emitOutput<boost::shared_ptr<CBTF_Protocol_Blob> >( "datablob_xdr_out",
+	    KrellInstitute::Messages::pack<CBTF_mem_usage_data>(
+	    pack_message, reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_usage_data))
+	    );
+}
+
 KRELL_INSTITUTE_CBTF_REGISTER_FACTORY_FUNCTION(MemAggregator)
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Declaration and definition of the ReductionAggregator component template.
+ *
+ */
+
+#ifndef _ReductionAggregator_
+#define _ReductionAggregator_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <KrellInstitute/CBTF/Component.hpp>
+#include <KrellInstitute/CBTF/Type.hpp>
+#include <KrellInstitute/CBTF/Version.hpp>
+#include <KrellInstitute/CBTF/Impl/MRNet.hpp>
+
+#include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/PerfData.hpp"
+#include "KrellInstitute/Core/ThreadName.hpp"
+#include "KrellInstitute/Messages/Blob.h"
+
+namespace KrellInstitute { namespace Core {
+
+    /**
+     * Base for components that reduce a mergeable summary of T up the tree.
+     *
+     * The leaf CPs decode their partial T from the performance data blobs
+     * on the "cbtf_protocol_blob" input and emit it once every thread they
+     * know about has terminated. The intermediate CPs and the frontend merge
+     * the partial T from each of their children and emit the result once
+     * every child has reported. Derived components supply the decoding,
+     * merging and size of T; T itself must provide printResults().
+     */
+    template <typename T>
+    class ReductionAggregator :
+	public KrellInstitute::CBTF::Component
+    {
+
+    protected:
+
+	/**
+	 * Constructor from the component type and port names.
+	 *
+	 * @param type         Type of the derived component.
+	 * @param input        Name of the input receiving partial T.
+	 * @param output       Name of the output emitting T.
+	 * @param print_env    Environment variable enabling printing at the
+	 *                     frontend.
+	 * @param debug_env    Environment variable enabling debug output.
+	 */
+	ReductionAggregator(const KrellInstitute::CBTF::Type& type,
+			    const std::string& input,
+			    const std::string& output,
+			    const char* print_env,
+			    const char* debug_env) :
+	    KrellInstitute::CBTF::Component(
+		type, KrellInstitute::CBTF::Version(0, 0, 1)
+		),
+	    dm_output(output),
+	    dm_print(getenv(print_env) != NULL),
+	    dm_debug(getenv(debug_env) != NULL),
+	    dm_data(),
+	    dm_perfdata(),
+	    dm_threadnames(),
+	    dm_handled(0),
+	    dm_terminated(0)
+	{
+	    declareInput<boost::shared_ptr<CBTF_Protocol_Blob> >(
+		"cbtf_protocol_blob",
+		boost::bind(&ReductionAggregator::blobHandler, this, _1)
+		);
+	    declareInput<T>(
+		input, boost::bind(&ReductionAggregator::partialHandler, this, _1)
+		);
+	    declareInput<ThreadNameVec>(
+		"threadnames",
+		boost::bind(&ReductionAggregator::threadnamesHandler, this, _1)
+		);
+	    declareInput<long>(
+		"numTerminatedIn",
+		boost::bind(&ReductionAggregator::numTerminatedHandler, this, _1)
+		);
+
+	    declareOutput<T>(output);
+	}
+
+	/** Decode any partial T carried by a performance data blob. */
+	virtual void decode(PerfData& perfdata, const Blob& blob, T& data) = 0;
+
+	/** Merge a partial T from a child into the local T. */
+	virtual void merge(T& data, const T& in) = 0;
+
+	/** Number of entries in a T, used for debug output. */
+	virtual std::size_t size(const T& data) const = 0;
+
+    private:
+
+	bool isFrontend() const
+	{
+	    return KrellInstitute::CBTF::Impl::TheTopologyInfo.IsFrontend;
+	}
+
+	bool isLeafCP() const
+	{
+	    return (!KrellInstitute::CBTF::Impl::TheTopologyInfo.IsFrontend &&
+		    KrellInstitute::CBTF::Impl::TheTopologyInfo.MaxLeafDistance == 1);
+	}
+
+	/** Handler for the "threadnames" input. */
+	void threadnamesHandler(const ThreadNameVec& in)
+	{
+	    dm_threadnames = in;
+	}
+
+	/** Handler for the "numTerminatedIn" input.
+	  * The leaf CPs emit their partial T once all known threads have
+	  * terminated since nothing further can arrive for them.
+	  */
+	void numTerminatedHandler(const long& in)
+	{
+	    if (in > 0) {
+		dm_terminated += static_cast<ThreadNameVec::size_type>(in);
+	    }
+
+	    if (isLeafCP() && !dm_threadnames.empty() &&
+		dm_terminated == dm_threadnames.size()) {
+#ifndef NDEBUG
+		if (dm_debug) {
+		    std::cerr << dm_output << " leaf EMIT size:"
+			      << size(dm_data) << std::endl;
+		}
+#endif
+		emitOutput<T>(dm_output, dm_data);
+	    }
+	}
+
+	/** Handler for the "cbtf_protocol_blob" input.
+	  * Only the leaf CPs decode performance data blobs.
+	  */
+	void blobHandler(const boost::shared_ptr<CBTF_Protocol_Blob>& in)
+	{
+	    if (!isLeafCP() || in->data.data_len == 0) {
+		return;
+	    }
+
+	    Blob perfdatablob(in->data.data_len, in->data.data_val);
+	    decode(dm_perfdata, perfdatablob, dm_data);
+	}
+
+	/** Handler for the partial T input.
+	  * Merges the partial T from each child and emits the result once
+	  * every child has reported.
+	  */
+	void partialHandler(const T& in)
+	{
+	    ++dm_handled;
+	    merge(dm_data, in);
+
+#ifndef NDEBUG
+	    if (dm_debug) {
+		std::cerr << dm_output << " handled:" << dm_handled
+			  << " expect:"
+			  << KrellInstitute::CBTF::Impl::TheTopologyInfo.NumChildren
+			  << " size:" << size(dm_data) << std::endl;
+	    }
+#endif
+
+	    if (dm_handled ==
+		KrellInstitute::CBTF::Impl::TheTopologyInfo.NumChildren) {
+		if (isFrontend() && dm_print) {
+		    dm_data.printResults();
+		}
+		emitOutput<T>(dm_output, dm_data);
+	    }
+	}
+
+	/** Name of the output emitting T. */
+	std::string dm_output;
+
+	/** Flag indicating if T is printed at the frontend. */
+	bool dm_print;
+
+	/** Flag indicating if debug output is enabled. */
+	bool dm_debug;
+
+	/** Partial T reduced at this node. */
+	T dm_data;
+
+	/** Decoder of performance data blobs at the leaf CPs. */
+	PerfData dm_perfdata;
+
+	/** Threads attached below this node. */
+	ThreadNameVec dm_threadnames;
+
+	/** Number of children that have reported. */
+	int dm_handled;
+
+	/** Number of attached threads that have terminated. */
+	ThreadNameVec::size_type dm_terminated;
+
+    };
+
+} } // namespace KrellInstitute::Core
+
+#endif
@@ -24,6 +24,7 @@
 #include <mrnet/MRNet.h>
 #include <typeinfo>
 #include <algorithm>
+#include <cmath>
 #include <sstream>
 
 #include <KrellInstitute/CBTF/Component.hpp>
@@ -35,6 +36,7 @@
 #include "KrellInstitute/Core/AddressBuffer.hpp"
 #include "KrellInstitute/Core/AddressRange.hpp"
 #include "KrellInstitute/Core/AddressSpace.hpp"
+#include "KrellInstitute/Core/AddressSpill.hpp"
 #if BFD_AVAILABLE_DPM
 #include "KrellInstitute/Core/BFDSymbols.hpp"
 #endif
@@ -131,6 +133,77 @@ typedef std::map<std::string,std::pair<ThreadName,uint64_t> > FunctionThreadCoun
 // mapping of function to total value and total number of threads.
 typedef std::map<std::string,std::pair<uint64_t,uint64_t> > FunctionAvgMap;
 
+// Distribution over threads of the value of a function along with the
+// threads holding the extreme values. Summaries are merged with the
+// pairwise mean/variance update of Chan et al. so each CP level only
+// forwards one entry per function regardless of the number of threads.
+struct FuncStats {
+    uint64_t num;
+    uint64_t min;
+    ThreadName min_thread;
+    uint64_t max;
+    ThreadName max_thread;
+    double mean;
+    double m2;
+
+    FuncStats()
+	: num(0), min(0), max(0), mean(0.0), m2(0.0)
+    {
+    };
+
+    FuncStats(const CBTF_Protocol_FunctionStatsValue& object)
+	: num(object.num), min(object.min), min_thread(object.min_thread),
+	  max(object.max), max_thread(object.max_thread),
+	  mean(object.mean), m2(object.m2)
+    {
+    };
+
+    void addValue(const ThreadName& t, const uint64_t& v)
+    {
+	FuncStats other;
+	other.num = 1;
+	other.min = other.max = v;
+	other.min_thread = other.max_thread = t;
+	other.mean = static_cast<double>(v);
+	merge(other);
+    };
+
+    void merge(const FuncStats& other)
+    {
+	if (other.num == 0) {
+	    return;
+	}
+	if (num == 0) {
+	    *this = other;
+	    return;
+	}
+
+	double n = static_cast<double>(num) + static_cast<double>(other.num);
+	double delta = other.mean - mean;
+	mean += delta * static_cast<double>(other.num) / n;
+	m2 += other.m2 + delta * delta *
+	    static_cast<double>(num) * static_cast<double>(other.num) / n;
+	num += other.num;
+
+	if (other.min < min) {
+	    min = other.min;
+	    min_thread = other.min_thread;
+	}
+	if (other.max > max) {
+	    max = other.max;
+	    max_thread = other.max_thread;
+	}
+    };
+
+    double stddev() const
+    {
+	return (num > 0) ? sqrt(m2 / static_cast<double>(num)) : 0.0;
+    };
+};
+
+// mapping of function to the distribution of its values over threads.
+typedef std::map<std::string,FuncStats> FunctionStatsMap;
+
 namespace {
 
     std::ostringstream debug_prefix;
@@ -160,6 +233,85 @@ bool is_time_symbol_events_enabled =
 bool is_show_metric_events_enabled =
     (getenv("CBTF_SHOW_METRIC_EVENTS") != NULL);
 
+/** Number of standard deviations from the mean beyond which an extreme
+ *  thread is reported as an outlier. Set with CBTF_METRIC_OUTLIER_SIGMA.
+ */
+double outlier_sigma = (getenv("CBTF_METRIC_OUTLIER_SIGMA") != NULL) ?
+    atof(getenv("CBTF_METRIC_OUTLIER_SIGMA")) : 3.0;
+
+/** Memory budget in megabytes for the address buffer of the leaf CP. The
+ *  AddressAggregator sends a buffer over budget as partial chunks, which
+ *  are spilled here under the same budget and directory.
+ */
+uint64_t memory_budget = (getenv("CBTF_AGGR_MEMORY_BUDGET") != NULL) ?
+    strtoull(getenv("CBTF_AGGR_MEMORY_BUDGET"), NULL, 10) * 1024 * 1024 : 0;
+
+/** Node local directory holding the spilled runs. */
+std::string spill_directory =
+    (getenv("CBTF_AGGR_SPILL_DIR") != NULL) ? getenv("CBTF_AGGR_SPILL_DIR") :
+    (getenv("TMPDIR") != NULL) ? getenv("TMPDIR") : "/tmp";
+
+    // Convert a map of function statistics to the protocol message.
+    boost::shared_ptr<CBTF_Protocol_FunctionStatsValues>
+    makeStatsValues(const FunctionStatsMap& stats)
+    {
+	CBTF_Protocol_FunctionStatsValues statsVals;
+	statsVals.values.values_len = stats.size();
+	statsVals.values.values_val =
+	    reinterpret_cast<CBTF_Protocol_FunctionStatsValue*>(
+		malloc(std::max(1U, statsVals.values.values_len) *
+		       sizeof(CBTF_Protocol_FunctionStatsValue)));
+	int i = 0;
+	for(FunctionStatsMap::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+	    CBTF_Protocol_FunctionStatsValue entry;
+	    entry.function = strdup((*it).first.c_str());
+	    entry.num = (*it).second.num;
+	    entry.min = (*it).second.min;
+	    entry.min_thread = (*it).second.min_thread;
+	    entry.max = (*it).second.max;
+	    entry.max_thread = (*it).second.max_thread;
+	    entry.mean = (*it).second.mean;
+	    entry.m2 = (*it).second.m2;
+	    statsVals.values.values_val[i] = entry;
+	    ++i;
+	}
+	return boost::make_shared<CBTF_Protocol_FunctionStatsValues>(statsVals);
+    }
+
+    // Show the function statistics along with any outlier threads.
+    void printStatsValues(const FunctionStatsMap& stats)
+    {
+	std::stringstream demo_output;
+	for(FunctionStatsMap::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+	    double stddev = (*it).second.stddev();
+	    double maxval = static_cast<double>((*it).second.max);
+	    double minval = static_cast<double>((*it).second.min);
+	    demo_output << "Stats: "
+	    << " function:" << (*it).first
+	    << " threads:" << (*it).second.num
+	    << " min:" << (*it).second.min
+	    << " max:" << (*it).second.max
+	    << " mean:" << (*it).second.mean
+	    << " stddev:" << stddev
+	    << " imbalance:"
+	    << ((maxval > 0.0) ? 100.0 * (maxval - (*it).second.mean) / maxval : 0.0)
+	    << "%" << std::endl;
+	    if (stddev > 0.0 && (maxval - (*it).second.mean) > outlier_sigma * stddev) {
+		demo_output << "Stats: "
+		<< " function:" << (*it).first
+		<< " outlier thread:" << (*it).second.max_thread
+		<< " max:" << (*it).second.max << std::endl;
+	    }
+	    if (stddev > 0.0 && ((*it).second.mean - minval) > outlier_sigma * stddev) {
+		demo_output << "Stats: "
+		<< " function:" << (*it).first
+		<< " outlier thread:" << (*it).second.min_thread
+		<< " min:" << (*it).second.min << std::endl;
+	    }
+	}
+	std::cout << demo_output.str();
+    }
+
 
 /** count indicating number of leaf CP's in mrnet tree. */
     int num_leafcp = 0;
@@ -169,6 +321,8 @@ bool is_show_metric_events_enabled =
     int min_msgs = 0;
 /** count indicating number of avg value messages to expect at FE. */
     int avg_msgs = 0;
+/** count indicating number of stats value messages to expect at FE. */
+    int stats_msgs = 0;
 /** count indicating number of linkedobjectvec messages to expect at FE. */
     int lov_msgs = 0;
     int lovmap_msgs = 0;
@@ -228,6 +382,8 @@ bool is_show_metric_events_enabled =
  * Currently max,min,avg (loadbalance at function level).
  * The max,min map a function name symbol to a thread and value.
  * The avg is a map of function name symbol to total value and thread count.
+ * The stats map a function name symbol to a mergeable summary of the
+ * per thread values (count,min,max,mean,variance and the extreme threads).
  */
 class __attribute__ ((visibility ("hidden"))) ResolveSymbols :
     public Component
@@ -247,7 +403,8 @@ private:
 
     /** Default constructor. */
     ResolveSymbols() :
-        Component(Type(typeid(ResolveSymbols)), Version(0, 0, 1))
+        Component(Type(typeid(ResolveSymbols)), Version(0, 0, 1)),
+        spill(spill_directory, memory_budget)
     {
         num_leafcp = 0;
 
@@ -296,6 +453,9 @@ private:
         declareInput<boost::shared_ptr<CBTF_Protocol_FunctionAvgValues> >(
             "avgfunctionvalues", boost::bind(&ResolveSymbols::AvgFunctionValuesHandler, this, _1)
             );
+        declareInput<boost::shared_ptr<CBTF_Protocol_FunctionStatsValues> >(
+            "statsfunctionvalues", boost::bind(&ResolveSymbols::StatsFunctionValuesHandler, this, _1)
+            );
         declareInput<boost::shared_ptr<CBTF_Protocol_SymbolTable> >(
             "symboltable_xdr_in", boost::bind(&ResolveSymbols::CbtfProtocolSymbolTableHandler, this, _1)
             );
@@ -319,6 +479,9 @@ private:
 	declareOutput<boost::shared_ptr<CBTF_Protocol_FunctionAvgValues> >(
 	    "avgfunctionvalues_xdr_out"
 	    );
+	declareOutput<boost::shared_ptr<CBTF_Protocol_FunctionStatsValues> >(
+	    "statsfunctionvalues_xdr_out"
+	    );
     }
 
     // passed from client FE to indicate number of ltwt BE's to expect.
@@ -717,6 +880,58 @@ private:
 #endif
     }
 
+
+    /** Handler for the "statsfunctionvalues" input.*/
+    // This does NOT run on the leafCP nodes.  It is a reduction handler.
+    // The summaries from the children of this node are merged per function
+    // and the result is emitted once every child has reported.
+    void StatsFunctionValuesHandler(const boost::shared_ptr<CBTF_Protocol_FunctionStatsValues>& in)
+    {
+        init_TopologyInfo();
+#ifndef NDEBUG
+	std::stringstream output;
+	DEBUGPREFIX(Impl::TheTopologyInfo.IsFrontend,Impl::TheTopologyInfo.MaxLeafDistance);
+#endif
+
+	++stats_msgs;
+
+	CBTF_Protocol_FunctionStatsValues *message = in.get();
+#ifndef NDEBUG
+        if (is_trace_symbol_events_enabled) {
+	    output << debug_prefix.str()
+	    << "ENTERED ResolveSymbols::StatsFunctionValuesHandler"
+	    << " num values " << message->values.values_len
+	    << " num msgs " << stats_msgs
+	    << " numChildren:" << getNumChildren()
+	    << std::endl;
+	    flushOutput(output);
+	}
+#endif
+
+	for(int i=0; i<message->values.values_len; ++i) {
+	    std::string f(message->values.values_val[i].function);
+	    statsvals[f].merge(FuncStats(message->values.values_val[i]));
+	}
+
+	if (stats_msgs == getNumChildren()) {
+	    // This output is for demo purposes.
+	    if (isFrontend() && is_show_metric_events_enabled) {
+		printStatsValues(statsvals);
+	    }
+
+	    // EMIT final merged stats values for ICP or FE.
+#ifndef NDEBUG
+	    if (is_trace_symbol_events_enabled) {
+		output << debug_prefix.str()
+		<< "ResolveSymbols::StatsFunctionValuesHandler: EMIT statsfunctionvalues_xdr_out" << std::endl;
+		flushOutput(output);
+	    }
+#endif
+	    emitOutput<boost::shared_ptr<CBTF_Protocol_FunctionStatsValues> >("statsfunctionvalues_xdr_out",makeStatsValues(statsvals));
+	}
+    }
+
+
     /** Handler for the "abuffer" input.*/
     // Is this only needed for the leafCPs. All other levels of the
     // tree should not need the buffer directly with regards to the
@@ -748,13 +963,84 @@ private:
 	    flushOutput(output);
 	}
 #endif
-	abuffer = in;
+	// A spilled buffer arrives as chunks of disjoint addresses, all
+	// but the last of which are partial. The chunks are spilled again
+	// here and resolved one at a time by finishedHandler, once the
+	// linked objects are known, rather than merged back into the
+	// complete buffer.
+	if ((in.partial || spill.getRunCount() > 0) && spill.isEnabled()) {
+	    AddressBuffer chunk(in);
+	    spill.spill(chunk);
+	    abuffer.addresscounts.insert(chunk.addresscounts.begin(),
+					 chunk.addresscounts.end());
+	} else if (abuffer.partial) {
+	    abuffer.addresscounts.insert(in.addresscounts.begin(),
+					 in.addresscounts.end());
+	} else {
+	    abuffer = in;
+	}
+	abuffer.partial = in.partial;
 
 #ifndef NDEBUG
 	//flushOutput(output);
 #endif
     }
 
+    // Add the linked objects holding the addresses of a chunk of the
+    // address buffer to symtabmap and the functions and statements at
+    // those addresses to their symbol tables.
+    void resolveChunk(const AddressBuffer& chunk, SymtabAPISymbols& stapi_symbols)
+    {
+#ifndef NDEBUG
+	std::stringstream output;
+#endif
+	AddressCounts ac = chunk.addresscounts;
+	std::set<AddressRange> ranges;
+	for (AddressCounts::const_iterator aci = ac.begin(); aci != ac.end(); ++aci) {
+	    bool foundit = false;
+	    for (LinkedObjectEntryVec::iterator li = linkedobjectvec.begin(); li != linkedobjectvec.end(); ++li) {
+		AddressRange addr_range(li->addr_begin,li->addr_end);
+		if (addr_range.doesContain(aci->first) ) {
+		    symtabmap.insert(std::make_pair(addr_range,
+				 std::make_pair(addr_range, *li )
+				));
+		    ranges.insert(addr_range);
+		    foundit = true;
+		    break;
+		}
+	    }
+
+	    if(!foundit) {
+#ifndef NDEBUG
+        	if (is_debug_symbol_events_enabled) {
+		    output << debug_prefix.str()
+		        << "ResolveSymbols::finishedHandler: CANNOT RESOLVE symbols for address "
+			<< aci->first  << std::endl;
+		}
+#endif
+	    }
+	}
+
+	// Find the functions and statements in the linked objects this
+	// chunk has addresses in.
+	for (std::set<AddressRange>::iterator ri = ranges.begin(); ri != ranges.end(); ++ri) {
+	    SymbolTableMap::iterator ii = symtabmap.find(*ri);
+	    LinkedObjectEntry le = ii->second.second;
+#ifndef NDEBUG
+            if (is_debug_symbol_events_enabled) {
+	        output << debug_prefix.str()
+		<< "ResolveSymbols::finishedHandler: resolve symbols for " << le.path
+			<< std::endl;
+	    }
+#endif
+	    stapi_symbols.getSymbols(chunk,le,ii->second.first);
+	}
+
+#ifndef NDEBUG
+	flushOutput(output);
+#endif
+    }
+
     /** Handler for the "threadaddrbufmap" input.*/
     // Local to leafCP nodes and provides a mapping of threads
     // to addressbuffers with counts. This should be a no-op at
@@ -1084,58 +1370,34 @@ private:
 	    return;
 	}
 
-	AddressCounts ac = abuffer.addresscounts;
 #ifndef NDEBUG
 	if (is_debug_symbol_events_enabled) {
             output << debug_prefix.str()
                 << "ResolveSymbols::finishedHandler"
-	        << " addresses:" << ac.size()
+	        << " addresses:" << abuffer.addresscounts.size()
+	        << " spilled runs:" << spill.getRunCount()
 	        << " symtabmap:" << symtabmap.size()
 	        << " linkedobjects:" << linkedobjectvec.size()
 		<< std::endl;
 	    flushOutput(output);
 	}
 #endif
-	for (AddressCounts::const_iterator aci = ac.begin(); aci != ac.end(); ++aci) {
-	    bool foundit = false;
-	    for (LinkedObjectEntryVec::iterator li = linkedobjectvec.begin(); li != linkedobjectvec.end(); ++li) {
-		AddressRange addr_range(li->addr_begin,li->addr_end);
-		if (addr_range.doesContain(aci->first) ) {
-		    symtabmap.insert(std::make_pair(addr_range,
-				 std::make_pair(addr_range, *li )
-				));
-		    foundit = true;
-		    break;
-		}
-	    }
-
-	    if(!foundit) {
-#ifndef NDEBUG
-        	if (is_debug_symbol_events_enabled) {
-		    output << debug_prefix.str()
-		        << "ResolveSymbols::finishedHandler: CANNOT RESOLVE symbols for address "
-			<< aci->first  << std::endl;
-		}
-#endif
-	    }
-	}
 
-	// Now cycle through these symboltables and find functions and statements.
+	// Resolve the buffer one chunk at a time into the symbol tables of
+	// symtabmap. Without spilled runs the whole buffer is one chunk.
 	SymtabAPISymbols stapi_symbols;
+	AddressBuffer chunk;
+	bool more = true;
+	while (more) {
+	    more = spill.next(abuffer, chunk);
+	    resolveChunk(chunk, stapi_symbols);
+	}
 
+	// Now cycle through these symboltables and emit them.
 	for(SymbolTableMap::iterator ii = symtabmap.begin(); ii != symtabmap.end(); ++ii)
 	{
 	    LinkedObjectEntry le = ii->second.second;
-	    SymbolTable st = ii->first;
-#ifndef NDEBUG
-            if (is_debug_symbol_events_enabled) {
-	        output << debug_prefix.str()
-		<< "ResolveSymbols::finishedHandler: resolve symbols for " << le.path
-			<< std::endl;
-	    }
-#endif
-
-	    stapi_symbols.getSymbols(abuffer,le,st);
+	    SymbolTable& st = ii->second.first;
 
 	    CBTF_Protocol_SymbolTable pst;
 	    pst = st;
@@ -1263,6 +1525,7 @@ private:
 
 	FunctionThreadCount maxfuncs;
 	FunctionThreadCount minfuncs;
+	FunctionStatsMap statsfuncs;
 	std::set<std::string>::const_iterator f;
 	for (std::set<std::string>::const_iterator f = functions.begin(); f != functions.end(); ++f) {
 	    for(FuncStatsVec::iterator fit = fstatvec.begin(); fit != fstatvec.end(); ++fit) {
@@ -1272,6 +1535,8 @@ private:
 		}
 		if (*f == (*fit).funcname) {
 		    std::pair<ThreadName,uint64_t> fts = std::make_pair((*fit).tname,(*fit).value);
+		    // handle STATS.
+		    statsfuncs[*f].addValue((*fit).tname,(*fit).value);
 		    // handle MAX.
 		    FunctionThreadCount::iterator it = maxfuncs.find(*f);
 		    if ( it == maxfuncs.end() ) {
@@ -1335,13 +1600,14 @@ private:
 #ifndef NDEBUG
 	if (is_trace_symbol_events_enabled) {
 	    output << debug_prefix.str()
-		<< "ResolveSymbols::finishedHandler: EMIT max,min,avg functionvalues_xdr_out" << std::endl;
+		<< "ResolveSymbols::finishedHandler: EMIT max,min,avg,stats functionvalues_xdr_out" << std::endl;
 	    flushOutput(output);
 	}
 #endif
 	emitOutput<boost::shared_ptr<CBTF_Protocol_FunctionThreadValues> >("maxfunctionvalues_xdr_out",maxvals_xdr);
 	emitOutput<boost::shared_ptr<CBTF_Protocol_FunctionThreadValues> >("minfunctionvalues_xdr_out",minvals_xdr);
 	emitOutput<boost::shared_ptr<CBTF_Protocol_FunctionAvgValues> >("avgfunctionvalues_xdr_out",avgvals_xdr);
+	emitOutput<boost::shared_ptr<CBTF_Protocol_FunctionStatsValues> >("statsfunctionvalues_xdr_out",makeStatsValues(statsfuncs));
 	
 #ifndef NDEBUG
 	if (is_time_symbol_events_enabled) {
@@ -1481,11 +1747,13 @@ private:
     LinkedObjectEntryVec linkedobjectvec;
     AddressSpace addressspace;
     AddressBuffer abuffer;
+    AddressSpill spill;
     FuncStatsVec fstatvec;
     ThreadAddrBufMap threadAddrBufMap;
     FunctionThreadCount maxvals;
     FunctionThreadCount minvals;
     FunctionAvgMap avgvals;
+    FunctionStatsMap statsvals;
 
 }; // class ResolveSymbols
 
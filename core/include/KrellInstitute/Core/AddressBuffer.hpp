@@ -36,15 +36,47 @@ namespace KrellInstitute { namespace Core {
 
     typedef std::map<Address, uint64_t> AddressCounts;
 
+    /**
+     * Unique addresses and their counts.
+     *
+     * A buffer can optionally be used as a top-K sketch by merging with
+     * mergeSketch() and bounding its size with truncate(). The counts of the
+     * retained addresses are then lower bounds, with addresserrors holding
+     * the most that each one may be missing. Any address that isn't retained
+     * has a count of at most missing. The counts of the dropped addresses
+     * are accumulated so that the total count of the buffer remains exact.
+     *
+     * A buffer too large to be held in memory is sent as a sequence of
+     * chunks holding disjoint address ranges. Every chunk but the last is
+     * marked as partial.
+     */
     class AddressBuffer {
 
 	public:
 
 	AddressCounts addresscounts;
 
+	/** Upper bound of the count missing from each retained address. */
+	AddressCounts addresserrors;
+
+	/** Upper bound of the count of any address that isn't retained. */
+	uint64_t missing;
+
+	/** Total count of the addresses dropped by truncate(). */
+	uint64_t dropped;
+
+	/** More chunks of this buffer follow. */
+	bool partial;
+
+	AddressBuffer() : missing(0), dropped(0), partial(false) { }
+
 	bool updateAddressCounts(uint64_t, uint64_t);
 	bool updateAddressCounts(AddressBuffer&);
 	bool updateAddressCounts(AddressCounts&);
+	void mergeSketch(const AddressBuffer&);
+	void truncate(unsigned);
+	uint64_t getError(const Address&) const;
+	uint64_t getTotalCount() const;
 	void printResults() const;
 
 	AddressCounts  getAddressCounts() {
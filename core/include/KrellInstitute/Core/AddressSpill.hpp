@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the AddressSpill class.
+ *
+ */
+#ifndef _KrellInsitute_Core_AddressSpill_
+#define _KrellInsitute_Core_AddressSpill_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "KrellInstitute/Core/AddressBuffer.hpp"
+
+
+namespace KrellInstitute { namespace Core {
+
+    /**
+     * Memory budget for the counts of an address buffer.
+     *
+     * Once the buffer holds more addresses than the budget allows, its counts
+     * are written as a sorted run of (address, count) pairs to a file in the
+     * spill directory and the buffer is emptied. The runs and whatever is
+     * left in the buffer are combined with a k-way merge, either into the
+     * complete buffer or streamed out in chunks no larger than the budget
+     * so that the complete buffer is never held in memory. The files are
+     * unlinked as soon as they are created so nothing is left behind if
+     * the process dies. At most MaxRuns runs are kept, merging them into
+     * one when the limit is reached. A budget of zero never spills.
+     */
+    class AddressSpill {
+
+	public:
+
+	AddressSpill(const std::string&, uint64_t);
+	~AddressSpill();
+
+	bool isEnabled() const {
+	    return budget > 0;
+	}
+
+	unsigned getRunCount() const {
+	    return runs.size();
+	}
+
+	void update(AddressBuffer&);
+	void spill(AddressBuffer&);
+	void merge(AddressBuffer&);
+	bool next(AddressBuffer&, AddressBuffer&);
+
+	/** Number of runs at which they are merged into one. */
+	enum { MaxRuns = 64 };
+
+	private:
+
+	class Merger;
+
+	FILE* create();
+	void closeRuns();
+
+	AddressSpill(const AddressSpill&);
+	AddressSpill& operator=(const AddressSpill&);
+
+	/** Directory holding the runs. */
+	std::string directory;
+
+	/** Number of addresses a buffer may hold before it is spilled. */
+	uint64_t budget;
+
+	/** Open run files, each positioned at its start. */
+	std::vector<FILE*> runs;
+
+	/** Merge in progress while the buffer is streamed out in chunks. */
+	Merger* merger;
+
+    };
+
+} }
+#endif
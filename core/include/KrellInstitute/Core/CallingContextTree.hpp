@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the mergeable calling context tree.
+ *
+ */
+#ifndef _KrellInsitute_Core_CallingContextTree_
+#define _KrellInsitute_Core_CallingContextTree_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /** One calling context: an address reached through its parent's path. */
+    struct CCTNode {
+	uint64_t pc;      /**< Address of the frame. */
+	uint32_t parent;  /**< Index of the caller or NoParent for a root. */
+	uint64_t count;   /**< Cost with this node as the top of stack. */
+
+	CCTNode(uint64_t p, uint32_t par) : pc(p), parent(par), count(0) {
+	};
+    };
+
+    /**
+     * Calling context tree.
+     *
+     * Stacks are stored as paths of nodes indexed from 0, each naming the
+     * index of its caller. Parents always precede their children, so the
+     * node arrays are also the serialized form sent between tree levels
+     * and merging another tree is one pass over its nodes. The size of a
+     * tree is the number of unique call paths below it, regardless of how
+     * many samples or events were folded into it.
+     */
+    class CallingContextTree {
+
+	public:
+
+	static const uint32_t NoParent = ~0U;
+
+	std::vector<CCTNode> nodes;
+
+	uint32_t addNode(uint32_t, uint64_t);
+	void addStack(const uint64_t*, unsigned, uint64_t);
+	void addTree(unsigned, const uint64_t*, const uint32_t*,
+		     const uint64_t*);
+	void addTree(unsigned, const uint64_t*, const uint32_t*,
+		     const uint32_t*, uint64_t);
+	void merge(const CallingContextTree&);
+	uint64_t getTotalCount() const;
+	void printResults() const;
+
+	private:
+
+	/** Index of each child indexed by (parent index, address). */
+	std::map<std::pair<uint32_t,uint64_t>, uint32_t> children;
+
+    };
+
+} }
+#endif
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the rank-to-rank communication matrix.
+ *
+ */
+#ifndef _KrellInsitute_Core_CommMatrix_
+#define _KrellInsitute_Core_CommMatrix_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "KrellInstitute/Messages/Mpi_data.h"
+#include <map>
+#include <utility>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /** Totals for the messages sent from one rank to another. */
+    struct CommMatrixCell {
+	uint64_t count;  /**< Number of messages. */
+	uint64_t bytes;  /**< Number of bytes. */
+	uint64_t time;   /**< Total time spent in the sends. */
+	uint64_t histogram[CBTF_MPI_COMM_HISTOGRAM_SIZE]; /**< Binned sends. */
+
+	CommMatrixCell() : count(0), bytes(0), time(0) {
+	    for (int i = 0; i < CBTF_MPI_COMM_HISTOGRAM_SIZE; ++i)
+		histogram[i] = 0;
+	};
+    };
+
+    /** Sparse matrix cells indexed by (source, destination) rank. */
+    typedef std::map<std::pair<int,int>, CommMatrixCell> CommMatrixCells;
+
+    class CommMatrix {
+
+	public:
+
+	CommMatrixCells cells;
+
+	void updateCommMatrix(int, const CBTF_mpi_comm_row_data&);
+	void updateCommMatrix(int, int, const CommMatrixCell&);
+	void updateCommMatrix(const CommMatrix&);
+	void printResults() const;
+
+	private:
+
+    };
+
+} }
+#endif
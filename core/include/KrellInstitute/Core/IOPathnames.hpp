@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the decoder for pathnames interned by the iot collector.
+ *
+ */
+#ifndef _KrellInsitute_Core_IOPathnames_
+#define _KrellInsitute_Core_IOPathnames_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "KrellInstitute/Core/ThreadName.hpp"
+#include "KrellInstitute/Messages/IO_data.h"
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /**
+     * Pathnames interned by the iot collector.
+     *
+     * The iot collector sends each distinct pathname once per thread and
+     * records only its path ID in the events. This keeps the pathnames seen
+     * so far for each thread so that the path IDs in later blobs from that
+     * thread can be resolved. Blobs from a thread must be added in the order
+     * they were sent.
+     */
+    class IOPathnames {
+
+	public:
+
+	void update(const ThreadName&, const CBTF_io_exttrace_data&);
+	std::string getPathname(const ThreadName&, uint16_t) const;
+
+	private:
+
+	/** Pathnames of each thread indexed by path ID. */
+	std::map<ThreadName, std::vector<std::string> > pathnames;
+
+    };
+
+} }
+#endif
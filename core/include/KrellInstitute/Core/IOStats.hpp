@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the per file I/O statistics.
+ *
+ */
+#ifndef _KrellInsitute_Core_IOStats_
+#define _KrellInsitute_Core_IOStats_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "KrellInstitute/Messages/IO_data.h"
+#include <map>
+#include <string>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /** Totals for the I/O done on one file. */
+    struct IOStatsFile {
+	uint64_t read_calls;   /**< Number of read calls. */
+	uint64_t read_bytes;   /**< Number of bytes read. */
+	uint64_t read_time;    /**< Total time spent in read calls. */
+	uint64_t write_calls;  /**< Number of write calls. */
+	uint64_t write_bytes;  /**< Number of bytes written. */
+	uint64_t write_time;   /**< Total time spent in write calls. */
+	uint64_t other_calls;  /**< Number of other calls. */
+	uint64_t other_time;   /**< Total time spent in other calls. */
+	uint64_t sequential;   /**< Number of sequential reads and writes. */
+	uint64_t random;       /**< Number of random reads and writes. */
+	uint64_t histogram[CBTF_IO_STATS_HISTOGRAM_SIZE]; /**< Binned calls. */
+
+	IOStatsFile() : read_calls(0), read_bytes(0), read_time(0),
+			write_calls(0), write_bytes(0), write_time(0),
+			other_calls(0), other_time(0),
+			sequential(0), random(0) {
+	    for (int i = 0; i < CBTF_IO_STATS_HISTOGRAM_SIZE; ++i)
+		histogram[i] = 0;
+	};
+    };
+
+    /** Per file totals indexed by pathname. */
+    typedef std::map<std::string, IOStatsFile> IOStatsFiles;
+
+    /**
+     * Per file I/O statistics.
+     *
+     * Sums the per file descriptor statistics sent by the iot collector (in
+     * CBTF_IO_STATS mode) by the pathname of each file, regardless of the
+     * file descriptor, thread or process that did the I/O.
+     */
+    class IOStats {
+
+	public:
+
+	IOStatsFiles files;
+
+	void update(const CBTF_io_stats_data&);
+	void update(const std::string&, const IOStatsFile&);
+	void update(const IOStats&);
+	void printResults() const;
+
+	private:
+
+    };
+
+} }
+#endif
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the per kernel Kokkos timings.
+ *
+ */
+#ifndef _KrellInsitute_Core_KokkosKernels_
+#define _KrellInsitute_Core_KokkosKernels_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "KrellInstitute/Messages/Kokkos_data.h"
+#include <map>
+#include <string>
+#include <utility>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /** Timings of all the launches of one kernel (or profile region). */
+    struct KokkosKernelStats {
+	uint64_t calls;       /**< Number of launches. */
+	uint64_t total_time;  /**< Total time spent in the kernel. */
+	uint64_t min_time;    /**< Shortest launch. */
+	uint64_t max_time;    /**< Longest launch. */
+
+	KokkosKernelStats() : calls(0), total_time(0),
+			      min_time(UINT64_MAX), max_time(0) {
+	};
+    };
+
+    /** Per kernel timings indexed by (kernel type, kernel name). */
+    typedef std::map<std::pair<int, std::string>, KokkosKernelStats>
+	KokkosKernelTimings;
+
+    /**
+     * Per kernel Kokkos timings.
+     *
+     * Sums the kernel timings sent by the overview Kokkos connector by
+     * kernel type and name, regardless of the thread or process that
+     * launched the kernel.
+     */
+    class KokkosKernels {
+
+	public:
+
+	KokkosKernelTimings kernels;
+
+	void update(const CBTF_kokkos_data&);
+	void update(int, const std::string&, const KokkosKernelStats&);
+	void update(const KokkosKernels&);
+	void printResults() const;
+
+	private:
+
+    };
+
+} }
+#endif
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the per lock contention statistics.
+ *
+ */
+#ifndef _KrellInsitute_Core_LockContention_
+#define _KrellInsitute_Core_LockContention_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "KrellInstitute/Messages/Ompt_data.h"
+#include "KrellInstitute/Messages/Pthreads_data.h"
+#include "KrellInstitute/Core/StackTrace.hpp"
+#include <map>
+#include <utility>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /** Totals for one mutex acquired at one call site. */
+    struct LockContentionStats {
+	uint64_t acquisitions;     /**< Number of times the mutex was acquired. */
+	uint64_t failed_trylocks;  /**< Number of trylocks finding it locked. */
+	uint64_t wait_time;        /**< Total time spent acquiring the mutex. */
+	uint64_t max_wait_time;    /**< Longest time spent acquiring it. */
+	uint64_t hold_time;        /**< Total time the mutex was held. */
+	uint64_t max_hold_time;    /**< Longest time the mutex was held. */
+	uint64_t histogram[CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE]; /**< Binned waits. */
+
+	LockContentionStats() : acquisitions(0), failed_trylocks(0),
+				wait_time(0), max_wait_time(0),
+				hold_time(0), max_hold_time(0) {
+	    for (int i = 0; i < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE; ++i)
+		histogram[i] = 0;
+	};
+    };
+
+    /** Per lock totals indexed by (mutex address, call site). */
+    typedef std::map<std::pair<uint64_t, StackTrace>, LockContentionStats>
+	LockContentionLocks;
+
+    /**
+     * Per lock contention statistics.
+     *
+     * Sums the statistics sent by the pthreads collector (in
+     * CBTF_PTHREAD_CONTENTION mode) and the OpenMP mutex statistics sent by
+     * the omptp collector by mutex and acquiring call site, regardless of the
+     * thread or process that acquired the mutex. OpenMP mutexes are keyed by
+     * their OMPT wait identifier and their call site is a single frame.
+     */
+    class LockContention {
+
+	public:
+
+	LockContentionLocks locks;
+
+	void update(const CBTF_pthreads_contention_data&);
+	void update(const CBTF_ompt_mutex_data&);
+	void update(uint64_t, const StackTrace&, const LockContentionStats&);
+	void update(const LockContention&);
+	void printResults() const;
+
+	private:
+
+    };
+
+} }
+#endif
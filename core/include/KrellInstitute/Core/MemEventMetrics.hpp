@@ -30,6 +30,7 @@
 
 #include "KrellInstitute/Core/AddressBuffer.hpp"
 #include "KrellInstitute/Core/Address.hpp"
+#include "KrellInstitute/Core/MemUsage.hpp"
 #include "KrellInstitute/Core/Time.hpp"
 #include "KrellInstitute/Core/TimeInterval.hpp"
 #include "KrellInstitute/Messages/Mem_data.h"
@@ -130,12 +131,34 @@ namespace KrellInstitute { namespace Core {
     typedef std::vector<MemEvent> MemEventVec;
     typedef std::map<StackTrace,int> StackCountsMap;
 
+    /**
+     * Allocation size histogram of a call site, as sent by the mem collector
+     * in CBTF_MEM_HISTOGRAM mode. See CBTF_mem_size_histogram.
+     */
+    struct MemSizeHistogram {
+	uint64_t calls;  /**< Number of calls, including frees. */
+	uint64_t time;   /**< Total time spent in the calls. */
+	uint64_t count[CBTF_MEM_HISTOGRAM_SIZE]; /**< Allocations in each bin. */
+	uint64_t bytes[CBTF_MEM_HISTOGRAM_SIZE]; /**< Bytes in each bin. */
+
+	MemSizeHistogram() : calls(0), time(0) {
+	    for (int i = 0; i < CBTF_MEM_HISTOGRAM_SIZE; ++i) {
+		count[i] = 0;
+		bytes[i] = 0;
+	    }
+	};
+    };
+
+    typedef std::map<StackTrace,MemSizeHistogram> StackMemSizeHistogramMap;
+
     struct MemMetrics {
 	AddressCounts allocationSizes;
 	AddressMemEventMap addrMemEvent;
 	MemEventVec  eventsOfInterest;
 	StackCountsMap stackCounts;
 	StackMemEventMap stackMemEvents;
+	StackMemSizeHistogramMap sizeHistograms;
+	MemUsage usage;
 	uint64_t highwater;
 	uint64_t currentAllocation;
 	int totalAllocations;
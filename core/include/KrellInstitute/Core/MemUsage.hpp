@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the memory usage time series.
+ *
+ */
+#ifndef _KrellInsitute_Core_MemUsage_
+#define _KrellInsitute_Core_MemUsage_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "KrellInstitute/Core/StackTrace.hpp"
+#include "KrellInstitute/Messages/Mem_data.h"
+#include <map>
+#include <vector>
+
+
+namespace KrellInstitute { namespace Core {
+
+    /** Usage during one bucket of time. See CBTF_mem_usage_bucket. */
+    struct MemUsageBucket {
+	uint64_t live;         /**< Bytes allocated at the end of the bucket. */
+	uint64_t peak;         /**< Most bytes allocated during the bucket. */
+	uint64_t allocated;    /**< Bytes allocated during the bucket. */
+	uint64_t freed;        /**< Bytes freed during the bucket. */
+	uint64_t allocations;  /**< Calls that allocated memory. */
+	uint64_t frees;        /**< Calls that freed memory. */
+
+	MemUsageBucket(uint64_t l = 0) : live(l), peak(l), allocated(0),
+					 freed(0), allocations(0), frees(0) {
+	};
+    };
+
+    /** Bytes allocated by each call site in each bucket. */
+    typedef std::map<StackTrace, std::vector<uint64_t> > StackMemUsageMap;
+
+    /**
+     * Memory usage time series of a thread.
+     *
+     * Updated with the bytes allocated by the thread after each of its mem
+     * events, in time order. The series holds at most CBTF_MEM_USAGE_SIZE
+     * buckets. When an event falls past the last one, the width of the
+     * buckets doubles and adjacent pairs are merged, so the series covers
+     * the whole run at a bounded size without knowing its length. A zero
+     * interval disables the series.
+     */
+    class MemUsage {
+
+	public:
+
+	uint64_t begin;     /**< Start time of the first bucket. */
+	uint64_t interval;  /**< Width of each bucket. */
+	std::vector<MemUsageBucket> buckets;
+	StackMemUsageMap sites;
+
+	MemUsage() : begin(0), interval(0), live(0) {
+	};
+
+	void update(uint64_t, uint64_t, const StackTrace&);
+	std::vector<StackMemUsageMap::const_iterator> getTopSites(unsigned) const;
+	void printResults() const;
+
+	private:
+
+	void coarsen();
+
+	/** Bytes allocated after the last update. */
+	uint64_t live;
+
+    };
+
+} }
+#endif
@@ -49,7 +49,8 @@ namespace KrellInstitute { namespace Core {
 	void aggregateAddressCounts(const unsigned int&,
 				    const uint64_t *,
 				    const uint8_t*,
-			 	    AddressBuffer&) const;
+			 	    AddressBuffer&,
+				    const uint64_t& weight = 1) const;
     };
     
 } }
@@ -28,6 +28,9 @@
 #include "config.h"
 #endif
 
+#include <boost/shared_ptr.hpp>
+#include <string>
+
 #include "KrellInstitute/Messages/Blob.h"
 #include "KrellInstitute/Messages/DataHeader.h"
 #include "KrellInstitute/Messages/Address.h"
@@ -44,6 +47,12 @@
 #include "KrellInstitute/Messages/ThreadEvents.h"
 #include "KrellInstitute/Core/AddressBuffer.hpp"
 #include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Core/CallingContextTree.hpp"
+#include "KrellInstitute/Core/CommMatrix.hpp"
+#include "KrellInstitute/Core/IOPathnames.hpp"
+#include "KrellInstitute/Core/IOStats.hpp"
+#include "KrellInstitute/Core/KokkosKernels.hpp"
+#include "KrellInstitute/Core/LockContention.hpp"
 #include "KrellInstitute/Core/Address.hpp"
 #include "KrellInstitute/Core/AddressEntry.hpp"
 #include "KrellInstitute/Core/PCData.hpp"
@@ -60,7 +69,20 @@ namespace KrellInstitute { namespace Core {
 
 	public:
 	   int aggregate(const Blob&, AddressBuffer& buf);
+	   int aggregate(const Blob&, AddressBuffer& buf, Blob*);
+	   int aggregate(const boost::shared_ptr<CBTF_Protocol_Blob>&,
+			 AddressBuffer& buf,
+			 boost::shared_ptr<CBTF_Protocol_Blob>&);
 	   int memMetrics(const Blob&, MemMetrics&);
+	   int memHistograms(const Blob&, MemMetrics&);
+	   int commMatrix(const Blob&, CommMatrix&);
+	   int ioPathnames(const Blob&, IOPathnames&);
+	   int ioStats(const Blob&, IOStats&);
+	   int lockContention(const Blob&, LockContention&);
+	   int kokkosKernels(const Blob&, KokkosKernels&);
+	   int callingContextTree(const Blob&, CallingContextTree&);
+
+	   static bool hasCallingContext(const std::string&);
 
 
 	private:
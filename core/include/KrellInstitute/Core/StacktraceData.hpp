@@ -47,15 +47,22 @@ namespace KrellInstitute { namespace Core {
 	StacktraceData();    
 
 	void aggregateAddressCounts(const unsigned &, const uint64_t*,
-				    const uint8_t*, AddressBuffer&) const;
+				    const uint8_t*, AddressBuffer&,
+				    const uint64_t& weight = 1) const;
 	void aggregateAddressCounts(const unsigned &, const uint64_t*,
 				    AddressBuffer&) const;
 	void aggregateAddressCounts(AddressCounts&,
 				    AddressBuffer&) const;
+	void aggregateAddressCounts(const unsigned &, const uint64_t*,
+				    const uint32_t*, AddressBuffer&,
+				    const uint64_t& weight = 1) const;
 	void graphAddressCounts(const unsigned &, const uint64_t*,
 				    const uint8_t*, Graph&) const;
 	void graphAddressCounts(const unsigned &, const uint64_t*,
 				    Graph&) const;
+	void graphAddressCounts(const unsigned &, const uint64_t*,
+				    const uint32_t*, const uint32_t*,
+				    Graph&) const;
     };
     
 } }
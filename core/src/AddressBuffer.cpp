@@ -22,6 +22,10 @@
  *
  */
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 #include "KrellInstitute/Core/Address.hpp"
 #include "KrellInstitute/Core/AddressEntry.hpp"
 #include "KrellInstitute/Core/AddressBuffer.hpp"
@@ -78,6 +82,12 @@ void AddressBuffer::printResults() const {
 	    }
 	    std::cout << "\ntotal unique sampled addresses: " << total_counts
 	    << "\n" << std::endl;
+	    if (dropped > 0) {
+		std::cout << "top " << addresscounts.size()
+		<< " addresses of total count " << getTotalCount()
+		<< ", other addresses have counts of at most " << missing
+		<< "\n" << std::endl;
+	    }
 }
 
 // FIXME: These methods return bool but are not returning as expected
@@ -129,3 +139,117 @@ bool AddressBuffer::updateAddressCounts(AddressCounts& addrcounts)
     }
   }
 }
+
+// Merge another (sketch) buffer into this one. The counts of an address
+// present in either buffer are summed and its error grows by the error of
+// each buffer for that address, or by the missing bound of a buffer that
+// doesn't retain it. Exact buffers merge into exact counts.
+void AddressBuffer::mergeSketch(const AddressBuffer& buf)
+{
+    AddressCounts counts;
+    AddressCounts errors;
+    AddressCounts::const_iterator ai = addresscounts.begin();
+    AddressCounts::const_iterator bi = buf.addresscounts.begin();
+
+    while (ai != addresscounts.end() || bi != buf.addresscounts.end()) {
+	Address addr;
+	uint64_t count = 0;
+	uint64_t error = 0;
+
+	if (bi == buf.addresscounts.end() ||
+	    (ai != addresscounts.end() && ai->first < bi->first)) {
+	    addr = ai->first;
+	    count = ai->second;
+	    error = getError(addr) + buf.missing;
+	    ++ai;
+	} else if (ai == addresscounts.end() || bi->first < ai->first) {
+	    addr = bi->first;
+	    count = bi->second;
+	    error = missing + buf.getError(addr);
+	    ++bi;
+	} else {
+	    addr = ai->first;
+	    count = ai->second + bi->second;
+	    error = getError(addr) + buf.getError(addr);
+	    ++ai;
+	    ++bi;
+	}
+
+	counts.insert(counts.end(), AddressCounts::value_type(addr, count));
+	if (error > 0) {
+	    errors.insert(errors.end(), AddressCounts::value_type(addr, error));
+	}
+    }
+
+    addresscounts.swap(counts);
+    addresserrors.swap(errors);
+    missing += buf.missing;
+    dropped += buf.dropped;
+}
+
+// Retain only the k addresses with the largest counts. The upper bound
+// of each dropped address (count plus error) bounds the count of any
+// address that is no longer retained.
+void AddressBuffer::truncate(unsigned k)
+{
+    if (addresscounts.size() <= k) {
+	return;
+    }
+
+    std::vector<uint64_t> counts;
+    counts.reserve(addresscounts.size());
+    AddressCounts::const_iterator aci;
+    for (aci = addresscounts.begin(); aci != addresscounts.end(); ++aci) {
+	counts.push_back(aci->second);
+    }
+    std::nth_element(counts.begin(), counts.begin() + k, counts.end(),
+		     std::greater<uint64_t>());
+    uint64_t cutoff = counts[k];
+
+    // Drop every address below the cutoff and enough of those at the
+    // cutoff to leave k addresses.
+    unsigned above = 0;
+    for (std::vector<uint64_t>::const_iterator i = counts.begin();
+	 i != counts.begin() + k; ++i) {
+	if (*i > cutoff) {
+	    ++above;
+	}
+    }
+    unsigned keep_at_cutoff = k - above;
+
+    AddressCounts::iterator ai = addresscounts.begin();
+    while (ai != addresscounts.end()) {
+	if (ai->second > cutoff ||
+	    (ai->second == cutoff && keep_at_cutoff > 0)) {
+	    if (ai->second == cutoff) {
+		--keep_at_cutoff;
+	    }
+	    ++ai;
+	    continue;
+	}
+
+	uint64_t error = getError(ai->first);
+	missing = std::max(missing, ai->second + error);
+	dropped += ai->second;
+	addresserrors.erase(ai->first);
+	addresscounts.erase(ai++);
+    }
+}
+
+// Upper bound of the count missing from a retained address.
+uint64_t AddressBuffer::getError(const Address& addr) const
+{
+    AddressCounts::const_iterator i = addresserrors.find(addr);
+    return (i == addresserrors.end()) ? 0 : i->second;
+}
+
+// Exact total count of all addresses, including the dropped ones.
+uint64_t AddressBuffer::getTotalCount() const
+{
+    uint64_t total = dropped;
+    AddressCounts::const_iterator aci;
+    for (aci = addresscounts.begin(); aci != addresscounts.end(); ++aci) {
+	total += aci->second;
+    }
+    return total;
+}
@@ -0,0 +1,378 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of AddressSpill functions.
+ *
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <utility>
+
+#include "KrellInstitute/Core/AddressSpill.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+namespace {
+
+    /** Number of (address, count) pairs moved per read or write. */
+    const unsigned BlockSize = 4096;
+
+    /** Approximate memory used by one entry of AddressCounts. */
+    const uint64_t EntrySize =
+	sizeof(AddressCounts::value_type) + 4 * sizeof(void*);
+
+    /** Buffered reader of the pairs of one run. */
+    class RunReader {
+
+	public:
+
+	RunReader(FILE* f) : file(f), next(0), size(0) {
+	}
+
+	bool get(uint64_t& address, uint64_t& count)
+	{
+	    if (next == size) {
+		size = fread(block, 2 * sizeof(uint64_t), BlockSize, file);
+		next = 0;
+		if (size == 0) {
+		    return false;
+		}
+	    }
+	    address = block[next][0];
+	    count = block[next][1];
+	    ++next;
+	    return true;
+	}
+
+	private:
+
+	FILE* file;
+	size_t next;
+	size_t size;
+	uint64_t block[BlockSize][2];
+
+    };
+
+    /** Buffered writer of the pairs of one run. */
+    class RunWriter {
+
+	public:
+
+	RunWriter(FILE* f) : file(f), size(0), failed(false) {
+	}
+
+	void add(uint64_t address, uint64_t count)
+	{
+	    block[size][0] = address;
+	    block[size][1] = count;
+	    if (++size == BlockSize) {
+		flush();
+	    }
+	}
+
+	bool finish()
+	{
+	    flush();
+	    return !failed && (fflush(file) == 0);
+	}
+
+	private:
+
+	void flush()
+	{
+	    failed |= (fwrite(block, sizeof(block[0]), size, file) != size);
+	    size = 0;
+	}
+
+	FILE* file;
+	size_t size;
+	bool failed;
+	uint64_t block[BlockSize][2];
+
+    };
+
+}
+
+
+
+/**
+ * K-way merge of the runs and the counts left in memory. Each address comes
+ * out once, in order, with the sum of its counts. The merge can be paused
+ * between any two addresses, which lets a spilled buffer be streamed out in
+ * chunks.
+ */
+class AddressSpill::Merger {
+
+    public:
+
+    /** Constructor from the runs and the counts, which are moved here. */
+    Merger(const std::vector<FILE*>& runs, AddressCounts& in) :
+	nruns(runs.size()),
+	counts(runs.size() + 1)
+    {
+	memory.swap(in);
+	mi = memory.begin();
+
+	// Source nruns is the part of the buffer that was never spilled.
+	for (unsigned i = 0; i < nruns; ++i) {
+	    uint64_t address;
+	    readers.push_back(new RunReader(runs[i]));
+	    if (readers[i]->get(address, counts[i])) {
+		heads.push(Head(address, i));
+	    }
+	}
+	if (mi != memory.end()) {
+	    counts[nruns] = mi->second;
+	    heads.push(Head(mi->first.getValue(), nruns));
+	}
+    }
+
+    ~Merger()
+    {
+	for (unsigned i = 0; i < readers.size(); ++i) {
+	    delete readers[i];
+	}
+    }
+
+    /** Has every address been merged? */
+    bool done() const {
+	return heads.empty();
+    }
+
+    /** Get the next address and the sum of its counts. */
+    bool get(uint64_t& address, uint64_t& count)
+    {
+	if (heads.empty()) {
+	    return false;
+	}
+
+	// Each source is sorted, so equal addresses come off the heap together.
+	address = heads.top().first;
+	count = 0;
+	while (!heads.empty() && heads.top().first == address) {
+	    unsigned source = heads.top().second;
+	    heads.pop();
+	    count += counts[source];
+
+	    uint64_t next;
+	    if (source < nruns) {
+		if (readers[source]->get(next, counts[source])) {
+		    heads.push(Head(next, source));
+		}
+	    } else if (++mi != memory.end()) {
+		counts[source] = mi->second;
+		heads.push(Head(mi->first.getValue(), source));
+	    }
+	}
+	return true;
+    }
+
+    /** Give the counts that were never spilled back to the buffer. */
+    void release(AddressCounts& out)
+    {
+	out.swap(memory);
+    }
+
+    private:
+
+    /** Smallest pending address and the index of its source. */
+    typedef std::pair<uint64_t, unsigned> Head;
+
+    unsigned nruns;
+    AddressCounts memory;
+    AddressCounts::const_iterator mi;
+    std::vector<RunReader*> readers;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+    std::vector<uint64_t> counts;
+
+};
+
+
+
+AddressSpill::AddressSpill(const std::string& dir, uint64_t bytes) :
+    directory(dir),
+    budget(bytes / EntrySize),
+    merger(NULL)
+{
+    if (bytes > 0 && budget == 0) {
+	budget = 1;
+    }
+}
+
+
+
+AddressSpill::~AddressSpill()
+{
+    delete merger;
+    for (unsigned i = 0; i < runs.size(); ++i) {
+	fclose(runs[i]);
+    }
+}
+
+
+
+// Spill the buffer if it holds more addresses than the budget allows.
+void AddressSpill::update(AddressBuffer& buf)
+{
+    if (budget > 0 && buf.addresscounts.size() > budget) {
+	spill(buf);
+    }
+}
+
+
+
+// Write the counts of the buffer as a new run and empty it. Once there are
+// MaxRuns runs they are first merged into a single run, so the number of
+// open files stays bounded. The buffer is left as it is if the run can't
+// be written, and spilling is disabled.
+void AddressSpill::spill(AddressBuffer& buf)
+{
+    if (buf.addresscounts.empty()) {
+	return;
+    }
+
+    FILE* file = create();
+    if (file == NULL) {
+	budget = 0;
+	return;
+    }
+
+    bool compact = (runs.size() + 1 >= MaxRuns);
+    RunWriter writer(file);
+    Merger runmerger(compact ? runs : std::vector<FILE*>(), buf.addresscounts);
+    uint64_t address, count;
+    while (runmerger.get(address, count)) {
+	writer.add(address, count);
+    }
+
+    if (!writer.finish()) {
+	std::cerr << "AddressSpill: unable to write a run in " << directory
+		  << ": " << strerror(errno) << std::endl;
+	runmerger.release(buf.addresscounts);
+	fclose(file);
+	for (unsigned i = 0; i < runs.size(); ++i) {
+	    rewind(runs[i]);
+	}
+	budget = 0;
+	return;
+    }
+
+    if (compact) {
+	closeRuns();
+    }
+
+    rewind(file);
+    runs.push_back(file);
+}
+
+
+
+// Merge all runs back into the buffer. The runs are consumed.
+void AddressSpill::merge(AddressBuffer& buf)
+{
+    if (runs.empty()) {
+	return;
+    }
+
+    Merger runmerger(runs, buf.addresscounts);
+    uint64_t address, count;
+    while (runmerger.get(address, count)) {
+	buf.addresscounts.insert(buf.addresscounts.end(),
+	    AddressCounts::value_type(Address(address), count));
+    }
+    closeRuns();
+}
+
+
+
+// Move the next chunk of the merge of the runs and the buffer into the
+// chunk buffer. Each chunk holds at most as many addresses as the budget
+// allows and the chunks hold disjoint, increasing address ranges. The
+// buffer is emptied by the first call and the runs are consumed by the
+// last. Returns true if more chunks follow. Without any runs the whole
+// buffer is the only chunk.
+bool AddressSpill::next(AddressBuffer& buf, AddressBuffer& chunk)
+{
+    chunk.addresscounts.clear();
+    if (merger == NULL) {
+	if (runs.empty()) {
+	    chunk.addresscounts.swap(buf.addresscounts);
+	    return false;
+	}
+	merger = new Merger(runs, buf.addresscounts);
+    }
+
+    uint64_t address, count;
+    while ((budget == 0 || chunk.addresscounts.size() < budget) &&
+	   merger->get(address, count)) {
+	chunk.addresscounts.insert(chunk.addresscounts.end(),
+	    AddressCounts::value_type(Address(address), count));
+    }
+
+    if (!merger->done()) {
+	return true;
+    }
+    delete merger;
+    merger = NULL;
+    closeRuns();
+    return false;
+}
+
+
+
+// Close and forget all runs.
+void AddressSpill::closeRuns()
+{
+    for (unsigned i = 0; i < runs.size(); ++i) {
+	fclose(runs[i]);
+    }
+    runs.clear();
+}
+
+
+
+// Create an unlinked file for a new run.
+FILE* AddressSpill::create()
+{
+    std::string path = directory + "/cbtf-spill-XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    int fd = mkstemp(&name[0]);
+    FILE* file = (fd < 0) ? NULL : fdopen(fd, "w+b");
+    if (file == NULL) {
+	std::cerr << "AddressSpill: unable to create a run in " << directory
+		  << ": " << strerror(errno) << std::endl;
+	if (fd >= 0) {
+	    close(fd);
+	}
+    }
+    if (fd >= 0) {
+	unlink(&name[0]);
+    }
+    return file;
+}
@@ -25,6 +25,7 @@
 
 #include "KrellInstitute/Core/Assert.hpp"
 #include "KrellInstitute/Core/Blob.hpp"
+#include "KrellInstitute/Messages/NativeEncoding.h"
 
 #include <string.h>
 
@@ -222,6 +223,12 @@ Blob& Blob::operator=(const Blob& other)
  * @note    It is the responsibility of the caller to use xdr_free() in order
  *          to free the decoded data structure when it is no longer needed.
  *
+ * @note    Performance data sent in the native layout encoding requested
+ *          from the collectors is decoded natively rather than with XDR. A
+ *          native encoding of another layout, or a truncated one, isn't an
+ *          assertion failure. Zero is returned and the data structure is left
+ *          without any allocated arrays.
+ *
  * @param xdrproc    XDR procedure for the returned data type.
  * @retval data      Pointer to the decoded data structure.
  * @return           Decoding size (in bytes).
@@ -232,6 +239,13 @@ unsigned Blob::getXDRDecoding(const xdrproc_t xdrproc, void* data) const
     Assert(xdrproc != NULL);
     Assert(data != NULL);
 
+    // Decode natively encoded contents directly
+    const char* contents = reinterpret_cast<const char*>(dm_contents);
+    if (CBTF_IsNativeEncoding(contents, dm_size) &&
+	CBTF_HasNativeEncoding(xdrproc)) {
+	return CBTF_NativeDecode(xdrproc, contents, dm_size, data);
+    }
+
     // Open an XDR stream using our contents
     XDR xdrs;
     xdrmem_create(&xdrs, reinterpret_cast<char*>(dm_contents),
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of CallingContextTree functions.
+ *
+ */
+
+#include <string>
+#include <iostream>
+
+#include "KrellInstitute/Core/CallingContextTree.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+const uint32_t CallingContextTree::NoParent;
+
+// Find the child of a node with the given address, creating it if needed.
+uint32_t CallingContextTree::addNode(uint32_t parent, uint64_t pc)
+{
+    std::pair<std::map<std::pair<uint32_t,uint64_t>, uint32_t>::iterator,
+	      bool> result = children.insert(
+		  std::make_pair(std::make_pair(parent, pc), nodes.size()));
+
+    if (result.second) {
+	nodes.push_back(CCTNode(pc, parent));
+    }
+    return result.first->second;
+}
+
+// Add a stack given top of stack first. The cost is charged to the top.
+void CallingContextTree::addStack(const uint64_t* frames, unsigned len,
+				  uint64_t count)
+{
+    if (len == 0) {
+	return;
+    }
+
+    uint32_t node = NoParent;
+    for (unsigned i = len; i > 0; --i) {
+	node = addNode(node, frames[i - 1]);
+    }
+    nodes[node].count += count;
+}
+
+// Add a tree sent as node arrays (parents before children).
+void CallingContextTree::addTree(unsigned len, const uint64_t* pc,
+				 const uint32_t* parent, const uint64_t* count)
+{
+    std::vector<uint32_t> map(len, NoParent);
+
+    for (unsigned i = 0; i < len; ++i) {
+	uint32_t p = parent[i] < i ? map[parent[i]] : NoParent;
+	map[i] = addNode(p, pc[i]);
+	nodes[map[i]].count += count[i];
+    }
+}
+
+// Add the tree built by a collector, weighting each of its sample counts.
+void CallingContextTree::addTree(unsigned len, const uint64_t* pc,
+				 const uint32_t* parent, const uint32_t* count,
+				 uint64_t weight)
+{
+    std::vector<uint32_t> map(len, NoParent);
+
+    for (unsigned i = 0; i < len; ++i) {
+	uint32_t p = parent[i] < i ? map[parent[i]] : NoParent;
+	map[i] = addNode(p, pc[i]);
+	nodes[map[i]].count += count[i] * weight;
+    }
+}
+
+// Merge a (partial) tree reduced by another node.
+void CallingContextTree::merge(const CallingContextTree& in)
+{
+    std::vector<uint32_t> map(in.nodes.size(), NoParent);
+
+    for (unsigned i = 0; i < in.nodes.size(); ++i) {
+	const CCTNode& n = in.nodes[i];
+	uint32_t p = n.parent < i ? map[n.parent] : NoParent;
+	map[i] = addNode(p, n.pc);
+	nodes[map[i]].count += n.count;
+    }
+}
+
+uint64_t CallingContextTree::getTotalCount() const
+{
+    uint64_t total = 0;
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+	total += nodes[i].count;
+    }
+    return total;
+}
+
+void CallingContextTree::printResults() const
+{
+    // Inclusive cost of each node. Children follow their parents so a
+    // reverse pass accumulates each subtree before reaching its root.
+    std::vector<uint64_t> inclusive(nodes.size());
+    std::vector<unsigned> depth(nodes.size(), 0);
+    std::vector<std::vector<uint32_t> > kids(nodes.size());
+    std::vector<uint32_t> roots;
+
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+	inclusive[i] = nodes[i].count;
+	if (nodes[i].parent == NoParent) {
+	    roots.push_back(i);
+	} else {
+	    depth[i] = depth[nodes[i].parent] + 1;
+	    kids[nodes[i].parent].push_back(i);
+	}
+    }
+    for (unsigned i = nodes.size(); i > 0; --i) {
+	if (nodes[i - 1].parent != NoParent) {
+	    inclusive[nodes[i - 1].parent] += inclusive[i - 1];
+	}
+    }
+
+    std::cout << "nodes: " << nodes.size()
+	<< " total: " << getTotalCount() << std::endl;
+    std::cout << "inclusive  exclusive  address" << std::endl;
+
+    std::vector<uint32_t> pending(roots.rbegin(), roots.rend());
+    while (!pending.empty()) {
+	uint32_t i = pending.back();
+	pending.pop_back();
+	std::cout << inclusive[i] << "  " << nodes[i].count << "  "
+	    << std::string(2 * depth[i], ' ')
+	    << "0x" << std::hex << nodes[i].pc << std::dec << std::endl;
+	pending.insert(pending.end(), kids[i].rbegin(), kids[i].rend());
+    }
+}
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of CommMatrix functions.
+ *
+ */
+
+#include <iostream>
+
+#include "KrellInstitute/Core/CommMatrix.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+// Add the totals of one cell to the cell for the given ranks.
+void CommMatrix::updateCommMatrix(int source, int destination,
+				  const CommMatrixCell& in)
+{
+    CommMatrixCell& cell = cells[std::make_pair(source, destination)];
+
+    cell.count += in.count;
+    cell.bytes += in.bytes;
+    cell.time += in.time;
+    for (int i = 0; i < CBTF_MPI_COMM_HISTOGRAM_SIZE; ++i) {
+	cell.histogram[i] += in.histogram[i];
+    }
+}
+
+// Add a row sent by the mpi collector for the given source rank.
+void CommMatrix::updateCommMatrix(int source,
+				  const CBTF_mpi_comm_row_data& row)
+{
+    for (unsigned i = 0; i < row.peers.peers_len; ++i) {
+	const CBTF_mpi_comm_peer& peer = row.peers.peers_val[i];
+	CommMatrixCell& cell = cells[std::make_pair(source, peer.peer)];
+
+	cell.count += peer.count;
+	cell.bytes += peer.bytes;
+	cell.time += peer.time;
+	for (int j = 0; j < CBTF_MPI_COMM_HISTOGRAM_SIZE; ++j) {
+	    cell.histogram[j] += peer.histogram[j];
+	}
+    }
+}
+
+// Merge a (partial) matrix reduced by another node.
+void CommMatrix::updateCommMatrix(const CommMatrix& in)
+{
+    CommMatrixCells::const_iterator ci;
+    for (ci = in.cells.begin(); ci != in.cells.end(); ++ci) {
+	updateCommMatrix(ci->first.first, ci->first.second, ci->second);
+    }
+}
+
+void CommMatrix::printResults() const
+{
+    std::cout << "source  destination  messages  bytes  time(ms)" << std::endl;
+
+    CommMatrixCells::const_iterator ci;
+    for (ci = cells.begin(); ci != cells.end(); ++ci) {
+	std::cout << ci->first.first << "  " << ci->first.second
+	    << "  " << ci->second.count
+	    << "  " << ci->second.bytes
+	    << "  " << static_cast<double>(ci->second.time) / 1000000.0
+	    << std::endl;
+    }
+}
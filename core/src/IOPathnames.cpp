@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of IOPathnames functions.
+ *
+ */
+
+#include "KrellInstitute/Core/IOPathnames.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+// Add the pathnames first sent in an iot data blob from the given thread.
+// Path ID 0 means no pathname and a first path ID of 1 starts a new set.
+void IOPathnames::update(const ThreadName& thread,
+			 const CBTF_io_exttrace_data& data)
+{
+    std::vector<std::string>& names = pathnames[thread];
+
+    if (names.empty() || data.first_pathid == 1) {
+	names.assign(1, std::string());
+    }
+    names.resize(data.first_pathid);
+
+    unsigned start = 0;
+    for (unsigned i = 0; i < data.pathnames.pathnames_len; ++i) {
+	if (data.pathnames.pathnames_val[i] == 0) {
+	    names.push_back(std::string(&data.pathnames.pathnames_val[start],
+					i - start));
+	    start = i + 1;
+	}
+    }
+}
+
+// Get the pathname for a path ID recorded in an event from the given thread.
+std::string IOPathnames::getPathname(const ThreadName& thread,
+				     uint16_t id) const
+{
+    std::map<ThreadName, std::vector<std::string> >::const_iterator i =
+	pathnames.find(thread);
+
+    if (i == pathnames.end() || id >= i->second.size()) {
+	return std::string();
+    }
+    return i->second[id];
+}
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of IOStats functions.
+ *
+ */
+
+#include <iostream>
+
+#include "KrellInstitute/Core/IOStats.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+// Add the statistics of each file descriptor sent by the iot collector.
+void IOStats::update(const CBTF_io_stats_data& data)
+{
+    for (unsigned i = 0; i < data.files.files_len; ++i) {
+	const CBTF_io_fd_stats& fd = data.files.files_val[i];
+	std::string pathname;
+	if (fd.pathname < data.pathnames.pathnames_len) {
+	    pathname = &data.pathnames.pathnames_val[fd.pathname];
+	}
+
+	IOStatsFile& file = files[pathname];
+	file.read_calls += fd.read_calls;
+	file.read_bytes += fd.read_bytes;
+	file.read_time += fd.read_time;
+	file.write_calls += fd.write_calls;
+	file.write_bytes += fd.write_bytes;
+	file.write_time += fd.write_time;
+	file.other_calls += fd.other_calls;
+	file.other_time += fd.other_time;
+	file.sequential += fd.sequential;
+	file.random += fd.random;
+	for (int j = 0; j < CBTF_IO_STATS_HISTOGRAM_SIZE; ++j) {
+	    file.histogram[j] += fd.histogram[j];
+	}
+    }
+}
+
+// Add the totals of one file to the totals for the given pathname.
+void IOStats::update(const std::string& pathname, const IOStatsFile& in)
+{
+    IOStatsFile& file = files[pathname];
+
+    file.read_calls += in.read_calls;
+    file.read_bytes += in.read_bytes;
+    file.read_time += in.read_time;
+    file.write_calls += in.write_calls;
+    file.write_bytes += in.write_bytes;
+    file.write_time += in.write_time;
+    file.other_calls += in.other_calls;
+    file.other_time += in.other_time;
+    file.sequential += in.sequential;
+    file.random += in.random;
+    for (int i = 0; i < CBTF_IO_STATS_HISTOGRAM_SIZE; ++i) {
+	file.histogram[i] += in.histogram[i];
+    }
+}
+
+// Merge (partial) statistics reduced by another node.
+void IOStats::update(const IOStats& in)
+{
+    IOStatsFiles::const_iterator fi;
+    for (fi = in.files.begin(); fi != in.files.end(); ++fi) {
+	update(fi->first, fi->second);
+    }
+}
+
+void IOStats::printResults() const
+{
+    std::cout << "reads  bytes read  writes  bytes written  other"
+	<< "  time(ms)  sequential  random  file" << std::endl;
+
+    IOStatsFiles::const_iterator fi;
+    for (fi = files.begin(); fi != files.end(); ++fi) {
+	uint64_t time = fi->second.read_time + fi->second.write_time +
+			fi->second.other_time;
+	std::cout << fi->second.read_calls
+	    << "  " << fi->second.read_bytes
+	    << "  " << fi->second.write_calls
+	    << "  " << fi->second.write_bytes
+	    << "  " << fi->second.other_calls
+	    << "  " << static_cast<double>(time) / 1000000.0
+	    << "  " << fi->second.sequential
+	    << "  " << fi->second.random
+	    << "  " << fi->first
+	    << std::endl;
+    }
+}
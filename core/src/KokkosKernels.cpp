@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of KokkosKernels functions.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "KrellInstitute/Core/KokkosKernels.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+namespace {
+
+    /** Order kernels by decreasing total time. */
+    bool compareTotalTime(KokkosKernelTimings::const_iterator lhs,
+			  KokkosKernelTimings::const_iterator rhs)
+    {
+	return lhs->second.total_time > rhs->second.total_time;
+    }
+
+    /** Names of the kernel types indexed by CBTF_kokkos_type. */
+    const char* const kernel_types[] = {
+	"parallel_for", "parallel_reduce", "parallel_scan", "region"
+    };
+
+}
+
+
+// Add the timings of each kernel sent by the overview Kokkos connector.
+void KokkosKernels::update(const CBTF_kokkos_data& data)
+{
+    for (unsigned i = 0; i < data.kernels.kernels_len; ++i) {
+	const CBTF_kokkos_kernel& kernel = data.kernels.kernels_val[i];
+
+	// skip names that don't lie within the names of this blob
+	if (kernel.name >= data.names.names_len) {
+	    continue;
+	}
+	const char* begin = data.names.names_val + kernel.name;
+	const char* last = data.names.names_val + data.names.names_len;
+	const char* end = std::find(begin, last, '\0');
+
+	KokkosKernelStats stats;
+	stats.calls = kernel.calls;
+	stats.total_time = kernel.total_time;
+	stats.min_time = kernel.min_time;
+	stats.max_time = kernel.max_time;
+	update(kernel.type, std::string(begin, end), stats);
+    }
+}
+
+// Add the timings of one kernel to the timings for the given type and name.
+void KokkosKernels::update(int type, const std::string& name,
+			   const KokkosKernelStats& in)
+{
+    KokkosKernelStats& stats = kernels[std::make_pair(type, name)];
+
+    stats.calls += in.calls;
+    stats.total_time += in.total_time;
+    stats.min_time = std::min(stats.min_time, in.min_time);
+    stats.max_time = std::max(stats.max_time, in.max_time);
+}
+
+// Merge (partial) timings reduced by another node.
+void KokkosKernels::update(const KokkosKernels& in)
+{
+    KokkosKernelTimings::const_iterator ki;
+    for (ki = in.kernels.begin(); ki != in.kernels.end(); ++ki) {
+	update(ki->first.first, ki->first.second, ki->second);
+    }
+}
+
+// Print the kernels with the most total time first.
+void KokkosKernels::printResults() const
+{
+    std::vector<KokkosKernelTimings::const_iterator> sorted;
+    KokkosKernelTimings::const_iterator ki;
+    for (ki = kernels.begin(); ki != kernels.end(); ++ki) {
+	sorted.push_back(ki);
+    }
+    std::sort(sorted.begin(), sorted.end(), compareTotalTime);
+
+    std::cout << "calls  total(ms)  min(ms)  max(ms)  type  kernel" << std::endl;
+
+    for (unsigned i = 0; i < sorted.size(); ++i) {
+	const KokkosKernelStats& stats = sorted[i]->second;
+	int type = sorted[i]->first.first;
+	std::cout << stats.calls
+	    << "  " << static_cast<double>(stats.total_time) / 1000000.0
+	    << "  " << static_cast<double>(stats.min_time) / 1000000.0
+	    << "  " << static_cast<double>(stats.max_time) / 1000000.0
+	    << "  " << ((type >= 0 && type <= CBTF_KOKKOS_PROFILE_REGION) ?
+			kernel_types[type] : "unknown")
+	    << "  " << sorted[i]->first.second
+	    << std::endl;
+    }
+}
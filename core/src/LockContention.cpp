@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of LockContention functions.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "KrellInstitute/Core/LockContention.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+namespace {
+
+    /** Order locks by decreasing total wait time. */
+    bool compareWaitTime(LockContentionLocks::const_iterator lhs,
+			 LockContentionLocks::const_iterator rhs)
+    {
+	return lhs->second.wait_time > rhs->second.wait_time;
+    }
+
+}
+
+
+// Add the statistics of each lock sent by the pthreads collector.
+void LockContention::update(const CBTF_pthreads_contention_data& data)
+{
+    for (unsigned i = 0; i < data.locks.locks_len; ++i) {
+	const CBTF_pthreads_lock_stats& lock = data.locks.locks_val[i];
+
+	StackTrace stack;
+	for (unsigned j = lock.stacktrace;
+	     j < data.stacktraces.stacktraces_len; ++j) {
+	    // end of stack
+	    if (data.stacktraces.stacktraces_val[j] == 0) break;
+	    stack.push_back(Address(data.stacktraces.stacktraces_val[j]));
+	}
+
+	LockContentionStats stats;
+	stats.acquisitions = lock.acquisitions;
+	stats.failed_trylocks = lock.failed_trylocks;
+	stats.wait_time = lock.wait_time;
+	stats.max_wait_time = lock.max_wait_time;
+	stats.hold_time = lock.hold_time;
+	stats.max_hold_time = lock.max_hold_time;
+	for (int k = 0; k < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE; ++k) {
+	    stats.histogram[k] = lock.histogram[k];
+	}
+	update(lock.mutex, stack, stats);
+    }
+}
+
+// Add the statistics of each OpenMP mutex sent by the omptp collector.
+void LockContention::update(const CBTF_ompt_mutex_data& data)
+{
+    for (unsigned i = 0; i < data.mutexes.mutexes_len; ++i) {
+	const CBTF_ompt_mutex_stats& mutex = data.mutexes.mutexes_val[i];
+
+	StackTrace stack;
+	if (mutex.codeptr != 0) {
+	    stack.push_back(Address(mutex.codeptr));
+	}
+
+	LockContentionStats stats;
+	stats.acquisitions = mutex.acquisitions;
+	stats.failed_trylocks = mutex.failed_tests;
+	stats.wait_time = mutex.wait_time;
+	stats.max_wait_time = mutex.max_wait_time;
+	stats.hold_time = mutex.hold_time;
+	stats.max_hold_time = mutex.max_hold_time;
+	for (int k = 0; k < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE &&
+			k < CBTF_OMPT_MUTEX_HISTOGRAM_SIZE; ++k) {
+	    stats.histogram[k] = mutex.histogram[k];
+	}
+	update(mutex.wait_id, stack, stats);
+    }
+}
+
+// Add the totals of one lock to the totals for the given mutex and call site.
+void LockContention::update(uint64_t mutex, const StackTrace& stack,
+			    const LockContentionStats& in)
+{
+    LockContentionStats& stats = locks[std::make_pair(mutex, stack)];
+
+    stats.acquisitions += in.acquisitions;
+    stats.failed_trylocks += in.failed_trylocks;
+    stats.wait_time += in.wait_time;
+    stats.max_wait_time = std::max(stats.max_wait_time, in.max_wait_time);
+    stats.hold_time += in.hold_time;
+    stats.max_hold_time = std::max(stats.max_hold_time, in.max_hold_time);
+    for (int i = 0; i < CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE; ++i) {
+	stats.histogram[i] += in.histogram[i];
+    }
+}
+
+// Merge (partial) statistics reduced by another node.
+void LockContention::update(const LockContention& in)
+{
+    LockContentionLocks::const_iterator li;
+    for (li = in.locks.begin(); li != in.locks.end(); ++li) {
+	update(li->first.first, li->first.second, li->second);
+    }
+}
+
+// Print the locks with the most wait time first.
+void LockContention::printResults() const
+{
+    std::vector<LockContentionLocks::const_iterator> sorted;
+    LockContentionLocks::const_iterator li;
+    for (li = locks.begin(); li != locks.end(); ++li) {
+	sorted.push_back(li);
+    }
+    std::sort(sorted.begin(), sorted.end(), compareWaitTime);
+
+    std::cout << "acquisitions  failed trylocks  wait(ms)  max wait(ms)"
+	<< "  hold(ms)  max hold(ms)  mutex  call site" << std::endl;
+
+    for (unsigned i = 0; i < sorted.size(); ++i) {
+	const LockContentionStats& stats = sorted[i]->second;
+	const StackTrace& stack = sorted[i]->first.second;
+	std::cout << stats.acquisitions
+	    << "  " << stats.failed_trylocks
+	    << "  " << static_cast<double>(stats.wait_time) / 1000000.0
+	    << "  " << static_cast<double>(stats.max_wait_time) / 1000000.0
+	    << "  " << static_cast<double>(stats.hold_time) / 1000000.0
+	    << "  " << static_cast<double>(stats.max_hold_time) / 1000000.0
+	    << "  " << Address(sorted[i]->first.first)
+	    << "  " << (stack.size() > 1 ? stack[1] :
+			(stack.empty() ? Address() : stack[0]))
+	    << std::endl;
+    }
+}
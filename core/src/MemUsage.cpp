@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of MemUsage functions.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "KrellInstitute/Core/MemUsage.hpp"
+
+using namespace KrellInstitute::Core;
+
+
+namespace {
+
+    /** Total bytes allocated by a call site. */
+    uint64_t getSiteTotal(const StackMemUsageMap::const_iterator& site)
+    {
+	uint64_t total = 0;
+	for (unsigned i = 0; i < site->second.size(); ++i) {
+	    total += site->second[i];
+	}
+	return total;
+    }
+
+    bool compareSiteTotals(const StackMemUsageMap::const_iterator& a,
+			   const StackMemUsageMap::const_iterator& b)
+    {
+	return getSiteTotal(a) > getSiteTotal(b);
+    }
+
+}
+
+
+
+// Account for an event at the given time that left the thread with the
+// given number of bytes allocated.
+void MemUsage::update(uint64_t time, uint64_t current, const StackTrace& stack)
+{
+    if (interval == 0) {
+	return;
+    }
+
+    if (buckets.empty()) {
+	begin = time;
+    }
+
+    // Events are in time order, but clamp any that aren't to the start.
+    uint64_t offset = (time > begin) ? time - begin : 0;
+    while (offset / interval >= CBTF_MEM_USAGE_SIZE) {
+	coarsen();
+    }
+    unsigned index = offset / interval;
+
+    while (buckets.size() <= index) {
+	buckets.push_back(MemUsageBucket(live));
+    }
+
+    MemUsageBucket& bucket = buckets[index];
+    if (current > live) {
+	std::vector<uint64_t>& site = sites[stack];
+	site.resize(buckets.size(), 0);
+	site[index] += current - live;
+	bucket.allocated += current - live;
+	++bucket.allocations;
+    } else if (current < live) {
+	bucket.freed += live - current;
+	++bucket.frees;
+    }
+    bucket.live = current;
+    bucket.peak = std::max(bucket.peak, current);
+    live = current;
+}
+
+
+
+// Double the width of the buckets, merging each adjacent pair.
+void MemUsage::coarsen()
+{
+    std::vector<MemUsageBucket> merged;
+    for (unsigned i = 0; i < buckets.size(); i += 2) {
+	MemUsageBucket b = buckets[i];
+	if (i + 1 < buckets.size()) {
+	    const MemUsageBucket& next = buckets[i + 1];
+	    b.live = next.live;
+	    b.peak = std::max(b.peak, next.peak);
+	    b.allocated += next.allocated;
+	    b.freed += next.freed;
+	    b.allocations += next.allocations;
+	    b.frees += next.frees;
+	}
+	merged.push_back(b);
+    }
+    buckets.swap(merged);
+
+    for (StackMemUsageMap::iterator si = sites.begin(); si != sites.end(); ++si) {
+	std::vector<uint64_t>& site = si->second;
+	for (unsigned i = 0; i < site.size(); i += 2) {
+	    site[i / 2] = site[i] + ((i + 1 < site.size()) ? site[i + 1] : 0);
+	}
+	site.resize((site.size() + 1) / 2);
+    }
+
+    interval *= 2;
+}
+
+
+
+// Call sites that allocated the most bytes, largest first.
+std::vector<StackMemUsageMap::const_iterator>
+MemUsage::getTopSites(unsigned count) const
+{
+    std::vector<StackMemUsageMap::const_iterator> top;
+    for (StackMemUsageMap::const_iterator si = sites.begin(); si != sites.end(); ++si) {
+	top.push_back(si);
+    }
+
+    count = std::min(count, static_cast<unsigned>(top.size()));
+    std::partial_sort(top.begin(), top.begin() + count, top.end(),
+		      compareSiteTotals);
+    top.resize(count);
+    return top;
+}
+
+
+
+void MemUsage::printResults() const
+{
+    std::cout << "interval: " << interval << " buckets: " << buckets.size()
+	      << std::endl;
+    std::cout << "time  live  peak  allocated  freed  allocations  frees"
+	      << std::endl;
+    for (unsigned i = 0; i < buckets.size(); ++i) {
+	const MemUsageBucket& b = buckets[i];
+	std::cout << begin + i * interval << "  " << b.live << "  " << b.peak
+		  << "  " << b.allocated << "  " << b.freed
+		  << "  " << b.allocations << "  " << b.frees << std::endl;
+    }
+}
@@ -53,11 +53,15 @@ PCData::PCData()
 // counts arrays.  It has an additional array to record
 // the counts for up to si hardware counters and is not
 // used by the aggregator.
+//
+// weight scales the counts of samples taken while an
+// adaptive timer had stretched the sampling interval.
 void PCData::aggregateAddressCounts(
 	const unsigned& len,
 	const uint64_t* pc,
 	const uint8_t* counts,
-	AddressBuffer& buffer) const
+	AddressBuffer& buffer,
+	const uint64_t& weight) const
 {
     // Iterate over each of the stacktrace address entries.
     for(unsigned i = 0; i < len; ++i) {
@@ -65,6 +69,6 @@ void PCData::aggregateAddressCounts(
 	std::cerr << "Address " << Address((uint64_t)pc[i]) << " has count "
 	 << (int)counts[i] <<  std::endl;
 #endif
-	buffer.updateAddressCounts(pc[i], counts[i]);
+	buffer.updateAddressCounts(pc[i], counts[i] * weight);
     }
 }
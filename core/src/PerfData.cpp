@@ -23,8 +23,13 @@
  */
 
 #include <algorithm>
+#include <boost/bind.hpp>
+#include <map>
+#include <vector>
 
 #include "KrellInstitute/Core/PerfData.hpp"
+#include "KrellInstitute/Messages/PerformanceData.hpp"
+#include "KrellInstitute/Services/FoldFrames.h"
 
 // uncomment this to get details of mem trace/
 // #define MEM_TRACE_DETAILS 1
@@ -42,371 +47,854 @@ bool is_debug_aggregator_events_enabled =
     Graph dGraph;
 #endif
 
-    void aggregatePCData(const std::string id, const Blob &blob,
-			 AddressBuffer &buf, uint64_t &interval)
+    // Samples taken while an adaptive timer had stretched the sampling
+    // interval each stand for several samples at the requested interval.
+    uint64_t sampleWeight(uint64_t interval, uint64_t effective_interval)
     {
-	if (id == "pcsamp") {
-            CBTF_pcsamp_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_pcsamp_data), &data);
-	    interval = data.interval;
-	    PCData pcdata;
-            pcdata.aggregateAddressCounts(data.pc.pc_len, data.pc.pc_val, data.count.count_val, buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_pcsamp_data),
-                     reinterpret_cast<char*>(&data));
-
-	} else if (id == "hwc") {
-            CBTF_hwc_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_hwc_data), &data);
-	    interval = data.interval;
-	    PCData pcdata;
-            pcdata.aggregateAddressCounts(data.pc.pc_len, data.pc.pc_val, data.count.count_val, buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_hwc_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "hwcsamp") {
-            CBTF_hwcsamp_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_hwcsamp_data), &data);
-	    interval = data.interval;
-	    PCData pcdata;
-            pcdata.aggregateAddressCounts(data.pc.pc_len, data.pc.pc_val, data.count.count_val, buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_hwcsamp_data),
-                     reinterpret_cast<char*>(&data));
-	} else {
-	    return;
+	if (interval == 0 || effective_interval <= interval) {
+	    return 1;
 	}
+	return effective_interval / interval;
     }
 
-    void aggregateSTSampleData(const std::string id, const Blob &blob,
-			 AddressBuffer &buf, uint64_t &interval)
-    {
-	StacktraceData stdata;
-	if (id == "usertime") {
-            CBTF_usertime_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_usertime_data), &data);
-	    interval = data.interval;
-	    stdata.aggregateAddressCounts(data.stacktraces.stacktraces_len,
-				data.stacktraces.stacktraces_val,
-				data.count.count_val, buf);
-#if defined(CREATE_GRAPH)
-	    // This is a per blob graph.
-	    Graph dGraph;
-	    stdata.graphAddressCounts(data.stacktraces.stacktraces_len,
-				data.stacktraces.stacktraces_val,
-				data.count.count_val, dGraph);
+    /**
+     * Type of the function adding the addresses of one collector's data. When
+     * the passed blob is not null, the stacks folded by the collector are also
+     * unfolded and the unfolded data encoded into the blob.
+     */
+    typedef void (*AggregateFunction)(const Blob&, AddressBuffer&, Blob*);
 
-	    dGraph.printGraph();
-#endif
+    /** Type of the function folding one collector's stacks into a tree. */
+    typedef unsigned (*ContextFunction)(const Blob&, CallingContextTree&);
 
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_usertime_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "hwctime") {
-            CBTF_hwctime_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_hwctime_data), &data);
-	    interval = data.interval;
-	    stdata.aggregateAddressCounts(data.stacktraces.stacktraces_len,
-				data.stacktraces.stacktraces_val,
-				data.count.count_val, buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_hwctime_data),
-                     reinterpret_cast<char*>(&data));
-	} else {
-	    return;
+    /** Type of the function adding one collector's lock statistics. */
+    typedef unsigned (*ContentionFunction)(const Blob&, LockContention&);
+
+    /** Collector data decoded from a blob and freed when going out of scope. */
+    template <typename D>
+    class Decoded {
+
+	public:
+
+	Decoded(const Blob& blob, xdrproc_t xdrproc) : proc(xdrproc)
+	{
+	    memset(&data, 0, sizeof(data));
+	    size = blob.getXDRDecoding(proc, &data);
 	}
 
+	~Decoded()
+	{
+	    xdr_free(proc, reinterpret_cast<char*>(&data));
+	}
+
+	/** Encode the (modified) data again. */
+	Blob encode() const
+	{
+	    return Blob(proc, &data);
+	}
+
+	D data;
+
+	/** Size of the decoded data. */
+	unsigned size;
+
+	private:
+
+	xdrproc_t proc;
+
+    };
+
+    // Charge a cost to every frame of the zero terminated stack at index.
+    // A repeat frame charges the frames of its cycle once per repeat.
+    inline void addStackTime(const uint64_t* st, const unsigned len,
+			     unsigned index, const uint64_t time,
+			     AddressCounts& addressTime)
+    {
+	const unsigned begin = index;
+	for (; index < len && st[index] != 0; ++index) {
+	    if (!CBTF_IsFrameRepeat(st[index])) {
+		addressTime[Address(st[index])] += time;
+		continue;
+	    }
+	    unsigned length = CBTF_FrameRepeatLength(st[index]);
+	    uint64_t repeat = time * CBTF_FrameRepeatCount(st[index]);
+	    for (unsigned i = index - std::min(length, index - begin);
+		 i < index; ++i) {
+		addressTime[Address(st[i])] += repeat;
+	    }
+	}
     }
 
-    void aggregateSTTraceData(const std::string id, const Blob &blob,
-			 AddressBuffer &buf)
+    // Charge the time of each traced event to every frame of its stack.
+    template <typename E>
+    void addEventTimes(const uint64_t* st, const unsigned len,
+		       const E* events, const unsigned nevents,
+		       AddressBuffer& buf)
     {
-	StacktraceData stdata;
-	if (id == "io") {
-            CBTF_io_trace_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_trace_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.events.events_len; ++i) {
-		++eventcount;
-		uint64_t event_time = data.events.events_val[i].stop_time - data.events.events_val[i].start_time;
-
-		for (unsigned j = data.events.events_val[i].stacktrace;
-		     j < data.stacktraces.stacktraces_len; ++j) {
+	AddressCounts addressTime;
+	for (unsigned i = 0; i < nevents; ++i) {
+	    addStackTime(st, len, events[i].stacktrace,
+			 events[i].stop_time - events[i].start_time,
+			 addressTime);
+	}
+	buf.updateAddressCounts(addressTime);
+    }
 
-		    if (data.stacktraces.stacktraces_val[j] == 0) break; // end of stack
-	        	Address a;
-			a = Address(data.stacktraces.stacktraces_val[j]);
+    // Charge the total time of each profiled address to that address.
+    void addProfileTimes(const uint64_t* st, const uint64_t* time,
+			 const unsigned len, AddressBuffer& buf)
+    {
+	AddressCounts addressTime;
+	for (unsigned i = 0; i < len; ++i) {
+	    addressTime[Address(st[i])] += time[i];
+	}
+	buf.updateAddressCounts(addressTime);
+    }
 
-			AddressCounts::iterator it = addressTime.find(a);
-			if (it == addressTime.end() ) {
-			    addressTime.insert(std::make_pair(a,event_time));
-			} else {
-			    (*it).second += event_time;
-		    }
-		}
+    /**
+     * Deepest unfolded stack. The frames beyond it, those nearest the root,
+     * are dropped just as the unwinders drop the frames that do not fit.
+     */
+    const unsigned MaxUnfoldedFrames = 1024;
+
+    /** Largest index of a stack in the 16 bit stack indices of trace data. */
+    const unsigned MaxStackIndex = 0xFFFF;
+
+
+    bool hasRepeatFrames(const unsigned len, const uint64_t* st)
+    {
+	for (unsigned i = 0; i < len; ++i) {
+	    if (CBTF_IsFrameRepeat(st[i])) {
+		return true;
 	    }
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_trace_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "iop") {
-            CBTF_io_profile_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_profile_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.time.time_len; ++i) {
-		++eventcount;
-	        Address a;
-		a = Address(data.stacktraces.stacktraces_val[i]);
-
-		AddressCounts::iterator it = addressTime.find(a);
-		if (it == addressTime.end() ) {
-		    addressTime.insert(std::make_pair(a,data.time.time_val[i]));
-		} else {
-		    (*it).second += data.time.time_val[i];
-		}
+	}
+	return false;
+    }
+
+    // Append the frames st[begin, end) of one stack to out, replacing each
+    // repeat frame with the copies of its cycle that it stands for. At most
+    // limit frames are appended.
+    void unfoldStack(const uint64_t* st, unsigned begin, unsigned end,
+		     std::size_t limit, std::vector<uint64_t>& out)
+    {
+	const std::size_t first = out.size();
+	for (unsigned i = begin; i < end && out.size() - first < limit; ++i) {
+	    if (!CBTF_IsFrameRepeat(st[i])) {
+		out.push_back(st[i]);
+		continue;
+	    }
+	    // the cycle never holds a repeat frame, so it is what was just
+	    // appended to out.
+	    std::size_t length =
+		std::min<std::size_t>(CBTF_FrameRepeatLength(st[i]), i - begin);
+	    for (uint64_t n = length * CBTF_FrameRepeatCount(st[i]);
+		 n > 0 && out.size() - first < limit; --n) {
+		uint64_t frame = out[out.size() - length];
+		out.push_back(frame);
 	    }
+	}
+    }
 
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_profile_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "iot") {
-            CBTF_io_exttrace_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_exttrace_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.events.events_len; ++i) {
-		++eventcount;
-		uint64_t event_time = data.events.events_val[i].stop_time - data.events.events_val[i].start_time;
-
-		for (unsigned j = data.events.events_val[i].stacktrace;
-		     j < data.stacktraces.stacktraces_len; ++j) {
+    // Replace an array allocated by the XDR decoding with the passed values.
+    template <typename T>
+    void replaceArray(u_int& len, T*& val, const std::vector<T>& values)
+    {
+	free(val);
+	val = reinterpret_cast<T*>(
+	    malloc(std::max<std::size_t>(values.size(), 1) * sizeof(T)));
+	std::copy(values.begin(), values.end(), val);
+	len = values.size();
+    }
 
-		    if (data.stacktraces.stacktraces_val[j] == 0) break; // end of stack
-	        	Address a;
-			a = Address(data.stacktraces.stacktraces_val[j]);
+    // Unfold a sampling or profiling buffer whose stacks each start at an
+    // entry with a positive count. The copies of the cycles get a zero count
+    // and, for buffers that have times, a zero time.
+    template <typename D>
+    bool unfoldCountedStacks(D& data, u_int* time_len, uint64_t** time)
+    {
+	const unsigned len = data.stacktraces.stacktraces_len;
+	const uint64_t* st = data.stacktraces.stacktraces_val;
+	const uint8_t* count = data.count.count_val;
+	if (!hasRepeatFrames(len, st) || data.count.count_len != len ||
+	    (time != NULL && *time_len != len)) {
+	    return false;
+	}
 
-			AddressCounts::iterator it = addressTime.find(a);
-			if (it == addressTime.end() ) {
-			    addressTime.insert(std::make_pair(a,event_time));
-			} else {
-			    (*it).second += event_time;
-		    }
+	std::vector<uint64_t> frames, times;
+	std::vector<uint8_t> counts;
+	unsigned i = 0;
+	while (i < len) {
+	    unsigned begin = i++;
+	    while (i < len && count[i] == 0) {
+		++i;
+	    }
+	    std::size_t first = frames.size();
+	    unfoldStack(st, begin, i, MaxUnfoldedFrames, frames);
+	    counts.resize(frames.size(), 0);
+	    if (time != NULL) {
+		times.resize(frames.size(), 0);
+	    }
+	    if (frames.size() > first) {
+		counts[first] = count[begin];
+		if (time != NULL) {
+		    times[first] = (*time)[begin];
 		}
 	    }
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_exttrace_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "mem") {
-            CBTF_mem_exttrace_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.events.events_len; ++i) {
-		++eventcount;
-		uint64_t event_time = data.events.events_val[i].stop_time - data.events.events_val[i].start_time;
-
-		for (unsigned j = data.events.events_val[i].stacktrace;
-		     j < data.stacktraces.stacktraces_len; ++j) {
+	}
 
-		    if (data.stacktraces.stacktraces_val[j] == 0) break; // end of stack
+	replaceArray(data.stacktraces.stacktraces_len,
+		     data.stacktraces.stacktraces_val, frames);
+	replaceArray(data.count.count_len, data.count.count_val, counts);
+	if (time != NULL) {
+	    replaceArray(*time_len, *time, times);
+	}
+	return true;
+    }
 
-	            Address a;
-		    a = Address(data.stacktraces.stacktraces_val[j]);
+    // Unfold the calling context tree built by a collector by building it
+    // again from the unfolded path to each node with a count.
+    template <typename D>
+    bool unfoldTree(D& data)
+    {
+	const unsigned len = data.cct_pc.cct_pc_len;
+	const uint64_t* pc = data.cct_pc.cct_pc_val;
+	const uint32_t* parent = data.cct_parent.cct_parent_val;
+	const uint32_t* count = data.cct_count.cct_count_val;
+	if (!hasRepeatFrames(len, pc) || data.cct_parent.cct_parent_len != len ||
+	    data.cct_count.cct_count_len != len) {
+	    return false;
+	}
 
-		    AddressCounts::iterator it = addressTime.find(a);
-		    if (it == addressTime.end() ) {
-			addressTime.insert(std::make_pair(a,event_time));
-		    } else {
-			(*it).second += event_time;
-		    }
-		}
+	CallingContextTree cct;
+	std::vector<uint64_t> path, frames;
+	for (unsigned i = 0; i < len; ++i) {
+	    if (count[i] == 0) {
+		continue;
 	    }
-
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "omptp") {
-            CBTF_ompt_profile_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_ompt_profile_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.time.time_len; ++i) {
-		++eventcount;
-	        Address a;
-		a = Address(data.stacktraces.stacktraces_val[i]);
-
-		AddressCounts::iterator it = addressTime.find(a);
-		if (it == addressTime.end() ) {
-		    addressTime.insert(std::make_pair(a,data.time.time_val[i]));
-		} else {
-		    (*it).second += data.time.time_val[i];
-		}
+	    // parents precede their children, so the walk always ends.
+	    path.clear();
+	    for (uint32_t n = i; n < len; n = parent[n] < n ? parent[n] : len) {
+		path.push_back(pc[n]);
 	    }
+	    frames.clear();
+	    unfoldStack(&path[0], 0, path.size(), MaxUnfoldedFrames, frames);
+	    if (!frames.empty()) {
+		cct.addStack(&frames[0], frames.size(), count[i]);
+	    }
+	}
 
-	    StacktraceData stdata;
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_ompt_profile_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "pthreads") {
-            CBTF_pthreads_exttrace_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_pthreads_exttrace_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.events.events_len; ++i) {
-		++eventcount;
-		uint64_t event_time = data.events.events_val[i].stop_time - data.events.events_val[i].start_time;
-
-		for (unsigned j = data.events.events_val[i].stacktrace;
-		     j < data.stacktraces.stacktraces_len; ++j) {
+	std::vector<uint64_t> pcs;
+	std::vector<uint32_t> parents, counts;
+	for (unsigned i = 0; i < cct.nodes.size(); ++i) {
+	    pcs.push_back(cct.nodes[i].pc);
+	    parents.push_back(cct.nodes[i].parent);
+	    counts.push_back(std::min<uint64_t>(cct.nodes[i].count, 0xFFFFFFFF));
+	}
 
-		    if (data.stacktraces.stacktraces_val[j] == 0) break; // end of stack
-	        	Address a;
-			a = Address(data.stacktraces.stacktraces_val[j]);
+	replaceArray(data.cct_pc.cct_pc_len, data.cct_pc.cct_pc_val, pcs);
+	replaceArray(data.cct_parent.cct_parent_len,
+		     data.cct_parent.cct_parent_val, parents);
+	replaceArray(data.cct_count.cct_count_len,
+		     data.cct_count.cct_count_val, counts);
+	return true;
+    }
 
-			AddressCounts::iterator it = addressTime.find(a);
-			if (it == addressTime.end() ) {
-			    addressTime.insert(std::make_pair(a,event_time));
-			} else {
-			    (*it).second += event_time;
-		    }
-		}
+    // Unfold the zero terminated stack at each index of the passed map and
+    // record its new index there. Fails if a new index does not fit in the
+    // 16 bits of a stack index. Bounded stacks are unfolded no further than
+    // the size of their folded form.
+    bool unfoldNamedStacks(const unsigned len, const uint64_t* st,
+			   bool bounded, std::map<unsigned, unsigned>& index,
+			   std::vector<uint64_t>& frames)
+    {
+	frames.clear();
+	for (std::map<unsigned, unsigned>::iterator i = index.begin();
+	     i != index.end(); ++i) {
+	    if (frames.size() > MaxStackIndex) {
+		return false;
 	    }
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_pthreads_exttrace_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "mpi") {
-            CBTF_mpi_trace_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_trace_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.events.events_len; ++i) {
-		++eventcount;
-		uint64_t event_time = data.events.events_val[i].stop_time - data.events.events_val[i].start_time;
-
-		for (unsigned j = data.events.events_val[i].stacktrace;
-		     j < data.stacktraces.stacktraces_len; ++j) {
+	    unsigned end = i->first;
+	    while (end < len && st[end] != 0) {
+		++end;
+	    }
+	    i->second = frames.size();
+	    unfoldStack(st, i->first, end,
+			bounded ? end - i->first : MaxUnfoldedFrames, frames);
+	    frames.push_back(0);
+	}
+	return true;
+    }
 
-		    if (data.stacktraces.stacktraces_val[j] == 0) break; // end of stack
-	        	Address a;
-			a = Address(data.stacktraces.stacktraces_val[j]);
+    // Unfold a tracing buffer whose items each name the index of their zero
+    // terminated stack, and move those indices to the unfolded stacks. When
+    // the unfolded stacks would outgrow the indices, each stack is unfolded
+    // only up to the size of its folded form. That always fits unless items
+    // name the middle of a stack, which no collector does.
+    template <typename E>
+    bool unfoldIndexedStacks(u_int& len, uint64_t*& st,
+			     E* items, const unsigned nitems)
+    {
+	if (!hasRepeatFrames(len, st)) {
+	    return false;
+	}
 
-			AddressCounts::iterator it = addressTime.find(a);
-			if (it == addressTime.end() ) {
-			    addressTime.insert(std::make_pair(a,event_time));
-			} else {
-			    (*it).second += event_time;
-		    }
-		}
+	std::map<unsigned, unsigned> index;
+	for (unsigned i = 0; i < nitems; ++i) {
+	    index[items[i].stacktrace] = 0;
+	}
+
+	std::vector<uint64_t> frames;
+	if (!unfoldNamedStacks(len, st, false, index, frames) &&
+	    !unfoldNamedStacks(len, st, true, index, frames)) {
+	    return false;
+	}
+
+	for (unsigned i = 0; i < nitems; ++i) {
+	    items[i].stacktrace = index[items[i].stacktrace];
+	}
+	replaceArray(len, st, frames);
+	return true;
+    }
+
+    // Add the stacks of a sampling collector's stacktrace buffer. A stack
+    // starts at an entry with a positive count (the top of stack) and runs
+    // through the caller frames that follow it with a zero count.
+    void addSampleStacks(const unsigned len, const uint64_t* st,
+			 const uint8_t* counts, CallingContextTree& cct,
+			 uint64_t weight)
+    {
+	unsigned i = 0;
+	while (i < len) {
+	    unsigned begin = i++;
+	    while (i < len && counts[i] == 0) {
+		++i;
 	    }
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_trace_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "mpip") {
-            CBTF_mpi_profile_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_profile_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.time.time_len; ++i) {
-		++eventcount;
-	        Address a;
-		a = Address(data.stacktraces.stacktraces_val[i]);
-
-		AddressCounts::iterator it = addressTime.find(a);
-		if (it == addressTime.end() ) {
-		    addressTime.insert(std::make_pair(a,data.time.time_val[i]));
-		} else {
-		    (*it).second += data.time.time_val[i];
-		}
+	    cct.addStack(&st[begin], i - begin, counts[begin] * weight);
+	}
+    }
+
+    // Add the stack of each traced event with the event time as its cost.
+    // Each event names the index of its zero terminated stack.
+    template <typename E>
+    void addEventStacks(const unsigned len, const uint64_t* st,
+			const unsigned nevents, const E* events,
+			CallingContextTree& cct)
+    {
+	for (unsigned i = 0; i < nevents; ++i) {
+	    unsigned begin = events[i].stacktrace, end = begin;
+	    while (end < len && st[end] != 0) {
+		++end;
 	    }
+	    cct.addStack(&st[begin], end - begin,
+			 events[i].stop_time - events[i].start_time);
+	}
+    }
 
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_profile_data),
-                     reinterpret_cast<char*>(&data));
-	} else if (id == "mpit") {
-            CBTF_mpi_exttrace_data data;
-            memset(&data, 0, sizeof(data));
-            unsigned bsize = blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_exttrace_data), &data);
-	    int eventcount = 0;
-	    AddressCounts addressTime;
-	    for(unsigned i = 0; i < data.events.events_len; ++i) {
-		++eventcount;
-		uint64_t event_time = data.events.events_val[i].stop_time - data.events.events_val[i].start_time;
-
-		for (unsigned j = data.events.events_val[i].stacktrace;
-		     j < data.stacktraces.stacktraces_len; ++j) {
+    void aggregatePCSamp(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_pcsamp_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_pcsamp_data));
+	PCData pcdata;
+	pcdata.aggregateAddressCounts(d.data.pc.pc_len, d.data.pc.pc_val,
+		d.data.count.count_val, buf,
+		sampleWeight(d.data.interval, d.data.effective_interval));
+    }
 
-		    if (data.stacktraces.stacktraces_val[j] == 0) break; // end of stack
-			Address a;
-			a = Address(data.stacktraces.stacktraces_val[j]);
+    void aggregateHwc(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_hwc_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_hwc_data));
+	PCData pcdata;
+	pcdata.aggregateAddressCounts(d.data.pc.pc_len, d.data.pc.pc_val,
+		d.data.count.count_val, buf);
+    }
 
-			AddressCounts::iterator it = addressTime.find(a);
-			if (it == addressTime.end() ) {
-			    addressTime.insert(std::make_pair(a,event_time));
-			} else {
-			    (*it).second += event_time;
-		    }
-		}
+    void aggregateHwcSamp(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_hwcsamp_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_hwcsamp_data));
+	PCData pcdata;
+	pcdata.aggregateAddressCounts(d.data.pc.pc_len, d.data.pc.pc_val,
+		d.data.count.count_val, buf,
+		sampleWeight(d.data.interval, d.data.effective_interval));
+    }
+
+    void aggregateUsertime(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_usertime_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_usertime_data));
+	uint64_t weight = sampleWeight(d.data.interval,
+				       d.data.effective_interval);
+	StacktraceData stdata;
+	stdata.aggregateAddressCounts(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.count.count_val, buf, weight);
+	// collectors built with a calling context tree send its nodes.
+	stdata.aggregateAddressCounts(d.data.cct_pc.cct_pc_len,
+		d.data.cct_pc.cct_pc_val,
+		d.data.cct_count.cct_count_val, buf, weight);
+#if defined(CREATE_GRAPH)
+	// This is a per blob graph.
+	Graph dGraph;
+	stdata.graphAddressCounts(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.count.count_val, dGraph);
+	stdata.graphAddressCounts(d.data.cct_pc.cct_pc_len,
+		d.data.cct_pc.cct_pc_val,
+		d.data.cct_parent.cct_parent_val,
+		d.data.cct_count.cct_count_val, dGraph);
+
+	dGraph.printGraph();
+#endif
+	if (unfolded != NULL) {
+	    bool folded = unfoldCountedStacks(d.data, NULL, NULL);
+	    folded |= unfoldTree(d.data);
+	    if (folded) {
+		*unfolded = d.encode();
 	    }
-	    stdata.aggregateAddressCounts(addressTime,buf);
-            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_exttrace_data),
-                     reinterpret_cast<char*>(&data));
-	} else {
-	    return;
 	}
+    }
+
+    void aggregateHwcTime(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_hwctime_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_hwctime_data));
+	StacktraceData stdata;
+	stdata.aggregateAddressCounts(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.count.count_val, buf);
+	// collectors built with a calling context tree send its nodes.
+	stdata.aggregateAddressCounts(d.data.cct_pc.cct_pc_len,
+		d.data.cct_pc.cct_pc_val,
+		d.data.cct_count.cct_count_val, buf);
+	if (unfolded != NULL) {
+	    bool folded = unfoldCountedStacks(d.data, NULL, NULL);
+	    folded |= unfoldTree(d.data);
+	    if (folded) {
+		*unfolded = d.encode();
+	    }
+	}
+    }
+
+    void aggregateIO(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_io_trace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_trace_data));
+	addEventTimes(d.data.stacktraces.stacktraces_val,
+		      d.data.stacktraces.stacktraces_len,
+		      d.data.events.events_val, d.data.events.events_len, buf);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.events.events_val, d.data.events.events_len)) {
+	    *unfolded = d.encode();
+	}
+    }
 
+    void aggregateIOP(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_io_profile_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_profile_data));
+	addProfileTimes(d.data.stacktraces.stacktraces_val,
+			d.data.time.time_val, d.data.time.time_len, buf);
+	if (unfolded != NULL &&
+	    unfoldCountedStacks(d.data, &d.data.time.time_len,
+				&d.data.time.time_val)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateIOT(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_io_exttrace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_exttrace_data));
+	addEventTimes(d.data.stacktraces.stacktraces_val,
+		      d.data.stacktraces.stacktraces_len,
+		      d.data.events.events_val, d.data.events.events_len, buf);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.events.events_val, d.data.events.events_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateMem(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_mem_exttrace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data));
+	addEventTimes(d.data.stacktraces.stacktraces_val,
+		      d.data.stacktraces.stacktraces_len,
+		      d.data.events.events_val, d.data.events.events_len, buf);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.events.events_val, d.data.events.events_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateMemHist(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_mem_histogram_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_histogram_data));
+	AddressCounts addressTime;
+	for (unsigned i = 0; i < d.data.sites.sites_len; ++i) {
+	    addStackTime(d.data.stacktraces.stacktraces_val,
+			 d.data.stacktraces.stacktraces_len,
+			 d.data.sites.sites_val[i].stacktrace,
+			 d.data.sites.sites_val[i].time, addressTime);
+	}
+	buf.updateAddressCounts(addressTime);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.sites.sites_val, d.data.sites.sites_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateOmptLocks(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_ompt_mutex_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_ompt_mutex_data));
+	AddressCounts addressTime;
+	for (unsigned i = 0; i < d.data.mutexes.mutexes_len; ++i) {
+	    // mutexes acquired through the pre-5.0 interface have no call site
+	    if (d.data.mutexes.mutexes_val[i].codeptr == 0) continue;
+	    addressTime[Address(d.data.mutexes.mutexes_val[i].codeptr)] +=
+		d.data.mutexes.mutexes_val[i].wait_time;
+	}
+	buf.updateAddressCounts(addressTime);
+    }
+
+    void aggregateOmptP(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_ompt_profile_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_ompt_profile_data));
+	addProfileTimes(d.data.stacktraces.stacktraces_val,
+			d.data.time.time_val, d.data.time.time_len, buf);
+	if (unfolded != NULL &&
+	    unfoldCountedStacks(d.data, &d.data.time.time_len,
+				&d.data.time.time_val)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregatePthreads(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_pthreads_exttrace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_pthreads_exttrace_data));
+	addEventTimes(d.data.stacktraces.stacktraces_val,
+		      d.data.stacktraces.stacktraces_len,
+		      d.data.events.events_val, d.data.events.events_len, buf);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.events.events_val, d.data.events.events_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregatePthreadLocks(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_pthreads_contention_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_pthreads_contention_data));
+	AddressCounts addressTime;
+	for (unsigned i = 0; i < d.data.locks.locks_len; ++i) {
+	    addStackTime(d.data.stacktraces.stacktraces_val,
+			 d.data.stacktraces.stacktraces_len,
+			 d.data.locks.locks_val[i].stacktrace,
+			 d.data.locks.locks_val[i].wait_time, addressTime);
+	}
+	buf.updateAddressCounts(addressTime);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.locks.locks_val, d.data.locks.locks_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateMPI(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_mpi_trace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_trace_data));
+	addEventTimes(d.data.stacktraces.stacktraces_val,
+		      d.data.stacktraces.stacktraces_len,
+		      d.data.events.events_val, d.data.events.events_len, buf);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.events.events_val, d.data.events.events_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateMPIP(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_mpi_profile_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_profile_data));
+	addProfileTimes(d.data.stacktraces.stacktraces_val,
+			d.data.time.time_val, d.data.time.time_len, buf);
+	if (unfolded != NULL &&
+	    unfoldCountedStacks(d.data, &d.data.time.time_len,
+				&d.data.time.time_val)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    void aggregateMPIT(const Blob& blob, AddressBuffer& buf, Blob* unfolded)
+    {
+	Decoded<CBTF_mpi_exttrace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_exttrace_data));
+	addEventTimes(d.data.stacktraces.stacktraces_val,
+		      d.data.stacktraces.stacktraces_len,
+		      d.data.events.events_val, d.data.events.events_len, buf);
+	if (unfolded != NULL &&
+	    unfoldIndexedStacks(d.data.stacktraces.stacktraces_len,
+		d.data.stacktraces.stacktraces_val,
+		d.data.events.events_val, d.data.events.events_len)) {
+	    *unfolded = d.encode();
+	}
+    }
+
+    unsigned contextUsertime(const Blob& blob, CallingContextTree& cct)
+    {
+	Decoded<CBTF_usertime_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_usertime_data));
+	uint64_t weight = sampleWeight(d.data.interval,
+				       d.data.effective_interval);
+	addSampleStacks(d.data.stacktraces.stacktraces_len,
+			d.data.stacktraces.stacktraces_val,
+			d.data.count.count_val, cct, weight);
+	// collectors built with a calling context tree send its nodes.
+	cct.addTree(d.data.cct_pc.cct_pc_len, d.data.cct_pc.cct_pc_val,
+		    d.data.cct_parent.cct_parent_val,
+		    d.data.cct_count.cct_count_val, weight);
+	return d.size;
+    }
+
+    unsigned contextHwcTime(const Blob& blob, CallingContextTree& cct)
+    {
+	Decoded<CBTF_hwctime_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_hwctime_data));
+	addSampleStacks(d.data.stacktraces.stacktraces_len,
+			d.data.stacktraces.stacktraces_val,
+			d.data.count.count_val, cct, 1);
+	cct.addTree(d.data.cct_pc.cct_pc_len, d.data.cct_pc.cct_pc_val,
+		    d.data.cct_parent.cct_parent_val,
+		    d.data.cct_count.cct_count_val, 1);
+	return d.size;
+    }
+
+    unsigned contextIO(const Blob& blob, CallingContextTree& cct)
+    {
+	Decoded<CBTF_io_trace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_trace_data));
+	addEventStacks(d.data.stacktraces.stacktraces_len,
+		       d.data.stacktraces.stacktraces_val,
+		       d.data.events.events_len, d.data.events.events_val, cct);
+	return d.size;
+    }
+
+    unsigned contextIOT(const Blob& blob, CallingContextTree& cct)
+    {
+	Decoded<CBTF_io_exttrace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_exttrace_data));
+	addEventStacks(d.data.stacktraces.stacktraces_len,
+		       d.data.stacktraces.stacktraces_val,
+		       d.data.events.events_len, d.data.events.events_val, cct);
+	return d.size;
+    }
+
+    unsigned contextMem(const Blob& blob, CallingContextTree& cct)
+    {
+	Decoded<CBTF_mem_exttrace_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data));
+	addEventStacks(d.data.stacktraces.stacktraces_len,
+		       d.data.stacktraces.stacktraces_val,
+		       d.data.events.events_len, d.data.events.events_val, cct);
+	return d.size;
+    }
+
+    unsigned contentionOmptLocks(const Blob& blob, LockContention& contention)
+    {
+	Decoded<CBTF_ompt_mutex_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_ompt_mutex_data));
+	contention.update(d.data);
+	return d.size;
+    }
+
+    unsigned contentionPthreadLocks(const Blob& blob, LockContention& contention)
+    {
+	Decoded<CBTF_pthreads_contention_data> d(blob,
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_pthreads_contention_data));
+	contention.update(d.data);
+	return d.size;
+    }
+
+    /** Functions handling the data of one collector. */
+    struct CollectorFunctions {
+
+	/** Adds the addresses of the data and unfolds its stacks. */
+	AggregateFunction aggregate;
+
+	/** Folds the stacks of the data into a calling context tree. */
+	ContextFunction callingContext;
+
+	/** Adds the lock contention statistics of the data. */
+	ContentionFunction lockContention;
+
+    };
+
+    CollectorFunctions functions(AggregateFunction aggregate,
+				 ContextFunction callingContext = NULL,
+				 ContentionFunction lockContention = NULL)
+    {
+	CollectorFunctions f = { aggregate, callingContext, lockContention };
+	return f;
+    }
+
+    /** Functions of each collector by collector ID. */
+    typedef std::map<std::string, CollectorFunctions> CollectorTable;
+
+    // A null function marks data a collector doesn't carry. Collectors whose
+    // data carries no addresses have a null aggregate function. A new
+    // collector only needs an entry here.
+    CollectorTable makeCollectorTable()
+    {
+	CollectorTable table;
+	table["pcsamp"] = functions(aggregatePCSamp);
+	table["hwc"] = functions(aggregateHwc);
+	table["hwcsamp"] = functions(aggregateHwcSamp);
+	table["usertime"] = functions(aggregateUsertime, contextUsertime);
+	table["hwctime"] = functions(aggregateHwcTime, contextHwcTime);
+	table["io"] = functions(aggregateIO, contextIO);
+	table["iop"] = functions(aggregateIOP);
+	table["iot"] = functions(aggregateIOT, contextIOT);
+	table["mem"] = functions(aggregateMem, contextMem);
+	table["memhist"] = functions(aggregateMemHist);
+	table["omptplocks"] =
+	    functions(aggregateOmptLocks, NULL, contentionOmptLocks);
+	table["omptp"] = functions(aggregateOmptP);
+	table["pthreads"] = functions(aggregatePthreads);
+	table["pthreadlocks"] =
+	    functions(aggregatePthreadLocks, NULL, contentionPthreadLocks);
+	table["mpi"] = functions(aggregateMPI);
+	table["mpip"] = functions(aggregateMPIP);
+	table["mpit"] = functions(aggregateMPIT);
+	// Communication matrix rows. See commMatrix.
+	table["mpicomm"] = functions(NULL);
+	// Per file descriptor I/O statistics. See ioStats.
+	table["iostats"] = functions(NULL);
+	// Kokkos kernel timings. See kokkosKernels.
+	table["kokkos"] = functions(NULL);
+	// Memory usage time series reduced by the mem aggregator.
+	table["memusage"] = functions(NULL);
+	return table;
+    }
+
+    /** Table built once at load time so lookups need no locking. */
+    const CollectorTable collector_table = makeCollectorTable();
+
+    // Find the functions of the collector named by the data header of the
+    // passed blob and the data that follows the header. Returns null for
+    // blobs of unknown collectors.
+    const CollectorFunctions* findCollector(const Blob& blob,
+					    unsigned& header_size, Blob& data)
+    {
+	CBTF_DataHeader header;
+	memset(&header, 0, sizeof(header));
+	header_size = blob.getXDRDecoding(
+	    reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+	    );
+	CollectorTable::const_iterator ci = collector_table.find(header.id);
+	xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+		 reinterpret_cast<char*>(&header));
+
+	data = Blob(blob.getSize() - header_size,
+		    &(reinterpret_cast<const char *>(blob.getContents())[header_size]));
+	return (ci == collector_table.end()) ? NULL : &ci->second;
     }
 };
 
 int PerfData::aggregate(const Blob &blob, AddressBuffer &buf) {
-	// decode this blobs data header
-        CBTF_DataHeader header;
-        memset(&header, 0, sizeof(header));
-        unsigned header_size = blob.getXDRDecoding(
-            reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
-            );
-	std::string collectorID(header.id);
+	return aggregate(blob, buf, NULL);
+}
 
-	// find the actual data blob after the header and create a Blob.
+// Aggregation of the addresses of a blob that also unfolds the stacks folded
+// by the collectors (see FoldFrames.h) from the same decoding of the data.
+// When unfolded is not null and any stack of the blob was folded, it is set
+// to a copy of the blob with each repeat frame replaced by the copies of its
+// cycle that it stands for. The copy is XDR encoded even if the blob is
+// natively encoded. Otherwise unfolded is left as it is. The leaf CPs unfold
+// every blob as it arrives so that nothing above the aggregators ever sees a
+// repeat frame.
+int PerfData::aggregate(const Blob &blob, AddressBuffer &buf, Blob* unfolded) {
+	// find the actual data blob after the header.
 	// TODO at callsite: Map the incoming data size to it's thread and increment as new
 	// data for same thread arrives.  Could be use to identify threads
 	// that are generating more data than others. REDUCTION.
-	unsigned data_size = blob.getSize() - header_size;
-	const void* data_ptr = &(reinterpret_cast<const char *>(blob.getContents())[header_size]);
-	Blob dblob(data_size,data_ptr);
+	unsigned header_size;
+	Blob dblob;
+	const CollectorFunctions* cf = findCollector(blob, header_size, dblob);
+	unsigned data_size = dblob.getSize();
 
 #ifndef NDEBUG
         if (is_debug_aggregator_events_enabled) {
-	    std::cerr << "Aggregating Data Blob addresses for "
-	    << collectorID << " data bytes: " << data_size
+	    std::cerr << "Aggregating Data Blob addresses"
+	    << " data bytes: " << data_size
 	    << std::endl;
 	}
 #endif
 
 	// The following does a global aggregation of the data. Not per thread of execution.
-	if (collectorID == "pcsamp" || collectorID == "hwc" || collectorID == "hwcsamp") {
-	    uint64_t interval;
-            aggregatePCData(collectorID, dblob, buf, interval);
-	} else if (collectorID == "usertime" || collectorID == "hwctime") {
-	    uint64_t interval;
-            aggregateSTSampleData(collectorID, dblob, buf, interval);
-        } else if (collectorID == "io" || collectorID == "iot" ||
-		   collectorID == "iop" || collectorID == "mem" ||
-		   collectorID == "mpi" || collectorID == "mpit" ||
-		   collectorID == "mpip" || collectorID == "pthreads" ||
-		   collectorID == "omptp" ) {
-            aggregateSTTraceData(collectorID, dblob, buf);
-	} else {
+	if (cf == NULL) {
 	    std::cerr << "Unknown collector data handled!" << std::endl;
+	    return data_size;
+	} else if (cf->aggregate == NULL) {
+	    return data_size;
+	}
+
+	Blob data;
+	cf->aggregate(dblob, buf, (unfolded != NULL) ? &data : NULL);
+	if (!data.isEmpty()) {
+	    // the header is passed on as it is.
+	    std::vector<char> contents(header_size + data.getSize());
+	    memcpy(&contents[0], blob.getContents(), header_size);
+	    memcpy(&contents[header_size], data.getContents(), data.getSize());
+	    *unfolded = Blob(contents.size(), &contents[0]);
+	}
+	return data_size;
+}
+
+// Aggregation of the addresses of a performance data blob arriving at a leaf
+// CP. Sets out to the blob passed on from there: the unfolded copy of the
+// blob if any of its stacks were folded, or else the blob converted to XDR.
+// Natively encoded blobs are aggregated without converting them first. Throws
+// std::runtime_error if the blob can't be converted.
+int PerfData::aggregate(const boost::shared_ptr<CBTF_Protocol_Blob>& in,
+			AddressBuffer &buf,
+			boost::shared_ptr<CBTF_Protocol_Blob>& out) {
+	Blob blob(in->data.data_len, in->data.data_val);
+	Blob unfolded;
+	int data_size = aggregate(blob, buf, &unfolded);
+	if (unfolded.isEmpty()) {
+	    out = KrellInstitute::Messages::toXDR(in);
+	    return data_size;
 	}
+
+	out.reset(
+	    new CBTF_Protocol_Blob(),
+	    boost::bind(&KrellInstitute::Messages::Impl::xdr_deleter<
+			    CBTF_Protocol_Blob>, _1,
+			reinterpret_cast<xdrproc_t>(xdr_CBTF_Protocol_Blob))
+	    );
+	out->data.data_len = unfolded.getSize();
+	out->data.data_val =
+	    reinterpret_cast<uint8_t*>(malloc(out->data.data_len));
+	memcpy(out->data.data_val, unfolded.getContents(), unfolded.getSize());
 	return data_size;
 }
 
@@ -1192,6 +1680,10 @@ int PerfData::memMetrics(const Blob &blob, MemMetrics& metrics) {
 	    }
 	}
 
+	// Track the allocated bytes over time.
+	metrics.usage.update(data.events.events_val[i].start_time,
+			     metrics.currentAllocation, stack);
+
 	// The MemEvent records a stack. The StackTraceCountMap stackCounts
 	// records the number of times that path was called in the MemMetrics
 	// struct. Ideally the OSS database schema could define a StackTrace
@@ -1370,3 +1862,249 @@ int PerfData::memMetrics(const Blob &blob, MemMetrics& metrics) {
     xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_exttrace_data),
                  reinterpret_cast<char*>(&data));
 }
+
+// Communication matrix rows from the mpit collector.
+// Adds the row in the passed blob to the matrix under the rank that sent it
+// and returns the size of the decoded row. Blobs from any other collector
+// are ignored.
+int PerfData::commMatrix(const Blob &blob, CommMatrix& matrix) {
+    // decode this blobs data header
+    CBTF_DataHeader header;
+    memset(&header, 0, sizeof(header));
+    unsigned header_size = blob.getXDRDecoding(
+            reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+            );
+    std::string collectorID(header.id);
+    int rank = header.rank;
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+	     reinterpret_cast<char*>(&header));
+
+    if (collectorID != "mpicomm") {
+	return 0;
+    }
+
+    // find the actual data blob after the header and create a Blob.
+    const void* data_ptr =
+	&(reinterpret_cast<const char *>(blob.getContents())[header_size]);
+    Blob dblob(blob.getSize() - header_size,data_ptr);
+
+    CBTF_mpi_comm_row_data data;
+    memset(&data, 0, sizeof(data));
+    unsigned bsize =
+	dblob.getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_comm_row_data),
+					    &data);
+
+    matrix.updateCommMatrix(rank, data);
+
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mpi_comm_row_data),
+	     reinterpret_cast<char*>(&data));
+    return bsize;
+}
+
+// Pathnames from the iot collector.
+// Adds the pathnames first sent in the passed blob to the per thread path
+// IDs so that the pathindex of each event can be resolved. Blobs from any
+// other collector are ignored.
+int PerfData::ioPathnames(const Blob &blob, IOPathnames& pathnames) {
+    // decode this blobs data header
+    CBTF_DataHeader header;
+    memset(&header, 0, sizeof(header));
+    unsigned header_size = blob.getXDRDecoding(
+            reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+            );
+    std::string collectorID(header.id);
+    ThreadName threadname(header.host,header.pid,header.posix_tid,header.rank,header.omp_tid);
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+	     reinterpret_cast<char*>(&header));
+
+    if (collectorID != "iot") {
+	return 0;
+    }
+
+    // find the actual data blob after the header and create a Blob.
+    const void* data_ptr =
+	&(reinterpret_cast<const char *>(blob.getContents())[header_size]);
+    Blob dblob(blob.getSize() - header_size,data_ptr);
+
+    CBTF_io_exttrace_data data;
+    memset(&data, 0, sizeof(data));
+    unsigned bsize =
+	dblob.getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_exttrace_data),
+					    &data);
+
+    pathnames.update(threadname, data);
+
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_exttrace_data),
+	     reinterpret_cast<char*>(&data));
+    return bsize;
+}
+
+// Per file descriptor I/O statistics from the iot collector.
+// Adds the statistics in the passed blob to the per file totals and returns
+// the size of the decoded statistics. Blobs from any other collector are
+// ignored.
+int PerfData::ioStats(const Blob &blob, IOStats& stats) {
+    // decode this blobs data header
+    CBTF_DataHeader header;
+    memset(&header, 0, sizeof(header));
+    unsigned header_size = blob.getXDRDecoding(
+            reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+            );
+    std::string collectorID(header.id);
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+	     reinterpret_cast<char*>(&header));
+
+    if (collectorID != "iostats") {
+	return 0;
+    }
+
+    // find the actual data blob after the header and create a Blob.
+    const void* data_ptr =
+	&(reinterpret_cast<const char *>(blob.getContents())[header_size]);
+    Blob dblob(blob.getSize() - header_size,data_ptr);
+
+    CBTF_io_stats_data data;
+    memset(&data, 0, sizeof(data));
+    unsigned bsize =
+	dblob.getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_io_stats_data),
+					    &data);
+
+    stats.update(data);
+
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_io_stats_data),
+	     reinterpret_cast<char*>(&data));
+    return bsize;
+}
+
+// Allocation size histograms from the mem collector.
+// Merges the histogram of each call site in the passed blob into the
+// histogram of the same call stack and returns the size of the decoded
+// histograms. Blobs from any other collector are ignored.
+int PerfData::memHistograms(const Blob &blob, MemMetrics& metrics) {
+    // decode this blobs data header
+    CBTF_DataHeader header;
+    memset(&header, 0, sizeof(header));
+    unsigned header_size = blob.getXDRDecoding(
+            reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+            );
+    std::string collectorID(header.id);
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+	     reinterpret_cast<char*>(&header));
+
+    if (collectorID != "memhist") {
+	return 0;
+    }
+
+    // find the actual data blob after the header and create a Blob.
+    const void* data_ptr =
+	&(reinterpret_cast<const char *>(blob.getContents())[header_size]);
+    Blob dblob(blob.getSize() - header_size,data_ptr);
+
+    CBTF_mem_histogram_data data;
+    memset(&data, 0, sizeof(data));
+    unsigned bsize =
+	dblob.getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_histogram_data),
+					    &data);
+
+    for(unsigned i = 0; i < data.sites.sites_len; ++i) {
+	const CBTF_mem_size_histogram& site = data.sites.sites_val[i];
+
+	StackTrace stack;
+	for (unsigned j = site.stacktrace;
+	     j < data.stacktraces.stacktraces_len; ++j) {
+	    // end of stack
+	    if (data.stacktraces.stacktraces_val[j] == 0) break;
+	    stack.push_back(Address(data.stacktraces.stacktraces_val[j]));
+	}
+
+	MemSizeHistogram& histogram = metrics.sizeHistograms[stack];
+	histogram.calls += site.calls;
+	histogram.time += site.time;
+	for (int k = 0; k < CBTF_MEM_HISTOGRAM_SIZE; ++k) {
+	    histogram.count[k] += site.count[k];
+	    histogram.bytes[k] += site.bytes[k];
+	}
+    }
+
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_mem_histogram_data),
+	     reinterpret_cast<char*>(&data));
+    return bsize;
+}
+
+// Lock contention statistics from the pthreads and omptp collectors.
+// Adds the statistics of each lock in the passed blob to the totals of the
+// same mutex and call site and returns the size of the decoded statistics.
+// Blobs from any other collector are ignored.
+int PerfData::lockContention(const Blob &blob, LockContention& contention) {
+    unsigned header_size;
+    Blob dblob;
+    const CollectorFunctions* cf = findCollector(blob, header_size, dblob);
+    if (cf == NULL || cf->lockContention == NULL) {
+	return 0;
+    }
+    return cf->lockContention(dblob, contention);
+}
+
+// Kokkos kernel timings from the overview collector.
+// Adds the timings of each kernel in the passed blob to the totals of the
+// same kernel and returns the size of the decoded timings. Blobs from any
+// other collector are ignored.
+int PerfData::kokkosKernels(const Blob &blob, KokkosKernels& kernels) {
+    // decode this blobs data header
+    CBTF_DataHeader header;
+    memset(&header, 0, sizeof(header));
+    unsigned header_size = blob.getXDRDecoding(
+            reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+            );
+    std::string collectorID(header.id);
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+	     reinterpret_cast<char*>(&header));
+
+    if (collectorID != "kokkos") {
+	return 0;
+    }
+
+    // find the actual data blob after the header and create a Blob.
+    const void* data_ptr =
+	&(reinterpret_cast<const char *>(blob.getContents())[header_size]);
+    Blob dblob(blob.getSize() - header_size,data_ptr);
+
+    CBTF_kokkos_data data;
+    memset(&data, 0, sizeof(data));
+    unsigned bsize =
+	dblob.getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_kokkos_data),
+					    &data);
+
+    kernels.update(data);
+
+    xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_kokkos_data),
+	     reinterpret_cast<char*>(&data));
+    return bsize;
+}
+
+// Collectors whose blobs carry stacks that callingContextTree folds into
+// the tree.
+bool PerfData::hasCallingContext(const std::string& collectorID) {
+    CollectorTable::const_iterator ci = collector_table.find(collectorID);
+    return ci != collector_table.end() && ci->second.callingContext != NULL;
+}
+
+// Calling context tree of the usertime, hwctime, io, iot and mem collectors.
+// Folds each stack in the passed blob into the tree so that the tree grows
+// with the number of unique call paths rather than with the number of
+// samples or events. Returns the size of the decoded data. Blobs from any
+// other collector are ignored.
+int PerfData::callingContextTree(const Blob &blob, CallingContextTree& cct) {
+    unsigned header_size;
+    Blob dblob;
+    const CollectorFunctions* cf = findCollector(blob, header_size, dblob);
+    if (cf == NULL || cf->callingContext == NULL) {
+	return 0;
+    }
+    return cf->callingContext(dblob, cct);
+}
@@ -23,8 +23,11 @@
  */
 //#define DEBUG_OVERLAP 1
  
+#include <algorithm>
+
 #include "KrellInstitute/Core/Assert.hpp"
 #include "KrellInstitute/Core/StacktraceData.hpp"
+#include "KrellInstitute/Services/FoldFrames.h"
 
 using namespace KrellInstitute::Core;
 
@@ -45,11 +48,16 @@ void StacktraceData::aggregateAddressCounts(
 	const unsigned& len,
 	const uint64_t* st,
 	const uint8_t* counts,
-	AddressBuffer& buffer) const
+	AddressBuffer& buffer,
+	const uint64_t& weight) const
 {
-    // Iterate over each of the stacktrace address entries.
+    // Iterate over each of the stacktrace address entries. Repeat frames
+    // are never the top of a stack, so they carry no count and are skipped.
     for(unsigned i = 0; i < len; ++i) {
-	buffer.updateAddressCounts(st[i], counts[i]);
+	if (CBTF_IsFrameRepeat(st[i])) {
+	    continue;
+	}
+	buffer.updateAddressCounts(st[i], counts[i] * weight);
     }
 }
 
@@ -59,9 +67,17 @@ void StacktraceData::aggregateAddressCounts(
 	const uint64_t* st,
 	AddressBuffer& buffer) const
 {
-    // Iterate over each of the stacktrace address entries.
+    // Iterate over each of the stacktrace address entries. A repeat frame
+    // counts the frames of its cycle once more per repeat.
     for(unsigned i = 0; i < len; ++i) {
-	buffer.updateAddressCounts(st[i], 1);
+	if (!CBTF_IsFrameRepeat(st[i])) {
+	    buffer.updateAddressCounts(st[i], 1);
+	    continue;
+	}
+	unsigned length = std::min(CBTF_FrameRepeatLength(st[i]), i);
+	for(unsigned j = i - length; j < i; ++j) {
+	    buffer.updateAddressCounts(st[j], CBTF_FrameRepeatCount(st[i]));
+	}
     }
 }
 
@@ -73,6 +89,26 @@ void StacktraceData::aggregateAddressCounts(
 	buffer.updateAddressCounts(addrcounts);
 }
 
+// Handle a calling context tree built by the collector. Each node carries
+// the count of samples where it was the top of stack, so every node address
+// is recorded and the counts land on the same addresses as they would for
+// the equivalent stacktrace buffer.
+void StacktraceData::aggregateAddressCounts(
+	const unsigned& len,
+	const uint64_t* pc,
+	const uint32_t* counts,
+	AddressBuffer& buffer,
+	const uint64_t& weight) const
+{
+    // Iterate over each of the calling context tree nodes.
+    for(unsigned i = 0; i < len; ++i) {
+	if (CBTF_IsFrameRepeat(pc[i])) {
+	    continue;
+	}
+	buffer.updateAddressCounts(pc[i], counts[i] * weight);
+    }
+}
+
 // graph g is a directed graph using an adjaceny list (boost).
 void StacktraceData::graphAddressCounts(
 	const unsigned& len,
@@ -102,7 +138,8 @@ void StacktraceData::graphAddressCounts(
 	  // terminate the stack.  In some cases, OpenMP stacks are
 	  // recorded with a begin frame of 0x0. Ignore these.
 	  // do not create an edge out of a terminal frame...
-	  if (counts[i] == 0 && st[i] > 0) {
+	  if (counts[i] == 0 && st[i] > 0 &&
+	      !CBTF_IsFrameRepeat(st[i]) && !CBTF_IsFrameRepeat(st[k])) {
 	    Address out((uint64_t)st[i]);
 	    Address in((uint64_t)st[k]);
 	    uint64_t cost = counts[i];
@@ -132,3 +169,26 @@ void StacktraceData::graphAddressCounts(
 #endif
     }
 }
+
+// graph g is a directed graph using an adjaceny list (boost).
+// The calling context tree already holds one edge per node from its
+// parent (caller) to the node itself, so no stack walking is needed.
+void StacktraceData::graphAddressCounts(
+	const unsigned& len,
+	const uint64_t* pc,
+	const uint32_t* parent,
+	const uint32_t* counts,
+	Graph& g) const
+{
+    for(unsigned i = 0; i < len; ++i) {
+	// nodes without a caller have no edge into them.
+	if (parent[i] >= len || CBTF_IsFrameRepeat(pc[i]) ||
+	    CBTF_IsFrameRepeat(pc[parent[i]])) {
+	    continue;
+	}
+	Address out((uint64_t)pc[parent[i]]);
+	Address in((uint64_t)pc[i]);
+	uint64_t cost = counts[i];
+	g.addEdge(out,in,/*cost*/ cost);
+    }
+}
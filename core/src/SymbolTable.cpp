@@ -31,6 +31,7 @@
 #include "KrellInstitute/Core/Path.hpp"
 #include "KrellInstitute/Core/SymbolTable.hpp"
 
+#include <algorithm>
 #include <deque>
 
 using namespace KrellInstitute::Core;
@@ -125,7 +126,11 @@ void SymbolTable::addFunction(const Address& begin,
             table_functions.insert(
                 std::make_pair(name, std::vector<AddressRange>())
                 ).first;
-    fti->second.push_back(range);
+
+    // A function may be added once for each chunk of a spilled buffer
+    if(std::find(fti->second.begin(), fti->second.end(), range) ==
+       fti->second.end())
+	fti->second.push_back(range);
 }
 
 
@@ -175,8 +180,9 @@ void SymbolTable::addStatement(const Address& begin,
 		std::vector<AddressRange>())
 	    ).first;
     
-    // Add this address range to the statement
-    i->second.push_back(range);
+    // Add this address range to the statement (unless already present)
+    if(std::find(i->second.begin(), i->second.end(), range) == i->second.end())
+	i->second.push_back(range);
 }
 
 
@@ -0,0 +1,65 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Declaration of the native layout encoding of performance data.
+ *
+ * The high volume performance data structures (sample, stack trace and event
+ * arrays) can be sent in the native layout of the sending process instead of
+ * XDR when every participant shares that layout. Scalars are copied as they
+ * are and each array is sent as its length followed by its elements, so
+ * encoding and decoding are a memcpy per array and uint8_t counts take one
+ * byte each on the wire.
+ *
+ * Native encoding is off by default. It is requested by setting the layout
+ * of the leaf CPs in the CBTF_WIRE_LAYOUT environment variable, which the
+ * collectionTool --native-wire option does with the layout of the frontend.
+ * A collector checks that layout against its own before sending any data,
+ * and uses XDR when they differ. Every native encoding starts with a marker,
+ * the layout of the sender and the type of the structure, which the leaf CP
+ * verifies before converting the data back to XDR. Nothing above the leaf
+ * CPs ever sees a native encoding.
+ *
+ */
+
+#ifndef _KrellInstitute_Messages_NativeEncoding_
+#define _KrellInstitute_Messages_NativeEncoding_
+
+#include <rpc/rpc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Name of the environment variable holding the requested layout. */
+#define CBTF_WIRE_LAYOUT_ENV "CBTF_WIRE_LAYOUT"
+
+uint32_t CBTF_NativeLayout();
+bool_t CBTF_UseNativeEncoding();
+bool_t CBTF_HasNativeEncoding(const xdrproc_t);
+bool_t CBTF_IsNativeEncoding(const char*, unsigned);
+unsigned CBTF_NativeEncode(const xdrproc_t, const void*, char*, unsigned);
+unsigned CBTF_NativeDecode(const xdrproc_t, const char*, unsigned, void*);
+unsigned CBTF_NativeToXDR(const char*, unsigned, char**);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
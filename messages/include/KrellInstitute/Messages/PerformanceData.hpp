@@ -27,8 +27,10 @@
 #include <boost/format.hpp>
 #include <boost/shared_ptr.hpp>
 #include <cstdlib>
+#include <cstring>
 #include <KrellInstitute/Messages/DataHeader.h>
 #include <KrellInstitute/Messages/Blob.h>
+#include <KrellInstitute/Messages/NativeEncoding.h>
 #include <rpc/rpc.h>
 #include <stdexcept>
 #include <typeinfo>
@@ -241,5 +243,89 @@ namespace KrellInstitute { namespace Messages {
         // Return the performance data header and data to the caller
         return out;
     }
-    
+
+    /**
+     * Convert the specified performance data blob into one whose performance
+     * data is encoded with XDR.
+     *
+     * @param in    Performance data blob.
+     * @return      Performance data blob with the same header and the
+     *              performance data encoded with XDR. This is the passed
+     *              blob itself if its performance data wasn't natively
+     *              encoded.
+     *
+     * @note    The collectors may send their performance data in the native
+     *          layout encoding. The leaf CPs use this function so that every
+     *          blob they pass on is of the same format as Open|SpeedShop's
+     *          performance data blobs.
+     */
+    inline boost::shared_ptr<CBTF_Protocol_Blob> toXDR(
+        const boost::shared_ptr<CBTF_Protocol_Blob>& in
+        )
+    {
+        if (!in)
+        {
+            throw std::runtime_error(
+                "The performance data blob to convert was null."
+                );
+        }
+
+        // Find the end of the performance data header
+        CBTF_DataHeader header;
+        memset(&header, 0, sizeof(header));
+        XDR xdrs;
+        xdrmem_create(&xdrs,
+                      reinterpret_cast<char*>(in->data.data_val),
+                      static_cast<unsigned int>(in->data.data_len),
+                      XDR_DECODE);
+        bool_t ok = xdr_CBTF_DataHeader(&xdrs, &header);
+        unsigned int header_size = xdr_getpos(&xdrs);
+        xdr_destroy(&xdrs);
+        xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+                 reinterpret_cast<char*>(&header));
+
+        if (!ok)
+        {
+            throw std::runtime_error(
+                "The performance data blob to convert had no header."
+                );
+        }
+
+        // Blobs already encoded with XDR are passed on as they are
+        const char* data =
+            reinterpret_cast<const char*>(in->data.data_val) + header_size;
+        unsigned int data_size = in->data.data_len - header_size;
+        if (!CBTF_IsNativeEncoding(data, data_size))
+        {
+            return in;
+        }
+
+        char* xdr_data = NULL;
+        unsigned int xdr_size = CBTF_NativeToXDR(data, data_size, &xdr_data);
+        if (xdr_size == 0)
+        {
+            throw std::runtime_error(
+                "The natively encoded performance data blob was truncated "
+                "or of a layout other than that of this process."
+                );
+        }
+
+        // Allocate the performance data blob
+        boost::shared_ptr<CBTF_Protocol_Blob> out(
+            new CBTF_Protocol_Blob(),
+            boost::bind(&Impl::xdr_deleter<CBTF_Protocol_Blob>, _1,
+                        reinterpret_cast<xdrproc_t>(xdr_CBTF_Protocol_Blob))
+            );
+
+        out->data.data_len = header_size + xdr_size;
+        out->data.data_val =
+            reinterpret_cast<uint8_t*>(malloc(header_size + xdr_size));
+        memcpy(out->data.data_val, in->data.data_val, header_size);
+        memcpy(out->data.data_val + header_size, xdr_data, xdr_size);
+        free(xdr_data);
+
+        // Return the performance data blob to the caller
+        return out;
+    }
+
 } } // namespace KrellInstitute::Messages
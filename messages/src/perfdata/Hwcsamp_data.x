@@ -32,6 +32,9 @@ struct CBTF_hwcsamp_event {
 /** Structure of the blob containing our performance data. */
 struct CBTF_hwcsamp_data {
     uint64_t interval;    /**< Sampling interval in nanoseconds. */
+    uint64_t effective_interval; /**< Interval actually in effect for these */
+				 /**< samples when the timer adapts its rate. */
+				 /**< A power of 2 multiple of interval, or 0. */
     uint64_t pc<>;        /**< Program counter (PC) addresses. */
     uint8_t count<>;      /**< Sample counts at those addresses. */    
     CBTF_hwcsamp_event events<>;
@@ -39,4 +39,14 @@ struct CBTF_hwctime_data {
 			  /**< Positive entries the count buffer represent */
 			  /**< the index into the address buffer (bt) for a */
 			  /**< specifc stack */
+
+    uint64_t cct_pc<>;    /**< Calling context tree node addresses. Used */
+			  /**< instead of stacktraces and count when the */
+			  /**< collector builds the tree itself. */
+
+    uint32_t cct_parent<>; /**< Index of each node's caller. Nodes without */
+			   /**< a caller have a parent index of ~0. */
+
+    uint32_t cct_count<>; /**< Number of samples with the node as the top */
+			  /**< of stack. */
 };
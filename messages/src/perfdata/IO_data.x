@@ -64,7 +64,7 @@ struct CBTF_iot_event {
     uint64_t stop_time;   /**< End time of the call. */
     uint16_t stacktrace;  /**< Index of the stack trace. */
 
-    uint16_t pathindex;         /**< Index of the pathnames. */
+    uint16_t pathindex;         /**< Path ID of the pathname (0 if none). */
     uint16_t syscallno;         /**< System call number. */
     uint16_t nsysargs;          /**< Number of arg to the syscall. */
     uint64_t sysargs[CBTF_IO_MAXARGS];  /**< Actual arguments as integers. */
@@ -81,7 +81,39 @@ struct CBTF_io_trace_data {
 struct CBTF_io_exttrace_data {
     uint64_t stacktraces<>;  /**< Stack traces. */
     CBTF_iot_event events<>;  /**< IO call events. */
-    char pathnames<>;        /**< I/O pathnames. */
+    uint16_t first_pathid;   /**< Path ID of the first pathname below. A */
+			     /**< value of 1 starts a new set of path IDs. */
+    char pathnames<>;        /**< I/O pathnames seen for the first time by */
+			     /**< this thread, each zero terminated, with */
+			     /**< consecutive path IDs. */
+};
+
+
+/** Number of bins in each latency histogram of the I/O statistics. */
+const CBTF_IO_STATS_HISTOGRAM_SIZE = 16;
+
+/** Structure describing the I/O done through one file descriptor. */
+struct CBTF_io_fd_stats {
+    int fd;                 /**< File descriptor. */
+    uint32_t pathname;      /**< Offset of the pathname in pathnames. */
+    uint64_t read_calls;    /**< Number of read calls. */
+    uint64_t read_bytes;    /**< Number of bytes read. */
+    uint64_t read_time;     /**< Total time spent in read calls. */
+    uint64_t write_calls;   /**< Number of write calls. */
+    uint64_t write_bytes;   /**< Number of bytes written. */
+    uint64_t write_time;    /**< Total time spent in write calls. */
+    uint64_t other_calls;   /**< Number of other calls (open, seek, ...). */
+    uint64_t other_time;    /**< Total time spent in other calls. */
+    uint64_t sequential;    /**< Reads and writes at the previous end offset. */
+    uint64_t random;        /**< Reads and writes anywhere else. */
+    uint32_t histogram[CBTF_IO_STATS_HISTOGRAM_SIZE]; /**< Calls binned by */
+			    /**< the log2 of their time in microseconds. */
+};
+
+/** Structure of the blob containing per file descriptor I/O statistics. */
+struct CBTF_io_stats_data {
+    CBTF_io_fd_stats files<>;  /**< Statistics of each file descriptor. */
+    char pathnames<>;          /**< Zero terminated pathnames of the files. */
 };
 
 
@@ -0,0 +1,49 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Specification of the Kokkos kernel timing blobs sent through the overview
+ * collector.
+ *
+ */
+
+
+/** Kinds of aggregated Kokkos timings. */
+enum CBTF_kokkos_type {
+    CBTF_KOKKOS_PARALLEL_FOR = 0,
+    CBTF_KOKKOS_PARALLEL_REDUCE = 1,
+    CBTF_KOKKOS_PARALLEL_SCAN = 2,
+    CBTF_KOKKOS_PROFILE_REGION = 3
+};
+
+/** Aggregated timings of a single Kokkos kernel or profile region. */
+struct CBTF_kokkos_kernel {
+    uint32_t name;          /**< Offset of the name within the names. */
+    CBTF_kokkos_type type;  /**< Kind of kernel or region. */
+    uint64_t calls;         /**< Number of launches (or region entries). */
+    uint64_t total_time;    /**< Total time of the launches. */
+    uint64_t min_time;      /**< Shortest launch. */
+    uint64_t max_time;      /**< Longest launch. */
+};
+
+/** Structure of the blob containing aggregated Kokkos timings. */
+struct CBTF_kokkos_data {
+    CBTF_kokkos_kernel kernels<>;  /**< Timings of each kernel. */
+    char names<>;  /**< Null-terminated names referenced by the kernels. */
+};
@@ -105,3 +105,56 @@ struct CBTF_overview_mem_event {
     CBTF_mem_type mem_type;   /**< event kind */
     uint16_t stacktrace;  /**< Index of the stack trace. */
 };
+
+/** Number of log2 allocation size bins in each histogram. */
+const CBTF_MEM_HISTOGRAM_SIZE = 32;
+
+/**
+ * Allocation size histogram of a single call site. Bin 0 holds zero byte
+ * allocations, bin b holds allocations of [2^(b-1), 2^b) bytes and the last
+ * bin also holds every larger allocation.
+ */
+struct CBTF_mem_size_histogram {
+    uint64_t calls;      /**< Number of calls, including frees. */
+    uint64_t time;       /**< Total time spent in the calls. */
+    uint32_t count[CBTF_MEM_HISTOGRAM_SIZE];  /**< Allocations in each bin. */
+    uint64_t bytes[CBTF_MEM_HISTOGRAM_SIZE];  /**< Bytes in each bin. */
+    uint16_t stacktrace; /**< Index of the call site's stack trace. */
+};
+
+/** Structure of the blob containing allocation size histograms. */
+struct CBTF_mem_histogram_data {
+    uint64_t stacktraces<>;              /**< Stack traces. */
+    CBTF_mem_size_histogram sites<>;     /**< Histogram of each call site. */
+};
+
+/** Maximum number of buckets in a memory usage time series. */
+const CBTF_MEM_USAGE_SIZE = 256;
+
+/** Maximum number of call sites given their own usage series. */
+const CBTF_MEM_USAGE_SITES = 8;
+
+/** Memory usage of a thread during one bucket of time. */
+struct CBTF_mem_usage_bucket {
+    uint64_t live;         /**< Bytes allocated at the end of the bucket. */
+    uint64_t peak;         /**< Most bytes allocated during the bucket. */
+    uint64_t allocated;    /**< Bytes allocated during the bucket. */
+    uint64_t freed;        /**< Bytes freed during the bucket. */
+    uint32_t allocations;  /**< Calls that allocated memory. */
+    uint32_t frees;        /**< Calls that freed memory. */
+};
+
+/**
+ * Structure of the blob containing the memory usage time series of a
+ * thread. Bucket i covers [time_begin + i * interval, time_begin + (i + 1)
+ * * interval) with time_begin taken from the data header. The bytes
+ * allocated by each of the top call sites in every bucket are given in
+ * site_allocated, one row of buckets_len values per site.
+ */
+struct CBTF_mem_usage_data {
+    uint64_t interval;                /**< Width of each bucket. */
+    CBTF_mem_usage_bucket buckets<>;  /**< Usage in each bucket. */
+    uint64_t stacktraces<>;           /**< Stack traces of the top sites. */
+    uint32_t sites<>;                 /**< Stack trace index of each site. */
+    uint64_t site_allocated<>;        /**< Bytes allocated per site and bucket. */
+};
@@ -67,6 +67,27 @@ struct CBTF_mpi_exttrace_data {
 };
 
 
+/** Number of buckets in the message time histogram. */
+const CBTF_MPI_COMM_HISTOGRAM_SIZE = 16;
+
+/** Messages sent from one rank to one of its peers. */
+struct CBTF_mpi_comm_peer {
+    int peer;         /**< Destination rank (in MPI_COMM_WORLD). */
+    uint64_t count;   /**< Number of messages sent. */
+    uint64_t bytes;   /**< Number of bytes sent. */
+    uint64_t time;    /**< Total time spent in the sends. */
+    uint32_t histogram[CBTF_MPI_COMM_HISTOGRAM_SIZE]; /**< Sends binned by */
+			  /**< time. Bucket 0 counts sends under 1 microsecond, */
+			  /**< bucket i those taking [2^(i-1), 2^i) microseconds */
+			  /**< and the last bucket all longer sends. */
+};
+
+/** Structure of the blob containing a row of the communication matrix. */
+struct CBTF_mpi_comm_row_data {
+    CBTF_mpi_comm_peer peers<>;  /**< Peers this rank sent messages to. */
+};
+
+
 /** Structure of the blob containing profile performance data. */
 struct CBTF_mpi_profile_data {
     uint64_t stacktraces<>;  /**< Stack traces. */
@@ -0,0 +1,501 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the native layout encoding of performance data.
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "KrellInstitute/Messages/NativeEncoding.h"
+#include "PCSamp_data.h"
+#include "Hwc_data.h"
+#include "Hwcsamp_data.h"
+#include "Hwctime_data.h"
+#include "Usertime_data.h"
+#include "IO_data.h"
+#include "Mem_data.h"
+#include "Mpi_data.h"
+#include "Pthreads_data.h"
+
+
+
+/** Marker starting every native encoding. Reads as a length or interval far
+ *  beyond any real one when taken as the start of an XDR encoding. */
+#define NativeMarker 0x4E415456
+
+/** Version of the native encoding. Bumped whenever a structure changes. */
+#define NativeVersion 2
+
+/** Size of the prefix (marker, layout and type) of every native encoding. */
+#define NativePrefixSize (3 * sizeof(uint32_t))
+
+/** Description of one field of a structure. */
+typedef struct {
+    size_t offset;      /**< Offset of the field or of the array length. */
+    size_t val_offset;  /**< Offset of the array elements pointer. */
+    size_t size;        /**< Size of the field or of each array element. */
+    bool_t is_array;    /**< Is this field a variable length array? */
+} NativeField;
+
+/** Structure giving the alignment of 64-bit integers within structures. */
+typedef struct {
+    char c;
+    uint64_t value;
+} NativeAlign;
+
+/** Description of a structure with a native encoding. */
+typedef struct {
+    xdrproc_t xdrproc;          /**< XDR procedure for the structure. */
+    size_t size;                /**< Size of the structure. */
+    const NativeField* fields;  /**< Fields of the structure in order. */
+    unsigned nfields;           /**< Number of fields. */
+} NativeType;
+
+#define SCALAR(type, field) \
+    { offsetof(type, field), 0, sizeof(((type*)0)->field), FALSE }
+
+#define ARRAY(type, field) \
+    { offsetof(type, field.field##_len), offsetof(type, field.field##_val), \
+      sizeof(*((type*)0)->field.field##_val), TRUE }
+
+#define TYPE(type, fields) \
+    { (xdrproc_t)xdr_##type, sizeof(type), fields, \
+      sizeof(fields) / sizeof(NativeField) }
+
+static const NativeField pcsamp_fields[] = {
+    SCALAR(CBTF_pcsamp_data, interval),
+    SCALAR(CBTF_pcsamp_data, effective_interval),
+    ARRAY(CBTF_pcsamp_data, pc),
+    ARRAY(CBTF_pcsamp_data, count)
+};
+
+static const NativeField hwc_fields[] = {
+    SCALAR(CBTF_hwc_data, interval),
+    ARRAY(CBTF_hwc_data, pc),
+    ARRAY(CBTF_hwc_data, count)
+};
+
+static const NativeField hwcsamp_fields[] = {
+    SCALAR(CBTF_hwcsamp_data, interval),
+    SCALAR(CBTF_hwcsamp_data, effective_interval),
+    ARRAY(CBTF_hwcsamp_data, pc),
+    ARRAY(CBTF_hwcsamp_data, count),
+    ARRAY(CBTF_hwcsamp_data, events),
+    SCALAR(CBTF_hwcsamp_data, clock_mhz)
+};
+
+static const NativeField usertime_fields[] = {
+    SCALAR(CBTF_usertime_data, interval),
+    SCALAR(CBTF_usertime_data, effective_interval),
+    ARRAY(CBTF_usertime_data, stacktraces),
+    ARRAY(CBTF_usertime_data, count),
+    ARRAY(CBTF_usertime_data, cct_pc),
+    ARRAY(CBTF_usertime_data, cct_parent),
+    ARRAY(CBTF_usertime_data, cct_count)
+};
+
+static const NativeField hwctime_fields[] = {
+    SCALAR(CBTF_hwctime_data, interval),
+    ARRAY(CBTF_hwctime_data, stacktraces),
+    ARRAY(CBTF_hwctime_data, count),
+    ARRAY(CBTF_hwctime_data, cct_pc),
+    ARRAY(CBTF_hwctime_data, cct_parent),
+    ARRAY(CBTF_hwctime_data, cct_count)
+};
+
+static const NativeField io_fields[] = {
+    ARRAY(CBTF_io_trace_data, stacktraces),
+    ARRAY(CBTF_io_trace_data, events)
+};
+
+static const NativeField iot_fields[] = {
+    ARRAY(CBTF_io_exttrace_data, stacktraces),
+    ARRAY(CBTF_io_exttrace_data, events),
+    SCALAR(CBTF_io_exttrace_data, first_pathid),
+    ARRAY(CBTF_io_exttrace_data, pathnames)
+};
+
+static const NativeField mem_fields[] = {
+    ARRAY(CBTF_mem_exttrace_data, stacktraces),
+    ARRAY(CBTF_mem_exttrace_data, events)
+};
+
+static const NativeField mpi_fields[] = {
+    ARRAY(CBTF_mpi_trace_data, stacktraces),
+    ARRAY(CBTF_mpi_trace_data, events)
+};
+
+static const NativeField mpit_fields[] = {
+    ARRAY(CBTF_mpi_exttrace_data, stacktraces),
+    ARRAY(CBTF_mpi_exttrace_data, events)
+};
+
+static const NativeField pthreads_fields[] = {
+    ARRAY(CBTF_pthreads_exttrace_data, stacktraces),
+    ARRAY(CBTF_pthreads_exttrace_data, events)
+};
+
+/** Structures with a native encoding. All of their array elements are plain
+ *  data, without pointers, so they can be copied as they are. The index of
+ *  a structure in this table identifies it in the encoding, so new entries
+ *  go at the end along with a bump of NativeVersion. */
+static const NativeType native_types[] = {
+    TYPE(CBTF_pcsamp_data, pcsamp_fields),
+    TYPE(CBTF_hwc_data, hwc_fields),
+    TYPE(CBTF_hwcsamp_data, hwcsamp_fields),
+    TYPE(CBTF_usertime_data, usertime_fields),
+    TYPE(CBTF_hwctime_data, hwctime_fields),
+    TYPE(CBTF_io_trace_data, io_fields),
+    TYPE(CBTF_io_exttrace_data, iot_fields),
+    TYPE(CBTF_mem_exttrace_data, mem_fields),
+    TYPE(CBTF_mpi_trace_data, mpi_fields),
+    TYPE(CBTF_mpi_exttrace_data, mpit_fields),
+    TYPE(CBTF_pthreads_exttrace_data, pthreads_fields)
+};
+
+
+
+/** Find the native description of the structure with an XDR procedure. */
+static const NativeType* findType(const xdrproc_t xdrproc)
+{
+    unsigned i;
+    for(i = 0; i < sizeof(native_types) / sizeof(NativeType); ++i)
+	if(native_types[i].xdrproc == xdrproc)
+	    return &native_types[i];
+    return NULL;
+}
+
+
+
+/** Find the native description of the structure with an index. */
+static const NativeType* findTypeIndex(uint32_t index)
+{
+    if(index < sizeof(native_types) / sizeof(NativeType))
+	return &native_types[index];
+    return NULL;
+}
+
+
+
+/** Release the arrays of the first fields of a partially decoded structure. */
+static void releaseFields(const NativeType* type, unsigned nfields, char* base)
+{
+    unsigned i;
+    for(i = 0; i < nfields; ++i) {
+	const NativeField* field = &type->fields[i];
+	if(field->is_array) {
+	    const u_int len = 0;
+	    void* val;
+	    memcpy(&val, base + field->val_offset, sizeof(void*));
+	    free(val);
+	    val = NULL;
+	    memcpy(base + field->offset, &len, sizeof(u_int));
+	    memcpy(base + field->val_offset, &val, sizeof(void*));
+	}
+    }
+}
+
+
+
+/**
+ * Get the native layout.
+ *
+ * Returns a tag describing the layout of the structures in this process:
+ * the encoding version, the alignment of 64-bit integers, the size of a
+ * pointer and the byte order. Processes with the same tag can exchange
+ * native encodings.
+ *
+ * @return    Layout tag of this process.
+ *
+ * @ingroup Utility
+ */
+uint32_t CBTF_NativeLayout()
+{
+    const uint16_t order = 1;
+
+    return (NativeVersion << 24) |
+	((uint32_t)offsetof(NativeAlign, value) << 16) |
+	((uint32_t)sizeof(void*) << 8) |
+	(*(const uint8_t*)&order == 1 ? 1 : 2);
+}
+
+
+
+/**
+ * Test if native encoding was requested.
+ *
+ * Native encoding is used only when the layout requested in the
+ * CBTF_WIRE_LAYOUT environment variable matches the layout of this process.
+ * This check is made before any performance data is sent.
+ *
+ * @return    Boolean "true" if performance data should be encoded natively,
+ *            or "false" if it should be encoded with XDR.
+ *
+ * @ingroup Utility
+ */
+bool_t CBTF_UseNativeEncoding()
+{
+    static int use_native = -1;
+
+    if(use_native < 0) {
+	const char* layout = getenv(CBTF_WIRE_LAYOUT_ENV);
+	use_native = (layout != NULL) &&
+	    (strtoul(layout, NULL, 0) == CBTF_NativeLayout());
+    }
+    return use_native ? TRUE : FALSE;
+}
+
+
+
+/**
+ * Test if a structure has a native encoding.
+ *
+ * @param xdrproc    XDR procedure for the structure.
+ * @return           Boolean "true" if the structure has a native encoding.
+ *
+ * @ingroup Utility
+ */
+bool_t CBTF_HasNativeEncoding(const xdrproc_t xdrproc)
+{
+    return findType(xdrproc) != NULL ? TRUE : FALSE;
+}
+
+
+
+/**
+ * Test if a buffer holds a native encoding.
+ *
+ * @param buffer    Buffer to be tested.
+ * @param size      Size of the buffer in bytes.
+ * @return          Boolean "true" if the buffer starts with the native marker.
+ *
+ * @ingroup Utility
+ */
+bool_t CBTF_IsNativeEncoding(const char* buffer, unsigned size)
+{
+    uint32_t marker;
+
+    if((buffer == NULL) || (size < NativePrefixSize))
+	return FALSE;
+    memcpy(&marker, buffer, sizeof(uint32_t));
+    return marker == NativeMarker ? TRUE : FALSE;
+}
+
+
+
+/**
+ * Encode a structure natively.
+ *
+ * @param xdrproc    XDR procedure for the structure.
+ * @param data       Structure to be encoded.
+ * @param buffer     Buffer to hold the encoding.
+ * @param size       Size of the buffer in bytes.
+ * @return           Size of the encoding in bytes, or zero if the structure
+ *                   has no native encoding or doesn't fit in the buffer.
+ *
+ * @ingroup Utility
+ */
+unsigned CBTF_NativeEncode(const xdrproc_t xdrproc, const void* data,
+			   char* buffer, unsigned size)
+{
+    const NativeType* type = findType(xdrproc);
+    const char* base = (const char*)data;
+    uint32_t word;
+    unsigned i, pos = 0;
+
+    if((type == NULL) || (size < NativePrefixSize))
+	return 0;
+
+    word = NativeMarker;
+    memcpy(&buffer[pos], &word, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    word = CBTF_NativeLayout();
+    memcpy(&buffer[pos], &word, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    word = (uint32_t)(type - native_types);
+    memcpy(&buffer[pos], &word, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+
+    for(i = 0; i < type->nfields; ++i) {
+	const NativeField* field = &type->fields[i];
+
+	if(!field->is_array) {
+	    if(size - pos < field->size)
+		return 0;
+	    memcpy(&buffer[pos], base + field->offset, field->size);
+	    pos += field->size;
+	}
+	else {
+	    u_int len;
+	    const void* val;
+	    memcpy(&len, base + field->offset, sizeof(u_int));
+	    memcpy(&val, base + field->val_offset, sizeof(void*));
+	    if((size - pos < sizeof(uint32_t)) ||
+	       ((size - pos - sizeof(uint32_t)) / field->size < len))
+		return 0;
+	    word = len;
+	    memcpy(&buffer[pos], &word, sizeof(uint32_t));
+	    pos += sizeof(uint32_t);
+	    if(len > 0)
+		memcpy(&buffer[pos], val, len * field->size);
+	    pos += len * field->size;
+	}
+    }
+
+    return pos;
+}
+
+
+
+/**
+ * Decode a natively encoded structure.
+ *
+ * Arrays are allocated with malloc() so that the decoded structure can be
+ * released with xdr_free() just like one decoded from XDR. Nothing remains
+ * allocated when the decoding fails.
+ *
+ * @param xdrproc    XDR procedure for the structure.
+ * @param buffer     Buffer holding the encoding.
+ * @param size       Size of the buffer in bytes.
+ * @retval data      Decoded structure.
+ * @return           Size of the decoded encoding in bytes, or zero if the
+ *                   encoding is of another layout or is malformed.
+ *
+ * @ingroup Utility
+ */
+unsigned CBTF_NativeDecode(const xdrproc_t xdrproc, const char* buffer,
+			   unsigned size, void* data)
+{
+    const NativeType* type = findType(xdrproc);
+    char* base = (char*)data;
+    uint32_t word;
+    unsigned i, pos = NativePrefixSize;
+
+    if((type == NULL) || !CBTF_IsNativeEncoding(buffer, size))
+	return 0;
+    memcpy(&word, &buffer[sizeof(uint32_t)], sizeof(uint32_t));
+    if(word != CBTF_NativeLayout())
+	return 0;
+    memcpy(&word, &buffer[2 * sizeof(uint32_t)], sizeof(uint32_t));
+    if(findTypeIndex(word) != type)
+	return 0;
+
+    for(i = 0; i < type->nfields; ++i) {
+	const NativeField* field = &type->fields[i];
+
+	if(!field->is_array) {
+	    if(size - pos < field->size)
+		break;
+	    memcpy(base + field->offset, &buffer[pos], field->size);
+	    pos += field->size;
+	}
+	else {
+	    u_int len;
+	    void* val = NULL;
+	    if(size - pos < sizeof(uint32_t))
+		break;
+	    memcpy(&word, &buffer[pos], sizeof(uint32_t));
+	    pos += sizeof(uint32_t);
+	    if((size - pos) / field->size < word)
+		break;
+	    len = word;
+	    if(len > 0) {
+		val = malloc(len * field->size);
+		if(val == NULL)
+		    break;
+		memcpy(val, &buffer[pos], len * field->size);
+	    }
+	    pos += len * field->size;
+	    memcpy(base + field->offset, &len, sizeof(u_int));
+	    memcpy(base + field->val_offset, &val, sizeof(void*));
+	}
+    }
+
+    if(i < type->nfields) {
+	releaseFields(type, i, base);
+	return 0;
+    }
+    return pos;
+}
+
+
+
+/**
+ * Convert a natively encoded structure to XDR.
+ *
+ * The structure is identified by the type recorded in its native encoding,
+ * decoded, and encoded again with its XDR procedure.
+ *
+ * @param buffer        Buffer holding the native encoding.
+ * @param size          Size of the buffer in bytes.
+ * @retval xdr_buffer   XDR encoding, allocated with malloc().
+ * @return              Size of the XDR encoding in bytes, or zero if the
+ *                      encoding is of another layout or is malformed.
+ *
+ * @ingroup Utility
+ */
+unsigned CBTF_NativeToXDR(const char* buffer, unsigned size, char** xdr_buffer)
+{
+    const NativeType* type;
+    void* data;
+    unsigned xdr_size = 0;
+    uint32_t word;
+    XDR xdrs;
+
+    *xdr_buffer = NULL;
+    if(!CBTF_IsNativeEncoding(buffer, size))
+	return 0;
+    memcpy(&word, &buffer[2 * sizeof(uint32_t)], sizeof(uint32_t));
+    type = findTypeIndex(word);
+    if(type == NULL)
+	return 0;
+
+    data = calloc(1, type->size);
+    if(data == NULL)
+	return 0;
+    if(CBTF_NativeDecode(type->xdrproc, buffer, size, data) == 0) {
+	free(data);
+	return 0;
+    }
+
+    xdr_size = xdr_sizeof(type->xdrproc, data);
+    *xdr_buffer = malloc(xdr_size > 0 ? xdr_size : 1);
+    if(*xdr_buffer != NULL) {
+	xdrmem_create(&xdrs, *xdr_buffer, xdr_size, XDR_ENCODE);
+	if((*type->xdrproc)(&xdrs, data))
+	    xdr_size = xdr_getpos(&xdrs);
+	else
+	    xdr_size = 0;
+	xdr_destroy(&xdrs);
+	if(xdr_size == 0) {
+	    free(*xdr_buffer);
+	    *xdr_buffer = NULL;
+	}
+    }
+    else
+	xdr_size = 0;
+
+    xdr_free(type->xdrproc, (char*)data);
+    free(data);
+    return xdr_size;
+}
@@ -61,3 +61,36 @@ struct CBTF_ompt_exttrace_data {
     uint64_t stacktraces<>;   /**< Stack traces. */
     CBTF_ompt_event events<>; /**< ompt events. */
 };
+
+/** Number of bins in each mutex wait time histogram. */
+const CBTF_OMPT_MUTEX_HISTOGRAM_SIZE = 16;
+
+/** Kinds of OpenMP mutual exclusion constructs. */
+enum CBTF_ompt_mutex_kind {
+    CBTF_OMPT_MUTEX_LOCK = 0,
+    CBTF_OMPT_MUTEX_NEST_LOCK = 1,
+    CBTF_OMPT_MUTEX_CRITICAL = 2,
+    CBTF_OMPT_MUTEX_ATOMIC = 3,
+    CBTF_OMPT_MUTEX_ORDERED = 4
+};
+
+/** Wait and hold statistics of one OpenMP mutex acquired at one call site. */
+struct CBTF_ompt_mutex_stats {
+    uint64_t wait_id;          /**< OMPT wait identifier of the mutex. */
+    CBTF_ompt_mutex_kind kind; /**< Kind of construct. */
+    uint64_t codeptr;          /**< Return address of the acquiring call. */
+    uint64_t acquisitions;     /**< Number of times the mutex was acquired. */
+    uint64_t failed_tests;     /**< Number of lock tests finding it locked. */
+    uint64_t wait_time;        /**< Total time spent acquiring the mutex. */
+    uint64_t max_wait_time;    /**< Longest time spent acquiring it. */
+    uint64_t hold_time;        /**< Total time the mutex was held. */
+    uint64_t max_hold_time;    /**< Longest time the mutex was held. */
+    uint32_t histogram[CBTF_OMPT_MUTEX_HISTOGRAM_SIZE];
+                               /**< Acquisitions binned by log2 of their */
+                               /**< wait time in microseconds. */
+};
+
+/** Structure of the blob containing OpenMP mutex statistics. */
+struct CBTF_ompt_mutex_data {
+    CBTF_ompt_mutex_stats mutexes<>;  /**< Statistics of each mutex. */
+};
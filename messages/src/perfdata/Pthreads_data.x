@@ -59,3 +59,29 @@ struct CBTF_pthreads_exttrace_data {
     uint64_t stacktraces<>;  /**< Stack traces. */
     CBTF_pthreadt_event events<>;       /**< pthread call events. */
 };
+
+/** Number of log2 wait time bins in each lock's histogram. */
+const CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE = 16;
+
+/**
+ * Contention statistics of a single mutex acquired at a single call site.
+ * Bin 0 of the histogram holds waits under 1 usec, bin b holds waits of
+ * [2^(b-1), 2^b) usec and the last bin also holds every longer wait.
+ */
+struct CBTF_pthreads_lock_stats {
+    uint64_t mutex;            /**< Address of the mutex. */
+    uint64_t acquisitions;     /**< Number of times the mutex was acquired. */
+    uint64_t failed_trylocks;  /**< Number of trylocks finding it locked. */
+    uint64_t wait_time;        /**< Total time spent acquiring the mutex. */
+    uint64_t max_wait_time;    /**< Longest time spent acquiring the mutex. */
+    uint64_t hold_time;        /**< Total time the mutex was held. */
+    uint64_t max_hold_time;    /**< Longest time the mutex was held. */
+    uint32_t histogram[CBTF_PTHREADS_LOCK_HISTOGRAM_SIZE]; /**< Binned waits. */
+    uint16_t stacktrace;       /**< Index of the call site's stack trace. */
+};
+
+/** Structure of the blob containing lock contention statistics. */
+struct CBTF_pthreads_contention_data {
+    uint64_t stacktraces<>;            /**< Stack traces. */
+    CBTF_pthreads_lock_stats locks<>;  /**< Statistics of each lock. */
+};
@@ -71,3 +71,44 @@ struct CBTF_Protocol_FunctionAvgValues
 {
     CBTF_Protocol_FunctionAvgValue values<>;
 };
+
+/**
+ * Function, per thread value statistics.
+ *
+ * Describes the distribution over threads of a uint64_t value for a single
+ * function. The mean and sum of squared deviations (m2) are kept instead of
+ * sums of values and squares so that summaries from different subtrees can
+ * be merged without overflow or loss of precision. The threads holding the
+ * extreme values are kept to identify outliers.
+ */
+struct CBTF_Protocol_FunctionStatsValue
+{
+    /** Name of this function. */
+    string function<>;
+
+    /** number of threads. */
+    uint64_t num;
+
+    /** minimum value. */
+    uint64_t min;
+
+    /** thread with the minimum value. */
+    CBTF_Protocol_ThreadName min_thread;
+
+    /** maximum value. */
+    uint64_t max;
+
+    /** thread with the maximum value. */
+    CBTF_Protocol_ThreadName max_thread;
+
+    /** mean value. */
+    double mean;
+
+    /** sum of squared deviations from the mean. */
+    double m2;
+};
+
+struct CBTF_Protocol_FunctionStatsValues
+{
+    CBTF_Protocol_FunctionStatsValue values<>;
+};
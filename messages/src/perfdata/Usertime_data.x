@@ -29,6 +29,9 @@
 /** Structure of the blob containing our performance data. */
 struct CBTF_usertime_data {
     uint64_t interval;    /**< Sampling interval in nanoseconds. */
+    uint64_t effective_interval; /**< Interval actually in effect for these */
+				 /**< samples when the timer adapts its rate. */
+				 /**< A power of 2 multiple of interval, or 0. */
 
     uint64_t stacktraces<>;        /**< Stack traces. */
 
@@ -39,4 +42,14 @@ struct CBTF_usertime_data {
 			  /**< Positive entries the count buffer represent */
 			  /**< the index into the address buffer (bt) for a */
 			  /**< specifc stack */
+
+    uint64_t cct_pc<>;    /**< Calling context tree node addresses. Used */
+			  /**< instead of stacktraces and count when the */
+			  /**< collector builds the tree itself. */
+
+    uint32_t cct_parent<>; /**< Index of each node's caller. Nodes without */
+			   /**< a caller have a parent index of ~0. */
+
+    uint32_t cct_count<>; /**< Number of samples with the node as the top */
+			  /**< of stack. */
 };
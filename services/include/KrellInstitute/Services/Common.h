@@ -52,5 +52,8 @@ uint64_t CBTF_GetPCFromContext(const ucontext_t*);
 void CBTF_SetPCInContext(uint64_t, ucontext_t*);
 int CBTF_GetInstrLength(uint64_t);
 uint64_t CBTF_GetTime();
+void CBTF_AddTextRange(uint64_t, uint64_t);
+bool CBTF_HaveTextRanges();
+bool CBTF_InTextRange(uint64_t);
 
 #endif
@@ -94,7 +94,37 @@ typedef struct {
 
 } CBTF_StackTraceData;
 
+/** Number of nodes in a calling context tree. */
+#define CBTF_CCT_NodeCount (512 * CBTF_BlobSizeFactor)
+/** Number of entries in the calling context tree hash table. */
+#define CBTF_CCT_HashTableSize (CBTF_CCT_NodeCount + (CBTF_CCT_NodeCount / 4))
+/** Parent index of the nodes that have no caller. */
+#define CBTF_CCT_Root UINT32_MAX
+
+/**
+ * Type representing a calling context tree of sampled stack traces.
+ *
+ * Nodes are allocated from fixed pools in the order they are first seen, so
+ * a node's parent always precedes it and the pools can be sent as they are.
+ */
+typedef struct {
+    uint64_t addr_begin;  /**< Beginning of gathered data's address range. */
+    uint64_t addr_end;    /**< End of gathered data's address range. */
+
+    uint32_t length;  /**< Actual used length of the node arrays. */
+
+    uint64_t pc[CBTF_CCT_NodeCount];      /**< Program counter (PC) addresses. */
+    uint32_t parent[CBTF_CCT_NodeCount];  /**< Index of each node's caller. */
+    uint32_t count[CBTF_CCT_NodeCount];   /**< Samples with node as the top. */
+
+    /** Hash table mapping parent index and PC address to their node index. */
+    uint32_t hash_table[CBTF_CCT_HashTableSize];
+
+} CBTF_CCTData;
+
 bool CBTF_UpdatePCData(uint64_t, CBTF_PCData*);
 bool CBTF_UpdateHWCPCData(uint64_t, CBTF_HWCPCData*, long long* );
+void CBTF_InitializeCCTData(CBTF_CCTData*);
+bool CBTF_UpdateCCTData(unsigned, const uint64_t*, CBTF_CCTData*);
 
 #endif
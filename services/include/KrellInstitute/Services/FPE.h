@@ -60,5 +60,7 @@ typedef enum {
 typedef void (*CBTF_FPEEventHandler)(const CBTF_FPEType, const ucontext_t*);
 
 void CBTF_FPEHandler(CBTF_FPEType, const CBTF_FPEEventHandler);
+void CBTF_FPECounting(CBTF_FPEType, const CBTF_FPEEventHandler, unsigned);
+void CBTF_FPECheck(ucontext_t*);
 
 #endif
@@ -0,0 +1,72 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Declaration of the folded stack trace encoding.
+ *
+ * When CBTF_FOLD_FRAMES is set, the unwinders fold repeated frames as they
+ * capture them. A run of a cycle of up to CBTF_FOLD_MAXCYCLE frames is
+ * stored as one copy of the cycle followed by a repeat frame. The repeat
+ * frame holds the length of the cycle and the number of times the cycle
+ * repeats after that copy. Stack traces are stored top of stack first, so
+ * the repeats are further from the top than the copy.
+ *
+ * Repeat frames have 0x8000 in their top 16 bits. That is a non-canonical
+ * address, so it is never a real program counter. The cycle before a
+ * repeat frame never contains another repeat frame.
+ *
+ * Folded stacks only travel from the collectors to the leaf CPs. The leaf
+ * CPs unfold the stacks of each blob as they aggregate its addresses
+ * (PerfData::aggregate), so the blobs, trees and reductions sent on from
+ * there hold plain stacks.
+ *
+ */
+
+#ifndef _KrellInstitute_Services_FoldFrames_
+#define _KrellInstitute_Services_FoldFrames_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest cycle of frames that is folded. */
+#define CBTF_FOLD_MAXCYCLE 4
+
+#define CBTF_FRAME_REPEAT 0x8000000000000000ULL
+#define CBTF_FRAME_REPEAT_MASK 0xFFFF000000000000ULL
+
+/** Build the repeat frame of a cycle of length frames repeated count times. */
+#define CBTF_FrameRepeat(length, count) \
+    (CBTF_FRAME_REPEAT | ((uint64_t)(length) << 32) | (uint64_t)(count))
+
+#define CBTF_IsFrameRepeat(frame) \
+    (((frame) & CBTF_FRAME_REPEAT_MASK) == CBTF_FRAME_REPEAT)
+#define CBTF_FrameRepeatLength(frame) ((unsigned)(((frame) >> 32) & 0xFFFF))
+#define CBTF_FrameRepeatCount(frame) ((unsigned)((frame) & 0xFFFFFFFF))
+
+int CBTF_FoldFramesEnabled();
+unsigned CBTF_FoldFrame(uint64_t*, unsigned, uint64_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
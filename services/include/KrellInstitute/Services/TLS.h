@@ -37,4 +37,8 @@
 void* CBTF_GetTLS(uint32_t);
 void CBTF_SetTLS(uint32_t, void*);
 
+uint32_t CBTF_RegisterTLS(uint32_t);
+void* CBTF_GetTLSSlot(uint32_t);
+void CBTF_SetTLSSlot(uint32_t, void*);
+
 #endif
@@ -34,13 +34,28 @@
 #ifdef HAVE_INTTYPES_H
 #include <inttypes.h>
 #endif
+#include <stdbool.h>
 #include <ucontext.h>
 
 /** Type representing a function pointer to a timer event handler. */
 typedef void (*CBTF_TimerEventHandler)(const ucontext_t*);
 
+/** Maximum number of frames passed to a perf event handler. */
+#define CBTF_PERF_EVENT_MAXFRAMES 128
+
+/**
+ * Type representing a function pointer to a perf event handler. It is passed
+ * the stack trace of one sample with the sampled PC address first.
+ */
+typedef void (*CBTF_PerfEventHandler)(unsigned, const uint64_t*);
+
 void CBTF_Timer(uint64_t, const CBTF_TimerEventHandler);
 void CBTF_SetTimerSignal();
 int  CBTF_GetTimerSignal();
+uint64_t CBTF_GetTimerInterval();
 void CBTF_BlockTimerSignal();
 void CBTF_UnBlockTimerSignal();
+
+bool CBTF_PerfEventTimer(uint64_t, bool, const CBTF_PerfEventHandler);
+void CBTF_PerfEventDrain();
+void CBTF_PerfEventEnable(bool);
@@ -23,6 +23,7 @@
  */
 
 #include "Common.h"
+#include "FoldFrames.h"
 #include <ucontext.h>
 
 void CBTF_GetStackTraceFromContext(const ucontext_t*,
@@ -30,4 +31,8 @@ void CBTF_GetStackTraceFromContext(const ucontext_t*,
                                      unsigned*, uint64_t*);
 #if defined(__linux) && defined(__x86_64)
 void CBTF_GetStackTrace( bool_t , unsigned , unsigned , unsigned* , uint64_t* );
+void CBTF_GetStackTraceFP(const ucontext_t*, unsigned, unsigned,
+                          unsigned*, uint64_t*);
+void CBTF_InitializeStackTraceFP();
+void CBTF_FinalizeStackTraceFP();
 #endif
@@ -19,7 +19,7 @@
 
 /** @file
  *
- * Definition of the CBTF_[Get|Set]]TLS() functions.
+ * Definition of the CBTF_[Get|Set]TLS[Slot]() and CBTF_RegisterTLS() functions.
  *
  */
 
@@ -34,16 +34,21 @@
 
 
 
-/** Number of entries in the key/value maps. */
+/** Number of slots in the key/value maps. */
 #define MapSize 32
 
-/** Type representing a map of keys to their corresponding values. */
+/** Type representing a thread's map of slots to their corresponding values. */
 typedef struct {
-    uint32_t size;           /**< Actual number of entries in the map. */
-    uint32_t keys[MapSize];  /**< Keys. */
-    void* values[MapSize];   /**< Corresponding values. */
+    void* values[MapSize];  /**< Values indexed by slot. */
 } Map;
 
+/**
+ * Keys indexed by the slot assigned to them. Slots are assigned once at
+ * registration time and are shared by every thread so that the per-thread
+ * maps only need to hold the values.
+ */
+static volatile uint32_t slot_keys[MapSize];
+
 
 
 /** Flag indicating if the process is multithreaded.  */
@@ -119,19 +124,17 @@ static void __attribute__ ((constructor)) initialize()
 
 
 /**
- * Get the value for a key.
+ * Get this thread's TLS map.
  *
- * Returns a pointer to the value corresponding to the specified key.
+ * Returns the calling thread's TLS map, allocating it upon first access.
  *
- * @param key    Key for which to get the value.
- * @return       Pointer to the current value corresponding to that key.
+ * @return    Calling thread's TLS map.
  *
  * @ingroup Implementation
  */
-static void** getValue(uint32_t key)
+static inline Map* getMap()
 {
     Map* map = &map_for_process;
-    unsigned bucket;
 
     /* Is this process multithreaded? */
     if(is_multithreaded) {
@@ -157,33 +160,119 @@ static void** getValue(uint32_t key)
     /* Check assertions */
     Assert(map != NULL);
 
-    /*
-     * Search this thread's TLS map for an existing entry corresponding to the
-     * specified key. Use a hash table with a simple linear probe to accelerate
-     * the search.
-     */
-    bucket = key % MapSize;
-    while((map->keys[bucket] > 0) && (map->keys[bucket] != key))
-	bucket = (bucket + 1) % MapSize;
+    return map;
+}
 
-    /* Is this the first time accessing this key? */
-    if(map->keys[bucket] == 0) {
 
-	/* Place this key into the map (with an initially-NULL value) */
-	map->keys[bucket] = key;
-	map->size++;
-	
-	/*
-	 * Check assertions. There must always be at least one empty (zero)
-	 * key in the map or the simple linear probe above would become an
-	 * infinite loop.
-	 */
-	Assert(map->size < (MapSize - 1));
-	
+
+/**
+ * Find the slot for a key.
+ *
+ * Returns the slot assigned to the specified key, assigning the next free
+ * slot when the key hasn't been seen before. Use a hash table with a simple
+ * linear probe to find the slot. Slots are claimed with an atomic compare
+ * and swap so that concurrent registrations from several threads (or from
+ * a signal handler) never hand the same slot to two different keys.
+ *
+ * @param key    Key for which to find the slot.
+ * @return       Slot assigned to that key.
+ *
+ * @ingroup Implementation
+ */
+static inline uint32_t getSlot(uint32_t key)
+{
+    unsigned bucket = key % MapSize;
+    unsigned probes;
+
+    /* Keys almost always live in their home slot */
+    if(slot_keys[bucket] == key)
+	return bucket;
+
+    for(probes = 0; probes < MapSize; ++probes) {
+
+	/* Has this slot already been assigned to the specified key? */
+	if(slot_keys[bucket] == key)
+	    return bucket;
+
+	/* Try to claim this slot if it is still free */
+	if(slot_keys[bucket] == 0) {
+	    uint32_t previous =
+		__sync_val_compare_and_swap(&slot_keys[bucket], 0, key);
+	    if((previous == 0) || (previous == key))
+		return bucket;
+	}
+
+	bucket = (bucket + 1) % MapSize;
     }
 
-    /* Return the value's pointer to the caller */
-    return &(map->values[bucket]);
+    /* Check assertions. Every slot is in use by some other key. */
+    Assert(probes < MapSize);
+    return 0;
+}
+
+
+
+/**
+ * Register a TLS key.
+ *
+ * Assigns a fixed slot to the specified key and returns it. The slot can be
+ * cached by the caller and passed to CBTF_[Get|Set]TLSSlot() to access the
+ * value without looking up the key again. Registering the same key again
+ * returns the same slot.
+ *
+ * @param key    Key to be registered.
+ * @return       Slot assigned to that key.
+ *
+ * @ingroup RuntimeAPI
+ */
+uint32_t CBTF_RegisterTLS(uint32_t key)
+{
+    /** Check preconditions */
+    Assert(key > 0);
+
+    return getSlot(key);
+}
+
+
+
+/**
+ * Get a TLS value by slot.
+ *
+ * Returns the value in thread-local storage (TLS) stored in the specified
+ * slot, as previously returned by CBTF_RegisterTLS().
+ *
+ * @param slot    Slot for which to get the value.
+ * @return        Current value stored in that slot.
+ *
+ * @ingroup RuntimeAPI
+ */
+void* CBTF_GetTLSSlot(uint32_t slot)
+{
+    /** Check preconditions */
+    Assert(slot < MapSize);
+
+    return getMap()->values[slot];
+}
+
+
+
+/**
+ * Set a TLS value by slot.
+ *
+ * Sets the value in thread-local storage (TLS) stored in the specified
+ * slot, as previously returned by CBTF_RegisterTLS().
+ *
+ * @param slot     Slot for which to set the value.
+ * @param value    New value stored in that slot.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_SetTLSSlot(uint32_t slot, void* value)
+{
+    /** Check preconditions */
+    Assert(slot < MapSize);
+
+    getMap()->values[slot] = value;
 }
 
 
@@ -204,17 +293,11 @@ static void** getValue(uint32_t key)
 void* CBTF_GetTLS(uint32_t key)
 {
 //fprintf(stderr,"CBTF_GetTLS GET gets key %#X\n",key);
-    void** map_value = NULL;
-    
     /** Check preconditions */
     Assert(key > 0);
 
-    /** Get a pointer to the value corresponding to this key */
-    map_value = getValue(key);
-    Assert(map_value != NULL);
-
     /** Return the current value of this key to the caller */
-    return *map_value;
+    return getMap()->values[getSlot(key)];
 }
 
 
@@ -235,15 +318,9 @@ void* CBTF_GetTLS(uint32_t key)
 void CBTF_SetTLS(uint32_t key, void* value)
 {
 //fprintf(stderr,"CBTF_SetTLS SET sets key %#X\n",key);
-    void** map_value = NULL;
-    
     /** Check preconditions */
     Assert(key > 0);
 
-    /** Get a pointer to the value corresponding to this key */
-    map_value = getValue(key);
-    Assert(map_value != NULL);
-
     /** Set this key's new value */
-    *map_value = value;
+    getMap()->values[getSlot(key)] = value;
 }
@@ -0,0 +1,123 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the CBTF_[Add|In]TextRange() functions.
+ *
+ */
+
+#include "KrellInstitute/Services/Common.h"
+
+
+
+/** Maximum number of text ranges that can be recorded. */
+#define MaxTextRanges 1024
+
+/** Type representing the address range of an executable mapping. */
+typedef struct {
+    uint64_t begin;  /**< Beginning address of the range. */
+    uint64_t end;    /**< Ending address of the range. */
+} TextRange;
+
+/** Executable address ranges recorded so far (append only). */
+static TextRange ranges[MaxTextRanges];
+
+/** Number of entries in the table above that have been claimed. */
+static volatile unsigned range_count = 0;
+
+
+
+/**
+ * Record a text range.
+ *
+ * Adds the specified executable address range to the process-wide table of
+ * known text ranges. Called as the executable and its shared objects are
+ * discovered by CBTF_GetDLInfo(). Ranges that were already recorded are
+ * ignored and ranges beyond the capacity of the table are silently dropped.
+ *
+ * @param begin    Beginning address of the range.
+ * @param end      Ending address of the range.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_AddTextRange(uint64_t begin, uint64_t end)
+{
+    unsigned i, count = range_count;
+
+    if(begin >= end)
+	return;
+
+    for(i = 0; i < count; ++i)
+	if((ranges[i].begin == begin) && (ranges[i].end == end))
+	    return;
+
+    i = __sync_fetch_and_add(&range_count, 1);
+    if(i >= MaxTextRanges) {
+	range_count = MaxTextRanges;
+	return;
+    }
+
+    ranges[i].begin = begin;
+    ranges[i].end = end;
+}
+
+
+
+/**
+ * Test if any text ranges are known.
+ *
+ * Returns a boolean value indicating if any text ranges have been recorded.
+ * Until they have, callers can't use CBTF_InTextRange() to validate addresses.
+ *
+ * @return    Boolean "true" if text ranges are known, "false" otherwise.
+ *
+ * @ingroup RuntimeAPI
+ */
+bool CBTF_HaveTextRanges()
+{
+    return range_count > 0;
+}
+
+
+
+/**
+ * Test if an address is in a text range.
+ *
+ * Returns a boolean value indicating if the specified address lies within one
+ * of the recorded text ranges. Safe to call from within a signal handler.
+ *
+ * @param address    Address to be tested.
+ * @return           Boolean "true" if the address is in a text range,
+ *                   "false" otherwise.
+ *
+ * @ingroup RuntimeAPI
+ */
+bool CBTF_InTextRange(uint64_t address)
+{
+    unsigned i, count = range_count;
+
+    if(count > MaxTextRanges)
+	count = MaxTextRanges;
+
+    for(i = 0; i < count; ++i)
+	if((address >= ranges[i].begin) && (address < ranges[i].end))
+	    return true;
+
+    return false;
+}
@@ -0,0 +1,128 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the CBTF_InitializeCCTData() and CBTF_UpdateCCTData()
+ * functions.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "KrellInstitute/Services/Common.h"
+#include "KrellInstitute/Services/Data.h"
+#include "KrellInstitute/Services/FoldFrames.h"
+
+
+
+/**
+ * Initialize calling context tree data.
+ *
+ * Empties the specified calling context tree so that it can be reused after
+ * its contents have been sent.
+ *
+ * @param tree    Calling context tree to be initialized.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_InitializeCCTData(CBTF_CCTData* tree)
+{
+    tree->addr_begin = ~0;
+    tree->addr_end = 0;
+    tree->length = 0;
+    memset(tree->count, 0, sizeof(tree->count));
+    memset(tree->hash_table, 0, sizeof(tree->hash_table));
+}
+
+
+
+/**
+ * Update calling context tree data.
+ *
+ * Updates the specified calling context tree with the passed stack trace. The
+ * path from the outermost frame to the top of the stack is located, adding
+ * any missing nodes, and the sample count of the top node is incremented.
+ *
+ * @note    The nodes are taken from fixed size arrays and no memory is ever
+ *          allocated, so this is safe to call from within a signal handler.
+ *          A hash table keyed on the parent index and PC address is used to
+ *          find the child of a node. The tree is left unchanged when it may
+ *          not have room for the stack trace.
+ *
+ * @param framecount    Number of frames in the stack trace.
+ * @param frames        Stack trace with the top of the stack first.
+ * @param tree          Calling context tree to be updated.
+ * @return              Boolean "true" if the stack trace was added, "false"
+ *                      if the tree is full and must be sent first.
+ *
+ * @ingroup RuntimeAPI
+ */
+bool CBTF_UpdateCCTData(unsigned framecount, const uint64_t* frames,
+			CBTF_CCTData* tree)
+{
+    uint32_t node = CBTF_CCT_Root;
+    unsigned bucket, i;
+
+    if(framecount == 0)
+	return true;
+
+    /* Will the worst case of all new nodes fit into the tree? */
+    if(tree->length + framecount > CBTF_CCT_NodeCount)
+	return false;
+
+    /* Walk the stack from the outermost frame to the top of the stack */
+    for(i = framecount; i > 0; --i) {
+	uint64_t pc = frames[i - 1];
+
+	/*
+	 * Search for the child of the current node with this PC address. Use
+	 * the hash table and a simple linear probe to accelerate the search.
+	 */
+	bucket = ((pc >> 4) ^ (node * 2654435761u)) % CBTF_CCT_HashTableSize;
+	while((tree->hash_table[bucket] > 0) &&
+	      ((tree->pc[tree->hash_table[bucket] - 1] != pc) ||
+	       (tree->parent[tree->hash_table[bucket] - 1] != node)))
+	    bucket = (bucket + 1) % CBTF_CCT_HashTableSize;
+
+	if(tree->hash_table[bucket] > 0) {
+	    node = tree->hash_table[bucket] - 1;
+	    continue;
+	}
+
+	/* Otherwise add a new node for this PC address to the tree */
+	tree->pc[tree->length] = pc;
+	tree->parent[tree->length] = node;
+	tree->count[tree->length] = 0;
+	node = tree->length;
+	tree->length++;
+	tree->hash_table[bucket] = node + 1;
+
+	/* Update the address interval in the tree, skipping repeat frames */
+	if(CBTF_IsFrameRepeat(pc))
+	    continue;
+	if(pc < tree->addr_begin)
+	    tree->addr_begin = pc;
+	if(pc > tree->addr_end)
+	    tree->addr_end = pc;
+    }
+
+    /* Increment the count of the node at the top of the stack */
+    tree->count[node]++;
+    return true;
+}
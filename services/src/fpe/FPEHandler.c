@@ -20,7 +20,8 @@
 
 /** @file
  *
- * Definition of the CBTF_FPEHandler() function.
+ * Definition of the CBTF_FPEHandler(), CBTF_FPECounting(), and CBTF_FPECheck()
+ * functions.
  *
  */
 
@@ -53,6 +54,15 @@ typedef struct {
     /** FPE event handling function. */
     CBTF_FPEEventHandler fpe_handler;
 
+    /** Exception flags sampled by the counting mode (zero when not counting). */
+    int count_excepts;
+
+    /** Number of checks between one-shot traps (zero for no traps). */
+    unsigned trap_interval;
+
+    /** Number of checks since the last one-shot trap was armed. */
+    unsigned checks;
+
 } TLS;
 
 #ifdef USE_EXPLICIT_TLS
@@ -74,6 +84,110 @@ static __thread TLS the_tls;
 
 
 
+/** Table mapping floating-point exception flags to FPE types. */
+static const struct {
+    int flag;             /**< Exception flag (FE_xxx). */
+    CBTF_FPEType type;    /**< Corresponding FPE type. */
+} FlagTypes[] = {
+    { FE_DIVBYZERO, DivideByZero },
+    { FE_OVERFLOW, Overflow },
+    { FE_UNDERFLOW, Underflow },
+    { FE_INEXACT, InexactResult },
+    { FE_INVALID, InvalidOperation },
+    { 0, Unknown }
+};
+
+
+
+/**
+ * Get the exception flags for a FPE type.
+ *
+ * @param fpe_type    Type of FPE.
+ * @return            Corresponding exception flags (FE_xxx).
+ *
+ * @ingroup Implementation
+ */
+static int getExcepts(CBTF_FPEType fpe_type)
+{
+    int i;
+
+    if(fpe_type == AllFPE)
+	return FE_ALL_EXCEPT;
+    for(i = 0; FlagTypes[i].flag != 0; ++i)
+	if(FlagTypes[i].type == fpe_type)
+	    return FlagTypes[i].flag;
+    return 0;
+}
+
+
+
+/*
+ * Access to the floating-point state of a thread.
+ *
+ * Signal handlers run with their own floating-point state which is discarded
+ * when they return. So the exception flags and masks of a thread interrupted
+ * by a (timer) signal are accessed through the signal context instead. On the
+ * x86-64 the FE_xxx flags match the bits of both the SSE MXCSR register and
+ * the x87 status word, with the corresponding mask bits 7 bits higher in the
+ * MXCSR and at the same position in the x87 control word. Other platforms
+ * access the floating-point environment of the calling thread directly and
+ * don't support one-shot traps.
+ */
+
+/** Test the specified exception flags in a context (or the calling thread). */
+static int testExcepts(const ucontext_t* context, int excepts)
+{
+#if defined(__x86_64__)
+    if((context != NULL) && (context->uc_mcontext.fpregs != NULL))
+	return (context->uc_mcontext.fpregs->mxcsr |
+		context->uc_mcontext.fpregs->swd) & excepts;
+#endif
+    return fetestexcept(excepts);
+}
+
+/** Clear the specified exception flags in a context (or the calling thread). */
+static void clearExcepts(ucontext_t* context, int excepts)
+{
+#if defined(__x86_64__)
+    if((context != NULL) && (context->uc_mcontext.fpregs != NULL)) {
+	context->uc_mcontext.fpregs->mxcsr &= ~excepts;
+	context->uc_mcontext.fpregs->swd &= ~excepts;
+	return;
+    }
+#endif
+    feclearexcept(excepts);
+}
+
+#if defined(__x86_64__)
+
+/** Unmask (trap) the specified exceptions in a context (or the calling thread). */
+static void armTrap(ucontext_t* context, int excepts)
+{
+    if((context != NULL) && (context->uc_mcontext.fpregs != NULL)) {
+	context->uc_mcontext.fpregs->mxcsr &= ~(excepts << 7);
+	context->uc_mcontext.fpregs->cwd &= ~excepts;
+	return;
+    }
+    feenableexcept(excepts);
+}
+
+/** Mask the specified exceptions again in the context of a trap. */
+static void disarmTrap(ucontext_t* context, int excepts)
+{
+    if((context != NULL) && (context->uc_mcontext.fpregs != NULL)) {
+	context->uc_mcontext.fpregs->mxcsr |= (excepts << 7);
+	context->uc_mcontext.fpregs->cwd |= excepts;
+	/* Drop the SSE flags that raised the trap so it isn't raised again */
+	context->uc_mcontext.fpregs->mxcsr &= ~excepts;
+	/* Drop the pending x87 exception along with its summary bits */
+	context->uc_mcontext.fpregs->swd &= ~(excepts | 0x8080);
+    }
+}
+
+#endif
+
+
+
 /**
  * Signal handler.
  *
@@ -131,6 +245,12 @@ static void signalHandler(int signal, siginfo_t* info, void* ptr)
 
 	(*tls->fpe_handler)(fpe_type, (ucontext_t*)ptr);
     }
+
+#if defined(__x86_64__)
+    /* Mask the exceptions again after a one-shot trap in counting mode */
+    if(tls->count_excepts != 0)
+	disarmTrap((ucontext_t*)ptr, tls->count_excepts);
+#endif
 }
 
 
@@ -162,6 +282,7 @@ void CBTF_FPEHandler(CBTF_FPEType fpe_type,
     if(tls == NULL) {
 	tls = malloc(sizeof(TLS));
 	Assert(tls != NULL);
+	memset(tls, 0, sizeof(TLS));
 	CBTF_SetTLS(TLSKey, tls);
     }
 #else
@@ -252,3 +373,135 @@ void CBTF_FPEHandler(CBTF_FPEType fpe_type,
 	
     }
 }
+
+
+
+/**
+ * Configure a per-thread FPE counting handler.
+ *
+ * Configure a FPE handler to be called from CBTF_FPECheck() for each of the
+ * specified types of FPE raised by the current executing thread since its
+ * previous check. Unlike CBTF_FPEHandler() the exceptions aren't trapped, so
+ * codes raising millions of exceptions run at full speed and each handler
+ * call represents one sample point rather than one exception. Checks made at
+ * timer ticks give statistical per-PC counts and checks made at function
+ * boundaries give per-call site counts.
+ *
+ * If a non-zero trap interval is given, every trap_interval-th check also
+ * unmasks the specified exceptions until the next one is raised. That trap
+ * calls the handler with the precise context of the faulting instruction and
+ * masks the exceptions again. One-shot traps are only supported on x86-64.
+ *
+ * Any previously configured counting handler is first removed. If the event
+ * handler is null, no new handler is configured.
+ *
+ * @param fpe_type         Type of FPE to count.
+ * @param handler          FPE event handler.
+ * @param trap_interval    Number of checks between one-shot traps or zero.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_FPECounting(CBTF_FPEType fpe_type,
+		      const CBTF_FPEEventHandler handler,
+		      unsigned trap_interval)
+{
+    /* Create and/or access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+    if(tls == NULL) {
+	tls = malloc(sizeof(TLS));
+	Assert(tls != NULL);
+	memset(tls, 0, sizeof(TLS));
+	CBTF_SetTLS(TLSKey, tls);
+    }
+#else
+    TLS* tls = &the_tls;
+#endif
+    Assert(tls != NULL);
+
+#if !defined(__x86_64__)
+    trap_interval = 0;
+#endif
+
+#if defined(__x86_64__)
+    /*
+     * Mask the previously counted exceptions again in case a one-shot trap
+     * is still armed, before its SIGFPE handler is removed. This restores
+     * both the MXCSR and x87 control word masks changed by armTrap().
+     */
+    if((tls->trap_interval > 0) && (tls->count_excepts != 0)) {
+	fedisableexcept(tls->count_excepts);
+	feclearexcept(tls->count_excepts);
+    }
+#endif
+
+    /* Remove any previous counting handler and its SIGFPE handler */
+    tls->count_excepts = 0;
+    if(tls->trap_interval > 0)
+	CBTF_FPEHandler(fpe_type, NULL);
+    tls->fpe_handler = NULL;
+    tls->trap_interval = 0;
+    tls->checks = 0;
+
+    if(handler == NULL)
+	return;
+
+    /* Only install the SIGFPE handler when one-shot traps are requested */
+    if(trap_interval > 0)
+	CBTF_FPEHandler(fpe_type, handler);
+    else
+	tls->fpe_handler = handler;
+
+    /* Start counting from a clean set of exception flags */
+    feclearexcept(FE_ALL_EXCEPT);
+    tls->trap_interval = trap_interval;
+    tls->count_excepts = getExcepts(fpe_type);
+}
+
+
+
+/**
+ * Check for FPEs raised since the previous check.
+ *
+ * Samples the exception flags of the current executing thread and calls its
+ * counting handler once for each of the counted types of FPE that were raised
+ * since the previous check, then clears those flags. Should be called either
+ * from a timer event handler, passing the signal context of the interrupted
+ * thread, or at function boundaries, passing null. In the latter case the
+ * handler is also passed null and should attribute the FPEs to its own call
+ * site. Does nothing if the thread has no counting handler.
+ *
+ * @param context    Signal context of the thread or null.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_FPECheck(ucontext_t* context)
+{
+    int i, raised;
+
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if((tls == NULL) || (tls->count_excepts == 0) || (tls->fpe_handler == NULL))
+	return;
+
+    /* Sample and clear the flags before the handler can raise any itself */
+    raised = testExcepts(context, tls->count_excepts);
+    if(raised != 0)
+	clearExcepts(context, raised);
+
+    for(i = 0; FlagTypes[i].flag != 0; ++i)
+	if(raised & FlagTypes[i].flag)
+	    (*tls->fpe_handler)(FlagTypes[i].type, context);
+
+#if defined(__x86_64__)
+    /* Arm a one-shot trap every trap_interval-th check */
+    if((tls->trap_interval > 0) && (++tls->checks >= tls->trap_interval)) {
+	tls->checks = 0;
+	armTrap(context, tls->count_excepts);
+    }
+#endif
+}
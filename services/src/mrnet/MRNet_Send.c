@@ -33,6 +33,7 @@
 #include "KrellInstitute/Messages/DataHeader.h"
 #include "KrellInstitute/Messages/EventHeader.h"
 #include "KrellInstitute/Messages/Blob.h"
+#include "KrellInstitute/Messages/NativeEncoding.h"
 #include "KrellInstitute/Messages/ToolMessageTags.h"
 #include "monitor.h" // monitor_get_thread_num
 
@@ -348,7 +349,7 @@ void CBTF_MRNet_Send_PerfData(const CBTF_DataHeader* header,
                               const xdrproc_t xdrproc, const void* data)
 {
     const size_t EncodingBufferSize = (CBTF_BlobSizeFactor * 15 * 1024);
-    unsigned size;
+    unsigned size, native_size = 0;
     char* buffer = NULL;
     XDR xdrs;
 
@@ -361,8 +362,20 @@ void CBTF_MRNet_Send_PerfData(const CBTF_DataHeader* header,
 
     xdrmem_create(&xdrs, buffer, EncodingBufferSize, XDR_ENCODE);
     Assert(xdr_CBTF_DataHeader(&xdrs, (void*)header) == TRUE);
-    Assert((*xdrproc)(&xdrs, (void*)data) == TRUE);
     size = xdr_getpos(&xdrs);
+
+    /* Use the native layout after the header when it was requested */
+    if (CBTF_UseNativeEncoding()) {
+	native_size = CBTF_NativeEncode(xdrproc, data, buffer + size,
+					EncodingBufferSize - size);
+    }
+
+    if (native_size > 0) {
+	size += native_size;
+    } else {
+	Assert((*xdrproc)(&xdrs, (void*)data) == TRUE);
+	size = xdr_getpos(&xdrs);
+    }
     xdr_destroy(&xdrs);
 
     /* send it as a blob */
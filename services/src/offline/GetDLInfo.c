@@ -42,6 +42,7 @@
 #include <dlfcn.h>
 #include <pthread.h>
 #include <link.h>
+#include "KrellInstitute/Services/Common.h"
 #include "KrellInstitute/Services/monlibs.h"
 
 
@@ -254,6 +255,9 @@ static void lc(ElfW(Addr) base_address, const char *name, mem_region *regions,
    }
 #endif
    
+    CBTF_AddTextRange(regions[0].mem_addr,
+		      regions[0].mem_addr + regions[0].mem_size);
+
     if (is_load) {
 	cbtf_offline_record_dlopen(name, regions[0].mem_addr,
 			      regions[0].mem_addr + regions[0].mem_size,
@@ -388,6 +392,7 @@ int CBTF_GetDLInfo(pid_t pid, char *path, uint64_t b_time, uint64_t e_time)
 		    mappedpath, begin, end);
 	    }
 #endif
+	    CBTF_AddTextRange(begin, end);
 	    cbtf_offline_record_dlopen(mappedpath, begin, end, b_time, e_time);
 	    break;
 	}
@@ -399,6 +404,7 @@ int CBTF_GetDLInfo(pid_t pid, char *path, uint64_t b_time, uint64_t e_time)
 		fprintf(stderr,"CBTF_GetDLInfo LD RECORD %s [%08Lx, %08Lx]\n", mappedpath, begin, end);
 	    }
 #endif
+	    CBTF_AddTextRange(begin, end);
 	    cbtf_offline_record_dso(mappedpath, begin, end, 0);
 	}
     } /* end while feof mapfile */
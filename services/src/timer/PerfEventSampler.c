@@ -0,0 +1,430 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the CBTF_PerfEventTimer() function.
+ *
+ */
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "KrellInstitute/Services/Common.h"
+#include "KrellInstitute/Services/Timer.h"
+#include "KrellInstitute/Services/TLS.h"
+
+#if defined(HAVE_PERF_EVENTS)
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/perf_event.h>
+
+/** Signal sent when a thread's ring buffer reaches its watermark. */
+#define CBTF_PERF_EVENT_SIGNAL (SIGRTMIN+5)
+
+/** Number of data pages in each thread's ring buffer (must be a power of 2). */
+#define RingPages 16
+
+/** Mutual exclusion lock for accessing shared state. */
+static pthread_mutex_t mutex_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Number of threads currently using perf events (shared state). */
+static unsigned num_threads = 0;
+
+/** Old signal handler action (shared state). */
+static struct sigaction original_action;
+
+/** Type defining the items stored in thread-local storage. */
+typedef struct {
+
+    /** Sample event handling function. */
+    CBTF_PerfEventHandler handler;
+
+    int fd;                            /**< Perf event file descriptor. */
+    struct perf_event_mmap_page* ring; /**< Mapped ring buffer. */
+    size_t page_size;                  /**< Size of the control page. */
+    size_t data_size;                  /**< Size of the ring buffer data. */
+    bool callchain;                    /**< Are callchains being sampled? */
+    bool draining;                     /**< Is the ring buffer being drained? */
+    uint64_t lost;                     /**< Number of samples lost. */
+
+    /** Stack trace of the sample being passed to the handler. */
+    uint64_t frames[CBTF_PERF_EVENT_MAXFRAMES];
+
+} TLS;
+
+#ifdef USE_EXPLICIT_TLS
+
+/**
+ * Thread-local storage key.
+ *
+ * Key used for looking up our thread-local storage. This key <em>must</em>
+ * be globally unique across the entire Open|SpeedShop code base.
+ */
+static const uint32_t TLSKey = 0xBAD0FE57;
+
+#else
+
+/** Thread-local storage. */
+static __thread TLS the_tls;
+
+#endif
+
+
+
+/** Read a 64-bit word from the ring buffer, allowing for wrap around. */
+static inline uint64_t ringWord(const TLS* tls, uint64_t offset)
+{
+    const char* data = (const char*)tls->ring + tls->page_size;
+    uint64_t value;
+    unsigned i;
+
+    offset &= tls->data_size - 1;
+    if(offset + sizeof(value) <= tls->data_size)
+	memcpy(&value, data + offset, sizeof(value));
+    else
+	for(i = 0; i < sizeof(value); ++i)
+	    ((char*)&value)[i] = data[(offset + i) & (tls->data_size - 1)];
+    return value;
+}
+
+
+
+/**
+ * Drain the ring buffer.
+ *
+ * Passes every sample recorded by the kernel since the last drain to the
+ * thread's sample event handler, then releases the space they occupied in
+ * the ring buffer back to the kernel.
+ *
+ * @param tls    Thread-local storage of the thread being drained.
+ *
+ * @ingroup Implementation
+ */
+static void drain(TLS* tls)
+{
+    struct perf_event_header header;
+    uint64_t head, tail, nr, pc, i;
+    unsigned framecount;
+
+    if((tls->ring == NULL) || tls->draining)
+	return;
+    tls->draining = true;
+
+    head = __atomic_load_n(&tls->ring->data_head, __ATOMIC_ACQUIRE);
+    tail = tls->ring->data_tail;
+
+    while(tail < head) {
+	uint64_t word = ringWord(tls, tail);
+	memcpy(&header, &word, sizeof(header));
+	if(header.size < sizeof(header))
+	    break;
+
+	if((header.type == PERF_RECORD_SAMPLE) && (tls->handler != NULL)) {
+
+	    /* PERF_SAMPLE_IP followed by the optional PERF_SAMPLE_CALLCHAIN */
+	    pc = ringWord(tls, tail + 8);
+	    framecount = 0;
+	    if(tls->callchain) {
+		nr = ringWord(tls, tail + 16);
+		for(i = 0; (i < nr) && (framecount < CBTF_PERF_EVENT_MAXFRAMES);
+		    ++i) {
+		    uint64_t frame = ringWord(tls, tail + 24 + (8 * i));
+		    /* Skip the kernel's context markers */
+		    if(frame >= (uint64_t)PERF_CONTEXT_MAX)
+			continue;
+		    tls->frames[framecount++] = frame;
+		}
+	    }
+	    if(framecount == 0)
+		tls->frames[framecount++] = pc;
+
+	    (*tls->handler)(framecount, tls->frames);
+
+	}
+	else if(header.type == PERF_RECORD_LOST)
+	    tls->lost += ringWord(tls, tail + 16);
+
+	tail += header.size;
+    }
+
+    __atomic_store_n(&tls->ring->data_tail, tail, __ATOMIC_RELEASE);
+    tls->draining = false;
+}
+
+
+
+/**
+ * Signal handler.
+ *
+ * Called by the operating system's signal handling system each time the
+ * ring buffer of the running thread reaches its watermark. Drains the ring
+ * buffer into the per-thread sample event handling function.
+ *
+ * @param signal    Signal number.
+ * @param info      Signal information.
+ * @param ptr       Untyped pointer to thread context.
+ *
+ * @ingroup Implementation
+ */
+static void signalHandler(int signal, siginfo_t* info, void* ptr)
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if((tls == NULL) || (tls->ring == NULL) || (info->si_fd != tls->fd))
+	return;
+
+    drain(tls);
+}
+
+
+
+/**
+ * Open the perf event for the calling thread.
+ *
+ * Creates a task clock event sampling the calling thread, maps its ring
+ * buffer and arranges for the thread to be signaled each time the ring
+ * buffer is half full. The event is left disabled.
+ *
+ * @return    Boolean "true" if the event was opened, "false" otherwise.
+ *
+ * @ingroup Implementation
+ */
+static bool openEvent(TLS* tls, uint64_t interval, bool callchain)
+{
+    struct perf_event_attr attr;
+    struct f_owner_ex owner;
+    void* ring;
+
+    tls->page_size = sysconf(_SC_PAGESIZE);
+    tls->data_size = RingPages * tls->page_size;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_TASK_CLOCK;
+    attr.sample_period = interval;
+    attr.sample_type = PERF_SAMPLE_IP;
+    if(callchain)
+	attr.sample_type |= PERF_SAMPLE_CALLCHAIN;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_callchain_kernel = 1;
+    attr.watermark = 1;
+    attr.wakeup_watermark = tls->data_size / 2;
+
+    tls->fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if(tls->fd < 0)
+	return false;
+
+    ring = mmap(NULL, tls->page_size + tls->data_size,
+		PROT_READ | PROT_WRITE, MAP_SHARED, tls->fd, 0);
+    if(ring == MAP_FAILED) {
+	close(tls->fd);
+	tls->fd = -1;
+	return false;
+    }
+    tls->ring = ring;
+    tls->callchain = callchain;
+    tls->draining = false;
+    tls->lost = 0;
+
+    /* Deliver the watermark signal to this thread only */
+    owner.type = F_OWNER_TID;
+    owner.pid = syscall(SYS_gettid);
+    if((fcntl(tls->fd, F_SETSIG, CBTF_PERF_EVENT_SIGNAL) != 0) ||
+       (fcntl(tls->fd, F_SETOWN_EX, &owner) != 0) ||
+       (fcntl(tls->fd, F_SETFL, O_ASYNC | O_NONBLOCK) != 0)) {
+	munmap(tls->ring, tls->page_size + tls->data_size);
+	tls->ring = NULL;
+	close(tls->fd);
+	tls->fd = -1;
+	return false;
+    }
+
+    return true;
+}
+
+
+
+/** Close the perf event for the calling thread. */
+static void closeEvent(TLS* tls)
+{
+    if(tls->ring != NULL) {
+	ioctl(tls->fd, PERF_EVENT_IOC_DISABLE, 0);
+	drain(tls);
+	munmap(tls->ring, tls->page_size + tls->data_size);
+	tls->ring = NULL;
+    }
+    if(tls->fd >= 0) {
+	close(tls->fd);
+	tls->fd = -1;
+    }
+}
+
+#endif
+
+
+
+/**
+ * Configure a per-thread perf event sampler.
+ *
+ * Configure the kernel to sample the currently executing thread at a specified
+ * interval of CPU time using perf_event_open(). Samples are written by the
+ * kernel into a per-thread ring buffer, which is drained into the specified
+ * event handler each time it is half full, when CBTF_PerfEventDrain() is called
+ * and when the sampler is removed. Any previously configured sampler is first
+ * removed. If the specified interval is zero and/or the event handler is null,
+ * no new sampler is configured.
+ *
+ * @note    Perf events are only used when the CBTF_USE_PERF_EVENTS environment
+ *          variable is set. Callers are expected to fall back to CBTF_Timer()
+ *          when no sampler could be configured.
+ *
+ * @param interval     Sampling interval (in nanoseconds).
+ * @param callchain    Boolean "true" if the kernel should record user
+ *                     callchains with each sample.
+ * @param handler      Sample event handler.
+ * @return             Boolean "true" if a sampler was configured, "false"
+ *                     otherwise.
+ *
+ * @ingroup RuntimeAPI
+ */
+bool CBTF_PerfEventTimer(uint64_t interval, bool callchain,
+			 const CBTF_PerfEventHandler handler)
+{
+#if defined(HAVE_PERF_EVENTS)
+    struct sigaction action;
+
+    /* Create and/or access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+    if(tls == NULL) {
+	tls = malloc(sizeof(TLS));
+	Assert(tls != NULL);
+	memset(tls, 0, sizeof(TLS));
+	tls->fd = -1;
+	CBTF_SetTLS(TLSKey, tls);
+    }
+#else
+    TLS* tls = &the_tls;
+#endif
+    Assert(tls != NULL);
+
+    /* Remove any sampler previously configured for this thread */
+    if(tls->handler != NULL) {
+	closeEvent(tls);
+	tls->handler = NULL;
+
+	Assert(pthread_mutex_lock(&mutex_lock) == 0);
+	if(--num_threads == 0)
+	    Assert(sigaction(CBTF_PERF_EVENT_SIGNAL, &original_action, NULL) == 0);
+	Assert(pthread_mutex_unlock(&mutex_lock) == 0);
+    }
+
+    if((interval == 0) || (handler == NULL) ||
+       (getenv("CBTF_USE_PERF_EVENTS") == NULL))
+	return false;
+
+    if(!openEvent(tls, interval, callchain))
+	return false;
+
+    /* Install our signal handler if this is the first thread using it */
+    Assert(pthread_mutex_lock(&mutex_lock) == 0);
+    if(num_threads++ == 0) {
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = signalHandler;
+	sigfillset(&(action.sa_mask));
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	Assert(sigaction(CBTF_PERF_EVENT_SIGNAL, &action, &original_action) == 0);
+    }
+    Assert(pthread_mutex_unlock(&mutex_lock) == 0);
+
+    /* Start sampling */
+    tls->handler = handler;
+    ioctl(tls->fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(tls->fd, PERF_EVENT_IOC_ENABLE, 0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+
+/**
+ * Drain the perf event sampler.
+ *
+ * Passes every sample recorded for the currently executing thread since the
+ * last drain to its event handler. Has no effect if the thread isn't using a
+ * perf event sampler.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_PerfEventDrain()
+{
+#if defined(HAVE_PERF_EVENTS)
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if(tls != NULL)
+	drain(tls);
+#endif
+}
+
+
+
+/**
+ * Enable or disable the perf event sampler.
+ *
+ * Stops or restarts sampling of the currently executing thread without losing
+ * its configuration. Samples already recorded are kept until the next drain.
+ *
+ * @param enable    Boolean "true" to enable sampling, "false" to disable it.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_PerfEventEnable(bool enable)
+{
+#if defined(HAVE_PERF_EVENTS)
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if((tls == NULL) || (tls->ring == NULL))
+	return;
+    ioctl(tls->fd, enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+#endif
+}
@@ -36,6 +36,7 @@
 #include <sys/time.h>
 
 #include "KrellInstitute/Services/Common.h"
+#include "KrellInstitute/Services/Time.h"
 #include "KrellInstitute/Services/Timer.h"
 #include "KrellInstitute/Services/TLS.h"
 
@@ -67,6 +68,21 @@ static int cbtf_timer_signal = 0;
 static bool use_posix_timer = true;
 static bool init_timer_signal = false;
 
+/** Number of samples between adjustments of an adaptive timer. */
+#define AdaptiveWindow 64
+
+/** Largest power of 2 by which an adaptive timer may stretch its interval. */
+#define AdaptiveMaxBackoff 10
+
+/** Is the timer interval adapted to the overhead of its handler? */
+static bool use_adaptive_timer = false;
+
+/** Largest percentage of time an adaptive timer's handler may take. */
+static uint64_t adaptive_overhead = 5;
+
+/** Number of samples per thread after which the interval is stretched. */
+static uint64_t adaptive_budget = 0;
+
 /** Type defining the items stored in thread-local storage. */
 typedef struct {
 
@@ -78,6 +94,12 @@ typedef struct {
     bool	    posix_timer_initialized;
 #endif
 
+    uint64_t base_interval;   /**< Interval requested by the collector. */
+    uint64_t interval;        /**< Interval currently in effect. */
+    uint64_t window_samples;  /**< Samples in the current adaptive window. */
+    uint64_t window_cost;     /**< Time in the handler during that window. */
+    uint64_t total_samples;   /**< Samples taken since the timer was set. */
+
 } TLS;
 
 #ifdef USE_EXPLICIT_TLS
@@ -99,6 +121,94 @@ static __thread TLS the_tls;
 
 
 
+/**
+ * Change the timer interval.
+ *
+ * Re-arms the calling thread's timer with a new interval. Only used after the
+ * timer has been configured, and safe to call from within the signal handler.
+ *
+ * @param tls         Thread-local storage of the calling thread.
+ * @param interval    New timer interval (in nanoseconds).
+ *
+ * @ingroup Implementation
+ */
+static void setInterval(TLS* tls, uint64_t interval)
+{
+    tls->interval = interval;
+
+    if (use_posix_timer) {
+#ifdef HAVE_POSIX_TIMERS
+	struct itimerspec itspec = {{0}};
+	itspec.it_interval.tv_sec = interval / (uint64_t)(1000000000);
+	itspec.it_interval.tv_nsec = interval % (uint64_t)(1000000000);
+	itspec.it_value = itspec.it_interval;
+	if (tls->posix_timer_initialized)
+	    timer_settime(tls->timerid, 0, &itspec, NULL);
+#endif
+    } else {
+	struct itimerval itval = {{0}};
+	itval.it_interval.tv_sec = interval / (uint64_t)(1000000000);
+	itval.it_interval.tv_usec =
+	    (interval % (uint64_t)(1000000000)) / (uint64_t)(1000);
+	itval.it_value = itval.it_interval;
+	setitimer(ITIMER_PROF, &itval, NULL);
+    }
+}
+
+
+
+/**
+ * Adapt the timer interval.
+ *
+ * Called after each sample of an adaptive timer with the time spent in the
+ * handler. Once per window of samples the handler's share of the time between
+ * samples is compared to the overhead ceiling: the interval is doubled while
+ * it is above the ceiling and halved again once it is well below. The shortest
+ * allowed interval is the requested one, doubled every time the thread takes
+ * another budget's worth of samples. The interval is therefore always a power
+ * of 2 multiple of the requested interval.
+ *
+ * @param tls     Thread-local storage of the calling thread.
+ * @param cost    Time spent in the handler for this sample (in nanoseconds).
+ *
+ * @ingroup Implementation
+ */
+static void adaptInterval(TLS* tls, uint64_t cost)
+{
+    uint64_t elapsed, floor, interval = tls->interval;
+    unsigned shift = 0;
+
+    tls->total_samples++;
+    tls->window_cost += cost;
+    if (++tls->window_samples < AdaptiveWindow)
+	return;
+
+    if (adaptive_budget > 0) {
+	shift = tls->total_samples / adaptive_budget;
+	if (shift > AdaptiveMaxBackoff)
+	    shift = AdaptiveMaxBackoff;
+    }
+    floor = tls->base_interval << shift;
+
+    elapsed = tls->window_samples * tls->interval;
+    if ((tls->window_cost * 100 > elapsed * adaptive_overhead) &&
+	(interval < (tls->base_interval << AdaptiveMaxBackoff)))
+	interval *= 2;
+    else if ((tls->window_cost * 400 < elapsed * adaptive_overhead) &&
+	     (interval / 2 >= floor))
+	interval /= 2;
+    if (interval < floor)
+	interval = floor;
+
+    if (interval != tls->interval)
+	setInterval(tls, interval);
+
+    tls->window_samples = 0;
+    tls->window_cost = 0;
+}
+
+
+
 /**
  * Signal handler.
  *
@@ -146,8 +256,15 @@ static void signalHandler(int signal, siginfo_t* info, void* ptr)
     }
 
     /* Call this thread's timer event handler */
-    if(tls->timer_handler != NULL)
-	(*tls->timer_handler)((ucontext_t*)ptr);
+    if(tls->timer_handler != NULL) {
+	if (use_adaptive_timer) {
+	    uint64_t begin = CBTF_GetTime();
+	    (*tls->timer_handler)((ucontext_t*)ptr);
+	    adaptInterval(tls, CBTF_GetTime() - begin);
+	} else {
+	    (*tls->timer_handler)((ucontext_t*)ptr);
+	}
+    }
 }
 
 
@@ -290,6 +407,11 @@ static void __CBTF_Timer(uint64_t interval, const CBTF_TimerEventHandler handler
 
 	/* Configure the new timer event handler for this thread */
 	tls->timer_handler = handler;
+	tls->base_interval = interval;
+	tls->interval = interval;
+	tls->window_samples = 0;
+	tls->window_cost = 0;
+	tls->total_samples = 0;
 	
 	/* Enable a timer for this thread */
 	if (use_posix_timer) {
@@ -338,6 +460,16 @@ void CBTF_SetTimerSignal()
 	    cbtf_timer_signal = CBTF_ITIMER_SIGNAL;
 	    use_posix_timer = false;
 	}
+	if (getenv("CBTF_TIMER_ADAPTIVE") != NULL) {
+	    const char* value;
+	    use_adaptive_timer = true;
+	    value = getenv("CBTF_TIMER_OVERHEAD");
+	    if ((value != NULL) && (atoi(value) > 0))
+		adaptive_overhead = atoi(value);
+	    value = getenv("CBTF_TIMER_SAMPLE_BUDGET");
+	    if ((value != NULL) && (atol(value) > 0))
+		adaptive_budget = atol(value);
+	}
 	init_timer_signal = true;
     }
 }
@@ -347,6 +479,29 @@ int CBTF_GetTimerSignal()
     return cbtf_timer_signal;
 }
 
+/**
+ * Get the timer interval.
+ *
+ * Returns the interval currently in effect for the calling thread's timer.
+ * This differs from the requested interval when the timer is adaptive, and is
+ * zero when the thread has no timer.
+ *
+ * @return    Timer interval (in nanoseconds).
+ *
+ * @ingroup RuntimeAPI
+ */
+uint64_t CBTF_GetTimerInterval()
+{
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if((tls == NULL) || (tls->timer_handler == NULL))
+	return 0;
+    return tls->interval;
+}
+
 void CBTF_Timer(uint64_t interval, const CBTF_TimerEventHandler handler)
 {
     /* Create and/or access our thread-local storage */
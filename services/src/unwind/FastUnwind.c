@@ -0,0 +1,497 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the CBTF_GetStackTraceFP() function.
+ *
+ */
+
+#include "KrellInstitute/Services/Assert.h"
+#include "KrellInstitute/Services/Common.h"
+#include "KrellInstitute/Services/FoldFrames.h"
+#include "KrellInstitute/Services/TLS.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux) && defined(__x86_64)
+
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+
+#include "monitor.h"  /* for monitor_in_main_start_func_wide */
+
+/* libunwind 1.3 can be told that the PC of a signal context is exact. */
+#if (UNW_VERSION_MAJOR > 1) || \
+    ((UNW_VERSION_MAJOR == 1) && (UNW_VERSION_MINOR >= 3))
+#define HAVE_UNW_INIT_LOCAL2 1
+#endif
+
+
+
+/** Number of entries in the per-thread frame cache (must be a power of 2). */
+#define FrameCacheSize 1024
+
+/** Largest distance between a frame and its caller's frame we'll believe. */
+#define MaxFrameSize (1024 * 1024)
+
+/** Rules for finding the caller of a frame. */
+typedef enum {
+    RuleUnknown = 0,   /**< Entry is unused. */
+    RuleFramePointer,  /**< Caller found through the saved frame pointer. */
+    RuleStackPointer,  /**< Caller found at a fixed offset from the SP. */
+    RuleLibunwind,     /**< Caller must be found by libunwind. */
+    RuleOutermost      /**< There is no caller. */
+} Rule;
+
+/** Type representing a cached frame to caller mapping. */
+typedef struct {
+    uint64_t pc;         /**< PC of the frame. */
+    uint32_t rule;       /**< Rule for finding the caller of that frame. */
+    uint32_t sp_offset;  /**< Offset from SP to caller's SP (stack rule). */
+} CacheEntry;
+
+/** Type representing the registers needed to walk one frame. */
+typedef struct {
+    uint64_t pc;  /**< Program counter. */
+    uint64_t sp;  /**< Stack pointer. */
+    uint64_t fp;  /**< Frame pointer. */
+} Frame;
+
+/** Type defining the items stored in thread-local storage. */
+typedef struct {
+    CacheEntry cache[FrameCacheSize];  /**< Frame to caller mappings. */
+} TLS;
+
+#ifdef USE_EXPLICIT_TLS
+
+/**
+ * Thread-local storage key.
+ *
+ * Key used for looking up our thread-local storage. This key <em>must</em>
+ * be globally unique across the entire Open|SpeedShop code base.
+ */
+static const uint32_t TLSKey = 0x0000FA57;
+
+#else
+
+/** Thread-local storage. */
+static __thread TLS the_tls;
+
+#endif
+
+
+
+/** Find the frame cache entry for a PC. */
+static inline CacheEntry* findEntry(TLS* tls, uint64_t pc)
+{
+    return &tls->cache[(pc ^ (pc >> 12)) & (FrameCacheSize - 1)];
+}
+
+
+
+/**
+ * Test if a frame is plausible.
+ *
+ * Returns a boolean value indicating if the specified caller frame could
+ * follow the specified frame: its stack pointer must be above that of the
+ * frame and its PC must fall within a known text range. A PC already in
+ * the frame cache was validated when it was inserted.
+ *
+ * @ingroup Implementation
+ */
+static inline bool isPlausible(TLS* tls, const Frame* frame,
+			       const Frame* caller)
+{
+    if((caller->sp <= frame->sp) || (caller->sp - frame->sp > MaxFrameSize))
+	return false;
+    if(caller->pc == 0)
+	return false;
+    if((tls != NULL) && (findEntry(tls, caller->pc)->pc == caller->pc))
+	return true;
+    return !CBTF_HaveTextRanges() || CBTF_InTextRange(caller->pc);
+}
+
+
+
+/**
+ * Step using the frame pointer.
+ *
+ * Finds the caller of a frame assuming the standard x86_64 frame layout
+ * where the frame pointer addresses the saved frame pointer, immediately
+ * followed by the return address.
+ *
+ * @ingroup Implementation
+ */
+static inline bool stepFramePointer(const Frame* frame, Frame* caller)
+{
+    const uint64_t* fp = (const uint64_t*)frame->fp;
+
+    if((frame->fp < frame->sp) || (frame->fp - frame->sp > MaxFrameSize) ||
+       ((frame->fp & 0x7) != 0))
+	return false;
+
+    caller->pc = fp[1];
+    caller->fp = fp[0];
+    caller->sp = frame->fp + 16;
+    return true;
+}
+
+
+
+/**
+ * Step using a fixed stack pointer offset.
+ *
+ * Finds the caller of a frame whose function doesn't use a frame pointer:
+ * the return address sits just below the caller's stack pointer and the
+ * frame pointer is left untouched.
+ *
+ * @ingroup Implementation
+ */
+static inline void stepStackPointer(const Frame* frame, uint32_t offset,
+				    Frame* caller)
+{
+    caller->sp = frame->sp + offset;
+    caller->pc = ((const uint64_t*)caller->sp)[-1];
+    caller->fp = frame->fp;
+}
+
+
+
+/** Type representing the state of one stack walk. */
+typedef struct {
+    unw_context_t context;  /**< Copy of the context the walk started from. */
+    unw_cursor_t cursor;    /**< libunwind cursor following the walk. */
+    bool is_signal;         /**< Is the context from a signal handler? */
+    int cursor_depth;       /**< Depth of the cursor or -1 if not started. */
+    unsigned depth;         /**< Depth of the current frame. */
+} Walk;
+
+
+
+/**
+ * Bring the libunwind cursor to the current frame.
+ *
+ * The cursor is only started the first time a frame has to be unwound by
+ * libunwind, and is then stepped over the frames the walk has passed with
+ * cached rules. Driving one cursor from the original context, rather than
+ * seeding a new one with a frame's PC, SP and FP, keeps the other callee
+ * saved registers correct and lets libunwind tell return addresses from
+ * the exact PCs of the first frame and of interrupted frames.
+ *
+ * @return    Boolean "true" if the cursor is at the frame, "false" otherwise.
+ *
+ * @ingroup Implementation
+ */
+static bool syncCursor(Walk* walk, const Frame* frame)
+{
+    unw_word_t pc, sp;
+
+    if(walk->cursor_depth < 0) {
+#if defined(HAVE_UNW_INIT_LOCAL2)
+	if(unw_init_local2(&walk->cursor, &walk->context,
+			   walk->is_signal ? UNW_INIT_SIGNAL_FRAME : 0) != 0)
+	    return false;
+#else
+	if(unw_init_local(&walk->cursor, &walk->context) != 0)
+	    return false;
+#endif
+	walk->cursor_depth = 0;
+    }
+    while(walk->cursor_depth < (int)walk->depth) {
+	if(unw_step(&walk->cursor) <= 0)
+	    return false;
+	walk->cursor_depth++;
+    }
+
+    if((unw_get_reg(&walk->cursor, UNW_REG_IP, &pc) != 0) ||
+       (unw_get_reg(&walk->cursor, UNW_REG_SP, &sp) != 0))
+	return false;
+    return (pc == frame->pc) && (sp == frame->sp);
+}
+
+
+
+/**
+ * Step using libunwind.
+ *
+ * Finds the caller of a frame by stepping the walk's libunwind cursor, which
+ * interprets the unwind information for the frame's PC.
+ *
+ * @return    Positive if the caller was found, zero if this is the outermost
+ *            frame, and negative if the frame couldn't be unwound.
+ *
+ * @ingroup Implementation
+ */
+static int stepLibunwind(Walk* walk, const Frame* frame, Frame* caller,
+			 bool* is_signal_frame)
+{
+    unw_word_t value;
+    int retval;
+
+    if(!syncCursor(walk, frame))
+	return -1;
+    *is_signal_frame = (unw_is_signal_frame(&walk->cursor) > 0);
+
+    retval = unw_step(&walk->cursor);
+    if(retval <= 0)
+	return retval;
+    walk->cursor_depth++;
+
+    if(unw_get_reg(&walk->cursor, UNW_REG_IP, &value) != 0)
+	return -1;
+    caller->pc = value;
+    if(unw_get_reg(&walk->cursor, UNW_REG_SP, &value) != 0)
+	return -1;
+    caller->sp = value;
+    if(unw_get_reg(&walk->cursor, UNW_X86_64_RBP, &value) != 0)
+	return -1;
+    caller->fp = value;
+
+    return 1;
+}
+
+
+
+/**
+ * Step to the caller of a frame.
+ *
+ * Finds the caller of a frame, consulting the frame cache first. On a miss
+ * the caller is found with libunwind and the cheapest rule that reproduces
+ * libunwind's answer is cached for the frame's PC. Signal frames are always
+ * unwound by libunwind. Cached rules whose answer isn't plausible are
+ * retried with libunwind before giving up.
+ *
+ * @return    Boolean "true" if the caller was found, "false" otherwise.
+ *
+ * @ingroup Implementation
+ */
+static bool step(TLS* tls, Walk* walk, const Frame* frame, Frame* caller)
+{
+    CacheEntry* entry = (tls != NULL) ? findEntry(tls, frame->pc) : NULL;
+    bool is_signal_frame = false;
+    Frame candidate;
+
+    if((entry != NULL) && (entry->pc == frame->pc)) {
+	switch(entry->rule) {
+
+	case RuleFramePointer:
+	    if(stepFramePointer(frame, caller) &&
+	       isPlausible(tls, frame, caller))
+		return true;
+	    break;
+
+	case RuleStackPointer:
+	    stepStackPointer(frame, entry->sp_offset, caller);
+	    if(isPlausible(tls, frame, caller))
+		return true;
+	    break;
+
+	case RuleOutermost:
+	    return false;
+
+	default:
+	    break;
+
+	}
+    }
+
+    /* Fall back to libunwind for this frame */
+    switch(stepLibunwind(walk, frame, caller, &is_signal_frame)) {
+
+    case 0:
+	if(entry != NULL) {
+	    entry->pc = frame->pc;
+	    entry->rule = RuleOutermost;
+	}
+	return false;
+
+    case 1:
+	if(isPlausible(tls, frame, caller))
+	    break;
+	/* Fall through */
+
+    default:
+	return false;
+
+    }
+
+    if((entry == NULL) || is_signal_frame) {
+	if(entry != NULL) {
+	    entry->pc = frame->pc;
+	    entry->rule = RuleLibunwind;
+	}
+	return true;
+    }
+
+    /* Remember the cheapest rule that agrees with libunwind */
+    entry->pc = frame->pc;
+    entry->rule = RuleLibunwind;
+    if(stepFramePointer(frame, &candidate) &&
+       (candidate.pc == caller->pc) && (candidate.sp == caller->sp) &&
+       (candidate.fp == caller->fp))
+	entry->rule = RuleFramePointer;
+    else if((caller->fp == frame->fp) &&
+	    (((const uint64_t*)caller->sp)[-1] == caller->pc)) {
+	entry->rule = RuleStackPointer;
+	entry->sp_offset = (uint32_t)(caller->sp - frame->sp);
+    }
+
+    return true;
+}
+
+
+
+/**
+ * Initialize the frame pointer unwinder for this thread.
+ *
+ * Allocates the calling thread's frame cache when explicit TLS is used. Must
+ * be called before the thread's first sample since allocating memory isn't
+ * safe from within a signal handler. Threads without a frame cache unwind
+ * every frame with libunwind.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_InitializeStackTraceFP()
+{
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+    if(tls == NULL) {
+	tls = malloc(sizeof(TLS));
+	Assert(tls != NULL);
+	memset(tls, 0, sizeof(TLS));
+	CBTF_SetTLS(TLSKey, tls);
+    }
+#endif
+}
+
+
+
+/**
+ * Finalize the frame pointer unwinder for this thread.
+ *
+ * Releases the calling thread's frame cache when explicit TLS is used.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_FinalizeStackTraceFP()
+{
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+    if(tls != NULL) {
+	CBTF_SetTLS(TLSKey, NULL);
+	free(tls);
+    }
+#endif
+}
+
+
+
+/**
+ * Get stack trace using frame pointers.
+ *
+ * Returns the stack trace from a thread context by walking frame pointers
+ * wherever a frame is known to have a standard frame, and using libunwind
+ * only for those frames that don't. A small per-thread cache remembers, for
+ * each PC, how to find the caller of the frame so that libunwind is consulted
+ * once per distinct PC rather than once per frame of every sample. Addresses
+ * are validated against the text ranges recorded by CBTF_GetDLInfo(). Each
+ * thread calls CBTF_InitializeStackTraceFP() before its first stack trace.
+ *
+ * @param signal_context    Thread signal context from which to extract the
+ *                          stack trace. Use null when obtaining stack trace
+ *                          from a non-signal context.
+ * @param skip_frames       Fixed number of frames to skip.
+ * @param max_frames        Maximum number of frames to be stored.
+ * @retval stacktrace_size  Actual size (in number of frames) of the stack
+ *                          trace obtained from the context.
+ * @retval stacktrace       Stack trace obtained from the context.
+ *
+ * @ingroup RuntimeAPI
+ */
+void CBTF_GetStackTraceFP(const ucontext_t* signal_context,
+			  unsigned skip_frames,
+			  unsigned max_frames,
+			  unsigned* stacktrace_size,
+			  uint64_t* stacktrace)
+{
+    Walk walk;
+    Frame frame, caller;
+    unsigned index = 0;
+    int fold = CBTF_FoldFramesEnabled();
+
+    /* Access our thread-local storage (allocated at thread start) */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = CBTF_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+
+    /* Use the current context when not called from a signal handler */
+    if(signal_context == NULL) {
+	Assert(getcontext((ucontext_t*)&walk.context) == 0);
+    }
+    else
+	memcpy(&walk.context, signal_context, sizeof(unw_context_t));
+    walk.is_signal = (signal_context != NULL);
+    walk.cursor_depth = -1;
+    walk.depth = 0;
+
+    frame.pc = (uint64_t)walk.context.uc_mcontext.gregs[REG_RIP];
+    frame.sp = (uint64_t)walk.context.uc_mcontext.gregs[REG_RSP];
+    frame.fp = (uint64_t)walk.context.uc_mcontext.gregs[REG_RBP];
+
+    /* Iterate over each frame in the stack trace from this context */
+    while(index < max_frames) {
+
+	/* Are we still unwinding past skipped frames? */
+	if(skip_frames > 0)
+	    --skip_frames;
+
+	/* Otherwise store the PC value from this frame in the stack trace */
+	else {
+#if defined(USES_LIBMONITOR)
+	    if(!monitor_in_main_start_func_wide((void*)frame.pc) &&
+	       !monitor_in_start_func_wide((void*)frame.pc)) {
+		if(fold)
+		    index = CBTF_FoldFrame(stacktrace, index, frame.pc);
+		else
+		    stacktrace[index++] = frame.pc;
+	    }
+#else
+	    if(fold)
+		index = CBTF_FoldFrame(stacktrace, index, frame.pc);
+	    else
+		stacktrace[index++] = frame.pc;
+#endif
+	}
+
+	/* Unwind to the next frame, stopping after the last frame */
+	if(!step(tls, &walk, &frame, &caller))
+	    break;
+	frame = caller;
+	walk.depth++;
+
+    }
+
+    /* Return the stack trace size to the caller */
+    *stacktrace_size = index;
+}
+
+#endif
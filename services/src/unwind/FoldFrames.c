@@ -0,0 +1,106 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the stack trace folding functions.
+ *
+ */
+
+#include "KrellInstitute/Services/FoldFrames.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/**
+ * Test if frames should be folded.
+ *
+ * Returns whether CBTF_FOLD_FRAMES is set in the environment. The variable is
+ * only read once. A race between the first callers is harmless since they
+ * all read the same value.
+ *
+ * @return    Non-zero if frames should be folded.
+ */
+int CBTF_FoldFramesEnabled()
+{
+    static int enabled = -1;
+
+    if(enabled < 0)
+	enabled = (getenv("CBTF_FOLD_FRAMES") != NULL);
+    return enabled;
+}
+
+
+
+/**
+ * Append a frame to a folded stack trace.
+ *
+ * The frame is appended and then folded in one of two ways. If the frames
+ * after a repeat frame become another copy of its cycle, they are removed
+ * and the repeat count is incremented. Otherwise, if the trace now ends with
+ * two copies of a cycle, the second copy is replaced by a repeat frame.
+ * The stack trace never grows by more than one frame.
+ *
+ * @param stacktrace    Stack trace to which the frame is appended.
+ * @param size          Number of frames in the stack trace.
+ * @param frame         Frame to be appended.
+ * @return              New number of frames in the stack trace.
+ */
+unsigned CBTF_FoldFrame(uint64_t* stacktrace, unsigned size, uint64_t frame)
+{
+    unsigned length, i;
+
+    stacktrace[size++] = frame;
+
+    /* Extend the repeat of a cycle that has just been completed again */
+    for(length = 1; length <= CBTF_FOLD_MAXCYCLE; ++length) {
+	if(size < 2 * length + 1)
+	    break;
+
+	uint64_t repeat = stacktrace[size - length - 1];
+	if(CBTF_IsFrameRepeat(repeat) &&
+	   (CBTF_FrameRepeatLength(repeat) == length) &&
+	   (CBTF_FrameRepeatCount(repeat) < 0xFFFFFFFF) &&
+	   (memcmp(&stacktrace[size - 2 * length - 1],
+		   &stacktrace[size - length],
+		   length * sizeof(uint64_t)) == 0)) {
+	    stacktrace[size - length - 1] = repeat + 1;
+	    return size - length;
+	}
+    }
+
+    /* Fold the shortest cycle ending the trace that appears twice in a row */
+    for(length = 1; length <= CBTF_FOLD_MAXCYCLE; ++length) {
+	if(size < 2 * length)
+	    break;
+
+	const uint64_t* first = &stacktrace[size - 2 * length];
+	if(memcmp(first, first + length, length * sizeof(uint64_t)) != 0)
+	    continue;
+	for(i = 0; (i < length) && !CBTF_IsFrameRepeat(first[i]); ++i);
+	if(i < length)
+	    continue;
+
+	stacktrace[size - length] = CBTF_FrameRepeat(length, 1);
+	return size - length + 1;
+    }
+
+    return size;
+}
@@ -26,6 +26,7 @@
 #include "KrellInstitute/Services/Assert.h"
 #include "KrellInstitute/Services/Common.h"
 #include "KrellInstitute/Services/Context.h"
+#include "KrellInstitute/Services/FoldFrames.h"
 
 #include <stdbool.h>
 #include <string.h>
@@ -60,6 +61,9 @@
  * @retval stacktrace_size      Actual size (in number of frames) of the stack
  *                              trace obtained from the current context.
  * @retval stacktrace           Stack trace obtained from the current context.
+ *                              Repeated frames are folded when enabled (see
+ *                              CBTF_FoldFrame), so max_frames bounds the size
+ *                              of the folded stack trace.
  */
 void CBTF_GetStackTraceFromContext(const ucontext_t* signal_context,
 				     bool_t skip_signal_frames,
@@ -73,6 +77,7 @@ void CBTF_GetStackTraceFromContext(const ucontext_t* signal_context,
     int retval;
     unw_word_t pc;
     unsigned index = 0;
+    int fold = CBTF_FoldFramesEnabled();
 
 /*
  * Always use the context from unw_getcontext and let libunwind
@@ -249,10 +254,16 @@ void CBTF_GetStackTraceFromContext(const ucontext_t* signal_context,
 		; //noop
 	    } else {
 		// adjust address for finding correct line
-		stacktrace[index++] = (uint64_t) ((char *) pc);
+		if (fold)
+		    index = CBTF_FoldFrame(stacktrace, index, (uint64_t)pc);
+		else
+		    stacktrace[index++] = (uint64_t) ((char *) pc);
 	    }
 #else
-	    stacktrace[index++] = (uint64_t)pc;	    
+	    if (fold)
+		index = CBTF_FoldFrame(stacktrace, index, (uint64_t)pc);
+	    else
+		stacktrace[index++] = (uint64_t)pc;
 #endif
 	}
 	
@@ -288,6 +299,15 @@ void CBTF_GetStackTrace( bool_t skip_signal_frames,
 	skip_frames = UNWIND_SKIP_FRAMES;
 
     int i;
+    if (CBTF_FoldFramesEnabled()) {
+	unsigned size = 0;
+	for (i = skip_frames; i < *stacktrace_size; i++) {
+	    size = CBTF_FoldFrame(stacktrace, size, framebuf[i]);
+	}
+	*stacktrace_size = size;
+	return;
+    }
+
     for (i = skip_frames; i < *stacktrace_size; i++) {
 	stacktrace[i-skip_frames] = framebuf[i];
     }
@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file Unit tests of the AddressBuffer top-K sketch. */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE address-sketch
+
+#include <boost/test/unit_test.hpp>
+#include <map>
+#include <vector>
+
+#include "KrellInstitute/Core/Address.hpp"
+#include "KrellInstitute/Core/AddressBuffer.hpp"
+
+using namespace KrellInstitute::Core;
+
+namespace {
+
+    /** Number of leaves in the simulated tree. */
+    const unsigned Leaves = 16;
+
+    /** Number of leaves below each intermediate node. */
+    const unsigned Fanout = 4;
+
+    /** Number of distinct addresses sampled by the leaves. */
+    const unsigned Addresses = 2000;
+
+    /** Number of addresses retained by each sketch. */
+    const unsigned K = 64;
+
+    /** Deterministic pseudo-random numbers so failures can be reproduced. */
+    uint64_t nextRandom(uint64_t& state)
+    {
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return state >> 33;
+    }
+
+    /**
+     * Fill the buffer of one leaf with a skewed sample of the addresses,
+     * adding the same counts to the exact totals.
+     */
+    void sampleLeaf(unsigned leaf, AddressBuffer& buf,
+		    std::map<uint64_t, uint64_t>& exact)
+    {
+	uint64_t state = leaf + 1;
+	for (unsigned i = 0; i < 20000; ++i) {
+	    // Squaring a uniform value skews the samples toward low addresses
+	    uint64_t r = nextRandom(state) % Addresses;
+	    uint64_t addr = 0x400000 + 4 * (r * r / Addresses);
+	    buf.updateAddressCounts(addr, 1);
+	    exact[addr] += 1;
+	}
+    }
+
+    /** Merge a child into its parent the way AddressAggregator does. */
+    void mergeChild(AddressBuffer& to, const AddressBuffer& from)
+    {
+	to.mergeSketch(from);
+	if (to.addresscounts.size() > 2 * K) {
+	    to.truncate(K);
+	}
+    }
+
+    /** Check the bounds of a sketch against the exact counts. */
+    void checkBounds(const AddressBuffer& sketch,
+		     const std::map<uint64_t, uint64_t>& exact)
+    {
+	uint64_t total = 0;
+	std::map<uint64_t, uint64_t>::const_iterator i;
+	for (i = exact.begin(); i != exact.end(); ++i) {
+	    total += i->second;
+	    AddressCounts::const_iterator j =
+		sketch.addresscounts.find(Address(i->first));
+	    if (j == sketch.addresscounts.end()) {
+		BOOST_CHECK_LE(i->second, sketch.missing);
+	    } else {
+		BOOST_CHECK_LE(j->second, i->second);
+		BOOST_CHECK_GE(j->second + sketch.getError(j->first), i->second);
+	    }
+	}
+	BOOST_CHECK_EQUAL(sketch.getTotalCount(), total);
+    }
+
+}
+
+
+
+/** Test that truncating a single exact buffer keeps the largest counts. */
+BOOST_AUTO_TEST_CASE(TruncateKeepsLargest)
+{
+    AddressBuffer buf;
+    for (uint64_t i = 1; i <= 10; ++i) {
+	buf.updateAddressCounts(i, i * 10);
+    }
+
+    buf.truncate(3);
+
+    BOOST_CHECK_EQUAL(buf.addresscounts.size(), 3u);
+    BOOST_CHECK_EQUAL(buf.addresscounts[Address(10)], 100u);
+    BOOST_CHECK_EQUAL(buf.addresscounts[Address(9)], 90u);
+    BOOST_CHECK_EQUAL(buf.addresscounts[Address(8)], 80u);
+    BOOST_CHECK_EQUAL(buf.missing, 70u);
+    BOOST_CHECK_EQUAL(buf.dropped, 280u);
+    BOOST_CHECK_EQUAL(buf.getTotalCount(), 550u);
+}
+
+
+
+/** Test that exact buffers merge into exact counts. */
+BOOST_AUTO_TEST_CASE(MergeExact)
+{
+    AddressBuffer a, b;
+    a.updateAddressCounts(1, 5);
+    a.updateAddressCounts(2, 7);
+    b.updateAddressCounts(2, 3);
+    b.updateAddressCounts(3, 4);
+
+    a.mergeSketch(b);
+
+    BOOST_CHECK_EQUAL(a.addresscounts[Address(1)], 5u);
+    BOOST_CHECK_EQUAL(a.addresscounts[Address(2)], 10u);
+    BOOST_CHECK_EQUAL(a.addresscounts[Address(3)], 4u);
+    BOOST_CHECK(a.addresserrors.empty());
+    BOOST_CHECK_EQUAL(a.missing, 0u);
+}
+
+
+
+/**
+ * Test that the bounds hold after merging the leaves of a two level tree,
+ * truncating at every node as the aggregator does.
+ */
+BOOST_AUTO_TEST_CASE(BoundsHoldThroughTree)
+{
+    std::map<uint64_t, uint64_t> exact;
+    std::vector<AddressBuffer> intermediates(Leaves / Fanout);
+
+    for (unsigned leaf = 0; leaf < Leaves; ++leaf) {
+	AddressBuffer buf;
+	sampleLeaf(leaf, buf, exact);
+	buf.truncate(K);
+	mergeChild(intermediates[leaf / Fanout], buf);
+    }
+
+    AddressBuffer frontend;
+    for (unsigned i = 0; i < intermediates.size(); ++i) {
+	intermediates[i].truncate(K);
+	mergeChild(frontend, intermediates[i]);
+    }
+    frontend.truncate(K);
+
+    BOOST_CHECK_EQUAL(frontend.addresscounts.size(), K);
+    checkBounds(frontend, exact);
+
+    // The hottest address must survive every truncation
+    std::map<uint64_t, uint64_t>::const_iterator i, hottest = exact.begin();
+    for (i = exact.begin(); i != exact.end(); ++i) {
+	if (i->second > hottest->second) {
+	    hottest = i;
+	}
+    }
+    BOOST_CHECK(frontend.addresscounts.find(Address(hottest->first)) !=
+		frontend.addresscounts.end());
+}
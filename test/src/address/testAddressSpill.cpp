@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file Unit tests of the AddressSpill k-way merge. */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE address-spill
+
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+#include "KrellInstitute/Core/Address.hpp"
+#include "KrellInstitute/Core/AddressBuffer.hpp"
+#include "KrellInstitute/Core/AddressSpill.hpp"
+
+using namespace KrellInstitute::Core;
+
+namespace {
+
+    /** Number of runs spilled, enough to be compacted more than once. */
+    const unsigned Runs = 2 * AddressSpill::MaxRuns + 10;
+
+    /** Number of addresses added to the buffer between spills. */
+    const unsigned AddressesPerRun = 300;
+
+    /** Number of distinct addresses, so that the runs overlap. */
+    const unsigned Addresses = 5000;
+
+    /** Memory budget, in bytes, allowing a few hundred addresses. */
+    const uint64_t Budget = 16 * 1024;
+
+    /** Deterministic pseudo-random numbers so failures can be reproduced. */
+    uint64_t nextRandom(uint64_t& state)
+    {
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return state >> 33;
+    }
+
+    /** Directory holding the runs of the tests. */
+    std::string spillDirectory()
+    {
+	return (getenv("TMPDIR") != NULL) ? getenv("TMPDIR") : "/tmp";
+    }
+
+    /**
+     * Add a batch of addresses to the buffer, adding the same counts to
+     * the exact totals.
+     */
+    void addBatch(uint64_t& state, AddressBuffer& buf,
+		  std::map<uint64_t, uint64_t>& exact)
+    {
+	for (unsigned i = 0; i < AddressesPerRun; ++i) {
+	    uint64_t address = 0x400000 + 4 * (nextRandom(state) % Addresses);
+	    uint64_t count = 1 + nextRandom(state) % 10;
+	    buf.updateAddressCounts(address, count);
+	    exact[address] += count;
+	}
+    }
+
+    /** Check that the counts of a buffer match the exact totals. */
+    void checkCounts(const AddressCounts& counts,
+		     const std::map<uint64_t, uint64_t>& exact)
+    {
+	BOOST_REQUIRE_EQUAL(counts.size(), exact.size());
+
+	AddressCounts::const_iterator i = counts.begin();
+	std::map<uint64_t, uint64_t>::const_iterator j = exact.begin();
+	for (; i != counts.end(); ++i, ++j) {
+	    BOOST_CHECK_EQUAL(i->first.getValue(), j->first);
+	    BOOST_CHECK_EQUAL(i->second, j->second);
+	}
+    }
+
+    /**
+     * Spill enough batches to compact the runs, leaving the last batch
+     * in the buffer.
+     */
+    void spillBatches(AddressSpill& spill, AddressBuffer& buf,
+		      std::map<uint64_t, uint64_t>& exact)
+    {
+	uint64_t state = 12345;
+	for (unsigned i = 0; i < Runs; ++i) {
+	    addBatch(state, buf, exact);
+	    spill.spill(buf);
+	    BOOST_REQUIRE(buf.addresscounts.empty());
+	    BOOST_REQUIRE(spill.getRunCount() < AddressSpill::MaxRuns);
+	}
+	addBatch(state, buf, exact);
+	BOOST_REQUIRE(spill.getRunCount() > 0);
+    }
+
+}
+
+
+
+/**
+ * Merging the runs and the buffer back must give the same counts as
+ * merging every batch in memory.
+ */
+BOOST_AUTO_TEST_CASE(MergeMatchesInMemory)
+{
+    AddressSpill spill(spillDirectory(), Budget);
+    AddressBuffer buf;
+    std::map<uint64_t, uint64_t> exact;
+
+    spillBatches(spill, buf, exact);
+    spill.merge(buf);
+
+    BOOST_CHECK_EQUAL(spill.getRunCount(), 0U);
+    checkCounts(buf.addresscounts, exact);
+}
+
+
+
+/**
+ * Streaming the merge out in chunks must give disjoint, increasing chunks
+ * that together hold the same counts as merging every batch in memory.
+ */
+BOOST_AUTO_TEST_CASE(ChunksMatchInMemory)
+{
+    AddressSpill spill(spillDirectory(), Budget);
+    AddressBuffer buf;
+    std::map<uint64_t, uint64_t> exact;
+
+    spillBatches(spill, buf, exact);
+
+    AddressCounts merged;
+    AddressBuffer chunk;
+    unsigned chunks = 0;
+    bool more = true;
+    while (more) {
+	more = spill.next(buf, chunk);
+	BOOST_REQUIRE(buf.addresscounts.empty());
+	if (!chunk.addresscounts.empty() && !merged.empty()) {
+	    BOOST_CHECK(merged.rbegin()->first < chunk.addresscounts.begin()->first);
+	}
+	merged.insert(chunk.addresscounts.begin(), chunk.addresscounts.end());
+	++chunks;
+    }
+
+    BOOST_CHECK(chunks > 1);
+    BOOST_CHECK_EQUAL(spill.getRunCount(), 0U);
+    checkCounts(merged, exact);
+}
+
+
+
+/** Without any runs the buffer is the only chunk. */
+BOOST_AUTO_TEST_CASE(SingleChunkWithoutRuns)
+{
+    AddressSpill spill(spillDirectory(), Budget);
+    AddressBuffer buf;
+    std::map<uint64_t, uint64_t> exact;
+    uint64_t state = 67890;
+
+    addBatch(state, buf, exact);
+
+    AddressBuffer chunk;
+    BOOST_CHECK(!spill.next(buf, chunk));
+    BOOST_CHECK(buf.addresscounts.empty());
+    checkCounts(chunk.addresscounts, exact);
+}
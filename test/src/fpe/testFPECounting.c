@@ -0,0 +1,113 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Test of the FPE counting in CBTF_FPECounting() and CBTF_FPECheck().
+ *
+ * A one-shot trap is armed by a check and counting is then removed, or
+ * reconfigured without traps, before the trap fires. The counted exceptions
+ * must be masked again in both the x87 control word and the MXCSR, so that
+ * dividing by zero afterwards doesn't raise SIGFPE. The program exits with
+ * a non-zero status if any check fails.
+ *
+ */
+
+#include "KrellInstitute/Services/FPE.h"
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
+
+
+/** Number of checks that failed. */
+static int failures = 0;
+
+/** Divisor hidden from the compiler so the division is done at run time. */
+static volatile double zero = 0.0;
+
+
+
+/** Counting handler, which has nothing to record here. */
+static void handler(const CBTF_FPEType type, const ucontext_t* context)
+{
+}
+
+
+
+#if defined(__x86_64__)
+
+/** Test whether any of the specified exceptions are unmasked (trapped). */
+static int isTrapped(int excepts)
+{
+    return ((fegetexcept() & excepts) != 0) ||
+	((~_mm_getcsr() & (excepts << 7)) != 0);
+}
+
+#endif
+
+
+
+/** Arm a one-shot trap, change the counting and check the trap is gone. */
+static void testArmThen(const char* name,
+			const CBTF_FPEEventHandler next_handler)
+{
+#if defined(__x86_64__)
+    volatile double result;
+
+    CBTF_FPECounting(DivideByZero, handler, 1);
+    CBTF_FPECheck(NULL);
+    if(!isTrapped(FE_DIVBYZERO)) {
+	fprintf(stderr, "%s: the one-shot trap wasn't armed\n", name);
+	++failures;
+    }
+
+    CBTF_FPECounting(DivideByZero, next_handler, 0);
+    if(isTrapped(FE_DIVBYZERO)) {
+	fprintf(stderr, "%s: the one-shot trap is still armed\n", name);
+	++failures;
+	fedisableexcept(FE_DIVBYZERO);
+    }
+
+    /* Raises SIGFPE, ending the test, if the trap is still armed */
+    result = 1.0 / zero;
+    (void)result;
+
+    CBTF_FPECounting(DivideByZero, NULL, 0);
+    feclearexcept(FE_ALL_EXCEPT);
+#endif
+}
+
+
+
+/** Run the tests. */
+int main(int argc, char* argv[])
+{
+    testArmThen("arm then remove", NULL);
+    testArmThen("arm then reconfigure", handler);
+
+    if(failures > 0) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
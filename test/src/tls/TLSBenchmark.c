@@ -0,0 +1,266 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Test and benchmark of the thread-local storage access methods available
+ * to the collectors: the original per-thread linear probe map, CBTF_GetTLS()
+ * by key, CBTF_GetTLSSlot() by registered slot, and the compiler's __thread
+ * storage.
+ *
+ * Every thread first checks that the values it stores by key and by slot
+ * read back unchanged through both interfaces while the other threads store
+ * their own values under the same keys. The program exits with a non-zero
+ * status if any check fails.
+ *
+ * Usage: tlsBenchmark [iterations] [threads]
+ *
+ */
+
+#include <stdint.h>
+
+#include "KrellInstitute/Services/TLS.h"
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+
+/** Default number of accesses timed per method and thread. */
+#define DefaultIterations 10000000
+
+/** Number of keys registered so that lookups don't all hit the first probe. */
+#define KeyCount 8
+
+/** Keys mirroring the ones used by the services and collectors. */
+static const uint32_t Keys[KeyCount] = {
+    0x0000FAB1, 0xBAD0BEEF, 0x0000AEF3, 0x00001EF7,
+    0x00001EFA, 0x00001EFB, 0x00001EFE, 0xBEEF0FAD
+};
+
+/** Number of entries in the legacy key/value maps. */
+#define MapSize 32
+
+/** Legacy per-thread map of keys to values (pre-slot TLS implementation). */
+typedef struct {
+    uint32_t size;
+    uint32_t keys[MapSize];
+    void* values[MapSize];
+} LegacyMap;
+
+/** Pointer to pthread_getspecific() as looked up by the legacy map. */
+static void* (*f_pthread_getspecific)(pthread_key_t) = NULL;
+
+/** Key for accessing a thread's legacy map. */
+static pthread_key_t legacy_key;
+
+/** Number of accesses timed per method and thread. */
+static unsigned long iterations = DefaultIterations;
+
+/** Value accessed through __thread. */
+static __thread void* implicit_value;
+
+/** Slot assigned to each key by the main thread. */
+static uint32_t main_slots[KeyCount];
+
+/** Barrier keeping the threads' stores and checks interleaved. */
+static pthread_barrier_t barrier;
+
+/** Number of failed checks over all threads. */
+static volatile unsigned long failures = 0;
+
+
+
+/** Legacy key lookup: pthread_getspecific() followed by a linear probe. */
+static void** legacyGetValue(uint32_t key)
+{
+    LegacyMap* map = (LegacyMap*)(*f_pthread_getspecific)(legacy_key);
+    unsigned bucket;
+
+    if(map == NULL) {
+	map = (LegacyMap*)calloc(1, sizeof(LegacyMap));
+	pthread_setspecific(legacy_key, map);
+    }
+
+    bucket = key % MapSize;
+    while((map->keys[bucket] > 0) && (map->keys[bucket] != key))
+	bucket = (bucket + 1) % MapSize;
+
+    if(map->keys[bucket] == 0) {
+	map->keys[bucket] = key;
+	map->size++;
+    }
+
+    return &(map->values[bucket]);
+}
+
+
+
+/** Get the current monotonic time in nanoseconds. */
+static uint64_t now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)(ts.tv_sec) * (uint64_t)(1000000000)) +
+	(uint64_t)(ts.tv_nsec);
+}
+
+
+
+/** Report a failed check from the given thread. */
+static void fail(unsigned long id, const char* what, int k)
+{
+    fprintf(stderr, "[%lu] FAILED: %s for key 0x%08x\n", id, what, Keys[k]);
+    __sync_fetch_and_add(&failures, 1);
+}
+
+
+
+/** Check that the calling thread's values round trip by key and by slot. */
+static void check(unsigned long id, uint32_t* slots)
+{
+    char values[KeyCount];
+    int k;
+
+    for(k = 0; k < KeyCount; ++k) {
+	slots[k] = CBTF_RegisterTLS(Keys[k]);
+	if(slots[k] != main_slots[k])
+	    fail(id, "slot differs from the main thread's", k);
+	if(CBTF_GetTLSSlot(slots[k]) != NULL)
+	    fail(id, "new thread's slot is not empty", k);
+    }
+
+    /* Store by slot and read back by key while the others do the same. */
+    for(k = 0; k < KeyCount; ++k)
+	CBTF_SetTLSSlot(slots[k], &values[k]);
+    pthread_barrier_wait(&barrier);
+    for(k = 0; k < KeyCount; ++k) {
+	if(CBTF_GetTLSSlot(slots[k]) != &values[k])
+	    fail(id, "CBTF_SetTLSSlot/CBTF_GetTLSSlot", k);
+	if(CBTF_GetTLS(Keys[k]) != &values[k])
+	    fail(id, "CBTF_SetTLSSlot/CBTF_GetTLS", k);
+    }
+    pthread_barrier_wait(&barrier);
+
+    /* Store by key and read back by slot. */
+    for(k = 0; k < KeyCount; ++k)
+	CBTF_SetTLS(Keys[k], &values[KeyCount - 1 - k]);
+    pthread_barrier_wait(&barrier);
+    for(k = 0; k < KeyCount; ++k) {
+	if(CBTF_GetTLS(Keys[k]) != &values[KeyCount - 1 - k])
+	    fail(id, "CBTF_SetTLS/CBTF_GetTLS", k);
+	if(CBTF_GetTLSSlot(slots[k]) != &values[KeyCount - 1 - k])
+	    fail(id, "CBTF_SetTLS/CBTF_GetTLSSlot", k);
+    }
+    pthread_barrier_wait(&barrier);
+}
+
+
+
+/** Check and then time each access method from the calling thread. */
+static void* run(void* arg)
+{
+    uint32_t slots[KeyCount];
+    uintptr_t sum = 0;
+    uint64_t start;
+    unsigned long i;
+    int k;
+
+    check((unsigned long)arg, slots);
+
+    for(k = 0; k < KeyCount; ++k) {
+	CBTF_SetTLSSlot(slots[k], &slots[k]);
+	*legacyGetValue(Keys[k]) = &slots[k];
+    }
+    implicit_value = &slots[KeyCount - 1];
+
+    start = now();
+    for(i = 0; i < iterations; ++i)
+	sum += (uintptr_t)*legacyGetValue(Keys[i % KeyCount]);
+    printf("[%lu] legacy map     %6.2f ns/access\n", (unsigned long)arg,
+	   (double)(now() - start) / iterations);
+
+    start = now();
+    for(i = 0; i < iterations; ++i)
+	sum += (uintptr_t)CBTF_GetTLS(Keys[i % KeyCount]);
+    printf("[%lu] CBTF_GetTLS     %6.2f ns/access\n", (unsigned long)arg,
+	   (double)(now() - start) / iterations);
+
+    start = now();
+    for(i = 0; i < iterations; ++i)
+	sum += (uintptr_t)CBTF_GetTLSSlot(slots[i % KeyCount]);
+    printf("[%lu] CBTF_GetTLSSlot %6.2f ns/access\n", (unsigned long)arg,
+	   (double)(now() - start) / iterations);
+
+    start = now();
+    for(i = 0; i < iterations; ++i) {
+	sum += (uintptr_t)implicit_value;
+	__asm__ __volatile__("" : : : "memory");
+    }
+    printf("[%lu] __thread        %6.2f ns/access\n", (unsigned long)arg,
+	   (double)(now() - start) / iterations);
+
+    return (void*)sum;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    unsigned long n, threads = 1;
+    pthread_t* tids;
+    int k;
+
+    if(argc > 1)
+	iterations = strtoul(argv[1], NULL, 10);
+    if(argc > 2)
+	threads = strtoul(argv[2], NULL, 10);
+    if((iterations == 0) || (threads == 0)) {
+	fprintf(stderr, "Usage: %s [iterations] [threads]\n", argv[0]);
+	return 1;
+    }
+
+    f_pthread_getspecific = (void* (*)(pthread_key_t))
+	dlsym(RTLD_DEFAULT, "pthread_getspecific");
+    pthread_key_create(&legacy_key, free);
+
+    for(k = 0; k < KeyCount; ++k)
+	main_slots[k] = CBTF_RegisterTLS(Keys[k]);
+    pthread_barrier_init(&barrier, NULL, threads);
+
+    tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    for(n = 0; n < threads; ++n)
+	if(pthread_create(&tids[n], NULL, run, (void*)n) != 0) {
+	    fprintf(stderr, "Cannot create thread %lu.\n", n);
+	    return 1;
+	}
+    for(n = 0; n < threads; ++n)
+	pthread_join(tids[n], NULL);
+    free(tids);
+    pthread_barrier_destroy(&barrier);
+
+    if(failures > 0) {
+	fprintf(stderr, "%lu TLS checks failed.\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This program is free software; you can redistribute it and/or modify it under
+** the terms of the GNU General Public License as published by the Free Software
+** Foundation; either version 2 of the License, or (at your option) any later
+** version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+** details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+** Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file Converter of binary overview records into CSV files. */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "OverviewRecord.h"
+
+/** Swap the bytes of a 32-bit value. */
+static uint32_t swap32(uint32_t value)
+{
+    return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) |
+	   ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+}
+
+/**
+ * Write one record as CSV. The record is appended to its CSV file below
+ * the given directory, using the same layout as the overview collector,
+ * or printed to the standard output when no directory is given.
+ *
+ * @param record       Record to be written.
+ * @param directory    Directory receiving the CSV files or null.
+ * @return             Zero on success, non-zero otherwise.
+ */
+static int write_record(const CBTF_overview_record* record,
+			const char* directory)
+{
+    char dir[PATH_MAX], path[PATH_MAX], prefix[64];
+    FILE* file = NULL;
+
+    if (directory == NULL) {
+	snprintf(prefix, sizeof(prefix), "[%" PRId64 ",%d] ",
+		 record->pid, record->omp_tid);
+	CBTF_overview_record_print_csv(stdout, prefix, record);
+	return 0;
+    }
+
+    if ((CBTF_overview_record_csv_dir(record, directory,
+				      dir, sizeof(dir)) != 0) ||
+	(CBTF_overview_record_csv_path(record, directory,
+				       path, sizeof(path)) != 0)) {
+	fprintf(stderr, "cbtf-overview-csv: path too long below %s\n",
+		directory);
+	return 1;
+    }
+
+    if (CBTF_overview_mkpath(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH)) {
+	fprintf(stderr, "cbtf-overview-csv: cannot create %s: %s\n",
+		dir, strerror(errno));
+	return 1;
+    }
+
+    file = fopen(path, "a");
+    if (file == NULL) {
+	fprintf(stderr, "cbtf-overview-csv: cannot open %s: %s\n",
+		path, strerror(errno));
+	return 1;
+    }
+    CBTF_overview_record_print_csv(file, NULL, record);
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Convert every record in one binary overview file.
+ *
+ * @param filename     Name of the binary overview file.
+ * @param directory    Directory receiving the CSV files or null.
+ * @return             Zero on success, non-zero otherwise.
+ */
+static int convert_file(const char* filename, const char* directory)
+{
+    CBTF_overview_record record;
+    uint32_t prefix[4];
+    int status = 0;
+    FILE* file = fopen(filename, "rb");
+
+    if (file == NULL) {
+	fprintf(stderr, "cbtf-overview-csv: cannot open %s: %s\n",
+		filename, strerror(errno));
+	return 1;
+    }
+
+    while (fread(prefix, sizeof(prefix), 1, file) == 1) {
+	if (prefix[0] != CBTF_OVERVIEW_RECORD_MAGIC) {
+	    if (prefix[0] == swap32(CBTF_OVERVIEW_RECORD_MAGIC)) {
+		fprintf(stderr, "cbtf-overview-csv: %s was written with a "
+			"different byte order\n", filename);
+	    } else {
+		fprintf(stderr, "cbtf-overview-csv: %s is corrupt or not a "
+			"binary overview file\n", filename);
+	    }
+	    status = 1;
+	    break;
+	}
+
+	/* Newer records may be longer but always begin with this layout */
+	if ((prefix[1] < CBTF_OVERVIEW_RECORD_VERSION) ||
+	    (prefix[2] < sizeof(CBTF_overview_record))) {
+	    fprintf(stderr, "cbtf-overview-csv: %s has an unsupported "
+		    "record version %u\n", filename, prefix[1]);
+	    status = 1;
+	    break;
+	}
+
+	memcpy(&record, prefix, sizeof(prefix));
+	if (fread((char*)&record + sizeof(prefix),
+		  sizeof(record) - sizeof(prefix), 1, file) != 1) {
+	    fprintf(stderr, "cbtf-overview-csv: %s is truncated\n", filename);
+	    status = 1;
+	    break;
+	}
+	if ((prefix[2] > sizeof(record)) &&
+	    (fseek(file, prefix[2] - sizeof(record), SEEK_CUR) != 0)) {
+	    fprintf(stderr, "cbtf-overview-csv: %s is truncated\n", filename);
+	    status = 1;
+	    break;
+	}
+
+	record.host[sizeof(record.host) - 1] = 0;
+	record.executable[sizeof(record.executable) - 1] = 0;
+	status |= write_record(&record, directory);
+    }
+
+    fclose(file);
+    return status;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* directory = NULL;
+    int status = 0, opt, i;
+
+    while ((opt = getopt(argc, argv, "d:h")) != -1) {
+	switch (opt) {
+	case 'd':
+	    directory = optarg;
+	    break;
+	default:
+	    fprintf(stderr, "usage: %s [-d directory] file...\n"
+		    "Converts the binary overview files written with "
+		    "CBTF_OVERVIEW_BINARY set\ninto CSV files below the "
+		    "directory, or onto the standard output.\n", argv[0]);
+	    return (opt == 'h') ? 0 : 1;
+	}
+    }
+
+    if (optind == argc) {
+	fprintf(stderr, "usage: %s [-d directory] file...\n", argv[0]);
+	return 1;
+    }
+
+    for (i = optind; i < argc; ++i) {
+	status |= convert_file(argv[i], directory);
+    }
+    return status;
+}